@@ -151,6 +151,13 @@ AS_IF([test "x$ucx_happy" = "xno"], [
                 ],
                 [AC_MSG_NOTICE([UCX: ucp_get_nbx NOT found])
                 ])
+            AC_COMPILE_IFELSE(
+                [AC_LANG_PROGRAM([[#include <ucp/api/ucp.h>]], [ucp_atomic_op_nbx])],
+                [AC_MSG_NOTICE([UCX: ucp_atomic_op_nbx found])
+               AC_DEFINE([HAVE_UCP_ATOMIC_OP_NBX], [1], [UCX has non-blocking extended ucp_atomic_op])
+                ],
+                [AC_MSG_NOTICE([UCX: ucp_atomic_op_nbx NOT found])
+                ])
             AC_COMPILE_IFELSE(
                 [AC_LANG_PROGRAM([[#include <ucp/api/ucp.h>]], [ucp_worker_flush_nbx])],
 		[AC_MSG_NOTICE([UCX: ucp_worker_flush_nbx found])
@@ -158,6 +165,21 @@ AS_IF([test "x$ucx_happy" = "xno"], [
                 ],
                 [AC_MSG_NOTICE([UCX: ucp_worker_flush_nbx NOT found])
                 ])
+            AC_COMPILE_IFELSE(
+                [AC_LANG_PROGRAM([[#include <ucp/api/ucp.h>]], [ucp_am_send_nbx])],
+                [AC_MSG_NOTICE([UCX: ucp_am_send_nbx found])
+               AC_DEFINE([HAVE_UCP_AM_SEND_NBX], [1], [UCX has non-blocking extended active messages])
+                ],
+                [AC_MSG_NOTICE([UCX: ucp_am_send_nbx NOT found])
+                ])
+            AC_COMPILE_IFELSE(
+                [AC_LANG_PROGRAM([[#include <ucp/api/ucp.h>]],
+                                 [[ucp_ep_attr_t a; a.field_mask = UCP_EP_ATTR_FIELD_TRANSPORTS; ucp_ep_query(NULL, &a)]])],
+                [AC_MSG_NOTICE([UCX: ucp_ep_query transports found])
+               AC_DEFINE([HAVE_UCP_EP_QUERY_TRANSPORTS], [1], [UCX can report the transports an endpoint uses])
+                ],
+                [AC_MSG_NOTICE([UCX: ucp_ep_query transports NOT found])
+                ])
             AC_LANG_POP([C])
             AC_SUBST([UCX_LIBS])
 
@@ -0,0 +1,101 @@
+/* For license: see LICENSE file at top-level */
+
+/*
+ * Check that a selection rule naming a power-of-2 algorithm is passed
+ * over for team sizes it can't handle.  With the rule
+ *
+ *   collect rec_dbl pes=5-8
+ *
+ * teams of 5, 6 and 7 PEs have to fall through to the configured
+ * collect algorithm, and only the team of 8 uses rec_dbl.  Each PE
+ * contributes a different number of elements.
+ *
+ * Usage: oshrun -n 8 ./a.out
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <shmem.h>
+
+#define MAX_TEAM 8
+
+/* PE i of a team contributes i + 1 elements */
+static long src[MAX_TEAM];
+static long dest[MAX_TEAM * (MAX_TEAM + 1) / 2];
+
+static int
+check_team(int n)
+{
+    shmem_team_t team;
+    int bad = 0;
+    int me;
+    int i, j, k;
+
+    shmem_team_split_strided(SHMEM_TEAM_WORLD, 0, 1, n, NULL, 0, &team);
+
+    if (team == SHMEM_TEAM_INVALID) {
+        /* not in this one, still join the world-wide check */
+        return 0;
+    }
+
+    me = shmem_team_my_pe(team);
+
+    for (i = 0; i <= me; ++i) {
+        src[i] = 100 * me + i;
+    }
+
+    shmem_long_collect(team, dest, src, me + 1);
+
+    for (i = 0, k = 0; i < n; ++i) {
+        for (j = 0; j <= i; ++j, ++k) {
+            if (dest[k] != 100 * i + j) {
+                ++bad;
+            }
+        }
+    }
+
+    shmem_team_destroy(team);
+
+    return bad;
+}
+
+int
+main(void)
+{
+    static int bad;
+    static int total;
+    int failed = 0;
+    int me;
+    int n;
+
+    /* overrides anything from the environment, just for this test */
+    setenv("SHMEM_COLL_RULES", "collect rec_dbl pes=5-8", 1);
+
+    shmem_init();
+
+    me = shmem_my_pe();
+
+    if (shmem_n_pes() < MAX_TEAM) {
+        if (me == 0) {
+            fprintf(stderr, "needs at least %d PEs\n", MAX_TEAM);
+        }
+        shmem_global_exit(1);
+    }
+
+    for (n = 5; n <= MAX_TEAM; ++n) {
+        bad = check_team(n);
+
+        shmem_int_sum_reduce(SHMEM_TEAM_WORLD, &total, &bad, 1);
+
+        if (me == 0) {
+            printf("collect on %d PEs: %s\n", n,
+                   (total == 0) ? "ok" : "FAILED");
+        }
+        failed += (total != 0);
+    }
+
+    shmem_finalize();
+
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
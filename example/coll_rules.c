@@ -0,0 +1,109 @@
+/* For license: see LICENSE file at top-level */
+
+/*
+ * Collective latency by message size, to see what selection rules
+ * buy and what they cost.  Run it without rules, then with some, e.g.
+ *
+ *   oshrun -n 16 ./a.out
+ *   SHMEM_COLL_RULES_FILE=osh_tune.rules oshrun -n 16 ./a.out
+ *
+ * The team_sync and 8-byte rows are dominated by dispatch plus the
+ * smallest message, so show the overhead of walking the rules.
+ *
+ * Usage: oshrun -n N ./a.out [max-bytes]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <shmem.h>
+#include <shmemx.h>
+
+#define REPS 100
+
+static double
+time_reduce(long *dest, long *src, size_t nelems)
+{
+    double t;
+    int r;
+
+    shmem_barrier_all();
+
+    t = shmemx_wtime();
+    for (r = 0; r < REPS; ++r) {
+        shmem_long_sum_reduce(SHMEM_TEAM_WORLD, dest, src, nelems);
+    }
+    t = shmemx_wtime() - t;
+
+    return t * 1.0e6 / REPS;
+}
+
+static double
+time_broadcast(long *dest, long *src, size_t nelems)
+{
+    double t;
+    int r;
+
+    shmem_barrier_all();
+
+    t = shmemx_wtime();
+    for (r = 0; r < REPS; ++r) {
+        shmem_long_broadcast(SHMEM_TEAM_WORLD, dest, src, nelems, 0);
+    }
+    t = shmemx_wtime() - t;
+
+    return t * 1.0e6 / REPS;
+}
+
+int
+main(int argc, char *argv[])
+{
+    size_t max = 1 << 20;
+    long *src, *dest;
+    size_t nbytes;
+    double t;
+    int me;
+    int r;
+
+    if (argc > 1) {
+        max = (size_t) atol(argv[1]);
+    }
+
+    shmem_init();
+
+    me = shmem_my_pe();
+
+    src = shmem_calloc(max / sizeof(long) + 1, sizeof(long));
+    dest = shmem_calloc(max / sizeof(long) + 1, sizeof(long));
+
+    shmem_barrier_all();
+
+    t = shmemx_wtime();
+    for (r = 0; r < REPS; ++r) {
+        shmem_team_sync(SHMEM_TEAM_WORLD);
+    }
+    t = (shmemx_wtime() - t) * 1.0e6 / REPS;
+
+    if (me == 0) {
+        printf("%d PEs, us per call\n", shmem_n_pes());
+        printf("%10s %12.2f\n", "team_sync", t);
+        printf("%10s %12s %12s\n", "bytes", "sum_reduce", "broadcast");
+    }
+
+    for (nbytes = sizeof(long); nbytes <= max; nbytes *= 4) {
+        const size_t nelems = nbytes / sizeof(long);
+        const double red = time_reduce(dest, src, nelems);
+        const double bc = time_broadcast(dest, src, nelems);
+
+        if (me == 0) {
+            printf("%10lu %12.2f %12.2f\n", (unsigned long) nbytes, red, bc);
+        }
+    }
+
+    shmem_free(dest);
+    shmem_free(src);
+
+    shmem_finalize();
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+/* For license: see LICENSE file at top-level */
+
+/*
+ * GUPS-style random small puts: every PE writes single longs to
+ * random slots of a table spread over all PEs, then quiets.  Compare
+ * put aggregation off and on, e.g.
+ *
+ *   oshrun -n 16 ./a.out
+ *   SHMEM_AGGREGATE_PUT_MAX=8 oshrun -n 16 ./a.out
+ *
+ * Usage: oshrun -n N ./a.out [log2-table-size-per-PE [updates-per-PE]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <shmem.h>
+#include <shmemx.h>
+
+static double elapsed;
+static double slowest;
+
+/* xorshift: cheap, and different on each PE */
+static uint64_t
+next_random(uint64_t *s)
+{
+    *s ^= *s << 13;
+    *s ^= *s >> 7;
+    *s ^= *s << 17;
+
+    return *s;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int logsize = 20;
+    long updates = 1 << 22;
+    uint64_t seed;
+    size_t nslots;
+    long *table;
+    double t;
+    int me, npes;
+    long i;
+
+    if (argc > 1) {
+        logsize = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        updates = atol(argv[2]);
+    }
+
+    shmem_init();
+
+    me = shmem_my_pe();
+    npes = shmem_n_pes();
+
+    nslots = (size_t) 1 << logsize;
+    table = shmem_calloc(nslots, sizeof(*table));
+    seed = 0x9e3779b97f4a7c15ULL * (me + 1);
+
+    shmem_barrier_all();
+
+    t = shmemx_wtime();
+    for (i = 0; i < updates; ++i) {
+        const uint64_t r = next_random(&seed);
+        const int pe = (int) (r % npes);
+        const size_t slot = (size_t) (r >> 32) & (nslots - 1);
+
+        shmem_long_p(&table[slot], (long) r, pe);
+    }
+    shmem_quiet();
+    elapsed = shmemx_wtime() - t;
+
+    shmem_double_max_reduce(SHMEM_TEAM_WORLD, &slowest, &elapsed, 1);
+
+    if (me == 0) {
+        printf("%d PEs, %ld updates each: %.3f s, %.3f MUPS\n",
+               npes, updates, slowest,
+               (double) updates * npes / slowest * 1.0e-6);
+    }
+
+    shmem_free(table);
+
+    shmem_finalize();
+
+    return 0;
+}
@@ -0,0 +1,142 @@
+/* For license: see LICENSE file at top-level */
+
+/*
+ * 3D halo exchange: each PE owns an N^3 block of doubles with a ghost
+ * layer all round, and sends its six faces to its neighbours (the
+ * PEs either side of it, for every direction, to keep it simple).
+ * Faces go with shmemx_put_subarray_nbi, and for comparison one
+ * shmem_double_iput per row, as before there were subarray puts.
+ *
+ * Usage: oshrun -n N ./a.out [N]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <shmem.h>
+#include <shmemx.h>
+
+#define REPS 20
+
+static int n;  /* interior points per side */
+static int m;  /* n + ghosts */
+
+/* offset of point (z, y, x), each in 0..m-1 */
+#define AT(_z, _y, _x) (((size_t) (_z) * m + (_y)) * m + (_x))
+
+/*
+ * face along dimension d (0 = z, 1 = y, 2 = x): from my interior layer
+ * "from" to the neighbour's ghost layer "to"
+ */
+static void
+face_subarray(double *grid, int d, int from, int to, int pe)
+{
+    const size_t count[2] = { n, n };
+    const ptrdiff_t plane = (ptrdiff_t) m * m;
+    ptrdiff_t st[2];
+    size_t src, dst;
+
+    switch (d) {
+    case 0:
+        st[0] = m; st[1] = 1;
+        src = AT(from, 1, 1); dst = AT(to, 1, 1);
+        break;
+    case 1:
+        st[0] = plane; st[1] = 1;
+        src = AT(1, from, 1); dst = AT(1, to, 1);
+        break;
+    default:
+        st[0] = plane; st[1] = m;
+        src = AT(1, 1, from); dst = AT(1, 1, to);
+        break;
+    }
+
+    shmemx_put_subarray_nbi(grid + dst, grid + src, sizeof(double), 2,
+                            count, st, st, pe);
+}
+
+static void
+face_rows(double *grid, int d, int from, int to, int pe)
+{
+    int i;
+
+    for (i = 1; i <= n; ++i) {
+        switch (d) {
+        case 0:
+            shmem_double_iput(grid + AT(to, i, 1), grid + AT(from, i, 1),
+                              1, 1, n, pe);
+            break;
+        case 1:
+            shmem_double_iput(grid + AT(i, to, 1), grid + AT(i, from, 1),
+                              1, 1, n, pe);
+            break;
+        default:
+            shmem_double_iput(grid + AT(i, 1, to), grid + AT(i, 1, from),
+                              m, m, n, pe);
+            break;
+        }
+    }
+}
+
+static double
+exchange(double *grid, int use_subarray)
+{
+    const int me = shmem_my_pe();
+    const int npes = shmem_n_pes();
+    const int left = (me + npes - 1) % npes;
+    const int right = (me + 1) % npes;
+    double t;
+    int r, d;
+
+    shmem_barrier_all();
+
+    t = shmemx_wtime();
+    for (r = 0; r < REPS; ++r) {
+        for (d = 0; d < 3; ++d) {
+            if (use_subarray) {
+                face_subarray(grid, d, 1, n + 1, left);
+                face_subarray(grid, d, n, 0, right);
+            } else {
+                face_rows(grid, d, 1, n + 1, left);
+                face_rows(grid, d, n, 0, right);
+            }
+        }
+        shmem_quiet();
+        shmem_barrier_all();
+    }
+    t = shmemx_wtime() - t;
+
+    return t * 1.0e6 / REPS;
+}
+
+int
+main(int argc, char *argv[])
+{
+    double *grid;
+    double sub, rows;
+
+    n = 64;
+    if (argc > 1) {
+        n = atoi(argv[1]);
+    }
+    m = n + 2;
+
+    shmem_init();
+
+    grid = shmem_calloc((size_t) m * m * m, sizeof(*grid));
+
+    sub = exchange(grid, 1);
+    rows = exchange(grid, 0);
+
+    if (shmem_my_pe() == 0) {
+        printf("%d^3 per PE, %d PEs, us per exchange\n", n, shmem_n_pes());
+        printf("  subarray nbi: %10.1f\n", sub);
+        printf("  iput per row: %10.1f\n", rows);
+    }
+
+    shmem_free(grid);
+
+    shmem_finalize();
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+/* For license: see LICENSE file at top-level */
+
+/*
+ * Multi-threaded message rate: 1, 2, 4, ... threads per PE, each with
+ * a private context, putting 8-byte messages to the next PE.  With
+ * per-context locking the rate should grow with the thread count.
+ *
+ * Build with: oshcc -pthread mt_rate.c
+ *
+ * Usage: oshrun -n 2 ./a.out [max-threads [messages-per-thread]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include <shmem.h>
+#include <shmemx.h>
+
+#define MAX_THREADS 64
+
+static long *target;
+static long msgs = 100000;
+static int pe;
+
+static pthread_barrier_t start;
+
+static void *
+sender(void *arg)
+{
+    const long slot = (long) (size_t) arg;
+    shmem_ctx_t ctx;
+    long i;
+
+    if (shmem_ctx_create(SHMEM_CTX_PRIVATE, &ctx) != 0) {
+        ctx = SHMEM_CTX_DEFAULT;
+    }
+
+    pthread_barrier_wait(&start);
+
+    for (i = 0; i < msgs; ++i) {
+        shmem_ctx_long_put_nbi(ctx, &target[slot], &i, 1, pe);
+    }
+    shmem_ctx_quiet(ctx);
+
+    if (ctx != SHMEM_CTX_DEFAULT) {
+        shmem_ctx_destroy(ctx);
+    }
+
+    return NULL;
+}
+
+int
+main(int argc, char *argv[])
+{
+    pthread_t threads[MAX_THREADS];
+    int max_threads = MAX_THREADS;
+    int provided;
+    int me;
+    int n;
+
+    if (argc > 1) {
+        max_threads = atoi(argv[1]);
+        if (max_threads > MAX_THREADS) {
+            max_threads = MAX_THREADS;
+        }
+    }
+    if (argc > 2) {
+        msgs = atol(argv[2]);
+    }
+
+    shmem_init_thread(SHMEM_THREAD_MULTIPLE, &provided);
+
+    me = shmem_my_pe();
+    pe = (me + 1) % shmem_n_pes();
+
+    if (provided != SHMEM_THREAD_MULTIPLE) {
+        if (me == 0) {
+            fprintf(stderr, "needs SHMEM_THREAD_MULTIPLE\n");
+        }
+        shmem_global_exit(1);
+    }
+
+    target = shmem_calloc(MAX_THREADS, sizeof(*target));
+
+    if (me == 0) {
+        printf("%8s %14s\n", "threads", "Mmsg/s per PE");
+    }
+
+    for (n = 1; n <= max_threads; n *= 2) {
+        double t;
+        int i;
+
+        pthread_barrier_init(&start, NULL, n + 1);
+
+        shmem_barrier_all();
+
+        for (i = 0; i < n; ++i) {
+            pthread_create(&threads[i], NULL, sender, (void *) (size_t) i);
+        }
+
+        pthread_barrier_wait(&start);
+        t = shmemx_wtime();
+
+        for (i = 0; i < n; ++i) {
+            pthread_join(threads[i], NULL);
+        }
+        t = shmemx_wtime() - t;
+
+        pthread_barrier_destroy(&start);
+
+        if (me == 0) {
+            printf("%8d %14.3f\n", n, (double) n * msgs / t * 1.0e-6);
+        }
+    }
+
+    shmem_barrier_all();
+
+    shmem_free(target);
+
+    shmem_finalize();
+
+    return 0;
+}
@@ -0,0 +1,152 @@
+/* For license: see LICENSE file at top-level */
+
+/*
+ * Compare shmem_putmem_signal_nbi with what it used to amount to, a
+ * blocking put, a fence and an atomic set, for a range of message
+ * sizes:
+ *
+ *   issue:   time to post a window of messages and quiet them, i.e.
+ *            how much the messages can overlap each other
+ *   latency: ping-pong half round trip, each side waiting on the
+ *            signal before replying
+ *
+ * Usage: oshrun -n 2 ./a.out [max-size]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <shmem.h>
+#include <shmemx.h>
+
+#define WINDOW 64
+#define REPS 100
+
+static uint64_t sig;
+
+static void
+old_put_signal(void *dest, const void *src, size_t n, uint64_t v, int pe)
+{
+    shmem_putmem(dest, src, n, pe);
+    shmem_fence();
+    shmem_uint64_atomic_set(&sig, v, pe);
+}
+
+static double
+issue(char *dest, const char *src, size_t n, int pe, int use_nbi)
+{
+    double t;
+    int r, w;
+
+    shmem_barrier_all();
+
+    t = shmemx_wtime();
+    for (r = 0; r < REPS; ++r) {
+        for (w = 0; w < WINDOW; ++w) {
+            if (use_nbi) {
+                shmem_putmem_signal_nbi(dest, src, n, &sig, 1,
+                                        SHMEM_SIGNAL_ADD, pe);
+            } else {
+                old_put_signal(dest, src, n, 1, pe);
+            }
+        }
+        shmem_quiet();
+    }
+    t = shmemx_wtime() - t;
+
+    shmem_barrier_all();
+    sig = 0;
+    shmem_barrier_all();
+
+    return t * 1.0e6 / (REPS * WINDOW);
+}
+
+static double
+latency(char *dest, const char *src, size_t n, int me, int use_nbi)
+{
+    const int other = 1 - me;
+    double t;
+    uint64_t r;
+
+    shmem_barrier_all();
+
+    t = shmemx_wtime();
+    for (r = 1; r <= REPS; ++r) {
+        if (me == 1) {
+            shmem_signal_wait_until(&sig, SHMEM_CMP_EQ, r);
+        }
+        if (use_nbi) {
+            shmem_putmem_signal_nbi(dest, src, n, &sig, r, SHMEM_SIGNAL_SET,
+                                    other);
+        } else {
+            old_put_signal(dest, src, n, r, other);
+        }
+        if (me == 0) {
+            shmem_signal_wait_until(&sig, SHMEM_CMP_EQ, r);
+        }
+    }
+    t = shmemx_wtime() - t;
+
+    shmem_barrier_all();
+    sig = 0;
+    shmem_barrier_all();
+
+    return t * 1.0e6 / (2 * REPS);
+}
+
+int
+main(int argc, char *argv[])
+{
+    size_t max = 1 << 20;
+    size_t n;
+    char *src, *dest;
+    int me;
+
+    if (argc > 1) {
+        max = (size_t) atol(argv[1]);
+    }
+
+    shmem_init();
+
+    me = shmem_my_pe();
+
+    if (shmem_n_pes() != 2) {
+        if (me == 0) {
+            fprintf(stderr, "needs exactly 2 PEs\n");
+        }
+        shmem_global_exit(1);
+    }
+
+    src = malloc(max);
+    dest = shmem_malloc(max);
+    memset(src, me, max);
+
+    if (me == 0) {
+        printf("%10s %12s %12s %12s %12s\n", "bytes",
+               "issue nbi", "issue old", "lat nbi", "lat old");
+        printf("%10s %12s %12s %12s %12s\n", "",
+               "(us/msg)", "(us/msg)", "(us)", "(us)");
+    }
+
+    for (n = 8; n <= max; n *= 4) {
+        double in, io, ln, lo;
+
+        in = issue(dest, src, n, 1 - me, 1);
+        io = issue(dest, src, n, 1 - me, 0);
+        ln = latency(dest, src, n, me, 1);
+        lo = latency(dest, src, n, me, 0);
+
+        if (me == 0) {
+            printf("%10lu %12.2f %12.2f %12.2f %12.2f\n",
+                   (unsigned long) n, in, io, ln, lo);
+        }
+    }
+
+    shmem_free(dest);
+    free(src);
+
+    shmem_finalize();
+
+    return 0;
+}
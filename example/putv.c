@@ -0,0 +1,116 @@
+/* For license: see LICENSE file at top-level */
+
+/*
+ * Message rate of many small puts to many PEs: a loop of
+ * shmem_putmem_nbi against one shmemx_putv_nbi call with the same
+ * puts, both completed by a quiet.
+ *
+ * Usage: oshrun -n N ./a.out [bytes [puts-per-batch]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <shmem.h>
+#include <shmemx.h>
+
+#define REPS 100
+
+static double
+run(int use_putv, void **dests, const void **srcs, const size_t *lens,
+    const int *pes, size_t nops)
+{
+    double t;
+    size_t i;
+    int r;
+
+    shmem_barrier_all();
+
+    t = shmemx_wtime();
+    for (r = 0; r < REPS; ++r) {
+        if (use_putv) {
+            shmemx_putv_nbi((void *const *) dests, srcs, lens, pes, nops,
+                            NULL);
+        } else {
+            for (i = 0; i < nops; ++i) {
+                shmem_putmem_nbi(dests[i], srcs[i], lens[i], pes[i]);
+            }
+        }
+        shmem_quiet();
+    }
+    t = shmemx_wtime() - t;
+
+    shmem_barrier_all();
+
+    /* millions of messages per second */
+    return (double) nops * REPS / t * 1.0e-6;
+}
+
+int
+main(int argc, char *argv[])
+{
+    size_t n = 8;
+    size_t nops = 512;
+    void **dests;
+    const void **srcs;
+    size_t *lens;
+    int *pes;
+    char *src, *dest;
+    double loop, vec;
+    int me, npes;
+    size_t i;
+
+    if (argc > 1) {
+        n = (size_t) atol(argv[1]);
+    }
+    if (argc > 2) {
+        nops = (size_t) atol(argv[2]);
+    }
+
+    shmem_init();
+
+    me = shmem_my_pe();
+    npes = shmem_n_pes();
+
+    src = malloc(nops * n);
+    dest = shmem_malloc(nops * n);
+    memset(src, me, nops * n);
+
+    dests = malloc(nops * sizeof(*dests));
+    srcs = malloc(nops * sizeof(*srcs));
+    lens = malloc(nops * sizeof(*lens));
+    pes = malloc(nops * sizeof(*pes));
+
+    /* round-robin over the other PEs, each put to its own slot */
+    for (i = 0; i < nops; ++i) {
+        dests[i] = dest + i * n;
+        srcs[i] = src + i * n;
+        lens[i] = n;
+        pes[i] = (int) ((me + 1 + i % (npes > 1 ? npes - 1 : 1)) % npes);
+    }
+
+    /* warm up: connect to everyone */
+    (void) run(0, dests, srcs, lens, pes, nops);
+
+    loop = run(0, dests, srcs, lens, pes, nops);
+    vec = run(1, dests, srcs, lens, pes, nops);
+
+    if (me == 0) {
+        printf("%lu puts of %lu bytes over %d PEs, Mmsg/s per PE\n",
+               (unsigned long) nops, (unsigned long) n, npes);
+        printf("  putmem_nbi loop: %8.3f\n", loop);
+        printf("  putv_nbi:        %8.3f\n", vec);
+    }
+
+    free(pes);
+    free(lens);
+    free(srcs);
+    free(dests);
+    shmem_free(dest);
+    free(src);
+
+    shmem_finalize();
+
+    return 0;
+}
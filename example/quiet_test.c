@@ -0,0 +1,149 @@
+/* For license: see LICENSE file at top-level */
+
+/*
+ * How much communication hides behind computation when the compute
+ * loop polls shmemx_ctx_quiet_test():
+ *
+ *   comm:     post the puts and quiet straight away
+ *   compute:  just the compute loop
+ *   no poll:  post, compute, then quiet
+ *   poll:     post, compute in slices with a quiet test between them,
+ *             then quiet once the test says done (or at the end)
+ *
+ * With perfect overlap "poll" takes as long as the longer of "comm"
+ * and "compute".
+ *
+ * Usage: oshrun -n 2 ./a.out [bytes [compute-slices]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <shmem.h>
+#include <shmemx.h>
+
+#define NPUTS 16
+#define REPS 20
+
+static volatile double sink;
+
+static void
+compute_slice(void)
+{
+    double x = 0.0;
+    int i;
+
+    for (i = 0; i < 20000; ++i) {
+        x += i * 0.5;
+    }
+    sink = x;
+}
+
+static void
+post(shmem_ctx_t ctx, char *dest, const char *src, size_t n, int pe)
+{
+    int i;
+
+    for (i = 0; i < NPUTS; ++i) {
+        shmem_ctx_putmem_nbi(ctx, dest + i * n, src + i * n, n, pe);
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    size_t n = 1 << 20;
+    int slices = 100;
+    shmem_ctx_t ctx;
+    char *src, *dest;
+    double t[4];
+    int me, pe;
+    int r, s;
+
+    if (argc > 1) {
+        n = (size_t) atol(argv[1]);
+    }
+    if (argc > 2) {
+        slices = atoi(argv[2]);
+    }
+
+    shmem_init();
+
+    me = shmem_my_pe();
+    pe = (me + 1) % shmem_n_pes();
+
+    if (shmem_ctx_create(SHMEM_CTX_PRIVATE, &ctx) != 0) {
+        ctx = SHMEM_CTX_DEFAULT;
+    }
+
+    src = malloc(NPUTS * n);
+    dest = shmem_malloc(NPUTS * n);
+    memset(src, me, NPUTS * n);
+
+    memset(t, 0, sizeof(t));
+
+    for (r = 0; r < REPS; ++r) {
+        double t0;
+        int done;
+
+        shmem_barrier_all();
+        t0 = shmemx_wtime();
+        post(ctx, dest, src, n, pe);
+        shmem_ctx_quiet(ctx);
+        t[0] += shmemx_wtime() - t0;
+
+        shmem_barrier_all();
+        t0 = shmemx_wtime();
+        for (s = 0; s < slices; ++s) {
+            compute_slice();
+        }
+        t[1] += shmemx_wtime() - t0;
+
+        shmem_barrier_all();
+        t0 = shmemx_wtime();
+        post(ctx, dest, src, n, pe);
+        for (s = 0; s < slices; ++s) {
+            compute_slice();
+        }
+        shmem_ctx_quiet(ctx);
+        t[2] += shmemx_wtime() - t0;
+
+        shmem_barrier_all();
+        t0 = shmemx_wtime();
+        post(ctx, dest, src, n, pe);
+        done = 0;
+        for (s = 0; s < slices; ++s) {
+            compute_slice();
+            if (!done) {
+                done = shmemx_ctx_quiet_test(ctx);
+            }
+        }
+        if (!done) {
+            shmem_ctx_quiet(ctx);
+        }
+        t[3] += shmemx_wtime() - t0;
+    }
+
+    shmem_barrier_all();
+
+    if (me == 0) {
+        printf("%d x %lu byte puts, %d compute slices (ms)\n",
+               NPUTS, (unsigned long) n, slices);
+        printf("  comm:    %10.3f\n", t[0] * 1.0e3 / REPS);
+        printf("  compute: %10.3f\n", t[1] * 1.0e3 / REPS);
+        printf("  no poll: %10.3f\n", t[2] * 1.0e3 / REPS);
+        printf("  poll:    %10.3f\n", t[3] * 1.0e3 / REPS);
+    }
+
+    shmem_free(dest);
+    free(src);
+
+    if (ctx != SHMEM_CTX_DEFAULT) {
+        shmem_ctx_destroy(ctx);
+    }
+
+    shmem_finalize();
+
+    return 0;
+}
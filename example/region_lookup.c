@@ -0,0 +1,78 @@
+/* For license: see LICENSE file at top-level */
+
+/*
+ * Time shmem_long_p to the next PE, with the target always in the
+ * same symmetric region, and alternating between the global data and
+ * the heap.  The first case hits the per-context region hint every
+ * time, the second misses it every time and takes the binary search.
+ *
+ * Usage: oshrun -n 2 ./a.out [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <shmem.h>
+#include <shmemx.h>
+
+static long global_target;
+
+static double
+time_puts(long *a, long *b, long iters, int pe)
+{
+    double t;
+    long i;
+
+    shmem_barrier_all();
+
+    t = shmemx_wtime();
+    for (i = 0; i < iters; i += 2) {
+        shmem_long_p(a, i, pe);
+        shmem_long_p(b, i + 1, pe);
+    }
+    shmem_quiet();
+    t = shmemx_wtime() - t;
+
+    shmem_barrier_all();
+
+    return t * 1.0e9 / iters;
+}
+
+int
+main(int argc, char *argv[])
+{
+    long iters = 1000000;
+    long *heap_target;
+    double same, alternate;
+    int me, npes, pe;
+
+    if (argc > 1) {
+        iters = atol(argv[1]);
+    }
+
+    shmem_init();
+
+    me = shmem_my_pe();
+    npes = shmem_n_pes();
+    pe = (me + 1) % npes;
+
+    heap_target = shmem_malloc(sizeof(*heap_target));
+
+    /* warm up: connect, map, etc. */
+    (void) time_puts(heap_target, &global_target, 1000, pe);
+
+    same = time_puts(heap_target, heap_target, iters, pe);
+    alternate = time_puts(heap_target, &global_target, iters, pe);
+
+    if (me == 0) {
+        printf("shmem_long_p, %ld iterations\n", iters);
+        printf("  same region:        %8.1f ns/op\n", same);
+        printf("  alternating region: %8.1f ns/op\n", alternate);
+    }
+
+    shmem_free(heap_target);
+
+    shmem_finalize();
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+/* For license: see LICENSE file at top-level */
+
+/*
+ * Time start-up: shmem_init, creating a context, and then talking to
+ * a few peers for the first time.  Run it at different PE counts,
+ * with and without SHMEM_LAZY_CONNECT, e.g.
+ *
+ *   for n in 16 64 256 1024; do
+ *     oshrun -n $n ./a.out
+ *     SHMEM_LAZY_CONNECT=y oshrun -n $n ./a.out
+ *   done
+ *
+ * Usage: oshrun -n N ./a.out [peers]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <shmem.h>
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1.0e-9;
+}
+
+static double times[3];
+static double maxes[3];
+
+static long target;
+
+int
+main(int argc, char *argv[])
+{
+    int peers = 8;
+    shmem_ctx_t ctx;
+    double t;
+    int me, npes;
+    int i;
+
+    if (argc > 1) {
+        peers = atoi(argv[1]);
+    }
+
+    t = now();
+    shmem_init();
+    times[0] = now() - t;
+
+    me = shmem_my_pe();
+    npes = shmem_n_pes();
+
+    if (peers > npes - 1) {
+        peers = npes - 1;
+    }
+
+    t = now();
+    if (shmem_ctx_create(0, &ctx) != 0) {
+        ctx = SHMEM_CTX_DEFAULT;
+    }
+    times[1] = now() - t;
+
+    /* first contact with a few neighbours */
+    t = now();
+    for (i = 1; i <= peers; ++i) {
+        shmem_ctx_long_atomic_inc(ctx, &target, (me + i) % npes);
+    }
+    shmem_ctx_quiet(ctx);
+    times[2] = now() - t;
+
+    shmem_double_max_reduce(SHMEM_TEAM_WORLD, maxes, times, 3);
+
+    if (me == 0) {
+        printf("%d PEs, slowest PE:\n", npes);
+        printf("  shmem_init:          %10.3f ms\n", maxes[0] * 1.0e3);
+        printf("  shmem_ctx_create:    %10.3f ms\n", maxes[1] * 1.0e3);
+        printf("  first AMO to %3d PEs: %9.3f ms\n", peers, maxes[2] * 1.0e3);
+    }
+
+    if (ctx != SHMEM_CTX_DEFAULT) {
+        shmem_ctx_destroy(ctx);
+    }
+
+    shmem_finalize();
+
+    return 0;
+}
@@ -0,0 +1,120 @@
+/* For license: see LICENSE file at top-level */
+
+/*
+ * Strided bandwidth: shmem_long_iput/iget of a column (stride on one
+ * or both sides) to the next PE, against a contiguous put of the same
+ * amount of data.
+ *
+ * Usage: oshrun -n 2 ./a.out [stride [max-elements]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <shmem.h>
+#include <shmemx.h>
+
+#define REPS 10
+
+enum { PUT_CONTIG, IPUT_SRC, IPUT_DST, IPUT_BOTH, IGET_SRC, IGET_DST, NKINDS };
+
+static const char *names[NKINDS] = {
+    "put", "iput src", "iput dst", "iput both", "iget src", "iget dst"
+};
+
+static double
+run(int kind, long *remote, long *local, ptrdiff_t stride, size_t n, int pe)
+{
+    double t;
+    int r;
+
+    shmem_barrier_all();
+
+    t = shmemx_wtime();
+    for (r = 0; r < REPS; ++r) {
+        switch (kind) {
+        case PUT_CONTIG:
+            shmem_long_put(remote, local, n, pe);
+            break;
+        case IPUT_SRC:
+            shmem_long_iput(remote, local, 1, stride, n, pe);
+            break;
+        case IPUT_DST:
+            shmem_long_iput(remote, local, stride, 1, n, pe);
+            break;
+        case IPUT_BOTH:
+            shmem_long_iput(remote, local, stride, stride, n, pe);
+            break;
+        case IGET_SRC:
+            shmem_long_iget(local, remote, 1, stride, n, pe);
+            break;
+        case IGET_DST:
+            shmem_long_iget(local, remote, stride, 1, n, pe);
+            break;
+        }
+    }
+    shmem_quiet();
+    t = shmemx_wtime() - t;
+
+    shmem_barrier_all();
+
+    /* MB/s */
+    return (double) n * sizeof(long) * REPS / t * 1.0e-6;
+}
+
+int
+main(int argc, char *argv[])
+{
+    ptrdiff_t stride = 16;
+    size_t max = 1 << 20;
+    long *remote, *local;
+    size_t n;
+    int me, pe;
+    int k;
+
+    if (argc > 1) {
+        stride = atol(argv[1]);
+    }
+    if (argc > 2) {
+        max = (size_t) atol(argv[2]);
+    }
+
+    shmem_init();
+
+    me = shmem_my_pe();
+    pe = (me + 1) % shmem_n_pes();
+
+    remote = shmem_calloc(max * stride, sizeof(long));
+    local = shmem_calloc(max * stride, sizeof(long));
+
+    if (me == 0) {
+        printf("stride %ld, MB/s\n%10s", (long) stride, "elements");
+        for (k = 0; k < NKINDS; ++k) {
+            printf(" %10s", names[k]);
+        }
+        printf("\n");
+    }
+
+    for (n = 1; n <= max; n *= 8) {
+        if (me == 0) {
+            printf("%10lu", (unsigned long) n);
+        }
+        for (k = 0; k < NKINDS; ++k) {
+            const double bw = run(k, remote, local, stride, n, pe);
+
+            if (me == 0) {
+                printf(" %10.1f", bw);
+            }
+        }
+        if (me == 0) {
+            printf("\n");
+        }
+    }
+
+    shmem_free(local);
+    shmem_free(remote);
+
+    shmem_finalize();
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+/* For license: see LICENSE file at top-level */
+
+/*
+ * shmem_long_wait_until_any over large flag arrays:
+ *
+ *   sweep:   cost of one shmem_long_test_any over flags none of which
+ *            are set, i.e. one full scan
+ *   wake-up: PE 1 sets a random flag on PE 0, which waits for any
+ *            flag, clears it and acknowledges; half the round trip
+ *
+ * Usage: oshrun -n 2 ./a.out [max-flags]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <shmem.h>
+#include <shmemx.h>
+
+#define SWEEPS 1000
+#define WAKES 1000
+
+static long ack;
+
+static double
+sweep(long *flags, size_t nflags)
+{
+    double t;
+    size_t found = 0;
+    int i;
+
+    t = shmemx_wtime();
+    for (i = 0; i < SWEEPS; ++i) {
+        if (shmem_long_test_any(flags, nflags, NULL, SHMEM_CMP_NE, 0) !=
+            SIZE_MAX) {
+            ++found;
+        }
+    }
+    t = shmemx_wtime() - t;
+
+    if (found > 0) {
+        printf("unexpected flags found\n");
+    }
+
+    return t * 1.0e9 / SWEEPS;
+}
+
+static double
+wake(long *flags, size_t nflags, int me)
+{
+    double t;
+    long r;
+
+    shmem_barrier_all();
+
+    t = shmemx_wtime();
+    for (r = 1; r <= WAKES; ++r) {
+        if (me == 0) {
+            const size_t i =
+                shmem_long_wait_until_any(flags, nflags, NULL, SHMEM_CMP_NE,
+                                          0);
+
+            flags[i] = 0;
+            shmem_long_atomic_set(&ack, r, 1);
+        } else {
+            const size_t i = (size_t) rand() % nflags;
+
+            shmem_long_atomic_set(&flags[i], 1, 0);
+            shmem_long_wait_until(&ack, SHMEM_CMP_EQ, r);
+        }
+    }
+    t = shmemx_wtime() - t;
+
+    shmem_barrier_all();
+    ack = 0;
+    shmem_barrier_all();
+
+    return t * 1.0e6 / (2 * WAKES);
+}
+
+int
+main(int argc, char *argv[])
+{
+    size_t max = 1 << 16;
+    size_t n;
+    long *flags;
+    int me;
+
+    if (argc > 1) {
+        max = (size_t) atol(argv[1]);
+    }
+
+    shmem_init();
+
+    me = shmem_my_pe();
+
+    if (shmem_n_pes() != 2) {
+        if (me == 0) {
+            fprintf(stderr, "needs exactly 2 PEs\n");
+        }
+        shmem_global_exit(1);
+    }
+
+    flags = shmem_calloc(max, sizeof(*flags));
+
+    if (me == 0) {
+        printf("%10s %14s %14s\n", "flags", "sweep (ns)", "wake-up (us)");
+    }
+
+    for (n = 64; n <= max; n *= 4) {
+        double s = 0.0;
+        double w;
+
+        if (me == 0) {
+            s = sweep(flags, n);
+        }
+        w = wake(flags, n, me);
+
+        if (me == 0) {
+            printf("%10lu %14.1f %14.2f\n", (unsigned long) n, s, w);
+        }
+    }
+
+    shmem_free(flags);
+
+    shmem_finalize();
+
+    return 0;
+}
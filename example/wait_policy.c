@@ -0,0 +1,117 @@
+/* For license: see LICENSE file at top-level */
+
+/*
+ * Wake-up latency under each wait policy.  PE 0 waits on a flag, PE 1
+ * sleeps for a while, then sets it and times how long PE 0 takes to
+ * answer.  The sleep is long enough for PE 0 to be well into its
+ * policy's last phase; PE 1 always spins for the answer.
+ *
+ * Blocking needs the wakeup support asked for at startup, so run
+ * with SHMEM_WAIT_BLOCK set to something, e.g.
+ *
+ *   SHMEM_WAIT_BLOCK=1ms oshrun -n 2 ./a.out
+ *
+ * Usage: oshrun -n 2 ./a.out [sleep-us]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <shmem.h>
+#include <shmemx.h>
+
+#define WAKES 200
+
+static long flag;
+static long answer;
+
+static const struct {
+    const char *name;
+    size_t spin_ns;
+    size_t block_ns;
+} policies[] = {
+    { "spin",     (size_t) -1, 0    },
+    { "wait_mem", 0,           0    },
+    { "block",    0,           1000 },
+};
+
+static void
+nap(long us)
+{
+    struct timespec ts;
+
+    ts.tv_sec = us / 1000000;
+    ts.tv_nsec = (us % 1000000) * 1000;
+    nanosleep(&ts, NULL);
+}
+
+int
+main(int argc, char *argv[])
+{
+    long sleep_us = 2000;
+    int me;
+    size_t p;
+
+    if (argc > 1) {
+        sleep_us = atol(argv[1]);
+    }
+
+    shmem_init();
+
+    me = shmem_my_pe();
+
+    if (shmem_n_pes() != 2) {
+        if (me == 0) {
+            fprintf(stderr, "needs exactly 2 PEs\n");
+        }
+        shmem_global_exit(1);
+    }
+
+    if (me == 1) {
+        printf("%10s %14s\n", "policy", "wake-up (us)");
+    }
+
+    for (p = 0; p < sizeof(policies) / sizeof(policies[0]); ++p) {
+        double total = 0.0;
+        long r;
+
+        if (me == 0) {
+            shmemx_ctx_set_wait_policy(SHMEM_CTX_DEFAULT, policies[p].spin_ns,
+                                       policies[p].block_ns);
+        } else {
+            shmemx_ctx_set_wait_policy(SHMEM_CTX_DEFAULT, (size_t) -1, 0);
+        }
+
+        shmem_barrier_all();
+
+        for (r = 1; r <= WAKES; ++r) {
+            if (me == 0) {
+                shmem_long_wait_until(&flag, SHMEM_CMP_EQ, r);
+                shmem_long_atomic_set(&answer, r, 1);
+            } else {
+                double t;
+
+                nap(sleep_us);
+
+                t = shmemx_wtime();
+                shmem_long_atomic_set(&flag, r, 0);
+                shmem_long_wait_until(&answer, SHMEM_CMP_EQ, r);
+                total += shmemx_wtime() - t;
+            }
+        }
+
+        shmem_barrier_all();
+        flag = 0;
+        answer = 0;
+        shmem_barrier_all();
+
+        if (me == 1) {
+            printf("%10s %14.2f\n", policies[p].name, total * 1.0e6 / WAKES);
+        }
+    }
+
+    shmem_finalize();
+
+    return 0;
+}
@@ -63,8 +63,9 @@ void *shmemx_lookup_remote_addr(void *addr, int pe);
 /** @} */
 
 /**
- * @defgroup shmemx_fence_quiet Non-blocking Fence/Quiet Functions
- * @brief Functions for testing fence and quiet completion
+ * @defgroup shmemx_fence_quiet Non-blocking and Per-PE Fence/Quiet Functions
+ * @brief Functions for testing fence and quiet completion, or
+ * limiting them to one PE
  * @{
  */
 
@@ -102,6 +103,284 @@ int shmemx_fence_test(void);
  */
 int shmemx_quiet_test(void);
 
+/**
+ * @brief Fence, but only order operations to one PE
+ *
+ * Puts, AMOs and signals issued on ctx to pe before this call are
+ * delivered to pe before any issued after it.  Operations to other
+ * PEs are not waited for.
+ *
+ * @param ctx Context on which to fence
+ * @param pe PE to order operations to
+ */
+void shmemx_ctx_fence_pe(shmem_ctx_t ctx, int pe);
+
+/**
+ * @brief Quiet, but only complete operations to one PE
+ *
+ * All operations issued on ctx to pe before this call have completed
+ * when it returns.  Operations to other PEs might not have.
+ *
+ * @param ctx Context on which to quiet
+ * @param pe PE whose operations are completed
+ */
+void shmemx_ctx_quiet_pe(shmem_ctx_t ctx, int pe);
+
+/**
+ * @brief shmemx_ctx_fence_pe on the default context
+ * @param pe PE to order operations to
+ */
+void shmemx_fence_pe(int pe);
+
+/**
+ * @brief shmemx_ctx_quiet_pe on the default context
+ * @param pe PE whose operations are completed
+ */
+void shmemx_quiet_pe(int pe);
+
+/** @} */
+
+/**
+ * @defgroup shmemx_subarray Multi-dimensional Subarray Transfers
+ * @brief Functions for moving rectangular pieces of symmetric arrays
+ *
+ * A subarray is described by the number of dimensions, the number of
+ * elements to move along each dimension, and the distance (in
+ * elements) between consecutive indices of each dimension on the
+ * target and source sides.  Dimension 0 is the outermost and
+ * dimension (ndims - 1) the innermost.  So e.g. a C array
+ * "double a[NZ][NY][NX]" has strides {NY * NX, NX, 1}.
+ *
+ * The whole subarray must lie within one symmetric object.
+ * @{
+ */
+
+/** @brief Most dimensions a subarray can have */
+#define SHMEMX_SUBARRAY_MAX_DIMS 8
+
+/**
+ * @brief Copy a subarray from the local PE to a remote PE
+ *
+ * @param ctx Context on which to perform the transfer
+ * @param dest Symmetric address of the first element on the target
+ * @param source Local address of the first element to copy
+ * @param elsize Size in bytes of each element
+ * @param ndims Number of dimensions (1..SHMEMX_SUBARRAY_MAX_DIMS)
+ * @param count Number of elements along each dimension
+ * @param dst_strides Target stride of each dimension, in elements
+ * @param src_strides Source stride of each dimension, in elements
+ * @param pe PE number of the remote PE
+ *
+ * @note Returns when source can be reused.  Completion at the target
+ * is as for shmem_put, i.e. after the next quiet.
+ */
+void shmemx_ctx_put_subarray(shmem_ctx_t ctx, void *dest, const void *source,
+                             size_t elsize, int ndims, const size_t *count,
+                             const ptrdiff_t *dst_strides,
+                             const ptrdiff_t *src_strides, int pe);
+
+/**
+ * @brief Copy a subarray from a remote PE to the local PE
+ *
+ * @param ctx Context on which to perform the transfer
+ * @param dest Local address of the first element to fill
+ * @param source Symmetric address of the first element on the target
+ * @param elsize Size in bytes of each element
+ * @param ndims Number of dimensions (1..SHMEMX_SUBARRAY_MAX_DIMS)
+ * @param count Number of elements along each dimension
+ * @param dst_strides Local stride of each dimension, in elements
+ * @param src_strides Target stride of each dimension, in elements
+ * @param pe PE number of the remote PE
+ *
+ * @note Returns when dest has been filled in.
+ */
+void shmemx_ctx_get_subarray(shmem_ctx_t ctx, void *dest, const void *source,
+                             size_t elsize, int ndims, const size_t *count,
+                             const ptrdiff_t *dst_strides,
+                             const ptrdiff_t *src_strides, int pe);
+
+/**
+ * @brief Non-blocking version of shmemx_ctx_put_subarray
+ *
+ * @note source must not be modified until after the next quiet on
+ * ctx.  Count and stride arrays can be reused on return.
+ */
+void shmemx_ctx_put_subarray_nbi(shmem_ctx_t ctx, void *dest,
+                                 const void *source, size_t elsize, int ndims,
+                                 const size_t *count,
+                                 const ptrdiff_t *dst_strides,
+                                 const ptrdiff_t *src_strides, int pe);
+
+/**
+ * @brief Non-blocking version of shmemx_ctx_get_subarray
+ *
+ * @note dest is filled in after the next quiet on ctx.  Count and
+ * stride arrays can be reused on return.
+ */
+void shmemx_ctx_get_subarray_nbi(shmem_ctx_t ctx, void *dest,
+                                 const void *source, size_t elsize, int ndims,
+                                 const size_t *count,
+                                 const ptrdiff_t *dst_strides,
+                                 const ptrdiff_t *src_strides, int pe);
+
+/**
+ * @brief shmemx_ctx_put_subarray on the default context
+ */
+void shmemx_put_subarray(void *dest, const void *source, size_t elsize,
+                         int ndims, const size_t *count,
+                         const ptrdiff_t *dst_strides,
+                         const ptrdiff_t *src_strides, int pe);
+
+/**
+ * @brief shmemx_ctx_get_subarray on the default context
+ */
+void shmemx_get_subarray(void *dest, const void *source, size_t elsize,
+                         int ndims, const size_t *count,
+                         const ptrdiff_t *dst_strides,
+                         const ptrdiff_t *src_strides, int pe);
+
+/**
+ * @brief shmemx_ctx_put_subarray_nbi on the default context
+ */
+void shmemx_put_subarray_nbi(void *dest, const void *source, size_t elsize,
+                             int ndims, const size_t *count,
+                             const ptrdiff_t *dst_strides,
+                             const ptrdiff_t *src_strides, int pe);
+
+/**
+ * @brief shmemx_ctx_get_subarray_nbi on the default context
+ */
+void shmemx_get_subarray_nbi(void *dest, const void *source, size_t elsize,
+                             int ndims, const size_t *count,
+                             const ptrdiff_t *dst_strides,
+                             const ptrdiff_t *src_strides, int pe);
+
+/** @} */
+
+/**
+ * @defgroup shmemx_vectored Vectored Transfers
+ * @brief Functions for issuing many independent transfers in one call
+ *
+ * Transfer i moves nbytes[i] bytes between dests[i] and sources[i] on
+ * PE pes[i].  The transfers are unordered with respect to each other,
+ * and complete like any other non-blocking transfer, i.e. by the next
+ * quiet on the context.  All four arrays can be reused on return.
+ *
+ * If completed is not NULL, *completed is incremented (atomically) as
+ * each transfer completes locally: for puts the source buffer can be
+ * reused, for gets the destination buffer has been filled in.  It
+ * advances as the context makes progress, e.g. in
+ * shmemx_ctx_quiet_test().
+ * @{
+ */
+
+/**
+ * @brief Post a batch of non-blocking puts
+ *
+ * @param ctx Context on which to perform the transfers
+ * @param dests Symmetric target addresses
+ * @param sources Local source addresses
+ * @param nbytes Number of bytes for each transfer
+ * @param pes Target PE of each transfer
+ * @param nops Number of transfers
+ * @param completed Optional local completion counter, or NULL
+ */
+void shmemx_ctx_putv_nbi(shmem_ctx_t ctx, void *const *dests,
+                         const void *const *sources, const size_t *nbytes,
+                         const int *pes, size_t nops, uint64_t *completed);
+
+/**
+ * @brief Post a batch of non-blocking gets
+ *
+ * @param ctx Context on which to perform the transfers
+ * @param dests Local destination addresses
+ * @param sources Symmetric source addresses
+ * @param nbytes Number of bytes for each transfer
+ * @param pes Source PE of each transfer
+ * @param nops Number of transfers
+ * @param completed Optional local completion counter, or NULL
+ */
+void shmemx_ctx_getv_nbi(shmem_ctx_t ctx, void *const *dests,
+                         const void *const *sources, const size_t *nbytes,
+                         const int *pes, size_t nops, uint64_t *completed);
+
+/**
+ * @brief shmemx_ctx_putv_nbi on the default context
+ */
+void shmemx_putv_nbi(void *const *dests, const void *const *sources,
+                     const size_t *nbytes, const int *pes, size_t nops,
+                     uint64_t *completed);
+
+/**
+ * @brief shmemx_ctx_getv_nbi on the default context
+ */
+void shmemx_getv_nbi(void *const *dests, const void *const *sources,
+                     const size_t *nbytes, const int *pes, size_t nops,
+                     uint64_t *completed);
+
+/** @} */
+
+/**
+ * @defgroup shmemx_am Active Messages
+ * @brief Functions for running handlers on other PEs
+ *
+ * A handler registered under an id on the target PE is run there with
+ * the message payload when the target makes progress: in its progress
+ * thread if it has one, otherwise during its next OpenSHMEM call that
+ * makes progress (e.g. shmemx_am_progress()).  Every PE has to
+ * register the same handler under the same id.
+ *
+ * Handlers must not call blocking OpenSHMEM routines, but can send
+ * active messages, e.g. to reply to the PE that sent the message.
+ * Needs SHMEM_ACTIVE_MESSAGES to be set when the program starts.
+ * @{
+ */
+
+/** @brief Number of handler ids available, from 0 */
+#define SHMEMX_AM_MAX_HANDLERS 64
+
+/**
+ * @brief Active message handler
+ *
+ * @param src_pe PE that sent the message
+ * @param payload Message payload (only valid during the call, and
+ * not necessarily aligned)
+ * @param nbytes Size of payload in bytes
+ * @param arg Argument given when the handler was registered
+ */
+typedef void (*shmemx_am_handler_t)(int src_pe, const void *payload,
+                                    size_t nbytes, void *arg);
+
+/**
+ * @brief Register a handler for active messages with the given id
+ *
+ * @param id Handler id, from 0 to SHMEMX_AM_MAX_HANDLERS - 1
+ * @param handler Handler to run, or NULL to remove the current one
+ * @param arg Passed through to the handler
+ * @return 0 on success, non-zero otherwise (including when active
+ * messages are not enabled)
+ */
+int shmemx_am_register(int id, shmemx_am_handler_t handler, void *arg);
+
+/**
+ * @brief Send an active message to a PE
+ *
+ * Returns straight away: payload can be reused on return.  The
+ * message has arrived at pe after the next quiet on the default
+ * context, and its handler runs when pe next makes progress.
+ *
+ * @param pe PE to run the handler on
+ * @param id Handler id
+ * @param payload Data to pass to the handler
+ * @param nbytes Size of payload in bytes
+ */
+void shmemx_am_send(int pe, int id, const void *payload, size_t nbytes);
+
+/**
+ * @brief Run handlers for any active messages that have arrived
+ */
+void shmemx_am_progress(void);
+
 /** @} */
 
 /**
@@ -122,6 +401,21 @@ void shmemx_ctx_session_start(shmem_ctx_t ctx);
  */
 void shmemx_ctx_session_stop(shmem_ctx_t ctx);
 
+/**
+ * @brief Set how waits on a context use the CPU
+ *
+ * Waits (wait_until, signal_wait_until, locks) poll for spin_ns, then
+ * park or yield the CPU, then, if block_ns is non-zero, sleep on
+ * communication events once they have lasted block_ns.  Sleeping
+ * needs SHMEM_WAIT_BLOCK set at startup.
+ *
+ * @param ctx Context to set the policy on
+ * @param spin_ns Nanoseconds to poll flat out
+ * @param block_ns Nanoseconds after which to sleep, 0 for never
+ */
+void shmemx_ctx_set_wait_policy(shmem_ctx_t ctx, size_t spin_ns,
+                                size_t block_ns);
+
 /** @} */
 
 /**
@@ -84,4 +84,11 @@
 /** Default algorithm for product-reduce operations */
 #define COLLECTIVES_DEFAULT_PROD_REDUCE COLLECTIVES_DEFAULT_REDUCTIONS
 
+/**
+ * Built-in algorithm selection rules (see rules.h).  None until there
+ * are measurements to base them on: osh_tune writes rules for a given
+ * system
+ */
+#define COLLECTIVES_DEFAULT_RULES ""
+
 #endif /* ! _COLLECTIVES_DEFAULTS_H */
@@ -0,0 +1,476 @@
+/**
+ * @file rules.c
+ * @brief Reading and checking collective algorithm selection rules
+ *
+ * Rules are written one per line, or separated by ';':
+ *
+ *   <collective> <algorithm> [pes=<range>] [bytes=<range>]
+ *
+ * A range is "lo-hi", "lo-", "-hi" or a single value, and byte counts
+ * can have the usual K/M/G... suffixes.  A missing range matches
+ * anything.  '#' starts a comment that runs to the end of the line.
+ *
+ * The collectives are alltoall, alltoalls, collect, fcollect,
+ * broadcast, {and,or,xor,max,min,sum,prod}_reduce, barrier_all,
+ * sync_all and team_sync; "reduce" stands for all of the reductions.
+ * Typed and "mem" variants share rules.
+ *
+ * A rule is passed over for team sizes its algorithm can't handle,
+ * e.g. "collect rec_dbl pes=5-8" only applies to teams of 8.
+ *
+ * Every PE has to pick the same algorithm.  PEs can contribute
+ * different amounts to a collect, so collect rules only look at the
+ * number of PEs.
+ *
+ * e.g.
+ *
+ *   broadcast scatter_collect bytes=256K-
+ *   team_sync dissemination pes=-64
+ *
+ * @copyright See LICENSE file at top-level
+ */
+
+#include "thispe.h"
+#include "state.h"
+#include "shmemu.h"
+#include "collectives/rules.h"
+#include "collectives/defaults.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+
+/** Rules for each collective */
+coll_rule_set_t coll_rules[COLL_RULE_NUM_OPS];
+
+/**
+ * @brief Generate a check that an algorithm is registered for a collective
+ * @param _coll Collective operation name
+ * @param _fn_t Type of its implementations
+ */
+#define RULE_CHECK(_coll, _fn_t)                                               \
+  static bool check_##_coll(const char *algo) {                                \
+    _fn_t f;                                                                   \
+                                                                               \
+    return lookup_##_coll(algo, &f) == 0;                                      \
+  }
+
+/**
+ * @brief Same for a typed collective: a rule applies to calls of any
+ * type, so every type has to have the algorithm
+ * @param _coll Collective operation name
+ */
+#define RULE_CHECK_TYPED(_coll)                                                \
+  static bool check_##_coll(const char *algo) {                                \
+    return lookup_every_##_coll(algo) == 0;                                    \
+  }
+
+RULE_CHECK_TYPED(alltoall_type)
+RULE_CHECK(alltoall_mem, untyped_coll_fn_t)
+RULE_CHECK_TYPED(alltoalls_type)
+RULE_CHECK(alltoalls_mem, untyped_coll_fn_t)
+RULE_CHECK_TYPED(collect_type)
+RULE_CHECK(collect_mem, untyped_coll_fn_t)
+RULE_CHECK_TYPED(fcollect_type)
+RULE_CHECK(fcollect_mem, untyped_coll_fn_t)
+RULE_CHECK_TYPED(broadcast_type)
+RULE_CHECK(broadcast_mem, untyped_coll_fn_t)
+RULE_CHECK_TYPED(and_reduce)
+RULE_CHECK_TYPED(or_reduce)
+RULE_CHECK_TYPED(xor_reduce)
+RULE_CHECK_TYPED(max_reduce)
+RULE_CHECK_TYPED(min_reduce)
+RULE_CHECK_TYPED(sum_reduce)
+RULE_CHECK_TYPED(prod_reduce)
+RULE_CHECK(barrier_all, coll_fn_t)
+RULE_CHECK(sync_all, coll_fn_t)
+RULE_CHECK(team_sync, untyped_coll_fn_t)
+
+#undef RULE_CHECK_TYPED
+#undef RULE_CHECK
+
+/**
+ * @brief What we need to know about each collective that can have rules
+ */
+typedef struct rule_op {
+  const char *name;                /**< as written in rules */
+  char *const *configured;         /**< SHMEM_<OP>_ALGO setting... */
+  const char *dflt;                /**< ...and its default */
+  bool (*check)(const char *);     /**< algorithm is registered? */
+  bool (*check_mem)(const char *); /**< ...for "mem" variant too? */
+  int (*fits)(const char *, int);  /**< algorithm runs on this many PEs? */
+} rule_op_t;
+
+static const rule_op_t rule_ops[COLL_RULE_NUM_OPS] = {
+    [COLL_RULE_ALLTOALL] = {"alltoall", &proc.env.coll.alltoall_type,
+                            COLLECTIVES_DEFAULT_ALLTOALL, check_alltoall_type,
+                            check_alltoall_mem, algorithm_fits_alltoall_mem},
+    [COLL_RULE_ALLTOALLS] = {"alltoalls", &proc.env.coll.alltoalls_type,
+                             COLLECTIVES_DEFAULT_ALLTOALLS,
+                             check_alltoalls_type, check_alltoalls_mem,
+                             algorithm_fits_alltoalls_mem},
+    [COLL_RULE_COLLECT] = {"collect", &proc.env.coll.collect_type,
+                           COLLECTIVES_DEFAULT_COLLECT, check_collect_type,
+                           check_collect_mem, algorithm_fits_collect_mem},
+    [COLL_RULE_FCOLLECT] = {"fcollect", &proc.env.coll.fcollect_type,
+                            COLLECTIVES_DEFAULT_FCOLLECT, check_fcollect_type,
+                            check_fcollect_mem, algorithm_fits_fcollect_mem},
+    [COLL_RULE_BROADCAST] = {"broadcast", &proc.env.coll.broadcast_type,
+                             COLLECTIVES_DEFAULT_BROADCAST,
+                             check_broadcast_type, check_broadcast_mem,
+                             algorithm_fits_broadcast_mem},
+    [COLL_RULE_AND_REDUCE] = {"and_reduce", &proc.env.coll.and_reduce,
+                              COLLECTIVES_DEFAULT_AND_REDUCE, check_and_reduce,
+                              NULL, algorithm_fits_reduce},
+    [COLL_RULE_OR_REDUCE] = {"or_reduce", &proc.env.coll.or_reduce,
+                             COLLECTIVES_DEFAULT_OR_REDUCE, check_or_reduce,
+                             NULL, algorithm_fits_reduce},
+    [COLL_RULE_XOR_REDUCE] = {"xor_reduce", &proc.env.coll.xor_reduce,
+                              COLLECTIVES_DEFAULT_XOR_REDUCE, check_xor_reduce,
+                              NULL, algorithm_fits_reduce},
+    [COLL_RULE_MAX_REDUCE] = {"max_reduce", &proc.env.coll.max_reduce,
+                              COLLECTIVES_DEFAULT_MAX_REDUCE, check_max_reduce,
+                              NULL, algorithm_fits_reduce},
+    [COLL_RULE_MIN_REDUCE] = {"min_reduce", &proc.env.coll.min_reduce,
+                              COLLECTIVES_DEFAULT_MIN_REDUCE, check_min_reduce,
+                              NULL, algorithm_fits_reduce},
+    [COLL_RULE_SUM_REDUCE] = {"sum_reduce", &proc.env.coll.sum_reduce,
+                              COLLECTIVES_DEFAULT_SUM_REDUCE, check_sum_reduce,
+                              NULL, algorithm_fits_reduce},
+    [COLL_RULE_PROD_REDUCE] = {"prod_reduce", &proc.env.coll.prod_reduce,
+                               COLLECTIVES_DEFAULT_PROD_REDUCE,
+                               check_prod_reduce, NULL, algorithm_fits_reduce},
+    [COLL_RULE_BARRIER_ALL] = {"barrier_all", &proc.env.coll.barrier_all,
+                               COLLECTIVES_DEFAULT_BARRIER_ALL,
+                               check_barrier_all, NULL,
+                               algorithm_fits_team_sync},
+    [COLL_RULE_SYNC_ALL] = {"sync_all", &proc.env.coll.sync_all,
+                            COLLECTIVES_DEFAULT_SYNC_ALL, check_sync_all,
+                            NULL, algorithm_fits_team_sync},
+    [COLL_RULE_TEAM_SYNC] = {"team_sync", &proc.env.coll.team_sync,
+                             COLLECTIVES_DEFAULT_SYNC, check_team_sync, NULL,
+                             algorithm_fits_team_sync},
+};
+
+#define RULE_SPACE " \t\r" /* between words in a rule */
+#define RULE_SEP ";\n"     /* between rules */
+
+/**
+ * @brief Parse a PE count or byte size
+ * @param str What to parse
+ * @param bytes Is it a size (else a plain count)?
+ * @param vp Where to put the value
+ * @return 0 on success, -1 on failure
+ */
+static int parse_value(const char *str, bool bytes, size_t *vp) {
+  char *end;
+  long n;
+
+  if (bytes) {
+    return shmemu_parse_size(str, vp);
+    /* NOT REACHED */
+  }
+
+  errno = 0;
+  n = strtol(str, &end, 10);
+  if ((errno != 0) || (*end != '\0') || (n < 0)) {
+    return -1;
+    /* NOT REACHED */
+  }
+
+  *vp = (size_t)n;
+  return 0;
+}
+
+/**
+ * @brief Parse "lo-hi", "lo-", "-hi" or "n"
+ * @param str What to parse
+ * @param bytes Is it a range of sizes (else of counts)?
+ * @param lop Where to put the lower bound
+ * @param hip Where to put the upper bound
+ * @return 0 on success, -1 on failure
+ */
+static int parse_range(const char *str, bool bytes, size_t *lop,
+                       size_t *hip) {
+  char buf[COLL_NAME_MAX];
+  char *dash;
+
+  if (strlen(str) >= sizeof(buf)) {
+    return -1;
+    /* NOT REACHED */
+  }
+  strcpy(buf, str);
+
+  dash = strchr(buf, '-');
+  if (dash == NULL) {
+    if (parse_value(buf, bytes, lop) != 0) {
+      return -1;
+      /* NOT REACHED */
+    }
+    *hip = *lop;
+    return 0;
+    /* NOT REACHED */
+  }
+
+  *dash = '\0';
+  *lop = 0;
+  *hip = SIZE_MAX;
+
+  if ((buf[0] != '\0') && (parse_value(buf, bytes, lop) != 0)) {
+    return -1;
+    /* NOT REACHED */
+  }
+  if ((dash[1] != '\0') && (parse_value(dash + 1, bytes, hip) != 0)) {
+    return -1;
+    /* NOT REACHED */
+  }
+
+  return (*lop <= *hip) ? 0 : -1;
+}
+
+inline static int clamp_pes(size_t n) {
+  return (n > INT_MAX) ? INT_MAX : (int)n;
+}
+
+/**
+ * @brief Find a collective by the name used in rules
+ * @param name The name
+ * @return its index, or -1 if there's no such collective
+ */
+static int find_op(const char *name) {
+  int op;
+
+  for (op = 0; op < COLL_RULE_NUM_OPS; ++op) {
+    if (strcmp(name, rule_ops[op].name) == 0) {
+      return op;
+      /* NOT REACHED */
+    }
+  }
+
+  return -1;
+}
+
+/**
+ * @brief Add a rule to the end of a collective's list
+ * @param op The collective
+ * @param rp The rule
+ * @param where Where the rule came from (for messages)
+ */
+static void add_rule(coll_rule_op_t op, const coll_rule_t *rp,
+                     const char *where) {
+  coll_rule_set_t *rsp = &coll_rules[op];
+
+  /* tuned files can have a lot of these */
+  if (rsp->nrules == rsp->size) {
+    const int size = (rsp->size == 0) ? 8 : 2 * rsp->size;
+    coll_rule_t *rules =
+        (coll_rule_t *)realloc(rsp->rules, size * sizeof(*rules));
+
+    shmemu_assert(rules != NULL,
+                  "can't allocate memory for collective rules");
+
+    rsp->rules = rules;
+    rsp->size = size;
+  }
+
+  rsp->rules[rsp->nrules++] = *rp;
+
+  logger(LOG_COLLECTIVES, "%s: %s uses %s for PEs %d-%d, bytes %zu-%zu",
+         where, rule_ops[op].name, rp->algo, rp->pes_lo, rp->pes_hi,
+         rp->bytes_lo, rp->bytes_hi);
+}
+
+/**
+ * @brief Parse one rule and add it to the collective(s) it names
+ * @param text The rule (modified)
+ * @param where Where the rule came from (for messages)
+ * @param builtin Is this one of our own rules?
+ */
+static void parse_rule(char *text, const char *where, bool builtin) {
+  char *save;
+  char *name;
+  char *algo;
+  char *tok;
+  coll_rule_t r;
+  size_t lo, hi;
+  int first, last;
+  int op;
+
+  name = strtok_r(text, RULE_SPACE, &save);
+  if (name == NULL) {
+    return; /* blank */
+    /* NOT REACHED */
+  }
+
+  algo = strtok_r(NULL, RULE_SPACE, &save);
+  shmemu_assert(algo != NULL, "%s: no algorithm in rule for \"%s\"", where,
+                name);
+  shmemu_assert(strlen(algo) < COLL_NAME_MAX,
+                "%s: algorithm name \"%s\" too long", where, algo);
+
+  strcpy(r.algo, algo);
+  r.pes_lo = 1;
+  r.pes_hi = INT_MAX;
+  r.bytes_lo = 0;
+  r.bytes_hi = SIZE_MAX;
+
+  while ((tok = strtok_r(NULL, RULE_SPACE, &save)) != NULL) {
+    if (strncmp(tok, "pes=", 4) == 0) {
+      shmemu_assert(parse_range(tok + 4, false, &lo, &hi) == 0,
+                    "%s: couldn't work out PE range \"%s\"", where, tok + 4);
+      r.pes_lo = clamp_pes(lo);
+      r.pes_hi = clamp_pes(hi);
+    } else if (strncmp(tok, "bytes=", 6) == 0) {
+      shmemu_assert(parse_range(tok + 6, true, &lo, &hi) == 0,
+                    "%s: couldn't work out byte range \"%s\"", where,
+                    tok + 6);
+      r.bytes_lo = lo;
+      r.bytes_hi = hi;
+    } else {
+      shmemu_fatal("%s: unknown setting \"%s\" in rule for \"%s\"", where,
+                   tok, name);
+      /* NOT REACHED */
+    }
+  }
+
+  if (strcmp(name, "reduce") == 0) {
+    first = COLL_RULE_AND_REDUCE;
+    last = COLL_RULE_PROD_REDUCE;
+  } else {
+    first = last = find_op(name);
+    shmemu_assert(first >= 0, "%s: can't have rules for collective \"%s\"",
+                  where, name);
+  }
+
+  for (op = first; op <= last; ++op) {
+    const rule_op_t *rop = &rule_ops[op];
+
+    /* user picked the algorithm, so leave it alone */
+    if (builtin && (strcmp(*rop->configured, rop->dflt) != 0)) {
+      continue;
+    }
+
+    shmemu_assert(rop->check(r.algo) &&
+                      ((rop->check_mem == NULL) || rop->check_mem(r.algo)),
+                  "%s: collective \"%s\" has no algorithm \"%s\"", where,
+                  rop->name, r.algo);
+
+    /* coll_rule_select() passes over it for the others */
+    if (!rop->fits(r.algo, r.pes_lo) || !rop->fits(r.algo, r.pes_hi)) {
+      logger(LOG_COLLECTIVES,
+             "%s: %s only uses %s for the PE counts in %d-%d it runs on",
+             where, rop->name, r.algo, r.pes_lo, r.pes_hi);
+    }
+
+    add_rule((coll_rule_op_t)op, &r, where);
+  }
+}
+
+/**
+ * @brief Parse a list of rules
+ * @param rules The rules (modified)
+ * @param where Where the rules came from (for messages)
+ * @param builtin Are these our own rules?
+ */
+static void parse_rules(char *rules, const char *where, bool builtin) {
+  char *save;
+  char *text;
+  char *c;
+
+  /* comments run to end of line */
+  for (c = rules; *c != '\0'; ++c) {
+    if (*c == '#') {
+      while ((*c != '\0') && (*c != '\n')) {
+        *c++ = ' ';
+      }
+      if (*c == '\0') {
+        break;
+      }
+    }
+  }
+
+  for (text = strtok_r(rules, RULE_SEP, &save); text != NULL;
+       text = strtok_r(NULL, RULE_SEP, &save)) {
+    parse_rule(text, where, builtin);
+  }
+}
+
+/**
+ * @brief Parse rules from a string we don't own
+ * @param rules The rules
+ * @param where Where the rules came from (for messages)
+ * @param builtin Are these our own rules?
+ */
+static void parse_rules_copy(const char *rules, const char *where,
+                             bool builtin) {
+  char *copy = strdup(rules);
+
+  shmemu_assert(copy != NULL, "can't allocate memory for collective rules");
+
+  parse_rules(copy, where, builtin);
+
+  free(copy);
+}
+
+/**
+ * @brief Parse rules from a file
+ * @param path The file
+ */
+static void parse_rules_file(const char *path) {
+  FILE *fp;
+  long len;
+  char *buf;
+  size_t n;
+
+  fp = fopen(path, "r");
+  shmemu_assert(fp != NULL, "can't open collective rules file \"%s\": %s",
+                path, strerror(errno));
+
+  (void)fseek(fp, 0L, SEEK_END);
+  len = ftell(fp);
+  rewind(fp);
+  shmemu_assert(len >= 0, "can't read collective rules file \"%s\": %s",
+                path, strerror(errno));
+
+  buf = (char *)malloc((size_t)len + 1);
+  shmemu_assert(buf != NULL, "can't allocate memory for collective rules");
+
+  n = fread(buf, 1, (size_t)len, fp);
+  buf[n] = '\0';
+
+  fclose(fp);
+
+  parse_rules(buf, path, false);
+
+  free(buf);
+}
+
+void coll_rules_init(void) {
+  int op;
+
+  memset(coll_rules, 0, sizeof(coll_rules));
+  for (op = 0; op < COLL_RULE_NUM_OPS; ++op) {
+    coll_rules[op].fits = rule_ops[op].fits;
+  }
+
+  if (proc.env.coll_rules != NULL) {
+    parse_rules_copy(proc.env.coll_rules, "SHMEM_COLL_RULES", false);
+  }
+  if (proc.env.coll_rules_file != NULL) {
+    parse_rules_file(proc.env.coll_rules_file);
+  }
+
+  parse_rules_copy(COLLECTIVES_DEFAULT_RULES, "built-in rules", true);
+}
+
+void coll_rules_finalize(void) {
+  int op;
+
+  for (op = 0; op < COLL_RULE_NUM_OPS; ++op) {
+    free(coll_rules[op].rules);
+  }
+
+  memset(coll_rules, 0, sizeof(coll_rules));
+}
@@ -0,0 +1,146 @@
+/**
+ * @file rules.h
+ * @brief Per-call collective algorithm selection
+ *
+ * A rule picks the algorithm for one collective when the number of PEs
+ * taking part and the number of bytes each PE contributes both fall in
+ * its ranges.  Rules are tried in order and the first match wins; if
+ * none match, the algorithm configured through SHMEM_<OP>_ALGO is used.
+ * A rule whose algorithm can't run on that many PEs (e.g. a power-of-2
+ * algorithm on 6 PEs) doesn't match.
+ *
+ * Rules come from (in this order) SHMEM_COLL_RULES,
+ * SHMEM_COLL_RULES_FILE and the built-in COLLECTIVES_DEFAULT_RULES.
+ * The built-in rules for a collective are skipped if its algorithm has
+ * been changed from the default, so setting SHMEM_<OP>_ALGO pins it.
+ *
+ * @copyright See LICENSE file at top-level
+ */
+
+#ifndef _COLL_RULES_H
+#define _COLL_RULES_H 1
+
+#include "table.h"
+
+#include <stddef.h>
+
+/** Rules per collective whose implementations call sites remember */
+#define COLL_RULES_CACHED 32
+
+/**
+ * @brief Collectives that can have selection rules
+ */
+typedef enum coll_rule_op {
+  COLL_RULE_ALLTOALL = 0,
+  COLL_RULE_ALLTOALLS,
+  COLL_RULE_COLLECT,
+  COLL_RULE_FCOLLECT,
+  COLL_RULE_BROADCAST,
+  COLL_RULE_AND_REDUCE,
+  COLL_RULE_OR_REDUCE,
+  COLL_RULE_XOR_REDUCE,
+  COLL_RULE_MAX_REDUCE,
+  COLL_RULE_MIN_REDUCE,
+  COLL_RULE_SUM_REDUCE,
+  COLL_RULE_PROD_REDUCE,
+  COLL_RULE_BARRIER_ALL,
+  COLL_RULE_SYNC_ALL,
+  COLL_RULE_TEAM_SYNC,
+  COLL_RULE_NUM_OPS
+} coll_rule_op_t;
+
+/**
+ * @brief A single selection rule (ranges are inclusive)
+ */
+typedef struct coll_rule {
+  int pes_lo;               /**< fewest PEs */
+  int pes_hi;               /**< most PEs */
+  size_t bytes_lo;          /**< fewest bytes per PE */
+  size_t bytes_hi;          /**< most bytes per PE */
+  char algo[COLL_NAME_MAX]; /**< algorithm to use */
+} coll_rule_t;
+
+/**
+ * @brief The rules for one collective, in the order they are tried
+ */
+typedef struct coll_rule_set {
+  coll_rule_t *rules;             /**< the rules */
+  int nrules;                     /**< how many in use */
+  int size;                       /**< how many there's room for */
+  int (*fits)(const char *, int); /**< algorithm runs on this many PEs? */
+} coll_rule_set_t;
+
+/** Rules for each collective */
+extern coll_rule_set_t coll_rules[COLL_RULE_NUM_OPS];
+
+/**
+ * @brief Find the rule to use for a call
+ *
+ * @param op The collective
+ * @param npes Number of PEs taking part
+ * @param nbytes Bytes contributed by each PE
+ * @return index of the first matching rule, or the number of rules if
+ *         the configured algorithm should be used
+ */
+inline static int coll_rule_select(coll_rule_op_t op, int npes,
+                                   size_t nbytes) {
+  const coll_rule_set_t *rsp = &coll_rules[op];
+  int i;
+
+  for (i = 0; i < rsp->nrules; ++i) {
+    const coll_rule_t *rp = &rsp->rules[i];
+
+    if ((npes >= rp->pes_lo) && (npes <= rp->pes_hi) &&
+        (nbytes >= rp->bytes_lo) && (nbytes <= rp->bytes_hi) &&
+        rsp->fits(rp->algo, npes)) {
+      return i;
+      /* NOT REACHED */
+    }
+  }
+
+  return rsp->nrules;
+}
+
+/**
+ * @brief Algorithm name for a rule picked by coll_rule_select()
+ *
+ * @param op The collective
+ * @param idx The rule index
+ * @param configured The algorithm to use if no rule matched
+ * @return algorithm name
+ */
+inline static const char *coll_rule_algo(coll_rule_op_t op, int idx,
+                                         const char *configured) {
+  const coll_rule_set_t *rsp = &coll_rules[op];
+
+  return (idx < rsp->nrules) ? rsp->rules[idx].algo : configured;
+}
+
+/**
+ * @brief Where a call site remembers the implementation for a rule
+ *
+ * @param op The collective
+ * @param idx The rule index from coll_rule_select()
+ * @return slot in a (COLL_RULES_CACHED + 1)-entry cache, or -1 if the
+ *         rule is too far down the list to be cached
+ */
+inline static int coll_rule_slot(coll_rule_op_t op, int idx) {
+  if (idx == coll_rules[op].nrules) {
+    return COLL_RULES_CACHED;
+    /* NOT REACHED */
+  }
+
+  return (idx < COLL_RULES_CACHED) ? idx : -1;
+}
+
+/**
+ * @brief Read and check the rules from all sources
+ */
+void coll_rules_init(void);
+
+/**
+ * @brief Throw the rules away
+ */
+void coll_rules_finalize(void);
+
+#endif /* ! _COLL_RULES_H */
@@ -15,6 +15,7 @@
 #include "thispe.h"
 #include "shmemu.h"
 #include "collectives/table.h"
+#include "collectives/rules.h"
 #include "shmem/teams.h"
 
 #include "shmem/api_types.h"
@@ -34,28 +35,169 @@
     }                                                                          \
   }
 
+/**
+ * @brief Number of PEs in a team, for algorithm selection
+ * @param team The team
+ * @return number of PEs, or 0 if the team is invalid
+ */
+inline static int team_npes(shmem_team_t team) {
+  return (team != SHMEM_TEAM_INVALID) ? ((shmemc_team_h)team)->nranks : 0;
+}
+
+/**
+ * @brief Look up a typed collective implementation, or die trying
+ * @param lookup The collective's lookup function
+ * @param algo Algorithm, or "algorithm:type"
+ * @param typename The type name
+ * @return the implementation
+ */
+static typed_coll_fn_t typed_lookup(int (*lookup)(const char *,
+                                                  typed_coll_fn_t *),
+                                    const char *algo, const char *typename) {
+  char opstr[COLL_NAME_MAX * 2];
+  typed_coll_fn_t f;
+  int s;
+
+  if (strchr(algo, ':') == NULL) {
+    snprintf(opstr, sizeof(opstr), "%s:%s", algo, typename);
+  } else {
+    strncpy(opstr, algo, sizeof(opstr) - 1);
+    opstr[sizeof(opstr) - 1] = '\0';
+  }
+
+  s = lookup(opstr, &f);
+  if (s != 0) {
+    shmemu_fatal("couldn't register typed collective '%s' (s = %d)", opstr,
+                 s);
+  }
+
+  return f;
+}
+
+/**
+ * @brief Look up an untyped collective implementation, or die trying
+ * @param lookup The collective's lookup function
+ * @param algo Algorithm name
+ * @return the implementation
+ */
+static untyped_coll_fn_t untyped_lookup(int (*lookup)(const char *,
+                                                      untyped_coll_fn_t *),
+                                        const char *algo) {
+  untyped_coll_fn_t f;
+  const int s = lookup(algo, &f);
+
+  if (s != 0) {
+    shmemu_fatal("couldn't register collective '%s' (s = %d)", algo, s);
+  }
+
+  return f;
+}
+
+/**
+ * @brief Look up an unsized collective implementation, or die trying
+ * @param lookup The collective's lookup function
+ * @param algo Algorithm name
+ * @return the implementation
+ */
+static coll_fn_t unsized_lookup(int (*lookup)(const char *, coll_fn_t *),
+                                const char *algo) {
+  coll_fn_t f;
+  const int s = lookup(algo, &f);
+
+  if (s != 0) {
+    shmemu_fatal("couldn't register collective '%s' (s = %d)", algo, s);
+  }
+
+  return f;
+}
+
+/*
+ * Each call site keeps the implementations it has used, one per
+ * selection rule (plus the configured algorithm), so after the first
+ * call with a given rule, picking the algorithm is just a walk through
+ * the rule list.  Racing threads look up the same thing.  Rules past
+ * the first COLL_RULES_CACHED look the implementation up every time.
+ */
+
 /**
  * @brief Helper macro to call a typed collective operation
  * @param CONFIG The collective operation name
+ * @param RULE The collective's selection rules
  * @param TYPENAME The type name
+ * @param NPES Number of PEs taking part
+ * @param NBYTES Bytes contributed by each PE
  * @param ... The arguments to the collective operation
  */
-#define TYPED_CALL(CONFIG, TYPENAME, ...)                                      \
+#define TYPED_CALL(CONFIG, RULE, TYPENAME, NPES, NBYTES, ...)                  \
   do {                                                                         \
-    char opstr[COLL_NAME_MAX * 2];                                             \
-    const char *base = proc.env.coll.CONFIG;                                   \
-    if (strchr(base, ':') == NULL) {                                           \
-      snprintf(opstr, sizeof(opstr), "%s:%s", base, TYPENAME);                 \
-    } else {                                                                   \
-      strncpy(opstr, base, sizeof(opstr) - 1);                                 \
-      opstr[sizeof(opstr) - 1] = '\0';                                         \
+    static typed_coll_fn_t _fns[COLL_RULES_CACHED + 1];                        \
+    const int _r = coll_rule_select(RULE, NPES, NBYTES);                       \
+    const int _slot = coll_rule_slot(RULE, _r);                                \
+    typed_coll_fn_t _f =                                                       \
+        (_slot < 0) ? NULL : __atomic_load_n(&_fns[_slot], __ATOMIC_RELAXED);  \
+                                                                               \
+    if (shmemu_unlikely(_f == NULL)) {                                         \
+      const char *_algo = coll_rule_algo(RULE, _r, proc.env.coll.CONFIG);      \
+                                                                               \
+      _f = typed_lookup(lookup_##CONFIG, _algo, TYPENAME);                     \
+      if (_slot >= 0) {                                                        \
+        __atomic_store_n(&_fns[_slot], _f, __ATOMIC_RELAXED);                  \
+      }                                                                        \
     }                                                                          \
-    int _rc = register_##CONFIG(opstr);                                        \
-    if (_rc != 0) {                                                            \
-      shmemu_fatal("couldn't register typed collective '%s' (s = %d)", opstr,  \
-                   _rc);                                                       \
+    return _f(__VA_ARGS__);                                                    \
+  } while (0)
+
+/**
+ * @brief Helper macro to call an untyped collective operation
+ * @param CONFIG The collective operation name
+ * @param RULE The collective's selection rules
+ * @param NPES Number of PEs taking part
+ * @param NBYTES Bytes contributed by each PE
+ * @param ... The arguments to the collective operation
+ */
+#define UNTYPED_CALL(CONFIG, RULE, NPES, NBYTES, ...)                          \
+  do {                                                                         \
+    static untyped_coll_fn_t _fns[COLL_RULES_CACHED + 1];                      \
+    const int _r = coll_rule_select(RULE, NPES, NBYTES);                       \
+    const int _slot = coll_rule_slot(RULE, _r);                                \
+    untyped_coll_fn_t _f =                                                     \
+        (_slot < 0) ? NULL : __atomic_load_n(&_fns[_slot], __ATOMIC_RELAXED);  \
+                                                                               \
+    if (shmemu_unlikely(_f == NULL)) {                                         \
+      const char *_algo = coll_rule_algo(RULE, _r, proc.env.coll.CONFIG);      \
+                                                                               \
+      _f = untyped_lookup(lookup_##CONFIG, _algo);                             \
+      if (_slot >= 0) {                                                        \
+        __atomic_store_n(&_fns[_slot], _f, __ATOMIC_RELAXED);                  \
+      }                                                                        \
+    }                                                                          \
+    return _f(__VA_ARGS__);                                                    \
+  } while (0)
+
+/**
+ * @brief Helper macro to call an unsized collective operation
+ * @param CONFIG The collective operation name
+ * @param RULE The collective's selection rules
+ * @param NPES Number of PEs taking part
+ * @param ... The arguments to the collective operation
+ */
+#define UNSIZED_CALL(CONFIG, RULE, NPES, ...)                                  \
+  do {                                                                         \
+    static coll_fn_t _fns[COLL_RULES_CACHED + 1];                              \
+    const int _r = coll_rule_select(RULE, NPES, 0);                            \
+    const int _slot = coll_rule_slot(RULE, _r);                                \
+    coll_fn_t _f =                                                             \
+        (_slot < 0) ? NULL : __atomic_load_n(&_fns[_slot], __ATOMIC_RELAXED);  \
+                                                                               \
+    if (shmemu_unlikely(_f == NULL)) {                                         \
+      const char *_algo = coll_rule_algo(RULE, _r, proc.env.coll.CONFIG);      \
+                                                                               \
+      _f = unsized_lookup(lookup_##CONFIG, _algo);                             \
+      if (_slot >= 0) {                                                        \
+        __atomic_store_n(&_fns[_slot], _f, __ATOMIC_RELAXED);                  \
+      }                                                                        \
     }                                                                          \
-    return colls.CONFIG.f(__VA_ARGS__);                                        \
+    _f(__VA_ARGS__);                                                           \
   } while (0)
 
 /**
@@ -131,12 +273,14 @@ void collectives_init(void) {
   TRY(min_reduce);
   TRY(sum_reduce);
   TRY(prod_reduce);
+
+  coll_rules_init();
 }
 
 /**
  * @brief Cleanup and finalize collective operations
  */
-void collectives_finalize(void) { return; }
+void collectives_finalize(void) { coll_rules_finalize(); }
 
 /**
  * @defgroup alltoall All-to-all Operations
@@ -187,7 +331,8 @@ void collectives_finalize(void) { return; }
                                    const _type *source, size_t nelems) {       \
     logger(LOG_COLLECTIVES, "%s(%p, %p, %p, %zu)", __func__, team, dest,       \
            source, nelems);                                                    \
-    TYPED_CALL(alltoall_type, #_typename, team, dest, source, nelems);         \
+    TYPED_CALL(alltoall_type, COLL_RULE_ALLTOALL, #_typename, team_npes(team), \
+               nelems * sizeof(_type), team, dest, source, nelems);            \
   }
 
 #define DECL_SHIM_ALLTOALL(_type, _typename)                                   \
@@ -214,7 +359,8 @@ int shmem_alltoallmem(shmem_team_t team, void *dest, const void *source,
                       size_t nelems) {
   logger(LOG_COLLECTIVES, "%s(%p, %p, %p, %zu)", __func__, team, dest, source,
          nelems);
-  colls.alltoall_mem.f(team, dest, source, nelems);
+  UNTYPED_CALL(alltoall_mem, COLL_RULE_ALLTOALL, team_npes(team), nelems, team,
+               dest, source, nelems);
 }
 
 #ifdef ENABLE_PSHMEM
@@ -317,8 +463,9 @@ void shmem_alltoall64(void *target, const void *source, size_t nelems,
                                     ptrdiff_t sst, size_t nelems) {            \
     logger(LOG_COLLECTIVES, "%s(%p, %p, %p, %td, %td, %zu)", __func__, team,   \
            dest, source, dst, sst, nelems);                                    \
-    TYPED_CALL(alltoalls_type, #_typename, team, dest, source, dst, sst,       \
-               nelems);                                                        \
+    TYPED_CALL(alltoalls_type, COLL_RULE_ALLTOALLS, #_typename,                \
+               team_npes(team), nelems * sizeof(_type), team, dest, source,    \
+               dst, sst, nelems);                                              \
   }
 
 #define DECL_SHIM_ALLTOALLS(_type, _typename)                                  \
@@ -347,7 +494,8 @@ int shmem_alltoallsmem(shmem_team_t team, void *dest, const void *source,
                        ptrdiff_t dst, ptrdiff_t sst, size_t nelems) {
   logger(LOG_COLLECTIVES, "%s(%p, %p, %p, %td, %td, %zu)", __func__, team, dest,
          source, dst, sst, nelems);
-  colls.alltoalls_mem.f(team, dest, source, dst, sst, nelems);
+  UNTYPED_CALL(alltoalls_mem, COLL_RULE_ALLTOALLS, team_npes(team), nelems,
+               team, dest, source, dst, sst, nelems);
 }
 
 #ifdef ENABLE_PSHMEM
@@ -473,7 +621,8 @@ void shmem_alltoalls64(void *target, const void *source, ptrdiff_t dst,
                                   const _type *source, size_t nelems) {        \
     logger(LOG_COLLECTIVES, "%s(%p, %p, %p, %zu)", __func__, team, dest, source,      \
            nelems);                                                            \
-    TYPED_CALL(collect_type, #_typename, team, dest, source, nelems);          \
+    TYPED_CALL(collect_type, COLL_RULE_COLLECT, #_typename, team_npes(team), 0,\
+               team, dest, source, nelems);                                    \
   }
 
 #define DECL_SHIM_COLLECT(_type, _typename)                                    \
@@ -500,7 +649,8 @@ int shmem_collectmem(shmem_team_t team, void *dest, const void *source,
                      size_t nelems) {
   logger(LOG_COLLECTIVES, "%s(%p, %p, %p, %zu)", __func__, team, dest, source,
          nelems);
-  colls.collect_mem.f(team, dest, source, nelems);
+  UNTYPED_CALL(collect_mem, COLL_RULE_COLLECT, team_npes(team), 0, team, dest,
+               source, nelems);
 }
 
 #ifdef ENABLE_PSHMEM
@@ -620,7 +770,8 @@ void shmem_collect64(void *target, const void *source, size_t nelems,
                                    const _type *source, size_t nelems) {       \
     logger(LOG_COLLECTIVES, "%s(%p, %p, %p, %zu)", __func__, team, dest, source,      \
            nelems);                                                            \
-    TYPED_CALL(fcollect_type, #_typename, team, dest, source, nelems);         \
+    TYPED_CALL(fcollect_type, COLL_RULE_FCOLLECT, #_typename, team_npes(team), \
+               nelems * sizeof(_type), team, dest, source, nelems);            \
   }
 
 #define DECL_SHIM_FCOLLECT(_type, _typename)                                   \
@@ -647,7 +798,8 @@ int shmem_fcollectmem(shmem_team_t team, void *dest, const void *source,
                       size_t nelems) {
   logger(LOG_COLLECTIVES, "%s(%p, %p, %p, %zu)", __func__, team, dest, source,
          nelems);
-  colls.fcollect_mem.f(team, dest, source, nelems);
+  UNTYPED_CALL(fcollect_mem, COLL_RULE_FCOLLECT, team_npes(team), nelems, team,
+               dest, source, nelems);
 }
 
 #ifdef ENABLE_PSHMEM
@@ -770,8 +922,9 @@ void shmem_fcollect64(void *target, const void *source, size_t nelems,
                                     int PE_root) {                             \
     logger(LOG_COLLECTIVES, "%s(%p, %p, %p, %zu, %d)", __func__, team, dest, source,  \
            nelems, PE_root);                                                   \
-    TYPED_CALL(broadcast_type, #_typename, team, dest, source, nelems,         \
-               PE_root);                                                       \
+    TYPED_CALL(broadcast_type, COLL_RULE_BROADCAST, #_typename,                \
+               team_npes(team), nelems * sizeof(_type), team, dest, source,    \
+               nelems, PE_root);                                               \
   }
 
 #define DECL_SHIM_BROADCAST(_type, _typename)                                  \
@@ -799,7 +952,8 @@ int shmem_broadcastmem(shmem_team_t team, void *dest, const void *source,
                        size_t nelems, int PE_root) {
   logger(LOG_COLLECTIVES, "%s(%p, %p, %p, %zu, %d)", __func__, team, dest, source,
          nelems, PE_root);
-  colls.broadcast_mem.f(team, dest, source, nelems, PE_root);
+  UNTYPED_CALL(broadcast_mem, COLL_RULE_BROADCAST, team_npes(team), nelems,
+               team, dest, source, nelems, PE_root);
 }
 
 #ifdef ENABLE_PSHMEM
@@ -1015,6 +1169,17 @@ SHMEM_TO_ALL_ARITH_TYPE_TABLE(DECL_SHIM_PROD_TO_ALL)
 
 #undef SHMEM_TYPENAME_OP_TO_ALL
 
+/*
+ * selection rules for each reduction operation
+ */
+#define REDUCE_RULE_and COLL_RULE_AND_REDUCE
+#define REDUCE_RULE_or COLL_RULE_OR_REDUCE
+#define REDUCE_RULE_xor COLL_RULE_XOR_REDUCE
+#define REDUCE_RULE_max COLL_RULE_MAX_REDUCE
+#define REDUCE_RULE_min COLL_RULE_MIN_REDUCE
+#define REDUCE_RULE_sum COLL_RULE_SUM_REDUCE
+#define REDUCE_RULE_prod COLL_RULE_PROD_REDUCE
+
 /**
  * @brief Declares a reduce operation for a given type and operation
  *
@@ -1027,7 +1192,8 @@ SHMEM_TO_ALL_ARITH_TYPE_TABLE(DECL_SHIM_PROD_TO_ALL)
       shmem_team_t team, _type *dest, const _type *source, size_t nreduce) {   \
     logger(LOG_COLLECTIVES, "%s(%p, %p, %p, %zu)", __func__, team, dest,       \
            source, nreduce);                                                   \
-    TYPED_CALL(_op##_reduce, #_typename, team, dest, source, nreduce);         \
+    TYPED_CALL(_op##_reduce, REDUCE_RULE_##_op, #_typename, team_npes(team),   \
+               nreduce * sizeof(_type), team, dest, source, nreduce);          \
   }
 
 #ifdef ENABLE_PSHMEM
@@ -1396,7 +1562,8 @@ extern long *shmemc_sync_all_psync;
 void shmem_barrier_all(void) {
   logger(LOG_COLLECTIVES, "%s()", __func__);
 
-  colls.barrier_all.f(shmemc_barrier_all_psync);
+  UNSIZED_CALL(barrier_all, COLL_RULE_BARRIER_ALL, proc.li.nranks,
+               shmemc_barrier_all_psync);
 }
 
 /** @} */
@@ -1414,7 +1581,8 @@ void shmem_barrier_all(void) {
 void shmem_sync_all(void) {
   logger(LOG_COLLECTIVES, "%s()", __func__);
 
-  colls.sync_all.f(shmemc_sync_all_psync);
+  UNSIZED_CALL(sync_all, COLL_RULE_SYNC_ALL, proc.li.nranks,
+               shmemc_sync_all_psync);
 }
 
 /** @} */
@@ -1479,7 +1647,7 @@ void shmem_barrier(int PE_start, int logPE_stride, int PE_size, long *pSync) {
 int shmem_team_sync(shmem_team_t team) {
   logger(LOG_COLLECTIVES, "%s(%p)", __func__, team);
 
-  colls.team_sync.f(team);
+  UNTYPED_CALL(team_sync, COLL_RULE_TEAM_SYNC, team_npes(team), 0, team);
 }
 
 /** @} */
@@ -128,7 +128,9 @@
       TYPED_REG(alltoall, xor_pairwise_exchange_signal, _typename),            \
       TYPED_REG(alltoall, color_pairwise_exchange_barrier, _typename),         \
       TYPED_REG(alltoall, color_pairwise_exchange_counter, _typename),         \
-      TYPED_REG(alltoall, color_pairwise_exchange_signal, _typename),
+      TYPED_REG(alltoall, color_pairwise_exchange_signal, _typename),          \
+      TYPED_REG(alltoall, node_aggregated, _typename),                         \
+      TYPED_REG(alltoall, bruck, _typename),
 
 static typed_op_t alltoall_type_tab[] = {
     SHMEM_STANDARD_RMA_TYPE_TABLE(ALLTOALL_TYPE_REG) TYPED_LAST};
@@ -147,6 +149,8 @@ static untyped_op_t alltoall_mem_tab[] = {
     UNTYPED_REG(alltoallmem, color_pairwise_exchange_barrier),
     UNTYPED_REG(alltoallmem, color_pairwise_exchange_counter),
     UNTYPED_REG(alltoallmem, color_pairwise_exchange_signal),
+    UNTYPED_REG(alltoallmem, node_aggregated),
+    UNTYPED_REG(alltoallmem, bruck),
     UNTYPED_LAST};
 
 /**
@@ -162,6 +166,8 @@ static sized_op_t alltoall_size_tab[] = {
     SIZED_REG(alltoall, color_pairwise_exchange_barrier),
     SIZED_REG(alltoall, color_pairwise_exchange_counter),
     SIZED_REG(alltoall, color_pairwise_exchange_signal),
+    SIZED_REG(alltoall, node_aggregated),
+    SIZED_REG(alltoall, bruck),
     SIZED_LAST};
 
 /**
@@ -173,7 +179,9 @@ static sized_op_t alltoall_size_tab[] = {
       TYPED_REG(alltoalls, xor_pairwise_exchange_barrier, _typename),          \
       TYPED_REG(alltoalls, xor_pairwise_exchange_counter, _typename),          \
       TYPED_REG(alltoalls, color_pairwise_exchange_barrier, _typename),        \
-      TYPED_REG(alltoalls, color_pairwise_exchange_counter, _typename),
+      TYPED_REG(alltoalls, color_pairwise_exchange_counter, _typename),        \
+      TYPED_REG(alltoalls, node_aggregated, _typename),                        \
+      TYPED_REG(alltoalls, bruck, _typename),
 
 static typed_op_t alltoalls_type_tab[] = {
     SHMEM_STANDARD_RMA_TYPE_TABLE(ALLTOALLS_TYPE_REG) TYPED_LAST};
@@ -189,6 +197,8 @@ static untyped_op_t alltoalls_mem_tab[] = {
     UNTYPED_REG(alltoallsmem, xor_pairwise_exchange_counter),
     UNTYPED_REG(alltoallsmem, color_pairwise_exchange_barrier),
     UNTYPED_REG(alltoallsmem, color_pairwise_exchange_counter),
+    UNTYPED_REG(alltoallsmem, node_aggregated),
+    UNTYPED_REG(alltoallsmem, bruck),
     UNTYPED_LAST};
 
 /**
@@ -201,6 +211,8 @@ static sized_op_t alltoalls_size_tab[] = {
     SIZED_REG(alltoalls, xor_pairwise_exchange_counter),
     SIZED_REG(alltoalls, color_pairwise_exchange_barrier),
     SIZED_REG(alltoalls, color_pairwise_exchange_counter),
+    SIZED_REG(alltoalls, node_aggregated),
+    SIZED_REG(alltoalls, bruck),
     SIZED_LAST};
 
 /**
@@ -344,7 +356,8 @@ static sized_op_t broadcast_size_tab[] = {
       TYPED_TO_ALL_REG(and, binomial, _typename),                              \
       TYPED_TO_ALL_REG(and, rec_dbl, _typename),                               \
       TYPED_TO_ALL_REG(and, rabenseifner, _typename),                          \
-      TYPED_TO_ALL_REG(and, rabenseifner2, _typename),
+      TYPED_TO_ALL_REG(and, rabenseifner2, _typename),                         \
+      TYPED_TO_ALL_REG(and, hierarchical, _typename),
 
 static typed_to_all_op_t and_to_all_tab[] = {
     SHMEM_TO_ALL_BITWISE_TYPE_TABLE(AND_TO_ALL_REG) TYPED_LAST};
@@ -358,7 +371,8 @@ static typed_to_all_op_t and_to_all_tab[] = {
       TYPED_TO_ALL_REG(or, binomial, _typename),                               \
       TYPED_TO_ALL_REG(or, rec_dbl, _typename),                                \
       TYPED_TO_ALL_REG(or, rabenseifner, _typename),                           \
-      TYPED_TO_ALL_REG(or, rabenseifner2, _typename),
+      TYPED_TO_ALL_REG(or, rabenseifner2, _typename),                          \
+      TYPED_TO_ALL_REG(or, hierarchical, _typename),
 
 static typed_to_all_op_t or_to_all_tab[] = {
     SHMEM_TO_ALL_BITWISE_TYPE_TABLE(OR_TO_ALL_REG) TYPED_LAST};
@@ -372,7 +386,8 @@ static typed_to_all_op_t or_to_all_tab[] = {
       TYPED_TO_ALL_REG(xor, binomial, _typename),                              \
       TYPED_TO_ALL_REG(xor, rec_dbl, _typename),                               \
       TYPED_TO_ALL_REG(xor, rabenseifner, _typename),                          \
-      TYPED_TO_ALL_REG(xor, rabenseifner2, _typename),
+      TYPED_TO_ALL_REG(xor, rabenseifner2, _typename),                         \
+      TYPED_TO_ALL_REG(xor, hierarchical, _typename),
 
 static typed_to_all_op_t xor_to_all_tab[] = {
     SHMEM_TO_ALL_BITWISE_TYPE_TABLE(XOR_TO_ALL_REG) TYPED_LAST};
@@ -386,7 +401,8 @@ static typed_to_all_op_t xor_to_all_tab[] = {
       TYPED_TO_ALL_REG(max, binomial, _typename),                              \
       TYPED_TO_ALL_REG(max, rec_dbl, _typename),                               \
       TYPED_TO_ALL_REG(max, rabenseifner, _typename),                          \
-      TYPED_TO_ALL_REG(max, rabenseifner2, _typename),
+      TYPED_TO_ALL_REG(max, rabenseifner2, _typename),                         \
+      TYPED_TO_ALL_REG(max, hierarchical, _typename),
 
 static typed_to_all_op_t max_to_all_tab[] = {
     SHMEM_TO_ALL_MINMAX_TYPE_TABLE(MAX_TO_ALL_REG) TYPED_LAST};
@@ -400,7 +416,8 @@ static typed_to_all_op_t max_to_all_tab[] = {
       TYPED_TO_ALL_REG(min, binomial, _typename),                              \
       TYPED_TO_ALL_REG(min, rec_dbl, _typename),                               \
       TYPED_TO_ALL_REG(min, rabenseifner, _typename),                          \
-      TYPED_TO_ALL_REG(min, rabenseifner2, _typename),
+      TYPED_TO_ALL_REG(min, rabenseifner2, _typename),                         \
+      TYPED_TO_ALL_REG(min, hierarchical, _typename),
 
 static typed_to_all_op_t min_to_all_tab[] = {
     SHMEM_TO_ALL_MINMAX_TYPE_TABLE(MIN_TO_ALL_REG) TYPED_LAST};
@@ -414,7 +431,8 @@ static typed_to_all_op_t min_to_all_tab[] = {
       TYPED_TO_ALL_REG(sum, binomial, _typename),                              \
       TYPED_TO_ALL_REG(sum, rec_dbl, _typename),                               \
       TYPED_TO_ALL_REG(sum, rabenseifner, _typename),                          \
-      TYPED_TO_ALL_REG(sum, rabenseifner2, _typename),
+      TYPED_TO_ALL_REG(sum, rabenseifner2, _typename),                         \
+      TYPED_TO_ALL_REG(sum, hierarchical, _typename),
 
 static typed_to_all_op_t sum_to_all_tab[] = {
     SHMEM_TO_ALL_ARITH_TYPE_TABLE(SUM_TO_ALL_REG) TYPED_LAST};
@@ -428,7 +446,8 @@ static typed_to_all_op_t sum_to_all_tab[] = {
       TYPED_TO_ALL_REG(prod, binomial, _typename),                             \
       TYPED_TO_ALL_REG(prod, rec_dbl, _typename),                              \
       TYPED_TO_ALL_REG(prod, rabenseifner, _typename),                         \
-      TYPED_TO_ALL_REG(prod, rabenseifner2, _typename),
+      TYPED_TO_ALL_REG(prod, rabenseifner2, _typename),                        \
+      TYPED_TO_ALL_REG(prod, hierarchical, _typename),
 
 static typed_to_all_op_t prod_to_all_tab[] = {
     SHMEM_TO_ALL_ARITH_TYPE_TABLE(PROD_TO_ALL_REG) TYPED_LAST};
@@ -442,7 +461,8 @@ static typed_to_all_op_t prod_to_all_tab[] = {
       TYPED_REDUCE_REG(and, binomial, _typename),                              \
       TYPED_REDUCE_REG(and, rec_dbl, _typename),                               \
       TYPED_REDUCE_REG(and, rabenseifner, _typename),                          \
-      TYPED_REDUCE_REG(and, rabenseifner2, _typename),
+      TYPED_REDUCE_REG(and, rabenseifner2, _typename),                         \
+      TYPED_REDUCE_REG(and, hierarchical, _typename),
 
 static typed_op_t and_reduce_tab[] = {
     SHMEM_REDUCE_BITWISE_TYPE_TABLE(AND_REDUCE_REG) TYPED_LAST};
@@ -456,7 +476,8 @@ static typed_op_t and_reduce_tab[] = {
       TYPED_REDUCE_REG(or, binomial, _typename),                               \
       TYPED_REDUCE_REG(or, rec_dbl, _typename),                                \
       TYPED_REDUCE_REG(or, rabenseifner, _typename),                           \
-      TYPED_REDUCE_REG(or, rabenseifner2, _typename),
+      TYPED_REDUCE_REG(or, rabenseifner2, _typename),                          \
+      TYPED_REDUCE_REG(or, hierarchical, _typename),
 
 static typed_op_t or_reduce_tab[] = {
     SHMEM_REDUCE_BITWISE_TYPE_TABLE(OR_REDUCE_REG) TYPED_LAST};
@@ -470,7 +491,8 @@ static typed_op_t or_reduce_tab[] = {
       TYPED_REDUCE_REG(xor, binomial, _typename),                              \
       TYPED_REDUCE_REG(xor, rec_dbl, _typename),                               \
       TYPED_REDUCE_REG(xor, rabenseifner, _typename),                          \
-      TYPED_REDUCE_REG(xor, rabenseifner2, _typename),
+      TYPED_REDUCE_REG(xor, rabenseifner2, _typename),                         \
+      TYPED_REDUCE_REG(xor, hierarchical, _typename),
 
 static typed_op_t xor_reduce_tab[] = {
     SHMEM_REDUCE_BITWISE_TYPE_TABLE(XOR_REDUCE_REG) TYPED_LAST};
@@ -484,7 +506,8 @@ static typed_op_t xor_reduce_tab[] = {
       TYPED_REDUCE_REG(max, binomial, _typename),                              \
       TYPED_REDUCE_REG(max, rec_dbl, _typename),                               \
       TYPED_REDUCE_REG(max, rabenseifner, _typename),                          \
-      TYPED_REDUCE_REG(max, rabenseifner2, _typename),
+      TYPED_REDUCE_REG(max, rabenseifner2, _typename),                         \
+      TYPED_REDUCE_REG(max, hierarchical, _typename),
 
 static typed_op_t max_reduce_tab[] = {
     SHMEM_REDUCE_MINMAX_TYPE_TABLE(MAX_REDUCE_REG) TYPED_LAST};
@@ -498,7 +521,8 @@ static typed_op_t max_reduce_tab[] = {
       TYPED_REDUCE_REG(min, binomial, _typename),                              \
       TYPED_REDUCE_REG(min, rec_dbl, _typename),                               \
       TYPED_REDUCE_REG(min, rabenseifner, _typename),                          \
-      TYPED_REDUCE_REG(min, rabenseifner2, _typename),
+      TYPED_REDUCE_REG(min, rabenseifner2, _typename),                         \
+      TYPED_REDUCE_REG(min, hierarchical, _typename),
 
 static typed_op_t min_reduce_tab[] = {
     SHMEM_REDUCE_MINMAX_TYPE_TABLE(MIN_REDUCE_REG) TYPED_LAST};
@@ -512,7 +536,8 @@ static typed_op_t min_reduce_tab[] = {
       TYPED_REDUCE_REG(sum, binomial, _typename),                              \
       TYPED_REDUCE_REG(sum, rec_dbl, _typename),                               \
       TYPED_REDUCE_REG(sum, rabenseifner, _typename),                          \
-      TYPED_REDUCE_REG(sum, rabenseifner2, _typename),
+      TYPED_REDUCE_REG(sum, rabenseifner2, _typename),                         \
+      TYPED_REDUCE_REG(sum, hierarchical, _typename),
 
 static typed_op_t sum_reduce_tab[] = {
     SHMEM_REDUCE_ARITH_TYPE_TABLE(SUM_REDUCE_REG) TYPED_LAST};
@@ -526,7 +551,8 @@ static typed_op_t sum_reduce_tab[] = {
       TYPED_REDUCE_REG(prod, binomial, _typename),                             \
       TYPED_REDUCE_REG(prod, rec_dbl, _typename),                              \
       TYPED_REDUCE_REG(prod, rabenseifner, _typename),                         \
-      TYPED_REDUCE_REG(prod, rabenseifner2, _typename),
+      TYPED_REDUCE_REG(prod, rabenseifner2, _typename),                        \
+      TYPED_REDUCE_REG(prod, hierarchical, _typename),
 
 static typed_op_t prod_reduce_tab[] = {
     SHMEM_REDUCE_ARITH_TYPE_TABLE(PROD_REDUCE_REG) TYPED_LAST};
@@ -541,6 +567,7 @@ static unsized_op_t barrier_all_tab[] = {
     UNSIZED_REG(barrier_all, binomial_tree),
     UNSIZED_REG(barrier_all, knomial_tree),
     UNSIZED_REG(barrier_all, dissemination),
+    UNSIZED_REG(barrier_all, hierarchical),
     UNSIZED_LAST};
 
 /**
@@ -549,7 +576,8 @@ static unsized_op_t barrier_all_tab[] = {
 static unsized_op_t sync_all_tab[] = {
     UNSIZED_REG(sync_all, linear),        UNSIZED_REG(sync_all, complete_tree),
     UNSIZED_REG(sync_all, binomial_tree), UNSIZED_REG(sync_all, knomial_tree),
-    UNSIZED_REG(sync_all, dissemination), UNSIZED_LAST};
+    UNSIZED_REG(sync_all, dissemination), UNSIZED_REG(sync_all, hierarchical),
+    UNSIZED_LAST};
 
 /**
  * @brief Table of barrier collective algorithms (deprecated)
@@ -557,7 +585,8 @@ static unsized_op_t sync_all_tab[] = {
 static unsized_op_t barrier_tab[] = {
     UNSIZED_REG(barrier, linear),        UNSIZED_REG(barrier, complete_tree),
     UNSIZED_REG(barrier, binomial_tree), UNSIZED_REG(barrier, knomial_tree),
-    UNSIZED_REG(barrier, dissemination), UNSIZED_LAST};
+    UNSIZED_REG(barrier, dissemination), UNSIZED_REG(barrier, hierarchical),
+    UNSIZED_LAST};
 
 /**
  * @brief Table of sync collective algorithms (deprecated)
@@ -565,7 +594,8 @@ static unsized_op_t barrier_tab[] = {
 static unsized_op_t sync_tab[] = {
     UNSIZED_REG(sync, linear),        UNSIZED_REG(sync, complete_tree),
     UNSIZED_REG(sync, binomial_tree), UNSIZED_REG(sync, knomial_tree),
-    UNSIZED_REG(sync, dissemination), UNSIZED_LAST};
+    UNSIZED_REG(sync, dissemination), UNSIZED_REG(sync, hierarchical),
+    UNSIZED_LAST};
 
 /**
  * @brief Table of team_sync collective algorithms
@@ -575,6 +605,7 @@ static untyped_op_t team_sync_tab[] = {UNTYPED_REG(team_sync, linear),
                                        UNTYPED_REG(team_sync, binomial_tree),
                                        UNTYPED_REG(team_sync, knomial_tree),
                                        UNTYPED_REG(team_sync, dissemination),
+                                       UNTYPED_REG(team_sync, hierarchical),
                                        UNTYPED_LAST};
 
 /******************************************************** */
@@ -669,6 +700,32 @@ static int register_typed(typed_op_t *tabp, const char *op,
   return -1;
 }
 
+/**
+ * @brief Is an algorithm registered for every type in a typed table?
+ * @param tabp Pointer to the operation table
+ * @param op Algorithm name
+ * @return 0 if it is, -1 if some type lacks it
+ */
+static int lookup_typed_every(const typed_op_t *tabp, const char *op) {
+  const typed_op_t *p;
+
+  for (p = tabp; p->f != NULL; ++p) {
+    const typed_op_t *q;
+
+    for (q = tabp; q->f != NULL; ++q) {
+      if ((strncmp(op, q->op, COLL_NAME_MAX) == 0) &&
+          (strncmp(p->type, q->type, COLL_NAME_MAX) == 0)) {
+        break;
+      }
+    }
+    if (q->f == NULL) {
+      return -1;
+      /* NOT REACHED */
+    }
+  }
+  return 0;
+}
+
 /**
  * @brief Register a typed to_all collective operation
  * @param tabp Pointer to the operation table
@@ -753,21 +810,35 @@ coll_ops_t colls;
   }
 
 /**
- * @brief Macro to generate registration function for unsized collectives
+ * @brief Macro to generate registration and lookup functions for unsized
+ * collectives
  * @param _coll Collective operation name
  */
 #define REGISTER_UNSIZED(_coll)                                                \
   int register_##_coll(const char *op) {                                       \
     return register_unsized(_coll##_tab, op, &colls._coll.f);                  \
+  }                                                                            \
+                                                                               \
+  int lookup_##_coll(const char *op, coll_fn_t *fn) {                          \
+    return register_unsized(_coll##_tab, op, fn);                              \
   }
 
 /**
- * @brief Macro to generate registration function for typed collectives
+ * @brief Macro to generate registration and lookup functions for typed
+ * collectives
  * @param _coll Collective operation name
  */
 #define REGISTER_TYPED(_coll)                                                  \
   int register_##_coll(const char *op) {                                       \
     return register_typed(_coll##_tab, op, &colls._coll.f);                    \
+  }                                                                            \
+                                                                               \
+  int lookup_##_coll(const char *op, typed_coll_fn_t *fn) {                    \
+    return register_typed(_coll##_tab, op, fn);                                \
+  }                                                                            \
+                                                                               \
+  int lookup_every_##_coll(const char *op) {                                   \
+    return lookup_typed_every(_coll##_tab, op);                                \
   }
 
 /**
@@ -780,12 +851,17 @@ coll_ops_t colls;
   }
 
 /**
- * @brief Macro to generate registration function for untyped collectives
+ * @brief Macro to generate registration and lookup functions for untyped
+ * collectives
  * @param _coll Collective operation name
  */
 #define REGISTER_UNTYPED(_coll)                                                \
   int register_##_coll(const char *op) {                                       \
     return register_untyped(_coll##_tab, op, &colls._coll.f);                  \
+  }                                                                            \
+                                                                               \
+  int lookup_##_coll(const char *op, untyped_coll_fn_t *fn) {                  \
+    return register_untyped(_coll##_tab, op, fn);                              \
   }
 
 /* Register all collectives */
@@ -830,3 +906,148 @@ REGISTER_UNSIZED(sync)
 REGISTER_UNSIZED(sync_all)
 REGISTER_UNSIZED(barrier)
 REGISTER_UNTYPED(team_sync)
+
+/******************************************************** */
+/**
+ * @brief Add an algorithm name to a list, if it isn't already there
+ * @param names The list
+ * @param n How many names in the list
+ * @param max Room in the list
+ * @param op The name to add
+ * @return new number of names in the list
+ */
+static size_t list_add(const char **names, size_t n, size_t max,
+                       const char *op) {
+  size_t i;
+
+  for (i = 0; i < n; ++i) {
+    if (strncmp(op, names[i], COLL_NAME_MAX) == 0) {
+      return n;
+      /* NOT REACHED */
+    }
+  }
+
+  if (n < max) {
+    names[n++] = op;
+  }
+
+  return n;
+}
+
+/**
+ * @brief Macro to generate a function listing a collective's algorithms
+ * @param _coll Collective operation name
+ * @param _op_t Type of its table entries
+ */
+#define LIST_ALGORITHMS(_coll, _op_t)                                          \
+  size_t algorithms_##_coll(const char **names, size_t max) {                  \
+    _op_t *p;                                                                  \
+    size_t n = 0;                                                              \
+                                                                               \
+    for (p = _coll##_tab; p->f != NULL; ++p) {                                 \
+      n = list_add(names, n, max, p->op);                                      \
+    }                                                                          \
+                                                                               \
+    return n;                                                                  \
+  }
+
+/* What can be tuned */
+LIST_ALGORITHMS(alltoall_mem, untyped_op_t)
+LIST_ALGORITHMS(alltoalls_mem, untyped_op_t)
+LIST_ALGORITHMS(collect_mem, untyped_op_t)
+LIST_ALGORITHMS(fcollect_mem, untyped_op_t)
+LIST_ALGORITHMS(broadcast_mem, untyped_op_t)
+LIST_ALGORITHMS(and_reduce, typed_op_t)
+LIST_ALGORITHMS(or_reduce, typed_op_t)
+LIST_ALGORITHMS(xor_reduce, typed_op_t)
+LIST_ALGORITHMS(max_reduce, typed_op_t)
+LIST_ALGORITHMS(min_reduce, typed_op_t)
+LIST_ALGORITHMS(sum_reduce, typed_op_t)
+LIST_ALGORITHMS(prod_reduce, typed_op_t)
+LIST_ALGORITHMS(team_sync, untyped_op_t)
+
+/******************************************************** */
+/*
+ * Some algorithms only work for some team sizes, and assert if asked
+ * to do anything else.  Anything not listed runs on any number of PEs.
+ */
+
+/**
+ * @brief What an algorithm needs of the number of PEs
+ */
+typedef struct pes_need {
+  const char op[COLL_NAME_MAX]; /**< Algorithm name */
+  int pow2;                     /**< Power of 2 only? */
+  int even;                     /**< Even only? */
+  int max;                      /**< Most PEs, 0 if no limit */
+} pes_need_t;
+
+#define PES_NEED_LAST {"", 0, 0, 0}
+
+/** Signal variants keep a pSync word per peer */
+#define SIGNAL_PES_MAX (SHCOLL_ALLTOALL_SYNC_SIZE + 1)
+
+static const pes_need_t alltoall_mem_needs[] = {
+    {"shift_exchange_signal", 0, 0, SIGNAL_PES_MAX},
+    {"xor_pairwise_exchange_barrier", 1, 0, 0},
+    {"xor_pairwise_exchange_counter", 1, 0, 0},
+    {"xor_pairwise_exchange_signal", 1, 0, SIGNAL_PES_MAX},
+    {"color_pairwise_exchange_barrier", 0, 1, 0},
+    {"color_pairwise_exchange_counter", 0, 1, 0},
+    {"color_pairwise_exchange_signal", 0, 1, SIGNAL_PES_MAX},
+    PES_NEED_LAST};
+
+static const pes_need_t alltoalls_mem_needs[] = {
+    {"xor_pairwise_exchange_barrier", 1, 0, 0},
+    {"xor_pairwise_exchange_counter", 1, 0, 0},
+    {"color_pairwise_exchange_barrier", 0, 1, 0},
+    {"color_pairwise_exchange_counter", 0, 1, 0},
+    PES_NEED_LAST};
+
+static const pes_need_t collect_mem_needs[] = {
+    {"rec_dbl", 1, 0, 0}, {"rec_dbl_signal", 1, 0, 0}, PES_NEED_LAST};
+
+static const pes_need_t fcollect_mem_needs[] = {
+    {"rec_dbl", 1, 0, 0}, {"neighbor_exchange", 0, 1, 0}, PES_NEED_LAST};
+
+static const pes_need_t no_needs[] = {PES_NEED_LAST};
+
+/**
+ * @brief Can an algorithm run on this many PEs?
+ * @param needs What the algorithms of a collective need
+ * @param op Algorithm name
+ * @param npes Number of PEs
+ * @return non-zero if it can
+ */
+static int pes_fit(const pes_need_t *needs, const char *op, int npes) {
+  const pes_need_t *p;
+
+  for (p = needs; p->op[0] != '\0'; ++p) {
+    if (strncmp(op, p->op, COLL_NAME_MAX) == 0) {
+      return (!p->pow2 || ((npes & (npes - 1)) == 0)) &&
+             (!p->even || ((npes % 2) == 0)) &&
+             ((p->max == 0) || (npes <= p->max));
+      /* NOT REACHED */
+    }
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Macro to generate a team size check for a collective
+ * @param _coll Collective operation name
+ * @param _needs What its algorithms need
+ */
+#define FITS_ALGORITHM(_coll, _needs)                                          \
+  int algorithm_fits_##_coll(const char *op, int npes) {                       \
+    return pes_fit(_needs, op, npes);                                          \
+  }
+
+FITS_ALGORITHM(alltoall_mem, alltoall_mem_needs)
+FITS_ALGORITHM(alltoalls_mem, alltoalls_mem_needs)
+FITS_ALGORITHM(collect_mem, collect_mem_needs)
+FITS_ALGORITHM(fcollect_mem, fcollect_mem_needs)
+FITS_ALGORITHM(broadcast_mem, no_needs)
+FITS_ALGORITHM(reduce, no_needs)
+FITS_ALGORITHM(team_sync, no_needs)
@@ -14,6 +14,8 @@
 #ifndef _TABLE_H
 #define _TABLE_H 1
 
+#include <stddef.h>
+
 /** Maximum length for collective operation names */
 #define COLL_NAME_MAX 64
 
@@ -177,4 +179,103 @@ int register_min_reduce(const char *op);
 int register_sum_reduce(const char *op);
 int register_prod_reduce(const char *op);
 
+/**
+ * @brief Lookup functions for collective operations
+ *
+ * Like the registration functions, but hand back the implementation
+ * instead of installing it in the global table.
+ *
+ * @param op Name of the operation to look up
+ * @param fn Where to put the implementation
+ * @return 0 on success, non-zero on failure
+ */
+int lookup_barrier_all(const char *op, coll_fn_t *fn);
+int lookup_sync_all(const char *op, coll_fn_t *fn);
+int lookup_barrier(const char *op, coll_fn_t *fn);
+int lookup_sync(const char *op, coll_fn_t *fn);
+int lookup_team_sync(const char *op, untyped_coll_fn_t *fn);
+
+int lookup_alltoall_type(const char *op, typed_coll_fn_t *fn);
+int lookup_alltoall_mem(const char *op, untyped_coll_fn_t *fn);
+
+int lookup_alltoalls_type(const char *op, typed_coll_fn_t *fn);
+int lookup_alltoalls_mem(const char *op, untyped_coll_fn_t *fn);
+
+int lookup_collect_type(const char *op, typed_coll_fn_t *fn);
+int lookup_collect_mem(const char *op, untyped_coll_fn_t *fn);
+
+int lookup_fcollect_type(const char *op, typed_coll_fn_t *fn);
+int lookup_fcollect_mem(const char *op, untyped_coll_fn_t *fn);
+
+int lookup_broadcast_type(const char *op, typed_coll_fn_t *fn);
+int lookup_broadcast_mem(const char *op, untyped_coll_fn_t *fn);
+
+int lookup_and_reduce(const char *op, typed_coll_fn_t *fn);
+int lookup_or_reduce(const char *op, typed_coll_fn_t *fn);
+int lookup_xor_reduce(const char *op, typed_coll_fn_t *fn);
+int lookup_max_reduce(const char *op, typed_coll_fn_t *fn);
+int lookup_min_reduce(const char *op, typed_coll_fn_t *fn);
+int lookup_sum_reduce(const char *op, typed_coll_fn_t *fn);
+int lookup_prod_reduce(const char *op, typed_coll_fn_t *fn);
+
+/**
+ * @brief Check a typed collective has an algorithm for every type
+ *
+ * The lookup functions above are happy if any one type has it.
+ *
+ * @param op Name of the algorithm
+ * @return 0 if every type has it, non-zero if not
+ */
+int lookup_every_alltoall_type(const char *op);
+int lookup_every_alltoalls_type(const char *op);
+int lookup_every_collect_type(const char *op);
+int lookup_every_fcollect_type(const char *op);
+int lookup_every_broadcast_type(const char *op);
+
+int lookup_every_and_reduce(const char *op);
+int lookup_every_or_reduce(const char *op);
+int lookup_every_xor_reduce(const char *op);
+int lookup_every_max_reduce(const char *op);
+int lookup_every_min_reduce(const char *op);
+int lookup_every_sum_reduce(const char *op);
+int lookup_every_prod_reduce(const char *op);
+
+/**
+ * @brief List the algorithms registered for a collective
+ * @param names Where to put the algorithm names
+ * @param max Room in names
+ * @return how many names were put in names
+ */
+size_t algorithms_alltoall_mem(const char **names, size_t max);
+size_t algorithms_alltoalls_mem(const char **names, size_t max);
+size_t algorithms_collect_mem(const char **names, size_t max);
+size_t algorithms_fcollect_mem(const char **names, size_t max);
+size_t algorithms_broadcast_mem(const char **names, size_t max);
+size_t algorithms_and_reduce(const char **names, size_t max);
+size_t algorithms_or_reduce(const char **names, size_t max);
+size_t algorithms_xor_reduce(const char **names, size_t max);
+size_t algorithms_max_reduce(const char **names, size_t max);
+size_t algorithms_min_reduce(const char **names, size_t max);
+size_t algorithms_sum_reduce(const char **names, size_t max);
+size_t algorithms_prod_reduce(const char **names, size_t max);
+size_t algorithms_team_sync(const char **names, size_t max);
+
+/**
+ * @brief Can an algorithm of a collective run on a team this size?
+ *
+ * Some only work for power-of-2 or even numbers of PEs, or for teams
+ * up to some size.  The reductions all share one check.
+ *
+ * @param op Name of the algorithm
+ * @param npes Number of PEs
+ * @return non-zero if it can
+ */
+int algorithm_fits_alltoall_mem(const char *op, int npes);
+int algorithm_fits_alltoalls_mem(const char *op, int npes);
+int algorithm_fits_collect_mem(const char *op, int npes);
+int algorithm_fits_fcollect_mem(const char *op, int npes);
+int algorithm_fits_broadcast_mem(const char *op, int npes);
+int algorithm_fits_reduce(const char *op, int npes);
+int algorithm_fits_team_sync(const char *op, int npes);
+
 #endif
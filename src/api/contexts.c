@@ -106,4 +106,29 @@ void shmemx_ctx_session_estop(shmem_ctx_t ctx) {
   SHMEMU_CHECK_INIT();
 }
 
+#ifdef ENABLE_PSHMEM
+#pragma weak shmemx_ctx_set_wait_policy = pshmemx_ctx_set_wait_policy
+#define shmemx_ctx_set_wait_policy pshmemx_ctx_set_wait_policy
+#endif /* ENABLE_PSHMEM */
+
+/**
+ * @brief Set how waits on a context use the CPU
+ *
+ * @param ctx Context whose waits are affected
+ * @param spin_ns Poll flat out for this long first
+ * @param block_ns Sleep on events after waiting this long (0 = never)
+ *
+ * Overrides SHMEM_WAIT_SPIN and SHMEM_WAIT_BLOCK for this context.
+ */
+void shmemx_ctx_set_wait_policy(shmem_ctx_t ctx, size_t spin_ns,
+                                size_t block_ns) {
+  SHMEMU_CHECK_INIT();
+  SHMEMU_CHECK_SAME_THREAD(ctx);
+
+  logger(LOG_CONTEXTS, "%s(ctx=%p, spin_ns=%lu, block_ns=%lu)", __func__, ctx,
+         (unsigned long)spin_ns, (unsigned long)block_ns);
+
+  SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_set_wait_policy(ctx, spin_ns, block_ns));
+}
+
 #endif /* ENABLE_EXPERIMENTAL */
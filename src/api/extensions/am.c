@@ -0,0 +1,52 @@
+/* For license: see LICENSE file at top-level */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include "shmemu.h"
+#include "shmemc.h"
+#include "shmem_mutex.h"
+#include "shmemx.h"
+
+#if SHMEMX_AM_MAX_HANDLERS != SHMEMC_AM_MAX_HANDLERS
+#error "SHMEMX_AM_MAX_HANDLERS and SHMEMC_AM_MAX_HANDLERS must match"
+#endif
+
+#ifdef ENABLE_PSHMEM
+#pragma weak shmemx_am_register = pshmemx_am_register
+#define shmemx_am_register pshmemx_am_register
+#pragma weak shmemx_am_send = pshmemx_am_send
+#define shmemx_am_send pshmemx_am_send
+#pragma weak shmemx_am_progress = pshmemx_am_progress
+#define shmemx_am_progress pshmemx_am_progress
+#endif /* ENABLE_PSHMEM */
+
+int shmemx_am_register(int id, shmemx_am_handler_t handler, void *arg) {
+  int s;
+
+  SHMEMU_CHECK_INIT();
+
+  SHMEMT_MUTEX_NOPROTECT(s = shmemc_am_register(id, handler, arg));
+
+  logger(LOG_INFO, "%s(id=%d, handler=%p, arg=%p) -> %d", __func__, id,
+         (void *)handler, arg, s);
+
+  return s;
+}
+
+void shmemx_am_send(int pe, int id, const void *payload, size_t nbytes) {
+  SHMEMU_CHECK_INIT();
+  SHMEMU_CHECK_PE_ARG_RANGE(pe, 1);
+
+  logger(LOG_RMA, "%s(pe=%d, id=%d, payload=%p, nbytes=%lu)", __func__, pe,
+         id, payload, nbytes);
+
+  SHMEMT_MUTEX_NOPROTECT(shmemc_am_send(pe, id, payload, nbytes));
+}
+
+void shmemx_am_progress(void) {
+  SHMEMU_CHECK_INIT();
+
+  SHMEMT_MUTEX_NOPROTECT(shmemc_progress());
+}
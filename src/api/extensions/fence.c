@@ -33,18 +33,27 @@ int shmemx_fence_test(void) {
 }
 
 #ifdef ENABLE_PSHMEM
+#pragma weak shmemx_ctx_fence_pe = pshmemx_ctx_fence_pe
+#define shmemx_ctx_fence_pe pshmemx_ctx_fence_pe
+#pragma weak shmemx_fence_pe = pshmemx_fence_pe
+#define shmemx_fence_pe pshmemx_fence_pe
 #pragma weak shmemx_pe_fence = pshmemx_pe_fence
 #define shmemx_pe_fence pshmemx_pe_fence
 #endif /* ENABLE_PSHMEM */
 
-int shmemx_pe_fence(shmem_ctx_t ctx, int pe) {
-  int s;
+void shmemx_ctx_fence_pe(shmem_ctx_t ctx, int pe) {
+  SHMEMU_CHECK_INIT();
+  SHMEMU_CHECK_PE_ARG_RANGE(pe, 2);
 
-  NO_WARN_UNUSED(pe);
+  SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_fence_pe(ctx, pe));
 
-  SHMEMT_MUTEX_NOPROTECT(s = shmemc_ctx_fence_test(ctx));
+  logger(LOG_FENCE, "%s(ctx=%lu, pe=%d)", __func__, shmemc_context_id(ctx),
+         pe);
+}
 
-  logger(LOG_FENCE, "%s(ctx=%lu) -> %d", __func__, shmemc_context_id(ctx), s);
+void shmemx_fence_pe(int pe) { shmemx_ctx_fence_pe(SHMEM_CTX_DEFAULT, pe); }
 
-  return s;
-}
+/*
+ * older spelling, kept for existing callers
+ */
+void shmemx_pe_fence(shmem_ctx_t ctx, int pe) { shmemx_ctx_fence_pe(ctx, pe); }
@@ -33,14 +33,27 @@ int shmemx_quiet_test(void) {
 }
 
 #ifdef ENABLE_PSHMEM
+#pragma weak shmemx_ctx_quiet_pe = pshmemx_ctx_quiet_pe
+#define shmemx_ctx_quiet_pe pshmemx_ctx_quiet_pe
+#pragma weak shmemx_quiet_pe = pshmemx_quiet_pe
+#define shmemx_quiet_pe pshmemx_quiet_pe
 #pragma weak shmemx_pe_quiet = pshmemx_pe_quiet
 #define shmemx_pe_quiet pshmemx_pe_quiet
 #endif /* ENABLE_PSHMEM */
 
-void shmemx_pe_quiet(shmem_ctx_t ctx, int pe) {
-  NO_WARN_UNUSED(pe);
+void shmemx_ctx_quiet_pe(shmem_ctx_t ctx, int pe) {
+  SHMEMU_CHECK_INIT();
+  SHMEMU_CHECK_PE_ARG_RANGE(pe, 2);
 
-  SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_quiet(ctx));
+  SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_quiet_pe(ctx, pe));
 
-  logger(LOG_QUIET, "%s(ctx=%lu)", __func__, shmemc_context_id(ctx));
+  logger(LOG_QUIET, "%s(ctx=%lu, pe=%d)", __func__, shmemc_context_id(ctx),
+         pe);
 }
+
+void shmemx_quiet_pe(int pe) { shmemx_ctx_quiet_pe(SHMEM_CTX_DEFAULT, pe); }
+
+/*
+ * older spelling, kept for existing callers
+ */
+void shmemx_pe_quiet(shmem_ctx_t ctx, int pe) { shmemx_ctx_quiet_pe(ctx, pe); }
@@ -55,7 +55,7 @@ void *shmemx_malloc_by_index(shmemx_heap_index_t index, size_t s) {
   SHMEMU_CHECK_INIT();
   SHMEMU_CHECK_HEAP_INDEX(index);
 
-  SHMEMT_MUTEX_PROTECT(addr = shmemxa_malloc_by_index(index, s));
+  SHMEMT_ALLOC_PROTECT(addr = shmemxa_malloc_by_index(index, s));
 
   shmem_barrier_all();
 
@@ -68,7 +68,7 @@ void *shmemx_calloc_by_index(shmemx_heap_index_t index, size_t n, size_t s) {
   SHMEMU_CHECK_INIT();
   SHMEMU_CHECK_HEAP_INDEX(index);
 
-  SHMEMT_MUTEX_PROTECT(addr = shmemxa_calloc_by_index(index, n, s));
+  SHMEMT_ALLOC_PROTECT(addr = shmemxa_calloc_by_index(index, n, s));
 
   shmem_barrier_all();
 
@@ -82,7 +82,7 @@ void shmemx_free_by_index(shmemx_heap_index_t index, void *p) {
 
   shmem_barrier_all();
 
-  SHMEMT_MUTEX_PROTECT(shmemxa_free_by_index(index, p));
+  SHMEMT_ALLOC_PROTECT(shmemxa_free_by_index(index, p));
 }
 
 /*
@@ -99,7 +99,7 @@ void *shmemx_realloc_by_index(shmemx_heap_index_t index, void *p, size_t s) {
 
   shmem_barrier_all();
 
-  SHMEMT_MUTEX_PROTECT(addr = shmemxa_realloc_by_index(index, p, s));
+  SHMEMT_ALLOC_PROTECT(addr = shmemxa_realloc_by_index(index, p, s));
 
   shmem_barrier_all();
 
@@ -112,7 +112,7 @@ void *shmemx_align_by_index(shmemx_heap_index_t index, size_t a, size_t s) {
   SHMEMU_CHECK_INIT();
   SHMEMU_CHECK_HEAP_INDEX(index);
 
-  SHMEMT_MUTEX_PROTECT(addr = shmemxa_align_by_index(index, a, s));
+  SHMEMT_ALLOC_PROTECT(addr = shmemxa_align_by_index(index, a, s));
 
   shmem_barrier_all();
 
@@ -143,7 +143,7 @@ void *shmemx_malloc_by_name(const char *name, size_t s) {
   SHMEMU_CHECK_INIT();
   SHMEMU_CHECK_HEAP_INDEX(index);
 
-  SHMEMT_MUTEX_PROTECT(addr = shmemxa_malloc_by_index(index, s));
+  SHMEMT_ALLOC_PROTECT(addr = shmemxa_malloc_by_index(index, s));
 
   return addr;
 }
@@ -155,7 +155,7 @@ void *shmemx_calloc_by_name(const char *name, size_t n, size_t s) {
   SHMEMU_CHECK_INIT();
   SHMEMU_CHECK_HEAP_INDEX(index);
 
-  SHMEMT_MUTEX_PROTECT(addr = shmemxa_calloc_by_index(index, n, s));
+  SHMEMT_ALLOC_PROTECT(addr = shmemxa_calloc_by_index(index, n, s));
 
   return addr;
 }
@@ -169,7 +169,7 @@ void shmemx_free_by_name(const char *name, void *p) {
 
   shmem_barrier_all();
 
-  SHMEMT_MUTEX_PROTECT(shmemxa_free_by_index(index, p));
+  SHMEMT_ALLOC_PROTECT(shmemxa_free_by_index(index, p));
 }
 
 void *shmemx_realloc_by_name(const char *name, void *p, size_t s) {
@@ -182,7 +182,7 @@ void *shmemx_realloc_by_name(const char *name, void *p, size_t s) {
 
   shmem_barrier_all();
 
-  SHMEMT_MUTEX_PROTECT(addr = shmemxa_realloc_by_index(index, p, s));
+  SHMEMT_ALLOC_PROTECT(addr = shmemxa_realloc_by_index(index, p, s));
 
   shmem_barrier_all();
 
@@ -196,7 +196,7 @@ void *shmemx_align_by_name(const char *name, size_t a, size_t s) {
   SHMEMU_CHECK_INIT();
   SHMEMU_CHECK_HEAP_INDEX(index);
 
-  SHMEMT_MUTEX_PROTECT(addr = shmemxa_align_by_index(index, a, s));
+  SHMEMT_ALLOC_PROTECT(addr = shmemxa_align_by_index(index, a, s));
 
   shmem_barrier_all();
 
@@ -0,0 +1,130 @@
+/* For license: see LICENSE file at top-level */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include "shmemu.h"
+#include "shmemc.h"
+#include "shmem_mutex.h"
+#include "shmemx.h"
+
+#ifdef ENABLE_PSHMEM
+#pragma weak shmemx_ctx_put_subarray = pshmemx_ctx_put_subarray
+#define shmemx_ctx_put_subarray pshmemx_ctx_put_subarray
+#pragma weak shmemx_ctx_get_subarray = pshmemx_ctx_get_subarray
+#define shmemx_ctx_get_subarray pshmemx_ctx_get_subarray
+#pragma weak shmemx_ctx_put_subarray_nbi = pshmemx_ctx_put_subarray_nbi
+#define shmemx_ctx_put_subarray_nbi pshmemx_ctx_put_subarray_nbi
+#pragma weak shmemx_ctx_get_subarray_nbi = pshmemx_ctx_get_subarray_nbi
+#define shmemx_ctx_get_subarray_nbi pshmemx_ctx_get_subarray_nbi
+#pragma weak shmemx_put_subarray = pshmemx_put_subarray
+#define shmemx_put_subarray pshmemx_put_subarray
+#pragma weak shmemx_get_subarray = pshmemx_get_subarray
+#define shmemx_get_subarray pshmemx_get_subarray
+#pragma weak shmemx_put_subarray_nbi = pshmemx_put_subarray_nbi
+#define shmemx_put_subarray_nbi pshmemx_put_subarray_nbi
+#pragma weak shmemx_get_subarray_nbi = pshmemx_get_subarray_nbi
+#define shmemx_get_subarray_nbi pshmemx_get_subarray_nbi
+#endif /* ENABLE_PSHMEM */
+
+/*
+ * shared by all the entry points
+ */
+#define SUBARRAY_CHECKS(_symm, _symm_pos)                                      \
+  do {                                                                         \
+    SHMEMU_CHECK_INIT();                                                       \
+    SHMEMU_CHECK_PE_ARG_RANGE(pe, 9);                                          \
+    SHMEMU_CHECK_SYMMETRIC(_symm, _symm_pos);                                  \
+    SHMEMU_CHECK_NOT_NULL(count, 6);                                           \
+    SHMEMU_CHECK_NOT_NULL(dst_strides, 7);                                     \
+    SHMEMU_CHECK_NOT_NULL(src_strides, 8);                                     \
+                                                                               \
+    if (shmemu_unlikely((ndims < 1) || (ndims > SHMEMX_SUBARRAY_MAX_DIMS))) {  \
+      shmemu_fatal("In %s(), ndims is %d: outside range [1, %d]", __func__,    \
+                   ndims, SHMEMX_SUBARRAY_MAX_DIMS);                           \
+      /* NOT REACHED */                                                        \
+    }                                                                          \
+                                                                               \
+    logger(LOG_RMA,                                                            \
+           "%s(ctx=%lu, dest=%p, src=%p, elsize=%lu, ndims=%d, pe=%d)",        \
+           __func__, shmemc_context_id(ctx), dest, source, elsize, ndims, pe); \
+  } while (0)
+
+void shmemx_ctx_put_subarray(shmem_ctx_t ctx, void *dest, const void *source,
+                             size_t elsize, int ndims, const size_t *count,
+                             const ptrdiff_t *dst_strides,
+                             const ptrdiff_t *src_strides, int pe) {
+  SUBARRAY_CHECKS(dest, 2);
+
+  SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_put_subarray(ctx, dest, source, elsize,
+                                                 ndims, count, dst_strides,
+                                                 src_strides, pe));
+}
+
+void shmemx_ctx_get_subarray(shmem_ctx_t ctx, void *dest, const void *source,
+                             size_t elsize, int ndims, const size_t *count,
+                             const ptrdiff_t *dst_strides,
+                             const ptrdiff_t *src_strides, int pe) {
+  SUBARRAY_CHECKS(source, 3);
+
+  SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_get_subarray(ctx, dest, source, elsize,
+                                                 ndims, count, dst_strides,
+                                                 src_strides, pe));
+}
+
+void shmemx_ctx_put_subarray_nbi(shmem_ctx_t ctx, void *dest,
+                                 const void *source, size_t elsize, int ndims,
+                                 const size_t *count,
+                                 const ptrdiff_t *dst_strides,
+                                 const ptrdiff_t *src_strides, int pe) {
+  SUBARRAY_CHECKS(dest, 2);
+
+  SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_put_subarray_nbi(ctx, dest, source, elsize,
+                                                     ndims, count, dst_strides,
+                                                     src_strides, pe));
+}
+
+void shmemx_ctx_get_subarray_nbi(shmem_ctx_t ctx, void *dest,
+                                 const void *source, size_t elsize, int ndims,
+                                 const size_t *count,
+                                 const ptrdiff_t *dst_strides,
+                                 const ptrdiff_t *src_strides, int pe) {
+  SUBARRAY_CHECKS(source, 3);
+
+  SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_get_subarray_nbi(ctx, dest, source, elsize,
+                                                     ndims, count, dst_strides,
+                                                     src_strides, pe));
+}
+
+void shmemx_put_subarray(void *dest, const void *source, size_t elsize,
+                         int ndims, const size_t *count,
+                         const ptrdiff_t *dst_strides,
+                         const ptrdiff_t *src_strides, int pe) {
+  shmemx_ctx_put_subarray(SHMEM_CTX_DEFAULT, dest, source, elsize, ndims,
+                          count, dst_strides, src_strides, pe);
+}
+
+void shmemx_get_subarray(void *dest, const void *source, size_t elsize,
+                         int ndims, const size_t *count,
+                         const ptrdiff_t *dst_strides,
+                         const ptrdiff_t *src_strides, int pe) {
+  shmemx_ctx_get_subarray(SHMEM_CTX_DEFAULT, dest, source, elsize, ndims,
+                          count, dst_strides, src_strides, pe);
+}
+
+void shmemx_put_subarray_nbi(void *dest, const void *source, size_t elsize,
+                             int ndims, const size_t *count,
+                             const ptrdiff_t *dst_strides,
+                             const ptrdiff_t *src_strides, int pe) {
+  shmemx_ctx_put_subarray_nbi(SHMEM_CTX_DEFAULT, dest, source, elsize, ndims,
+                              count, dst_strides, src_strides, pe);
+}
+
+void shmemx_get_subarray_nbi(void *dest, const void *source, size_t elsize,
+                             int ndims, const size_t *count,
+                             const ptrdiff_t *dst_strides,
+                             const ptrdiff_t *src_strides, int pe) {
+  shmemx_ctx_get_subarray_nbi(SHMEM_CTX_DEFAULT, dest, source, elsize, ndims,
+                              count, dst_strides, src_strides, pe);
+}
@@ -0,0 +1,79 @@
+/* For license: see LICENSE file at top-level */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include "shmemu.h"
+#include "shmemc.h"
+#include "shmem_mutex.h"
+#include "shmemx.h"
+
+#ifdef ENABLE_PSHMEM
+#pragma weak shmemx_ctx_putv_nbi = pshmemx_ctx_putv_nbi
+#define shmemx_ctx_putv_nbi pshmemx_ctx_putv_nbi
+#pragma weak shmemx_ctx_getv_nbi = pshmemx_ctx_getv_nbi
+#define shmemx_ctx_getv_nbi pshmemx_ctx_getv_nbi
+#pragma weak shmemx_putv_nbi = pshmemx_putv_nbi
+#define shmemx_putv_nbi pshmemx_putv_nbi
+#pragma weak shmemx_getv_nbi = pshmemx_getv_nbi
+#define shmemx_getv_nbi pshmemx_getv_nbi
+#endif /* ENABLE_PSHMEM */
+
+/*
+ * shared by all the entry points: _symm is the array of symmetric
+ * addresses
+ */
+#define VECTORED_CHECKS(_symm, _symm_pos)                                      \
+  do {                                                                         \
+    size_t i;                                                                  \
+                                                                               \
+    SHMEMU_CHECK_INIT();                                                       \
+                                                                               \
+    if (nops > 0) {                                                            \
+      SHMEMU_CHECK_NOT_NULL(dests, 2);                                         \
+      SHMEMU_CHECK_NOT_NULL(sources, 3);                                       \
+      SHMEMU_CHECK_NOT_NULL(nbytes, 4);                                        \
+      SHMEMU_CHECK_NOT_NULL(pes, 5);                                           \
+    }                                                                          \
+                                                                               \
+    for (i = 0; i < nops; ++i) {                                               \
+      SHMEMU_CHECK_PE_ARG_RANGE(pes[i], 5);                                    \
+      SHMEMU_CHECK_SYMMETRIC(_symm[i], _symm_pos);                             \
+    }                                                                          \
+                                                                               \
+    logger(LOG_RMA, "%s(ctx=%lu, nops=%lu, completed=%p)", __func__,           \
+           shmemc_context_id(ctx), nops, completed);                           \
+  } while (0)
+
+void shmemx_ctx_putv_nbi(shmem_ctx_t ctx, void *const *dests,
+                         const void *const *sources, const size_t *nbytes,
+                         const int *pes, size_t nops, uint64_t *completed) {
+  VECTORED_CHECKS(dests, 2);
+
+  SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_putv_nbi(ctx, dests, sources, nbytes, pes,
+                                             nops, completed));
+}
+
+void shmemx_ctx_getv_nbi(shmem_ctx_t ctx, void *const *dests,
+                         const void *const *sources, const size_t *nbytes,
+                         const int *pes, size_t nops, uint64_t *completed) {
+  VECTORED_CHECKS(sources, 3);
+
+  SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_getv_nbi(ctx, dests, sources, nbytes, pes,
+                                             nops, completed));
+}
+
+void shmemx_putv_nbi(void *const *dests, const void *const *sources,
+                     const size_t *nbytes, const int *pes, size_t nops,
+                     uint64_t *completed) {
+  shmemx_ctx_putv_nbi(SHMEM_CTX_DEFAULT, dests, sources, nbytes, pes, nops,
+                      completed);
+}
+
+void shmemx_getv_nbi(void *const *dests, const void *const *sources,
+                     const size_t *nbytes, const int *pes, size_t nops,
+                     uint64_t *completed) {
+  shmemx_ctx_getv_nbi(SHMEM_CTX_DEFAULT, dests, sources, nbytes, pes, nops,
+                      completed);
+}
@@ -110,6 +110,8 @@ inline static int init_thread_helper(int requested, int *provided) {
   /* utiltiies */
   shmemt_init();
   shmemu_init();
+  /* logging now up, so report how long comms setup took */
+  shmemc_log_startup_times();
   collectives_init();
 
 #ifdef ENABLE_ALIGNED_ADDRESSES
@@ -97,6 +97,28 @@ inline static int lock_owner(void *addr) {
   return owner;
 }
 
+/**
+ * @brief Wait for another PE to change part of my lock node
+ *
+ * @param field Part of the node to watch
+ * @param value Wait while it still has this value
+ *
+ * Follows the default context's wait policy.
+ */
+inline static void wait_until_not(volatile int16_t *field, int16_t value) {
+  shmemc_waiter_t w;
+
+  shmemc_waiter_init(&w, SHMEM_CTX_DEFAULT);
+
+  while (1) {
+    shmemc_progress();
+    if (*field != value) {
+      break;
+    }
+    shmemc_waiter_pause(&w, (void *)field);
+  }
+}
+
 /*
  * split the lock claim into 2-phase request + execute.
  *
@@ -207,9 +229,7 @@ inline static void set_lock_execute(shmem_lock_t *node, int me,
     shmem_short_p(&(node->d.next), me, cmp->d.next);
 
     /* sit here until unlocked */
-    do {
-      shmemc_progress();
-    } while (node->d.locked == SHMEM_LOCK_ACQUIRED);
+    wait_until_not(&(node->d.locked), SHMEM_LOCK_ACQUIRED);
   }
 }
 
@@ -249,9 +269,7 @@ inline static void clear_lock_execute(shmem_lock_t *node, int me,
   }
 
   /* wait for a chainer PE to appear */
-  do {
-    shmemc_progress();
-  } while (node->d.next == SHMEM_LOCK_FREE);
+  wait_until_not(&(node->d.next), SHMEM_LOCK_FREE);
 
   /* tell next pe about release */
   shmem_short_p(&(node->d.locked), SHMEM_LOCK_RESET, node->d.next);
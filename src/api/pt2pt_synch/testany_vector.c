@@ -73,7 +73,7 @@
   size_t shmem_##_opname##_test_any_vector(_type *ivars, size_t nelems,        \
                                            const int *status, int cmp,         \
                                            _type *cmp_values) {                \
-    SHMEMT_MUTEX_PROTECT(switch (cmp) {                                        \
+    SHMEMT_MUTEX_NOPROTECT(switch (cmp) {                                      \
       case SHMEM_CMP_EQ:                                                       \
         return shmemc_ctx_test_any_vector_eq##_size(                           \
             SHMEM_CTX_DEFAULT, (int##_size##_t *)ivars, nelems, status,        \
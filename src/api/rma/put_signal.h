@@ -36,8 +36,10 @@
     SHMEMU_CHECK_SYMMETRIC(dest, 2);                                           \
     SHMEMU_CHECK_SYMMETRIC(sig_addr, 5);                                       \
                                                                                \
-    SHMEMT_MUTEX_PROTECT(shmemc_ctx_put_signal(ctx, dest, src, nb, sig_addr,   \
-                                               signal, sig_op, pe));           \
+    SHMEMT_CTX_PROTECT(                                                        \
+        ctx,                                                                   \
+        shmemc_ctx_put_signal(ctx, dest, src, nb,                              \
+                              sig_addr, signal, sig_op, pe));                  \
   }
 
 /**
@@ -60,8 +62,10 @@
     SHMEMU_CHECK_SYMMETRIC(dest, 1);                                           \
     SHMEMU_CHECK_SYMMETRIC(sig_addr, 4);                                       \
                                                                                \
-    SHMEMT_MUTEX_PROTECT(shmemc_ctx_put_signal(                                \
-        SHMEM_CTX_DEFAULT, dest, src, nb, sig_addr, signal, sig_op, pe));      \
+    SHMEMT_CTX_PROTECT(                                                        \
+        SHMEM_CTX_DEFAULT,                                                     \
+        shmemc_ctx_put_signal(SHMEM_CTX_DEFAULT, dest, src, nb,                \
+                              sig_addr, signal, sig_op, pe));                  \
   }
 
 /**
@@ -83,8 +87,10 @@
     SHMEMU_CHECK_SYMMETRIC(dest, 2);                                           \
     SHMEMU_CHECK_SYMMETRIC(sig_addr, 5);                                       \
                                                                                \
-    SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_put_signal(ctx, dest, src, nb, sig_addr, \
-                                                 signal, sig_op, pe));         \
+    SHMEMT_CTX_PROTECT(                                                        \
+        ctx,                                                                   \
+        shmemc_ctx_put_signal(ctx, dest, src, nb,                              \
+                              sig_addr, signal, sig_op, pe));                  \
   }
 
 /**
@@ -106,8 +112,10 @@
     SHMEMU_CHECK_SYMMETRIC(dest, 1);                                           \
     SHMEMU_CHECK_SYMMETRIC(sig_addr, 4);                                       \
                                                                                \
-    SHMEMT_MUTEX_PROTECT(shmemc_ctx_put_signal(                                \
-        SHMEM_CTX_DEFAULT, dest, src, nb, sig_addr, signal, sig_op, pe));      \
+    SHMEMT_CTX_PROTECT(                                                        \
+        SHMEM_CTX_DEFAULT,                                                     \
+        shmemc_ctx_put_signal(SHMEM_CTX_DEFAULT, dest, src, nb,                \
+                              sig_addr, signal, sig_op, pe));                  \
   }
 
 /**
@@ -125,8 +133,10 @@
     SHMEMU_CHECK_SYMMETRIC(dest, 2);                                           \
     SHMEMU_CHECK_SYMMETRIC(sig_addr, 5);                                       \
                                                                                \
-    SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_put_signal(                              \
-        ctx, dest, src, nelems, sig_addr, signal, sig_op, pe));                \
+    SHMEMT_CTX_PROTECT(                                                        \
+        ctx,                                                                   \
+        shmemc_ctx_put_signal(ctx, dest, src, nelems,                          \
+                              sig_addr, signal, sig_op, pe));                  \
   }
 
 /**
@@ -144,8 +154,10 @@
     SHMEMU_CHECK_SYMMETRIC(dest, 1);                                           \
     SHMEMU_CHECK_SYMMETRIC(sig_addr, 4);                                       \
                                                                                \
-    SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_put_signal(                              \
-        SHMEM_CTX_DEFAULT, dest, src, nelems, sig_addr, signal, sig_op, pe));  \
+    SHMEMT_CTX_PROTECT(                                                        \
+        SHMEM_CTX_DEFAULT,                                                     \
+        shmemc_ctx_put_signal(SHMEM_CTX_DEFAULT, dest, src, nelems,            \
+                              sig_addr, signal, sig_op, pe));                  \
   }
 
 /*
@@ -172,8 +184,10 @@
     SHMEMU_CHECK_SYMMETRIC(dest, 2);                                           \
     SHMEMU_CHECK_SYMMETRIC(sig_addr, 5);                                       \
                                                                                \
-    SHMEMT_MUTEX_PROTECT(shmemc_ctx_put_signal_nbi(                            \
-        ctx, dest, src, nb, sig_addr, signal, sig_op, pe));                    \
+    SHMEMT_CTX_PROTECT(                                                        \
+        ctx,                                                                   \
+        shmemc_ctx_put_signal_nbi(ctx, dest, src, nb,                          \
+                                  sig_addr, signal, sig_op, pe));              \
   }
 
 /**
@@ -196,8 +210,10 @@
     SHMEMU_CHECK_SYMMETRIC(dest, 1);                                           \
     SHMEMU_CHECK_SYMMETRIC(sig_addr, 4);                                       \
                                                                                \
-    SHMEMT_MUTEX_PROTECT(shmemc_ctx_put_signal_nbi(                            \
-        SHMEM_CTX_DEFAULT, dest, src, nb, sig_addr, signal, sig_op, pe));      \
+    SHMEMT_CTX_PROTECT(                                                        \
+        SHMEM_CTX_DEFAULT,                                                     \
+        shmemc_ctx_put_signal_nbi(SHMEM_CTX_DEFAULT, dest, src, nb,            \
+                                  sig_addr, signal, sig_op, pe));              \
   }
 
 /**
@@ -219,8 +235,10 @@
     SHMEMU_CHECK_SYMMETRIC(dest, 2);                                           \
     SHMEMU_CHECK_SYMMETRIC(sig_addr, 5);                                       \
                                                                                \
-    SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_put_signal_nbi(                          \
-        ctx, dest, src, nb, sig_addr, signal, sig_op, pe));                    \
+    SHMEMT_CTX_PROTECT(                                                        \
+        ctx,                                                                   \
+        shmemc_ctx_put_signal_nbi(ctx, dest, src, nb,                          \
+                                  sig_addr, signal, sig_op, pe));              \
   }
 
 /**
@@ -242,8 +260,10 @@
     SHMEMU_CHECK_SYMMETRIC(dest, 1);                                           \
     SHMEMU_CHECK_SYMMETRIC(sig_addr, 4);                                       \
                                                                                \
-    SHMEMT_MUTEX_PROTECT(shmemc_ctx_put_signal_nbi(                            \
-        SHMEM_CTX_DEFAULT, dest, src, nb, sig_addr, signal, sig_op, pe));      \
+    SHMEMT_CTX_PROTECT(                                                        \
+        SHMEM_CTX_DEFAULT,                                                     \
+        shmemc_ctx_put_signal_nbi(SHMEM_CTX_DEFAULT, dest, src, nb,            \
+                                  sig_addr, signal, sig_op, pe));              \
   }
 
 /**
@@ -262,8 +282,10 @@
     SHMEMU_CHECK_SYMMETRIC(dest, 2);                                           \
     SHMEMU_CHECK_SYMMETRIC(sig_addr, 5);                                       \
                                                                                \
-    SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_put_signal_nbi(                          \
-        ctx, dest, src, nelems, sig_addr, signal, sig_op, pe));                \
+    SHMEMT_CTX_PROTECT(                                                        \
+        ctx,                                                                   \
+        shmemc_ctx_put_signal_nbi(ctx, dest, src, nelems,                      \
+                                  sig_addr, signal, sig_op, pe));              \
   }
 
 /**
@@ -281,8 +303,10 @@
     SHMEMU_CHECK_SYMMETRIC(dest, 1);                                           \
     SHMEMU_CHECK_SYMMETRIC(sig_addr, 4);                                       \
                                                                                \
-    SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_put_signal_nbi(                          \
-        SHMEM_CTX_DEFAULT, dest, src, nelems, sig_addr, signal, sig_op, pe));  \
+    SHMEMT_CTX_PROTECT(                                                        \
+        SHMEM_CTX_DEFAULT,                                                     \
+        shmemc_ctx_put_signal_nbi(SHMEM_CTX_DEFAULT, dest, src, nelems,        \
+                                  sig_addr, signal, sig_op, pe));              \
   }
 
 #endif /* ! _SHMEM_PUTGET_SIGNAL_H */
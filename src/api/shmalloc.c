@@ -51,7 +51,7 @@ inline static void *shmem_malloc_private(size_t s) {
     return NULL;
   }
 
-  SHMEMT_MUTEX_PROTECT(addr = shmema_malloc(s));
+  SHMEMT_ALLOC_PROTECT(addr = shmema_malloc(s));
 
   shmem_barrier_all();
 
@@ -109,7 +109,7 @@ void *shmem_calloc(size_t n, size_t s) {
     return NULL;
   }
 
-  SHMEMT_MUTEX_PROTECT(addr = shmema_calloc(n, s));
+  SHMEMT_ALLOC_PROTECT(addr = shmema_calloc(n, s));
 
   shmem_barrier_all();
 
@@ -130,7 +130,7 @@ void *shmem_calloc(size_t n, size_t s) {
 void shmem_free(void *p) {
   shmem_barrier_all();
 
-  SHMEMT_MUTEX_PROTECT(shmema_free(p));
+  SHMEMT_ALLOC_PROTECT(shmema_free(p));
 
   logger(LOG_MEMORY, "%s(addr=%p)", __func__, p);
 }
@@ -156,7 +156,7 @@ void *shmem_realloc(void *p, size_t s) {
 
   shmem_barrier_all();
 
-  SHMEMT_MUTEX_PROTECT(addr = shmema_realloc(p, s));
+  SHMEMT_ALLOC_PROTECT(addr = shmema_realloc(p, s));
 
   shmem_barrier_all();
 
@@ -182,7 +182,7 @@ void *shmem_align(size_t a, size_t s) {
     return NULL;
   }
 
-  SHMEMT_MUTEX_PROTECT(addr = shmema_align(a, s));
+  SHMEMT_ALLOC_PROTECT(addr = shmema_align(a, s));
 
   shmem_barrier_all();
 
@@ -0,0 +1,647 @@
+/**
+ * @file osh_tune.c
+ * @brief OpenSHMEM collective algorithm tuner
+ *
+ * Launched like any other OpenSHMEM program, this times every algorithm
+ * registered for the team-based collectives over a range of team and
+ * message sizes, then writes the fastest ones out as selection rules.
+ * Point SHMEM_COLL_RULES_FILE at the output, or install it as the
+ * default rules file, and programs pick their algorithms from it at
+ * start-up.
+ *
+ * For license: see LICENSE file at top-level
+ */
+
+/* no config.h */
+
+#include "collectives/table.h"
+#include "collectives/rules.h"
+
+#include <shmem.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <libgen.h> /* basename */
+
+static char *progname;
+
+static const char *default_output = "osh_tune.rules";
+static const size_t default_min_size = 8;
+static const size_t default_max_size = 1024 * 1024;
+static const int default_warmup = 5;
+static const int default_reps = 20;
+
+#define MAX_ALGOS 32 /* per collective */
+#define MAX_SIZES 64 /* doubling from min to max */
+#define MAX_TEAMS 32 /* doubling up to all PEs */
+
+/**
+ * @brief How a collective gets called
+ */
+typedef enum tune_kind {
+  TUNE_ALLTOALL,
+  TUNE_ALLTOALLS,
+  TUNE_COLLECT,
+  TUNE_FCOLLECT,
+  TUNE_BROADCAST,
+  TUNE_REDUCE,
+  TUNE_SYNC
+} tune_kind_t;
+
+/**
+ * @brief A collective to tune
+ */
+typedef struct tune_op {
+  const char *name;                            /**< as used in rules */
+  tune_kind_t kind;                            /**< how to call it */
+  size_t (*algorithms)(const char **, size_t); /**< what's registered */
+  int (*fits)(const char *, int);              /**< runs on this many PEs? */
+  int (*reduce)(const char *, typed_coll_fn_t *); /**< reduction lookup */
+  const char *also[2];                            /**< same rules for these */
+} tune_op_t;
+
+/*
+ * Rules are by bytes, not type, so each reduction is timed on long,
+ * which all of them support
+ */
+#define TUNE_REDUCE_OP(_op)                                                    \
+  {#_op "_reduce",         TUNE_REDUCE,           algorithms_##_op##_reduce,   \
+   algorithm_fits_reduce, lookup_##_op##_reduce, {NULL, NULL}}
+
+static const tune_op_t tune_ops[] = {
+    {"alltoall", TUNE_ALLTOALL, algorithms_alltoall_mem,
+     algorithm_fits_alltoall_mem, NULL, {NULL, NULL}},
+    {"alltoalls", TUNE_ALLTOALLS, algorithms_alltoalls_mem,
+     algorithm_fits_alltoalls_mem, NULL, {NULL, NULL}},
+    {"collect", TUNE_COLLECT, algorithms_collect_mem,
+     algorithm_fits_collect_mem, NULL, {NULL, NULL}},
+    {"fcollect", TUNE_FCOLLECT, algorithms_fcollect_mem,
+     algorithm_fits_fcollect_mem, NULL, {NULL, NULL}},
+    {"broadcast", TUNE_BROADCAST, algorithms_broadcast_mem,
+     algorithm_fits_broadcast_mem, NULL, {NULL, NULL}},
+    TUNE_REDUCE_OP(and),
+    TUNE_REDUCE_OP(or),
+    TUNE_REDUCE_OP(xor),
+    TUNE_REDUCE_OP(max),
+    TUNE_REDUCE_OP(min),
+    TUNE_REDUCE_OP(sum),
+    TUNE_REDUCE_OP(prod),
+    {"team_sync", TUNE_SYNC, algorithms_team_sync, algorithm_fits_team_sync,
+     NULL, {"barrier_all", "sync_all"}},
+};
+
+#undef TUNE_REDUCE_OP
+
+static const size_t n_tune_ops = sizeof(tune_ops) / sizeof(tune_ops[0]);
+
+/*
+ * symmetric work areas
+ */
+static char *src;
+static char *dest;
+static double my_time;
+static double max_time;
+
+/**
+ * @brief Display usage information for the program
+ */
+static void output_help(void) {
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Usage: oshrun ... %s [options]\n\n", progname);
+  fprintf(stderr,
+          "    -o F | --output=F     "
+          "write rules to file F (default \"%s\")\n",
+          default_output);
+  fprintf(stderr,
+          "    -s N | --min-size=N   "
+          "smallest message size in bytes (default %lu)\n",
+          (unsigned long)default_min_size);
+  fprintf(stderr,
+          "    -S N | --max-size=N   "
+          "largest message size in bytes (default %lu)\n",
+          (unsigned long)default_max_size);
+  fprintf(stderr,
+          "    -w N | --warmup=N     "
+          "untimed calls before timing (default %d)\n",
+          default_warmup);
+  fprintf(stderr,
+          "    -r N | --reps=N       "
+          "timed calls to average over (default %d)\n",
+          default_reps);
+  fprintf(stderr, "    -h   | --help         "
+                  "show this help message\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Sizes can have a K, M or G suffix.  Needs a symmetric "
+                  "heap of at least\n2 x max-size x number of PEs "
+                  "(see SHMEM_SYMMETRIC_SIZE).\n");
+  fprintf(stderr, "\n");
+}
+
+static struct option opts[] = {{"output", required_argument, NULL, 'o'},
+                               {"min-size", required_argument, NULL, 's'},
+                               {"max-size", required_argument, NULL, 'S'},
+                               {"warmup", required_argument, NULL, 'w'},
+                               {"reps", required_argument, NULL, 'r'},
+                               {"help", no_argument, NULL, 'h'},
+                               {NULL, no_argument, NULL, 0}};
+
+/**
+ * @brief Parse a byte count, with optional K/M/G suffix
+ * @param str What to parse
+ * @param np Where to put the count
+ * @return 0 on success, -1 on failure
+ */
+static int parse_size(const char *str, size_t *np) {
+  char *end;
+  unsigned long n = strtoul(str, &end, 10);
+
+  switch (*end) {
+  case 'g':
+  case 'G':
+    n *= 1024;
+    /* fall through */
+  case 'm':
+  case 'M':
+    n *= 1024;
+    /* fall through */
+  case 'k':
+  case 'K':
+    n *= 1024;
+    ++end;
+    break;
+  default:
+    break;
+  }
+
+  if ((end == str) || (*end != '\0')) {
+    return -1;
+    /* NOT REACHED */
+  }
+
+  *np = (size_t)n;
+  return 0;
+}
+
+static double now(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1.0e9;
+}
+
+/**
+ * @brief Find the implementation of an algorithm
+ */
+static untyped_coll_fn_t find_algo(const tune_op_t *op, const char *algo) {
+  char opstr[COLL_NAME_MAX * 2];
+  untyped_coll_fn_t uf = NULL;
+  typed_coll_fn_t tf = NULL;
+  int s = -1;
+
+  switch (op->kind) {
+  case TUNE_ALLTOALL:
+    s = lookup_alltoall_mem(algo, &uf);
+    break;
+  case TUNE_ALLTOALLS:
+    s = lookup_alltoalls_mem(algo, &uf);
+    break;
+  case TUNE_COLLECT:
+    s = lookup_collect_mem(algo, &uf);
+    break;
+  case TUNE_FCOLLECT:
+    s = lookup_fcollect_mem(algo, &uf);
+    break;
+  case TUNE_BROADCAST:
+    s = lookup_broadcast_mem(algo, &uf);
+    break;
+  case TUNE_REDUCE:
+    snprintf(opstr, sizeof(opstr), "%s:long", algo);
+    s = op->reduce(opstr, &tf);
+    uf = (untyped_coll_fn_t)tf;
+    break;
+  case TUNE_SYNC:
+    s = lookup_team_sync(algo, &uf);
+    break;
+  }
+
+  return (s == 0) ? uf : NULL;
+}
+
+/**
+ * @brief One call of the collective
+ */
+static void run_once(const tune_op_t *op, untyped_coll_fn_t f,
+                     shmem_team_t team, size_t nbytes) {
+  size_t nelems;
+
+  switch (op->kind) {
+  case TUNE_ALLTOALL:
+  case TUNE_COLLECT:
+  case TUNE_FCOLLECT:
+    (void)f(team, dest, src, nbytes);
+    break;
+  case TUNE_ALLTOALLS:
+    (void)f(team, dest, src, (ptrdiff_t)1, (ptrdiff_t)1, nbytes);
+    break;
+  case TUNE_BROADCAST:
+    (void)f(team, dest, src, nbytes, 0);
+    break;
+  case TUNE_REDUCE:
+    nelems = nbytes / sizeof(long);
+    (void)f(team, (long *)dest, (long *)src, (nelems > 0) ? nelems : 1);
+    break;
+  case TUNE_SYNC:
+    (void)f(team);
+    break;
+  }
+}
+
+/**
+ * @brief Average time of a call, slowest PE in the team
+ */
+static double time_algo(const tune_op_t *op, untyped_coll_fn_t f,
+                        shmem_team_t team, size_t nbytes, int warmup,
+                        int reps) {
+  double start;
+  int i;
+
+  for (i = 0; i < warmup; ++i) {
+    run_once(op, f, team, nbytes);
+  }
+
+  shmem_team_sync(team);
+
+  start = now();
+  for (i = 0; i < reps; ++i) {
+    run_once(op, f, team, nbytes);
+  }
+  my_time = (now() - start) / reps;
+
+  shmem_double_max_reduce(team, &max_time, &my_time, 1);
+
+  return max_time;
+}
+
+/**
+ * @brief Write a range for a rule: "lo-hi", or "lo-" if open-ended
+ */
+static void write_range(FILE *fp, const char *what, size_t lo, size_t hi,
+                        bool open) {
+  if (open) {
+    fprintf(fp, " %s=%lu-", what, (unsigned long)lo);
+  } else {
+    fprintf(fp, " %s=%lu-%lu", what, (unsigned long)lo, (unsigned long)hi);
+  }
+}
+
+/*
+ * what we found out, kept on PE 0
+ */
+static const char *algos[MAX_ALGOS];
+static size_t nalgos;
+static int team_sizes[MAX_TEAMS];
+static size_t nteams;
+static size_t sizes[MAX_SIZES];
+static size_t nsizes;
+static int best[MAX_TEAMS][MAX_SIZES]; /* index into algos, -1 if none */
+
+/**
+ * @brief Did two team sizes get the same winners at every message size?
+ */
+static bool same_winners(size_t t1, size_t t2) {
+  size_t j;
+
+  for (j = 0; j < nsizes; ++j) {
+    if (best[t1][j] != best[t2][j]) {
+      return false;
+      /* NOT REACHED */
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Does an algorithm run on every team size from lo to hi?
+ */
+static bool fits_all(const tune_op_t *op, int w, size_t lo, size_t hi) {
+  size_t n;
+
+  for (n = lo; n <= hi; ++n) {
+    if (!op->fits(algos[w], (int)n)) {
+      return false;
+      /* NOT REACHED */
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Write the team sizes for a rule whose winner came from rows
+ * t..t_last.  Only those sizes were timed, so the range is only
+ * widened over the ones in between (and left open past the last) if
+ * the winner runs on all of them; otherwise each timed size gets its
+ * own rule, and the others fall through to the configured algorithm.
+ */
+static void write_rule(FILE *fp, const tune_op_t *op, const char *name,
+                       int w, size_t t, size_t t_last, size_t j,
+                       size_t last) {
+  const size_t pes_lo = (t == 0) ? 1 : (size_t)team_sizes[t - 1] + 1;
+  const size_t pes_hi = (size_t)team_sizes[t_last];
+  const bool widen = fits_all(op, w, pes_lo, pes_hi);
+  /* an open range takes in bigger teams too, so try a few */
+  const bool open = widen && (t_last == nteams - 1) &&
+                    fits_all(op, w, pes_hi + 1, 2 * pes_hi);
+  size_t u;
+
+  for (u = widen ? t_last : t; u <= t_last; ++u) {
+    fprintf(fp, "%s %s", name, algos[w]);
+    if (widen) {
+      write_range(fp, "pes", pes_lo, pes_hi, open);
+    } else {
+      fprintf(fp, " pes=%d", team_sizes[u]);
+    }
+    if (nsizes > 1) {
+      write_range(fp, "bytes", (j == 0) ? 0 : sizes[j - 1] + 1, sizes[last],
+                  last == nsizes - 1);
+    }
+    fprintf(fp, "\n");
+  }
+}
+
+/**
+ * @brief Write the rules for one collective, merging neighbouring
+ * message sizes, and then team sizes, with the same winners
+ */
+static void write_rules(FILE *fp, const tune_op_t *op) {
+  const char *names[3] = {op->name, op->also[0], op->also[1]};
+  size_t k;
+
+  for (k = 0; k < 3; ++k) {
+    size_t t;
+    size_t t_last;
+
+    if (names[k] == NULL) {
+      continue;
+    }
+
+    fprintf(fp, "\n# %s\n", names[k]);
+
+    for (t = 0; t < nteams; t = t_last + 1) {
+      size_t j = 0;
+
+      for (t_last = t;
+           (t_last + 1 < nteams) && same_winners(t, t_last + 1); ++t_last) {
+        ;
+      }
+
+      while (j < nsizes) {
+        const int w = best[t][j];
+        size_t last = j;
+
+        while ((last + 1 < nsizes) && (best[t][last + 1] == w)) {
+          ++last;
+        }
+
+        if (w >= 0) {
+          write_rule(fp, op, names[k], w, t, t_last, j, last);
+        }
+
+        j = last + 1;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Time every algorithm of one collective at every team and
+ * message size
+ */
+static void tune(const tune_op_t *op, int warmup, int reps) {
+  const int me = shmem_my_pe();
+  const bool sized = (op->kind != TUNE_SYNC);
+  size_t t;
+
+  nalgos = op->algorithms(algos, MAX_ALGOS);
+
+  for (t = 0; t < nteams; ++t) {
+    const int npes = team_sizes[t];
+    double total[MAX_ALGOS];
+    shmem_team_t team;
+    size_t j;
+    size_t a;
+
+    shmem_team_split_strided(SHMEM_TEAM_WORLD, 0, 1, npes, NULL, 0, &team);
+
+    for (a = 0; a < nalgos; ++a) {
+      total[a] = 0.0;
+    }
+
+    for (j = 0; j < (sized ? nsizes : 1); ++j) {
+      double fastest = -1.0;
+
+      best[t][j] = -1;
+
+      if (team == SHMEM_TEAM_INVALID) {
+        continue;
+      }
+
+      for (a = 0; a < nalgos; ++a) {
+        untyped_coll_fn_t f;
+        double tm;
+
+        if (!op->fits(algos[a], npes)) {
+          continue;
+        }
+        f = find_algo(op, algos[a]);
+        if (f == NULL) {
+          continue;
+        }
+
+        tm = time_algo(op, f, team, sized ? sizes[j] : 0, warmup, reps);
+        total[a] += tm;
+
+        if ((fastest < 0.0) || (tm < fastest)) {
+          fastest = tm;
+          best[t][j] = (int)a;
+        }
+      }
+    }
+
+    /*
+     * collect contributions can differ between PEs, so its rules
+     * can't look at sizes: go with the best over all of them
+     */
+    if ((me == 0) && (op->kind == TUNE_COLLECT)) {
+      int w = -1;
+
+      for (a = 0; a < nalgos; ++a) {
+        if ((total[a] > 0.0) && ((w < 0) || (total[a] < total[w]))) {
+          w = (int)a;
+        }
+      }
+      for (j = 0; j < nsizes; ++j) {
+        best[t][j] = w;
+      }
+    }
+    if (!sized) {
+      for (j = 1; j < nsizes; ++j) {
+        best[t][j] = best[t][0];
+      }
+    }
+
+    if (team != SHMEM_TEAM_INVALID) {
+      shmem_team_destroy(team);
+    }
+    shmem_barrier_all();
+
+    if (me == 0) {
+      fprintf(stderr, "%s: %s on %d PEs done\n", progname, op->name, npes);
+    }
+  }
+}
+
+/**
+ * @brief Main program entry point
+ *
+ * @param argc Number of command line arguments
+ * @param argv Array of command line argument strings
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error
+ */
+int main(int argc, char *argv[]) {
+  const char *output = default_output;
+  size_t min_size = default_min_size;
+  size_t max_size = default_max_size;
+  int warmup = default_warmup;
+  int reps = default_reps;
+  int help = 0;
+  int me, npes;
+  size_t s;
+  size_t i;
+  FILE *fp = NULL;
+
+  progname = basename(argv[0]);
+
+  opterr = 0; /* no err msg, just my output */
+
+  while (1) {
+    const int c = getopt_long(argc, argv, "o:s:S:w:r:h", opts, NULL);
+
+    if (c == -1) {
+      break;
+    }
+
+    switch (c) {
+    case 'o':
+      output = optarg;
+      break;
+    case 's':
+      help |= (parse_size(optarg, &min_size) != 0);
+      break;
+    case 'S':
+      help |= (parse_size(optarg, &max_size) != 0);
+      break;
+    case 'w':
+      warmup = atoi(optarg);
+      help |= (warmup < 0);
+      break;
+    case 'r':
+      reps = atoi(optarg);
+      help |= (reps < 1);
+      break;
+    case 'h':
+    default:
+      help = 1;
+      break;
+    }
+  }
+
+  if ((min_size < 1) || (min_size > max_size)) {
+    help = 1;
+  }
+
+  shmem_init();
+  me = shmem_my_pe();
+  npes = shmem_n_pes();
+
+  if (help || (npes < 2)) {
+    if (me == 0) {
+      if (npes < 2) {
+        fprintf(stderr, "%s: need at least 2 PEs\n", progname);
+      }
+      output_help();
+    }
+    shmem_finalize();
+    return EXIT_FAILURE;
+    /* NOT REACHED */
+  }
+
+  /* team sizes: powers of 2, then everyone */
+  for (nteams = 0, i = 2; (i < (size_t)npes) && (nteams < MAX_TEAMS - 1);
+       i *= 2) {
+    team_sizes[nteams++] = (int)i;
+  }
+  team_sizes[nteams++] = npes;
+
+  for (nsizes = 0, s = min_size; (s <= max_size) && (nsizes < MAX_SIZES);
+       s *= 2) {
+    sizes[nsizes++] = s;
+  }
+
+  src = (char *)shmem_malloc(max_size * npes);
+  dest = (char *)shmem_malloc(max_size * npes);
+  if ((src == NULL) || (dest == NULL)) {
+    if (me == 0) {
+      fprintf(stderr,
+              "%s: can't allocate %lu bytes of symmetric memory, "
+              "try a bigger SHMEM_SYMMETRIC_SIZE or smaller --max-size\n",
+              progname, (unsigned long)(2 * max_size * npes));
+    }
+    shmem_global_exit(EXIT_FAILURE);
+    /* NOT REACHED */
+  }
+  memset(src, me, max_size * npes);
+
+  if (me == 0) {
+    fp = fopen(output, "w");
+    if (fp == NULL) {
+      perror(output);
+      shmem_global_exit(EXIT_FAILURE);
+      /* NOT REACHED */
+    }
+
+    fprintf(fp, "# collective rules from %s on %d PEs\n", progname, npes);
+    fprintf(fp, "# message sizes %lu-%lu bytes, %d warm-up, %d timed\n",
+            (unsigned long)min_size, (unsigned long)max_size, warmup, reps);
+  }
+
+  for (i = 0; i < n_tune_ops; ++i) {
+    tune(&tune_ops[i], warmup, reps);
+
+    if (me == 0) {
+      write_rules(fp, &tune_ops[i]);
+    }
+  }
+
+  if (me == 0) {
+    fclose(fp);
+    fprintf(stderr,
+            "%s: wrote \"%s\", use it with SHMEM_COLL_RULES_FILE, or\n"
+            "install it as \"%s\" for everyone\n",
+            progname, output, SHMEM_COLL_RULES_DEFAULT_FILE);
+  }
+
+  shmem_free(dest);
+  shmem_free(src);
+
+  shmem_finalize();
+
+  return EXIT_SUCCESS;
+}
@@ -12,12 +12,17 @@
  * - Signal-based
  * - Counter-based
  *
+ * and there are two that cut down the number of messages:
+ * - Node-aggregated (one message per pair of nodes per local PE)
+ * - Bruck (log2(PE_size) rounds, for small blocks)
+ *
  * @copyright For license: see LICENSE file at top-level
  */
 
 #include <shmem/api_types.h>
 #include "shcoll.h"
 #include "shcoll/compat.h"
+#include "util/exchange.h"
 
 #include <string.h>
 #include <limits.h>
@@ -233,6 +238,53 @@ ALLTOALL_HELPER_SIGNAL_DEFINITION(color_pairwise_exchange, COLOR_PEER,
 
 // @formatter:on
 
+/**
+ * @brief Node-aggregated alltoall
+ *
+ * Falls back to the counter-based shift exchange if nodes have
+ * different numbers of PEs.
+ *
+ * @param dest Symmetric destination array
+ * @param source Symmetric source array
+ * @param nelems Bytes for each PE
+ * @param PE_start First PE in the active set
+ * @param logPE_stride Log2 of stride between PEs
+ * @param PE_size Number of PEs in the active set
+ * @param pSync Symmetric work array
+ */
+inline static void
+alltoall_helper_node_aggregated(void *dest, const void *source, size_t nelems,
+                                int PE_start, int logPE_stride, int PE_size,
+                                long *pSync) {
+  const exchange_blocks_t blocks = {dest, source, 1, 1, nelems, 1};
+
+  if (exchange_node_aggregated(&blocks, PE_start, logPE_stride, PE_size,
+                               pSync) != 0) {
+    alltoall_helper_shift_exchange_counter(dest, source, nelems, PE_start,
+                                           logPE_stride, PE_size, pSync);
+  }
+}
+
+/**
+ * @brief Bruck alltoall
+ *
+ * @param dest Symmetric destination array
+ * @param source Symmetric source array
+ * @param nelems Bytes for each PE
+ * @param PE_start First PE in the active set
+ * @param logPE_stride Log2 of stride between PEs
+ * @param PE_size Number of PEs in the active set
+ * @param pSync Symmetric work array
+ */
+inline static void alltoall_helper_bruck(void *dest, const void *source,
+                                         size_t nelems, int PE_start,
+                                         int logPE_stride, int PE_size,
+                                         long *pSync) {
+  const exchange_blocks_t blocks = {dest, source, 1, 1, nelems, 1};
+
+  exchange_bruck(&blocks, PE_start, logPE_stride, PE_size, pSync);
+}
+
 /**
  * @brief Helper macro to define SIZE alltoall implementations
  *
@@ -289,6 +341,12 @@ SHCOLL_ALLTOALL_SIZE_DEFINITION(color_pairwise_exchange_barrier, 64)
 SHCOLL_ALLTOALL_SIZE_DEFINITION(color_pairwise_exchange_signal, 32)
 SHCOLL_ALLTOALL_SIZE_DEFINITION(color_pairwise_exchange_signal, 64)
 
+SHCOLL_ALLTOALL_SIZE_DEFINITION(node_aggregated, 32)
+SHCOLL_ALLTOALL_SIZE_DEFINITION(node_aggregated, 64)
+
+SHCOLL_ALLTOALL_SIZE_DEFINITION(bruck, 32)
+SHCOLL_ALLTOALL_SIZE_DEFINITION(bruck, 64)
+
 // @formatter:on
 
 /**
@@ -345,6 +403,47 @@ SHCOLL_ALLTOALL_SIZE_DEFINITION(color_pairwise_exchange_signal, 64)
 SHMEM_STANDARD_RMA_TYPE_TABLE(DEFINE_ALLTOALL_TYPES)
 #undef DEFINE_ALLTOALL_TYPES
 
+/**
+ * @brief Helper macro to define typed alltoall implementations that
+ *        leave pSync clean themselves
+ *
+ * As SHCOLL_ALLTOALL_TYPE_DEFINITION, but a PE may already have
+ * signalled us for the next alltoall, so pSync must not be reset after.
+ *
+ * @param _algo Algorithm name
+ * @param _type Data type
+ * @param _typename Type name string
+ */
+#define SHCOLL_ALLTOALL_TYPE_CLEAN_DEFINITION(_algo, _type, _typename)         \
+  int shcoll_##_typename##_alltoall_##_algo(                                   \
+      shmem_team_t team, _type *dest, const _type *source, size_t nelems) {    \
+    SHMEMU_CHECK_INIT();                                                       \
+    SHMEMU_CHECK_TEAM_VALID(team);                                             \
+    shmemc_team_h team_h = (shmemc_team_h)team;                                \
+    SHMEMU_CHECK_TEAM_STRIDE(team_h->stride, __func__);                        \
+    SHMEMU_CHECK_SYMMETRIC(dest, sizeof(_type) * nelems * team_h->nranks);     \
+    SHMEMU_CHECK_SYMMETRIC(source, sizeof(_type) * nelems * team_h->nranks);   \
+    SHMEMU_CHECK_BUFFER_OVERLAP(dest, source,                                  \
+                                sizeof(_type) * nelems * team_h->nranks,       \
+                                sizeof(_type) * nelems * team_h->nranks);      \
+    SHMEMU_CHECK_NULL(shmemc_team_get_psync(team_h, SHMEMC_PSYNC_ALLTOALL),    \
+                      "team_h->pSyncs[ALLTOALL]");                             \
+                                                                               \
+    alltoall_helper_##_algo(                                                   \
+        dest, source, nelems * sizeof(_type), team_h->start,                   \
+        (team_h->stride > 0) ? (int)log2((double)team_h->stride) : 0,          \
+        team_h->nranks, shmemc_team_get_psync(team_h, SHMEMC_PSYNC_ALLTOALL)); \
+                                                                               \
+    return 0;                                                                  \
+  }
+
+#define DEFINE_ALLTOALL_TYPES(_type, _typename)                                \
+  SHCOLL_ALLTOALL_TYPE_CLEAN_DEFINITION(node_aggregated, _type, _typename)     \
+  SHCOLL_ALLTOALL_TYPE_CLEAN_DEFINITION(bruck, _type, _typename)
+
+SHMEM_STANDARD_RMA_TYPE_TABLE(DEFINE_ALLTOALL_TYPES)
+#undef DEFINE_ALLTOALL_TYPES
+
 /**
  * @brief Helper macro to define alltoallmem implementations
  *
@@ -386,4 +485,37 @@ SHCOLL_ALLTOALLMEM_DEFINITION(color_pairwise_exchange_barrier)
 SHCOLL_ALLTOALLMEM_DEFINITION(color_pairwise_exchange_counter)
 SHCOLL_ALLTOALLMEM_DEFINITION(color_pairwise_exchange_signal)
 
+/**
+ * @brief Helper macro to define alltoallmem implementations that leave
+ *        pSync clean themselves (see SHCOLL_ALLTOALL_TYPE_CLEAN_DEFINITION)
+ *
+ * @param _algo Algorithm name
+ */
+#define SHCOLL_ALLTOALLMEM_CLEAN_DEFINITION(_algo)                             \
+  int shcoll_alltoallmem_##_algo(shmem_team_t team, void *dest,                \
+                                 const void *source, size_t nelems) {          \
+    SHMEMU_CHECK_INIT();                                                       \
+    SHMEMU_CHECK_TEAM_VALID(team);                                             \
+    shmemc_team_h team_h = (shmemc_team_h)team;                                \
+    SHMEMU_CHECK_NULL(dest, "dest");                                           \
+    SHMEMU_CHECK_NULL(source, "source");                                       \
+    SHMEMU_CHECK_TEAM_STRIDE(team_h->stride, __func__);                        \
+    SHMEMU_CHECK_SYMMETRIC(dest, nelems * team_h->nranks);                     \
+    SHMEMU_CHECK_SYMMETRIC(source, nelems * team_h->nranks);                   \
+    SHMEMU_CHECK_BUFFER_OVERLAP(dest, source, nelems * team_h->nranks,         \
+                                nelems * team_h->nranks);                      \
+    SHMEMU_CHECK_NULL(shmemc_team_get_psync(team_h, SHMEMC_PSYNC_ALLTOALL),    \
+                      "team_h->pSyncs[ALLTOALL]");                             \
+                                                                               \
+    alltoall_helper_##_algo(                                                   \
+        dest, source, nelems, team_h->start,                                   \
+        (team_h->stride > 0) ? (int)log2((double)team_h->stride) : 0,          \
+        team_h->nranks, shmemc_team_get_psync(team_h, SHMEMC_PSYNC_ALLTOALL)); \
+                                                                               \
+    return 0;                                                                  \
+  }
+
+SHCOLL_ALLTOALLMEM_CLEAN_DEFINITION(node_aggregated)
+SHCOLL_ALLTOALLMEM_CLEAN_DEFINITION(bruck)
+
 // @formatter:on
@@ -11,6 +11,7 @@
 #include "shcoll.h"
 #include "shcoll/compat.h"
 #include "shcoll/barrier.h"
+#include "util/exchange.h"
 #include <shmem/api_types.h>
 
 #include <assert.h>
@@ -296,6 +297,33 @@ inline static void alltoalls_helper_color_pairwise_exchange_counter(
   shmem_long_p(pSync, SHCOLL_SYNC_VALUE, me);
 }
 
+inline static void alltoalls_helper_node_aggregated(
+    void *dest, const void *source, ptrdiff_t dst_stride, ptrdiff_t sst_stride,
+    size_t elem_size, size_t nelems, int PE_start, int logPE_stride,
+    int PE_size, long *pSync) {
+  const exchange_blocks_t blocks = {dest,      source,    dst_stride,
+                                    sst_stride, elem_size, nelems};
+
+  /* nodes have different numbers of PEs */
+  if (exchange_node_aggregated(&blocks, PE_start, logPE_stride, PE_size,
+                               pSync) != 0) {
+    alltoalls_helper_shift_exchange_counter(dest, source, dst_stride,
+                                            sst_stride, elem_size, nelems,
+                                            PE_start, logPE_stride, PE_size,
+                                            pSync);
+  }
+}
+
+inline static void alltoalls_helper_bruck(
+    void *dest, const void *source, ptrdiff_t dst_stride, ptrdiff_t sst_stride,
+    size_t elem_size, size_t nelems, int PE_start, int logPE_stride,
+    int PE_size, long *pSync) {
+  const exchange_blocks_t blocks = {dest,      source,    dst_stride,
+                                    sst_stride, elem_size, nelems};
+
+  exchange_bruck(&blocks, PE_start, logPE_stride, PE_size, pSync);
+}
+
 /* ======================= Front-ends (size) ======================= */
 /* Element size is _size bits; _esz is bytes/element. Required bytes include
  * stride and (team_size + nelems - 1) per spec indexing.
@@ -340,6 +368,10 @@ SHCOLL_ALLTOALLS_SIZE_DEFINITION(color_pairwise_exchange_barrier, 32)
 SHCOLL_ALLTOALLS_SIZE_DEFINITION(color_pairwise_exchange_barrier, 64)
 SHCOLL_ALLTOALLS_SIZE_DEFINITION(color_pairwise_exchange_counter, 32)
 SHCOLL_ALLTOALLS_SIZE_DEFINITION(color_pairwise_exchange_counter, 64)
+SHCOLL_ALLTOALLS_SIZE_DEFINITION(node_aggregated, 32)
+SHCOLL_ALLTOALLS_SIZE_DEFINITION(node_aggregated, 64)
+SHCOLL_ALLTOALLS_SIZE_DEFINITION(bruck, 32)
+SHCOLL_ALLTOALLS_SIZE_DEFINITION(bruck, 64)
 
 /* ======================= Front-ends (typed) ======================= */
 
@@ -390,6 +422,47 @@ SHCOLL_ALLTOALLS_SIZE_DEFINITION(color_pairwise_exchange_counter, 64)
 SHMEM_STANDARD_RMA_TYPE_TABLE(DEFINE_ALLTOALLS_TYPES)
 #undef DEFINE_ALLTOALLS_TYPES
 
+/* These leave pSync clean themselves, and a PE may already have
+ * signalled us for the next call, so don't reset it afterwards.
+ */
+#define SHCOLL_ALLTOALLS_TYPE_CLEAN_DEFINITION(_algo, _type, _typename)        \
+  int shcoll_##_typename##_alltoalls_##_algo(                                  \
+      shmem_team_t team, _type *dest, const _type *source, ptrdiff_t dst,      \
+      ptrdiff_t sst, size_t nelems) {                                          \
+    SHMEMU_CHECK_INIT();                                                       \
+    SHMEMU_CHECK_TEAM_VALID(team);                                             \
+    SHMEMU_CHECK_NULL(dest, "dest");                                           \
+    SHMEMU_CHECK_NULL(source, "source");                                       \
+    SHMEMU_CHECK_POSITIVE(dst, "dst");                                         \
+    SHMEMU_CHECK_POSITIVE(sst, "sst");                                         \
+    SHMEMU_CHECK_POSITIVE(nelems, "nelems");                                   \
+    shmemc_team_h team_h = (shmemc_team_h)team;                                \
+    SHMEMU_CHECK_TEAM_STRIDE(team_h->stride, __func__);                        \
+    size_t need_dst =                                                          \
+        sizeof(_type) * (size_t)dst * nelems * (size_t)team_h->nranks;         \
+    size_t need_src =                                                          \
+        sizeof(_type) * (size_t)sst * nelems * (size_t)team_h->nranks;         \
+    SHMEMU_CHECK_SYMMETRIC(dest, need_dst);                                    \
+    SHMEMU_CHECK_SYMMETRIC(source, need_src);                                  \
+    SHMEMU_CHECK_BUFFER_OVERLAP(dest, source, need_dst, need_src);             \
+    long *ps = shmemc_team_get_psync(team_h, SHMEMC_PSYNC_ALLTOALL);           \
+    SHMEMU_CHECK_NULL(ps, "team_h->pSyncs[ALLTOALL]");                         \
+                                                                               \
+    alltoalls_helper_##_algo(                                                  \
+        dest, source, dst, sst, sizeof(_type), nelems, team_h->start,          \
+        (team_h->stride > 0) ? (int)log2((double)team_h->stride) : 0,          \
+        team_h->nranks, ps);                                                   \
+                                                                               \
+    return 0;                                                                  \
+  }
+
+#define DEFINE_ALLTOALLS_TYPES(_type, _typename)                               \
+  SHCOLL_ALLTOALLS_TYPE_CLEAN_DEFINITION(node_aggregated, _type, _typename)    \
+  SHCOLL_ALLTOALLS_TYPE_CLEAN_DEFINITION(bruck, _type, _typename)
+
+SHMEM_STANDARD_RMA_TYPE_TABLE(DEFINE_ALLTOALLS_TYPES)
+#undef DEFINE_ALLTOALLS_TYPES
+
 /* ======================= alltoallsmem() front-ends ======================= */
 /* API: shmem_alltoallsmem(team, dest, source, dst, sst, elem_size_bytes)
  * We move ONE element per PE (nelems == 1) whose size is elem_size_bytes.
@@ -433,3 +506,39 @@ SHCOLL_ALLTOALLSMEM_DEFINITION(xor_pairwise_exchange_barrier)
 SHCOLL_ALLTOALLSMEM_DEFINITION(xor_pairwise_exchange_counter)
 SHCOLL_ALLTOALLSMEM_DEFINITION(color_pairwise_exchange_barrier)
 SHCOLL_ALLTOALLSMEM_DEFINITION(color_pairwise_exchange_counter)
+
+/* As above, without the pSync reset */
+#define SHCOLL_ALLTOALLSMEM_CLEAN_DEFINITION(_algo)                            \
+  int shcoll_alltoallsmem_##_algo(shmem_team_t team, void *dest,               \
+                                  const void *source, ptrdiff_t dst,           \
+                                  ptrdiff_t sst, size_t elem_size) {           \
+    SHMEMU_CHECK_INIT();                                                       \
+    SHMEMU_CHECK_TEAM_VALID(team);                                             \
+    SHMEMU_CHECK_NULL(dest, "dest");                                           \
+    SHMEMU_CHECK_NULL(source, "source");                                       \
+    SHMEMU_CHECK_POSITIVE(dst, "dst");                                         \
+    SHMEMU_CHECK_POSITIVE(sst, "sst");                                         \
+    SHMEMU_CHECK_POSITIVE(elem_size, "elem_size");                             \
+    shmemc_team_h team_h = (shmemc_team_h)team;                                \
+    SHMEMU_CHECK_TEAM_STRIDE(team_h->stride, __func__);                        \
+    /* Minimal sizes per spec indexing with nelems=1 */                        \
+    size_t need_dst =                                                          \
+        (size_t)elem_size * (size_t)dst * 1 * (size_t)team_h->nranks;          \
+    size_t need_src =                                                          \
+        (size_t)elem_size * (size_t)sst * 1 * (size_t)team_h->nranks;          \
+    SHMEMU_CHECK_SYMMETRIC(dest, need_dst);                                    \
+    SHMEMU_CHECK_SYMMETRIC(source, need_src);                                  \
+    SHMEMU_CHECK_BUFFER_OVERLAP(dest, source, need_dst, need_src);             \
+    long *ps = shmemc_team_get_psync(team_h, SHMEMC_PSYNC_ALLTOALL);           \
+    SHMEMU_CHECK_NULL(ps, "team_h->pSyncs[ALLTOALL]");                         \
+                                                                               \
+    alltoalls_helper_##_algo(                                                  \
+        dest, source, dst, sst, elem_size, 1 /* nelems */, team_h->start,      \
+        (team_h->stride > 0) ? (int)log2((double)team_h->stride) : 0,          \
+        team_h->nranks, ps);                                                   \
+                                                                               \
+    return 0;                                                                  \
+  }
+
+SHCOLL_ALLTOALLSMEM_CLEAN_DEFINITION(node_aggregated)
+SHCOLL_ALLTOALLSMEM_CLEAN_DEFINITION(bruck)
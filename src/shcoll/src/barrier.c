@@ -9,6 +9,7 @@
  * - Binomial tree barrier
  * - K-nomial tree barrier
  * - Dissemination barrier
+ * - Hierarchical (node-aware) barrier
  *
  * Each algorithm is implemented for both barrier and sync operations, and
  * includes variants for team-based and global (all PEs) synchronization.
@@ -16,6 +17,7 @@
 
 #include "shcoll.h"
 #include "util/trees.h"
+#include "util/nodes.h"
 
 #include "shmem.h"
 #include <math.h>
@@ -265,6 +267,72 @@ inline static void barrier_sync_helper_dissemination(int PE_start,
   }
 }
 
+/**
+ * @brief Helper function implementing hierarchical barrier algorithm
+ *
+ * PEs on a node check in with their node leader through shared memory,
+ * the leaders run a dissemination barrier among themselves, then each
+ * leader lets its node go.  Only the leaders talk across the network.
+ *
+ * pSync[0] counts arrivals on a leader and is the release flag on the
+ * others.  pSync[1] holds the leaders' dissemination rounds, 2 bits
+ * per round: a fast leader can be one barrier ahead, so a round can
+ * see at most 2 pokes before being consumed.
+ *
+ * @param PE_start First PE in the active set
+ * @param logPE_stride Log2 of stride between PEs
+ * @param PE_size Number of PEs in the active set
+ * @param pSync Symmetric work array
+ */
+inline static void barrier_sync_helper_hierarchical(int PE_start,
+                                                    int logPE_stride,
+                                                    int PE_size, long *pSync) {
+  const int me = shmem_my_pe();
+  const int stride = 1 << logPE_stride;
+  const pe_hierarchy_t *hp = get_pe_hierarchy(PE_start, stride, PE_size);
+  long *node_sync = &pSync[0];
+  long *leader_sync = &pSync[1];
+  int round;
+  int distance;
+  long unused;
+
+  if (hp->me_local != 0) {
+    node_check_in(hp, node_sync);
+    node_wait_release(node_sync);
+    return;
+    /* NOT REACHED */
+  }
+
+  /* everyone on my node is here */
+  node_wait_check_ins(hp, node_sync);
+
+  for (round = 0, distance = 1; distance < hp->nleaders;
+       round++, distance <<= 1) {
+    const int target = hp->leaders[(hp->me_leader + distance) % hp->nleaders];
+    const int shift = 2 * round;
+    long seen;
+
+    /* Poke the target leader for the current round */
+    shmem_long_atomic_add(leader_sync, 1L << shift,
+                          pe_hierarchy_pe(hp, target));
+
+    /* Wait until poked in this round */
+    seen = shmem_long_atomic_fetch(leader_sync, me);
+    while (((seen >> shift) & 3) == 0) {
+      shmem_long_wait_until(leader_sync, SHMEM_CMP_NE, seen);
+      seen = shmem_long_atomic_fetch(leader_sync, me);
+    }
+
+    /* Consume the poke; fadd so it's done before the next barrier */
+    unused = shmem_long_atomic_fetch_add(leader_sync, -(1L << shift), me);
+  }
+
+  NO_WARN_UNUSED(unused);
+
+  /* let my node go */
+  node_release(hp, node_sync);
+}
+
 /**
  * @brief Macro to define barrier and sync functions for a given algorithm
  *
@@ -330,6 +398,7 @@ SHCOLL_BARRIER_SYNC_DEFINITION(complete_tree)
 SHCOLL_BARRIER_SYNC_DEFINITION(knomial_tree)
 SHCOLL_BARRIER_SYNC_DEFINITION(binomial_tree)
 SHCOLL_BARRIER_SYNC_DEFINITION(dissemination)
+SHCOLL_BARRIER_SYNC_DEFINITION(hierarchical)
 
 /* @formatter:on */
 
@@ -364,3 +433,23 @@ SHCOLL_TEAM_SYNC_DEFINITION(complete_tree)
 SHCOLL_TEAM_SYNC_DEFINITION(knomial_tree)
 SHCOLL_TEAM_SYNC_DEFINITION(binomial_tree)
 SHCOLL_TEAM_SYNC_DEFINITION(dissemination)
+
+/*
+ * The hierarchical barrier leaves pSync clean itself, and a leader may
+ * already hold a poke for the next sync, so don't reset it afterwards.
+ */
+int shcoll_team_sync_hierarchical(shmem_team_t team) {
+  SHMEMU_CHECK_INIT();
+  SHMEMU_CHECK_TEAM_VALID(team);
+  shmemc_team_h team_h = (shmemc_team_h)team;
+  SHMEMU_CHECK_TEAM_STRIDE(team_h->stride, __func__);
+  SHMEMU_CHECK_NULL(shmemc_team_get_psync(team_h, SHMEMC_PSYNC_BARRIER),
+                    "team_h->pSyncs[BARRIER]");
+
+  barrier_sync_helper_hierarchical(
+      team_h->start,
+      (team_h->stride > 0) ? (int)log2((double)team_h->stride) : 0,
+      team_h->nranks, shmemc_team_get_psync(team_h, SHMEMC_PSYNC_BARRIER));
+
+  return 0;
+}
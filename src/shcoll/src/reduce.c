@@ -7,6 +7,7 @@
  * - Binomial tree reduction
  * - Recursive doubling reduction
  * - Rabenseifner's algorithm
+ * - Hierarchical (node-aware) reduction
  *
  * Each algorithm is implemented as a macro that generates type-specific
  * implementations for different reduction operations (AND, OR, XOR, MIN, MAX,
@@ -16,6 +17,7 @@
 #include "shcoll.h"
 #include <shmem/api_types.h>
 #include "util/bithacks.h"
+#include "util/nodes.h"
 #include "../tests/util/debug.h"
 
 #include "shmem.h"
@@ -723,6 +725,344 @@
     }                                                                          \
   }
 
+/*
+ * pSync elements used by the hierarchical reductions.  The leaders'
+ * power-of-2 set has at most 2^30 members, so there are at most
+ * PE_SIZE_LOG - 2 reduce-scatter and allgather rounds, and everything
+ * fits in SHCOLL_REDUCE_SYNC_SIZE.
+ */
+#define HIER_NODE_SYNC 0 /* leader: check-ins; others: release flag */
+#define HIER_NODE_DONE 1 /* leader: PEs done reading the result */
+#define HIER_PRE 2       /* fold in leaders outside the power-of-2 set */
+#define HIER_POST 3      /* and hand them the result */
+#define HIER_RS 4        /* first reduce-scatter round */
+#define HIER_AG (HIER_RS + PE_SIZE_LOG - 2) /* first allgather round */
+
+/**
+ * @brief Scratch space for hierarchical reductions
+ *
+ * @param nbytes How much (> 0)
+ * @return the memory, to be free()d
+ */
+inline static void *hier_scratch(size_t nbytes) {
+  void *p = malloc(nbytes);
+
+  shmemu_assert(p != NULL, "shcoll: can't allocate %lu bytes for reduction",
+                (unsigned long)nbytes);
+
+  return p;
+}
+
+/**
+ * @brief Hand the leader's result to the rest of the node
+ *
+ * The others copy it out of the leader's dest, which must stay put
+ * until they have all done so.
+ *
+ * @param dest Symmetric result buffer
+ * @param nbytes Size of result
+ * @param hp Node layout of the active set
+ * @param pSync Symmetric work array
+ */
+inline static void hier_node_broadcast(void *dest, size_t nbytes,
+                                       const pe_hierarchy_t *hp,
+                                       long *pSync) {
+  if (hp->me_local == 0) {
+    node_release(hp, pSync + HIER_NODE_SYNC);
+    node_wait_check_ins(hp, pSync + HIER_NODE_DONE);
+  } else {
+    const int leader = pe_hierarchy_pe(hp, hp->local[0]);
+    const void *src = shmem_ptr(dest, leader);
+
+    node_wait_release(pSync + HIER_NODE_SYNC);
+    if (src != NULL) {
+      memcpy(dest, src, nbytes);
+    } else {
+      shmem_getmem(dest, dest, nbytes, leader);
+    }
+    node_check_in(hp, pSync + HIER_NODE_DONE);
+  }
+}
+
+/**
+ * @brief Helper macro to define hierarchical reduction operations
+ *
+ * Each node first reduces on-node through shared memory, every PE
+ * taking a segment of the array and reading it straight out of its
+ * peers' sources.  The node leaders then run Rabenseifner's algorithm
+ * among themselves, and each leader's node copies the result from it.
+ * Only the leaders move data between nodes.
+ *
+ * @param _name Name of the reduction operation
+ * @param _type Data type to operate on
+ * @param _op Binary operator to apply
+ */
+#define REDUCE_HELPER_HIERARCHICAL(_name, _type, _op)                          \
+  inline static void node_##_name##_reduce(_type *dest, const _type *source,   \
+                                           size_t nelems,                      \
+                                           const pe_hierarchy_t *hp,           \
+                                           long *pSync) {                      \
+    const int leader = pe_hierarchy_pe(hp, hp->local[0]);                      \
+    const size_t seg_begin = (hp->me_local * nelems) / hp->nlocal;             \
+    const size_t seg_end = ((hp->me_local + 1) * nelems) / hp->nlocal;         \
+    const size_t seg_nelems = seg_end - seg_begin;                             \
+    const size_t seg_bytes = seg_nelems * sizeof(_type);                       \
+    _type *acc = (_type *)shmem_ptr(dest, leader);                             \
+    _type *scratch = NULL;                                                     \
+    int i;                                                                     \
+                                                                               \
+    /* Wait until every source on the node is ready */                         \
+    if (hp->me_local == 0) {                                                   \
+      node_wait_check_ins(hp, pSync + HIER_NODE_SYNC);                         \
+      node_release(hp, pSync + HIER_NODE_SYNC);                                \
+    } else {                                                                   \
+      node_check_in(hp, pSync + HIER_NODE_SYNC);                               \
+      node_wait_release(pSync + HIER_NODE_SYNC);                               \
+    }                                                                          \
+                                                                               \
+    /*                                                                         \
+     * Reduce my segment, straight into the leader's dest if mapped.           \
+     * Start from the leader's own source: if it reduces in place,             \
+     * that's where my segment is going.                                       \
+     */                                                                        \
+    if (seg_nelems > 0) {                                                      \
+      if (acc != NULL) {                                                       \
+        acc += seg_begin;                                                      \
+      } else {                                                                 \
+        scratch = hier_scratch(2 * seg_bytes);                                 \
+        acc = scratch;                                                         \
+      }                                                                        \
+                                                                               \
+      for (i = 0; i < hp->nlocal; ++i) {                                       \
+        const int pe = pe_hierarchy_pe(hp, hp->local[i]);                      \
+        const _type *from = (const _type *)shmem_ptr(source, pe);              \
+                                                                               \
+        if (from != NULL) {                                                    \
+          from += seg_begin;                                                   \
+        } else {                                                               \
+          if (scratch == NULL) {                                               \
+            scratch = hier_scratch(2 * seg_bytes);                             \
+          }                                                                    \
+          shmem_getmem(scratch + seg_nelems, source + seg_begin, seg_bytes,    \
+                       pe);                                                    \
+          from = scratch + seg_nelems;                                         \
+        }                                                                      \
+                                                                               \
+        if (i == 0) {                                                          \
+          memmove(acc, from, seg_bytes);                                       \
+        } else {                                                               \
+          local_##_name##_reduce(acc, acc, from, seg_nelems);                  \
+        }                                                                      \
+      }                                                                        \
+                                                                               \
+      if (acc == scratch) {                                                    \
+        shmem_putmem(dest + seg_begin, acc, seg_bytes, leader);                \
+        shmem_quiet();                                                         \
+      }                                                                        \
+      free(scratch);                                                           \
+    }                                                                          \
+                                                                               \
+    /* Once everyone has checked in the leader has the node's result */        \
+    if (hp->me_local == 0) {                                                   \
+      node_wait_check_ins(hp, pSync + HIER_NODE_SYNC);                         \
+    } else {                                                                   \
+      node_check_in(hp, pSync + HIER_NODE_SYNC);                               \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  inline static void leaders_##_name##_reduce(_type *dest, size_t nelems,      \
+                                              const pe_hierarchy_t *hp,        \
+                                              long *pSync) {                   \
+    const int me = shmem_my_pe();                                              \
+    const int me_ld = hp->me_leader;                                           \
+    const int nleaders = hp->nleaders;                                         \
+    int peer;                                                                  \
+    int i;                                                                     \
+                                                                               \
+    int block_idx_begin;                                                       \
+    int block_idx_end;                                                         \
+                                                                               \
+    ptrdiff_t block_offset;                                                    \
+    ptrdiff_t next_block_offset;                                               \
+    size_t block_nelems;                                                       \
+                                                                               \
+    int xchg_peer_p2s;                                                         \
+    int xchg_peer_pe;                                                          \
+                                                                               \
+    /* Power 2 set */                                                          \
+    int me_p2s;                                                                \
+    int p2s_size;                                                              \
+    int log_p2s_size;                                                          \
+                                                                               \
+    int distance;                                                              \
+    _type *tmp_array = hier_scratch((nelems / 2 + 1) * sizeof(_type));         \
+                                                                               \
+    /* Find the greatest power of 2 lower than nleaders */                     \
+    for (p2s_size = 1, log_p2s_size = 0; p2s_size * 2 <= nleaders;             \
+         p2s_size *= 2, log_p2s_size++)                                        \
+      ;                                                                        \
+                                                                               \
+    /* Check if this leader belongs to the power 2 set */                      \
+    me_p2s = me_ld * p2s_size / nleaders;                                      \
+    if ((me_p2s * nleaders + p2s_size - 1) / p2s_size != me_ld) {              \
+      me_p2s = -1;                                                             \
+    }                                                                          \
+                                                                               \
+    /* Fold leaders outside the power 2 set into their neighbours */           \
+    if (me_p2s == -1) {                                                        \
+      peer = pe_hierarchy_pe(hp, hp->leaders[me_ld - 1]);                      \
+      shmem_long_p(pSync + HIER_PRE, SHCOLL_SYNC_VALUE + 1, peer);             \
+                                                                               \
+      /* Reduce the upper half of the array with the peer's */                 \
+      block_offset = nelems / 2;                                               \
+      block_nelems = (size_t)(nelems - block_offset);                          \
+                                                                               \
+      shmem_long_wait_until(pSync + HIER_PRE, SHMEM_CMP_NE,                    \
+                            SHCOLL_SYNC_VALUE);                                \
+      shmem_getmem(tmp_array, dest + block_offset,                             \
+                   block_nelems * sizeof(_type), peer);                        \
+      local_##_name##_reduce(dest + block_offset, dest + block_offset,         \
+                             tmp_array, block_nelems);                         \
+                                                                               \
+      /* Send the upper half of the array to peer */                           \
+      shmem_putmem(dest + block_offset, dest + block_offset,                   \
+                   block_nelems * sizeof(_type), peer);                        \
+      shmem_fence();                                                           \
+      shmem_long_p(pSync + HIER_PRE, SHCOLL_SYNC_VALUE + 2, peer);             \
+      shmem_long_p(pSync + HIER_PRE, SHCOLL_SYNC_VALUE, me);                   \
+    } else if ((me_ld + 1) * p2s_size / nleaders == me_p2s) {                  \
+      peer = pe_hierarchy_pe(hp, hp->leaders[me_ld + 1]);                      \
+      shmem_long_p(pSync + HIER_PRE, SHCOLL_SYNC_VALUE + 1, peer);             \
+                                                                               \
+      /* Reduce the lower half of the array with the peer's */                 \
+      block_nelems = nelems / 2;                                               \
+                                                                               \
+      shmem_long_wait_until(pSync + HIER_PRE, SHMEM_CMP_GT,                    \
+                            SHCOLL_SYNC_VALUE);                                \
+      shmem_getmem(tmp_array, dest, block_nelems * sizeof(_type), peer);       \
+      local_##_name##_reduce(dest, dest, tmp_array, block_nelems);             \
+                                                                               \
+      /* Wait until the upper half is received from peer */                    \
+      shmem_long_wait_until(pSync + HIER_PRE, SHMEM_CMP_GT,                    \
+                            SHCOLL_SYNC_VALUE + 1);                            \
+      shmem_long_p(pSync + HIER_PRE, SHCOLL_SYNC_VALUE, me);                   \
+    }                                                                          \
+                                                                               \
+    if (me_p2s != -1) {                                                        \
+      /* Reduce scatter within the power 2 set */                              \
+      block_idx_begin = 0;                                                     \
+      block_idx_end = p2s_size;                                                \
+                                                                               \
+      for (distance = 1, i = HIER_RS; distance < p2s_size;                     \
+           distance <<= 1, i++) {                                              \
+        xchg_peer_p2s = ((me_p2s & distance) == 0) ? me_p2s + distance         \
+                                                   : me_p2s - distance;        \
+        xchg_peer_pe = pe_hierarchy_pe(                                        \
+            hp, hp->leaders[(xchg_peer_p2s * nleaders + p2s_size - 1) /        \
+                            p2s_size]);                                        \
+                                                                               \
+        /* Notify the peer that the data is ready to be read */                \
+        shmem_long_p(pSync + i, SHCOLL_SYNC_VALUE + 1, xchg_peer_pe);          \
+                                                                               \
+        /* Keep the lower or upper half of the current block */                \
+        if ((me_p2s & distance) == 0) {                                        \
+          block_idx_end = (block_idx_begin + block_idx_end) / 2;               \
+        } else {                                                               \
+          block_idx_begin = (block_idx_begin + block_idx_end) / 2;             \
+        }                                                                      \
+                                                                               \
+        block_offset = (block_idx_begin * nelems) / p2s_size;                  \
+        next_block_offset = (block_idx_end * nelems) / p2s_size;               \
+        block_nelems = (size_t)(next_block_offset - block_offset);             \
+                                                                               \
+        shmem_long_wait_until(pSync + i, SHMEM_CMP_GE, SHCOLL_SYNC_VALUE + 1); \
+        shmem_getmem(tmp_array, dest + block_offset,                           \
+                     block_nelems * sizeof(_type), xchg_peer_pe);              \
+                                                                               \
+        /* Notify the peer that the data has been read */                      \
+        shmem_fence();                                                         \
+        shmem_long_p(pSync + i, SHCOLL_SYNC_VALUE + 2, xchg_peer_pe);          \
+                                                                               \
+        local_##_name##_reduce(dest + block_offset, dest + block_offset,       \
+                               tmp_array, block_nelems);                       \
+                                                                               \
+        /* Wait until the peer has read my data */                             \
+        shmem_long_wait_until(pSync + i, SHMEM_CMP_GE, SHCOLL_SYNC_VALUE + 2); \
+        shmem_long_p(pSync + i, SHCOLL_SYNC_VALUE, me);                        \
+      }                                                                        \
+                                                                               \
+      /* Collect the reduced blocks within the power 2 set */                  \
+      block_idx_begin = reverse_bits(me_p2s, log_p2s_size);                    \
+      block_idx_end = block_idx_begin + 1;                                     \
+                                                                               \
+      for (distance = p2s_size / 2, i = HIER_AG; distance > 0;                 \
+           distance >>= 1, i++) {                                              \
+        xchg_peer_p2s = ((me_p2s & distance) == 0) ? me_p2s + distance         \
+                                                   : me_p2s - distance;        \
+        xchg_peer_pe = pe_hierarchy_pe(                                        \
+            hp, hp->leaders[(xchg_peer_p2s * nleaders + p2s_size - 1) /        \
+                            p2s_size]);                                        \
+                                                                               \
+        block_offset = (block_idx_begin * nelems) / p2s_size;                  \
+        next_block_offset = (block_idx_end * nelems) / p2s_size;               \
+        block_nelems = (size_t)(next_block_offset - block_offset);             \
+                                                                               \
+        shmem_putmem(dest + block_offset, dest + block_offset,                 \
+                     block_nelems * sizeof(_type), xchg_peer_pe);              \
+        shmem_fence();                                                         \
+        shmem_long_p(pSync + i, SHCOLL_SYNC_VALUE + 1, xchg_peer_pe);          \
+                                                                               \
+        /* Wait until the data has arrived from the peer */                    \
+        shmem_long_wait_until(pSync + i, SHMEM_CMP_GE, SHCOLL_SYNC_VALUE + 1); \
+        shmem_long_p(pSync + i, SHCOLL_SYNC_VALUE, me);                        \
+                                                                               \
+        if ((me_p2s & distance) == 0) {                                        \
+          block_idx_end += (block_idx_end - block_idx_begin);                  \
+        } else {                                                               \
+          block_idx_begin -= (block_idx_end - block_idx_begin);                \
+        }                                                                      \
+      }                                                                        \
+    }                                                                          \
+                                                                               \
+    /* Hand the result back to leaders outside the power 2 set */              \
+    if (me_p2s == -1) {                                                        \
+      shmem_long_wait_until(pSync + HIER_POST, SHMEM_CMP_GE,                   \
+                            SHCOLL_SYNC_VALUE + 1);                            \
+      shmem_long_p(pSync + HIER_POST, SHCOLL_SYNC_VALUE, me);                  \
+    } else if ((me_ld + 1) * p2s_size / nleaders == me_p2s) {                  \
+      peer = pe_hierarchy_pe(hp, hp->leaders[me_ld + 1]);                      \
+      shmem_putmem(dest, dest, nelems * sizeof(_type), peer);                  \
+      shmem_fence();                                                           \
+      shmem_long_p(pSync + HIER_POST, SHCOLL_SYNC_VALUE + 1, peer);            \
+    }                                                                          \
+                                                                               \
+    free(tmp_array);                                                           \
+  }                                                                            \
+                                                                               \
+  void reduce_helper_##_name##_hierarchical(                                   \
+      _type *dest, const _type *source, int nreduce, int PE_start,             \
+      int logPE_stride, int PE_size, _type *pWrk, long *pSync) {               \
+    const int stride = 1 << logPE_stride;                                      \
+    const pe_hierarchy_t *hp = get_pe_hierarchy(PE_start, stride, PE_size);    \
+    const size_t nelems = (const size_t)nreduce;                               \
+                                                                               \
+    NO_WARN_UNUSED(pWrk);                                                      \
+                                                                               \
+    if (hp->nlocal > 1) {                                                      \
+      node_##_name##_reduce(dest, source, nelems, hp, pSync);                  \
+    } else if (dest != source) {                                               \
+      memcpy(dest, source, nelems * sizeof(_type));                            \
+    }                                                                          \
+                                                                               \
+    if ((hp->me_local == 0) && (hp->nleaders > 1)) {                           \
+      leaders_##_name##_reduce(dest, nelems, hp, pSync);                       \
+    }                                                                          \
+                                                                               \
+    if (hp->nlocal > 1) {                                                      \
+      hier_node_broadcast(dest, nelems * sizeof(_type), hp, pSync);            \
+    }                                                                          \
+  }
+
 /*
  * Supported reduction operations
  */
@@ -878,6 +1218,21 @@
 #define REDUCE_HELPER_RABENSEIFNER2_PROD_HELPER(_type, _typename)              \
   REDUCE_HELPER_RABENSEIFNER2(_typename##_prod, _type, PROD_OP)
 
+#define REDUCE_HELPER_HIERARCHICAL_AND_HELPER(_type, _typename)                \
+  REDUCE_HELPER_HIERARCHICAL(_typename##_and, _type, AND_OP)
+#define REDUCE_HELPER_HIERARCHICAL_OR_HELPER(_type, _typename)                 \
+  REDUCE_HELPER_HIERARCHICAL(_typename##_or, _type, OR_OP)
+#define REDUCE_HELPER_HIERARCHICAL_XOR_HELPER(_type, _typename)                \
+  REDUCE_HELPER_HIERARCHICAL(_typename##_xor, _type, XOR_OP)
+#define REDUCE_HELPER_HIERARCHICAL_MAX_HELPER(_type, _typename)                \
+  REDUCE_HELPER_HIERARCHICAL(_typename##_max, _type, MAX_OP)
+#define REDUCE_HELPER_HIERARCHICAL_MIN_HELPER(_type, _typename)                \
+  REDUCE_HELPER_HIERARCHICAL(_typename##_min, _type, MIN_OP)
+#define REDUCE_HELPER_HIERARCHICAL_SUM_HELPER(_type, _typename)                \
+  REDUCE_HELPER_HIERARCHICAL(_typename##_sum, _type, SUM_OP)
+#define REDUCE_HELPER_HIERARCHICAL_PROD_HELPER(_type, _typename)               \
+  REDUCE_HELPER_HIERARCHICAL(_typename##_prod, _type, PROD_OP)
+
 /* Combined macro that generates all implementations */
 #define SHCOLL_TO_ALL_DEFINE(_name)                                            \
   SHCOLL_TO_ALL_DEFINE_AND(_name)                                              \
@@ -896,6 +1251,7 @@ SHCOLL_TO_ALL_DEFINE(REDUCE_HELPER_BINOMIAL)
 SHCOLL_TO_ALL_DEFINE(REDUCE_HELPER_REC_DBL)
 SHCOLL_TO_ALL_DEFINE(REDUCE_HELPER_RABENSEIFNER)
 SHCOLL_TO_ALL_DEFINE(REDUCE_HELPER_RABENSEIFNER2)
+SHCOLL_TO_ALL_DEFINE(REDUCE_HELPER_HIERARCHICAL)
 
 /* Generate additional helpers for TO_ALL bitwise types (which don't overlap
  * with REDUCE bitwise types) */
@@ -917,6 +1273,9 @@ SHMEM_TO_ALL_BITWISE_TYPE_TABLE(REDUCE_HELPER_RABENSEIFNER_XOR_HELPER)
 SHMEM_TO_ALL_BITWISE_TYPE_TABLE(REDUCE_HELPER_RABENSEIFNER2_AND_HELPER)
 SHMEM_TO_ALL_BITWISE_TYPE_TABLE(REDUCE_HELPER_RABENSEIFNER2_OR_HELPER)
 SHMEM_TO_ALL_BITWISE_TYPE_TABLE(REDUCE_HELPER_RABENSEIFNER2_XOR_HELPER)
+SHMEM_TO_ALL_BITWISE_TYPE_TABLE(REDUCE_HELPER_HIERARCHICAL_AND_HELPER)
+SHMEM_TO_ALL_BITWISE_TYPE_TABLE(REDUCE_HELPER_HIERARCHICAL_OR_HELPER)
+SHMEM_TO_ALL_BITWISE_TYPE_TABLE(REDUCE_HELPER_HIERARCHICAL_XOR_HELPER)
 
 /* @formatter:on */
 // clang-format on
@@ -1036,6 +1395,21 @@ SHMEM_TO_ALL_BITWISE_TYPE_TABLE(REDUCE_HELPER_RABENSEIFNER2_XOR_HELPER)
 #define TO_ALL_WRAPPER_PROD_rabenseifner2(_type, _typename)                    \
   TO_ALL_WRAPPER(_typename##_prod, _type, PROD_OP, rabenseifner2)
 
+#define TO_ALL_WRAPPER_AND_hierarchical(_type, _typename)                      \
+  TO_ALL_WRAPPER(_typename##_and, _type, AND_OP, hierarchical)
+#define TO_ALL_WRAPPER_OR_hierarchical(_type, _typename)                       \
+  TO_ALL_WRAPPER(_typename##_or, _type, OR_OP, hierarchical)
+#define TO_ALL_WRAPPER_XOR_hierarchical(_type, _typename)                      \
+  TO_ALL_WRAPPER(_typename##_xor, _type, XOR_OP, hierarchical)
+#define TO_ALL_WRAPPER_MAX_hierarchical(_type, _typename)                      \
+  TO_ALL_WRAPPER(_typename##_max, _type, MAX_OP, hierarchical)
+#define TO_ALL_WRAPPER_MIN_hierarchical(_type, _typename)                      \
+  TO_ALL_WRAPPER(_typename##_min, _type, MIN_OP, hierarchical)
+#define TO_ALL_WRAPPER_SUM_hierarchical(_type, _typename)                      \
+  TO_ALL_WRAPPER(_typename##_sum, _type, SUM_OP, hierarchical)
+#define TO_ALL_WRAPPER_PROD_hierarchical(_type, _typename)                     \
+  TO_ALL_WRAPPER(_typename##_prod, _type, PROD_OP, hierarchical)
+
 /* Group by operation type using TO_ALL type tables for wrappers (only generate
  * for supported types) */
 #define TO_ALL_WRAPPER_BITWISE(_algo)                                          \
@@ -1063,6 +1437,7 @@ TO_ALL_WRAPPER_ALL(binomial)
 TO_ALL_WRAPPER_ALL(rec_dbl)
 TO_ALL_WRAPPER_ALL(rabenseifner)
 TO_ALL_WRAPPER_ALL(rabenseifner2)
+TO_ALL_WRAPPER_ALL(hierarchical)
 
 /*
  * @brief Macro to define team-based reduction operations
@@ -1101,6 +1476,38 @@ TO_ALL_WRAPPER_ALL(rabenseifner2)
     return 0;                                                                  \
   }
 
+/*
+ * @brief Macro to define team-based hierarchical reduction operations
+ *
+ * As SHCOLL_REDUCE_DEFINITION, but the hierarchical reduction needs no
+ * pWrk and leaves pSync clean itself: a PE may already have checked in
+ * for the next reduction, so it must not be reset afterwards.
+ *
+ * @param _typename Type name (e.g. int_sum)
+ * @param _type Actual type (e.g. int)
+ * @param _op Operation (e.g. sum)
+ */
+#define SHCOLL_REDUCE_HIERARCHICAL_DEFINITION(_typename, _type, _op)           \
+  int shcoll_##_typename##_##_op##_reduce_hierarchical(                        \
+      shmem_team_t team, _type *dest, const _type *source, size_t nreduce) {   \
+    SHMEMU_CHECK_INIT();                                                       \
+    SHMEMU_CHECK_TEAM_VALID(team);                                             \
+    SHMEMU_CHECK_SYMMETRIC(dest, "dest");                                      \
+    SHMEMU_CHECK_SYMMETRIC(source, "source");                                  \
+    shmemc_team_h team_h = (shmemc_team_h)team;                                \
+    SHMEMU_CHECK_TEAM_STRIDE(team_h->stride, __func__);                        \
+    SHMEMU_CHECK_NULL(shmemc_team_get_psync(team_h, SHMEMC_PSYNC_REDUCE),      \
+                      "team_h->pSyncs[REDUCE]");                               \
+                                                                               \
+    reduce_helper_##_typename##_##_op##_hierarchical(                          \
+        dest, source, nreduce, team_h->start,                                  \
+        (team_h->stride > 0) ? (int)log2((double)team_h->stride) : 0,          \
+        team_h->nranks, NULL,                                                  \
+        shmemc_team_get_psync(team_h, SHMEMC_PSYNC_REDUCE));                   \
+                                                                               \
+    return 0;                                                                  \
+  }
+
 #define SHIM_REDUCE_DECLARE(_typename, _type, _op, _algo)                      \
   SHCOLL_REDUCE_DEFINITION(_typename, _type, _op, _algo)
 
@@ -1207,6 +1614,21 @@ TO_ALL_WRAPPER_ALL(rabenseifner2)
 #define DECLARE_ARITH_REDUCE_TYPE_prod_rabenseifner2(_type, _typename)         \
   SHIM_REDUCE_DECLARE(_typename, _type, prod, rabenseifner2)
 
+#define DECLARE_BITWISE_REDUCE_TYPE_and_hierarchical(_type, _typename)         \
+  SHCOLL_REDUCE_HIERARCHICAL_DEFINITION(_typename, _type, and)
+#define DECLARE_BITWISE_REDUCE_TYPE_or_hierarchical(_type, _typename)          \
+  SHCOLL_REDUCE_HIERARCHICAL_DEFINITION(_typename, _type, or)
+#define DECLARE_BITWISE_REDUCE_TYPE_xor_hierarchical(_type, _typename)         \
+  SHCOLL_REDUCE_HIERARCHICAL_DEFINITION(_typename, _type, xor)
+#define DECLARE_MINMAX_REDUCE_TYPE_min_hierarchical(_type, _typename)          \
+  SHCOLL_REDUCE_HIERARCHICAL_DEFINITION(_typename, _type, min)
+#define DECLARE_MINMAX_REDUCE_TYPE_max_hierarchical(_type, _typename)          \
+  SHCOLL_REDUCE_HIERARCHICAL_DEFINITION(_typename, _type, max)
+#define DECLARE_ARITH_REDUCE_TYPE_sum_hierarchical(_type, _typename)           \
+  SHCOLL_REDUCE_HIERARCHICAL_DEFINITION(_typename, _type, sum)
+#define DECLARE_ARITH_REDUCE_TYPE_prod_hierarchical(_type, _typename)          \
+  SHCOLL_REDUCE_HIERARCHICAL_DEFINITION(_typename, _type, prod)
+
 /*
  * @brief Grouping macros for each algorithm
  */
@@ -1234,3 +1656,4 @@ SHIM_REDUCE_ALL(binomial)
 SHIM_REDUCE_ALL(rec_dbl)
 SHIM_REDUCE_ALL(rabenseifner)
 SHIM_REDUCE_ALL(rabenseifner2)
+SHIM_REDUCE_ALL(hierarchical)
@@ -12,6 +12,8 @@
  * - Barrier-based
  * - Signal-based
  * - Counter-based
+ *
+ * plus node-aggregated and Bruck exchanges.
  */
 
 #ifndef _SHCOLL_ALLTOALL_H
@@ -52,7 +54,9 @@
   SHCOLL_TYPED_ALLTOALL_DECLARATION(color_pairwise_exchange_counter, _type,    \
                                     _typename)                                 \
   SHCOLL_TYPED_ALLTOALL_DECLARATION(color_pairwise_exchange_signal, _type,     \
-                                    _typename)
+                                    _typename)                                 \
+  SHCOLL_TYPED_ALLTOALL_DECLARATION(node_aggregated, _type, _typename)         \
+  SHCOLL_TYPED_ALLTOALL_DECLARATION(bruck, _type, _typename)
 
 SHMEM_STANDARD_RMA_TYPE_TABLE(DECLARE_ALLTOALL_TYPES)
 #undef DECLARE_ALLTOALL_TYPES
@@ -75,6 +79,8 @@ SHCOLL_ALLTOALLMEM_DECLARATION(xor_pairwise_exchange_signal)
 SHCOLL_ALLTOALLMEM_DECLARATION(color_pairwise_exchange_barrier)
 SHCOLL_ALLTOALLMEM_DECLARATION(color_pairwise_exchange_counter)
 SHCOLL_ALLTOALLMEM_DECLARATION(color_pairwise_exchange_signal)
+SHCOLL_ALLTOALLMEM_DECLARATION(node_aggregated)
+SHCOLL_ALLTOALLMEM_DECLARATION(bruck)
 
 /**
  * @brief Macro to declare sized alltoall implementations
@@ -115,4 +121,10 @@ SHCOLL_SIZED_ALLTOALL_DECLARATION(color_pairwise_exchange_counter, 64)
 SHCOLL_SIZED_ALLTOALL_DECLARATION(color_pairwise_exchange_signal, 32)
 SHCOLL_SIZED_ALLTOALL_DECLARATION(color_pairwise_exchange_signal, 64)
 
+SHCOLL_SIZED_ALLTOALL_DECLARATION(node_aggregated, 32)
+SHCOLL_SIZED_ALLTOALL_DECLARATION(node_aggregated, 64)
+
+SHCOLL_SIZED_ALLTOALL_DECLARATION(bruck, 32)
+SHCOLL_SIZED_ALLTOALL_DECLARATION(bruck, 64)
+
 #endif /* ! _SHCOLL_ALLTOALL_H */
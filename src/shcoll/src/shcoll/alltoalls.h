@@ -12,6 +12,8 @@
  * - Barrier-based
  * - Signal-based
  * - Counter-based
+ *
+ * plus node-aggregated and Bruck exchanges.
  */
 
 #ifndef _SHCOLL_ALLTOALLS_H
@@ -49,7 +51,9 @@
   SHCOLL_TYPED_ALLTOALLS_DECLARATION(color_pairwise_exchange_barrier, _type,   \
                                      _typename)                                \
   SHCOLL_TYPED_ALLTOALLS_DECLARATION(color_pairwise_exchange_counter, _type,   \
-                                     _typename)
+                                     _typename)                                \
+  SHCOLL_TYPED_ALLTOALLS_DECLARATION(node_aggregated, _type, _typename)        \
+  SHCOLL_TYPED_ALLTOALLS_DECLARATION(bruck, _type, _typename)
 
 SHMEM_STANDARD_RMA_TYPE_TABLE(DECLARE_ALLTOALLS_TYPES)
 #undef DECLARE_ALLTOALLS_TYPES
@@ -71,6 +75,8 @@ SHCOLL_ALLTOALLSMEM_DECLARATION(xor_pairwise_exchange_barrier)
 SHCOLL_ALLTOALLSMEM_DECLARATION(xor_pairwise_exchange_counter)
 SHCOLL_ALLTOALLSMEM_DECLARATION(color_pairwise_exchange_barrier)
 SHCOLL_ALLTOALLSMEM_DECLARATION(color_pairwise_exchange_counter)
+SHCOLL_ALLTOALLSMEM_DECLARATION(node_aggregated)
+SHCOLL_ALLTOALLSMEM_DECLARATION(bruck)
 
 /**
  * @brief Macro to declare sized strided alltoall implementations
@@ -102,5 +108,9 @@ SHCOLL_SIZED_ALLTOALLS_DECLARATION(color_pairwise_exchange_barrier, 64)
 
 SHCOLL_SIZED_ALLTOALLS_DECLARATION(color_pairwise_exchange_counter, 32)
 SHCOLL_SIZED_ALLTOALLS_DECLARATION(color_pairwise_exchange_counter, 64)
+SHCOLL_SIZED_ALLTOALLS_DECLARATION(node_aggregated, 32)
+SHCOLL_SIZED_ALLTOALLS_DECLARATION(node_aggregated, 64)
+SHCOLL_SIZED_ALLTOALLS_DECLARATION(bruck, 32)
+SHCOLL_SIZED_ALLTOALLS_DECLARATION(bruck, 64)
 
 #endif /* ! _SHCOLL_ALLTOALLS_H */
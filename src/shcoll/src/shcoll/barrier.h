@@ -8,6 +8,7 @@
  * - Binomial tree barrier
  * - K-nomial tree barrier
  * - Dissemination barrier
+ * - Hierarchical (node-aware) barrier
  */
 
 #ifndef _SHCOLL_BARRIER_H
@@ -52,6 +53,7 @@ SHCOLL_BARRIER_SYNC_DECLARATION(complete_tree)
 SHCOLL_BARRIER_SYNC_DECLARATION(binomial_tree)
 SHCOLL_BARRIER_SYNC_DECLARATION(knomial_tree)
 SHCOLL_BARRIER_SYNC_DECLARATION(dissemination)
+SHCOLL_BARRIER_SYNC_DECLARATION(hierarchical)
 
 /**
  * @brief Macro to declare team sync function for a given algorithm
@@ -69,5 +71,6 @@ SHCOLL_TEAM_SYNC_DECLARATION(complete_tree)
 SHCOLL_TEAM_SYNC_DECLARATION(binomial_tree)
 SHCOLL_TEAM_SYNC_DECLARATION(knomial_tree)
 SHCOLL_TEAM_SYNC_DECLARATION(dissemination)
+SHCOLL_TEAM_SYNC_DECLARATION(hierarchical)
 
 #endif /* ! _SHCOLL_BARRIER_H */
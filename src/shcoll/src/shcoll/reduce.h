@@ -6,7 +6,7 @@
  * This file provides declarations for various reduction operations (AND, OR,
  * XOR, MIN, MAX, SUM, PROD) across different data types. Multiple algorithm
  * implementations are supported including linear, binomial, recursive doubling,
- * and Rabenseifner's algorithm.
+ * Rabenseifner's algorithm and a hierarchical (node-aware) reduction.
  */
 
 #ifndef _SHCOLL_REDUCTION_H
@@ -37,16 +37,19 @@
   SHCOLL_TO_ALL_DECLARE(_typename##_and, _type, rec_dbl);                      \
   SHCOLL_TO_ALL_DECLARE(_typename##_and, _type, rabenseifner);                 \
   SHCOLL_TO_ALL_DECLARE(_typename##_and, _type, rabenseifner2);                \
+  SHCOLL_TO_ALL_DECLARE(_typename##_and, _type, hierarchical);                 \
   SHCOLL_TO_ALL_DECLARE(_typename##_or, _type, linear);                        \
   SHCOLL_TO_ALL_DECLARE(_typename##_or, _type, binomial);                      \
   SHCOLL_TO_ALL_DECLARE(_typename##_or, _type, rec_dbl);                       \
   SHCOLL_TO_ALL_DECLARE(_typename##_or, _type, rabenseifner);                  \
   SHCOLL_TO_ALL_DECLARE(_typename##_or, _type, rabenseifner2);                 \
+  SHCOLL_TO_ALL_DECLARE(_typename##_or, _type, hierarchical);                  \
   SHCOLL_TO_ALL_DECLARE(_typename##_xor, _type, linear);                       \
   SHCOLL_TO_ALL_DECLARE(_typename##_xor, _type, binomial);                     \
   SHCOLL_TO_ALL_DECLARE(_typename##_xor, _type, rec_dbl);                      \
   SHCOLL_TO_ALL_DECLARE(_typename##_xor, _type, rabenseifner);                 \
-  SHCOLL_TO_ALL_DECLARE(_typename##_xor, _type, rabenseifner2);
+  SHCOLL_TO_ALL_DECLARE(_typename##_xor, _type, rabenseifner2);                \
+  SHCOLL_TO_ALL_DECLARE(_typename##_xor, _type, hierarchical);
 SHMEM_TO_ALL_BITWISE_TYPE_TABLE(DECLARE_TO_ALL_BITWISE)
 #undef DECLARE_TO_ALL_BITWISE
 
@@ -56,11 +59,13 @@ SHMEM_TO_ALL_BITWISE_TYPE_TABLE(DECLARE_TO_ALL_BITWISE)
   SHCOLL_TO_ALL_DECLARE(_typename##_min, _type, rec_dbl);                      \
   SHCOLL_TO_ALL_DECLARE(_typename##_min, _type, rabenseifner);                 \
   SHCOLL_TO_ALL_DECLARE(_typename##_min, _type, rabenseifner2);                \
+  SHCOLL_TO_ALL_DECLARE(_typename##_min, _type, hierarchical);                 \
   SHCOLL_TO_ALL_DECLARE(_typename##_max, _type, linear);                       \
   SHCOLL_TO_ALL_DECLARE(_typename##_max, _type, binomial);                     \
   SHCOLL_TO_ALL_DECLARE(_typename##_max, _type, rec_dbl);                      \
   SHCOLL_TO_ALL_DECLARE(_typename##_max, _type, rabenseifner);                 \
-  SHCOLL_TO_ALL_DECLARE(_typename##_max, _type, rabenseifner2);
+  SHCOLL_TO_ALL_DECLARE(_typename##_max, _type, rabenseifner2);                \
+  SHCOLL_TO_ALL_DECLARE(_typename##_max, _type, hierarchical);
 SHMEM_TO_ALL_MINMAX_TYPE_TABLE(DECLARE_TO_ALL_MINMAX)
 #undef DECLARE_TO_ALL_MINMAX
 
@@ -70,11 +75,13 @@ SHMEM_TO_ALL_MINMAX_TYPE_TABLE(DECLARE_TO_ALL_MINMAX)
   SHCOLL_TO_ALL_DECLARE(_typename##_sum, _type, rec_dbl);                      \
   SHCOLL_TO_ALL_DECLARE(_typename##_sum, _type, rabenseifner);                 \
   SHCOLL_TO_ALL_DECLARE(_typename##_sum, _type, rabenseifner2);                \
+  SHCOLL_TO_ALL_DECLARE(_typename##_sum, _type, hierarchical);                 \
   SHCOLL_TO_ALL_DECLARE(_typename##_prod, _type, linear);                      \
   SHCOLL_TO_ALL_DECLARE(_typename##_prod, _type, binomial);                    \
   SHCOLL_TO_ALL_DECLARE(_typename##_prod, _type, rec_dbl);                     \
   SHCOLL_TO_ALL_DECLARE(_typename##_prod, _type, rabenseifner);                \
-  SHCOLL_TO_ALL_DECLARE(_typename##_prod, _type, rabenseifner2);
+  SHCOLL_TO_ALL_DECLARE(_typename##_prod, _type, rabenseifner2);               \
+  SHCOLL_TO_ALL_DECLARE(_typename##_prod, _type, hierarchical);
 SHMEM_TO_ALL_ARITH_TYPE_TABLE(DECLARE_TO_ALL_ARITH)
 #undef DECLARE_TO_ALL_ARITH
 
@@ -98,16 +105,19 @@ SHMEM_TO_ALL_ARITH_TYPE_TABLE(DECLARE_TO_ALL_ARITH)
   SHCOLL_REDUCE_DECLARE(_typename, _type, and, rec_dbl)                        \
   SHCOLL_REDUCE_DECLARE(_typename, _type, and, rabenseifner)                   \
   SHCOLL_REDUCE_DECLARE(_typename, _type, and, rabenseifner2)                  \
+  SHCOLL_REDUCE_DECLARE(_typename, _type, and, hierarchical)                   \
   SHCOLL_REDUCE_DECLARE(_typename, _type, or, linear)                          \
   SHCOLL_REDUCE_DECLARE(_typename, _type, or, binomial)                        \
   SHCOLL_REDUCE_DECLARE(_typename, _type, or, rec_dbl)                         \
   SHCOLL_REDUCE_DECLARE(_typename, _type, or, rabenseifner)                    \
   SHCOLL_REDUCE_DECLARE(_typename, _type, or, rabenseifner2)                   \
+  SHCOLL_REDUCE_DECLARE(_typename, _type, or, hierarchical)                    \
   SHCOLL_REDUCE_DECLARE(_typename, _type, xor, linear)                         \
   SHCOLL_REDUCE_DECLARE(_typename, _type, xor, binomial)                       \
   SHCOLL_REDUCE_DECLARE(_typename, _type, xor, rec_dbl)                        \
   SHCOLL_REDUCE_DECLARE(_typename, _type, xor, rabenseifner)                   \
-  SHCOLL_REDUCE_DECLARE(_typename, _type, xor, rabenseifner2)
+  SHCOLL_REDUCE_DECLARE(_typename, _type, xor, rabenseifner2)                  \
+  SHCOLL_REDUCE_DECLARE(_typename, _type, xor, hierarchical)
 SHMEM_REDUCE_BITWISE_TYPE_TABLE(DECLARE_REDUCE_BITWISE)
 #undef DECLARE_REDUCE_BITWISE
 
@@ -117,11 +127,13 @@ SHMEM_REDUCE_BITWISE_TYPE_TABLE(DECLARE_REDUCE_BITWISE)
   SHCOLL_REDUCE_DECLARE(_typename, _type, min, rec_dbl)                        \
   SHCOLL_REDUCE_DECLARE(_typename, _type, min, rabenseifner)                   \
   SHCOLL_REDUCE_DECLARE(_typename, _type, min, rabenseifner2)                  \
+  SHCOLL_REDUCE_DECLARE(_typename, _type, min, hierarchical)                   \
   SHCOLL_REDUCE_DECLARE(_typename, _type, max, linear)                         \
   SHCOLL_REDUCE_DECLARE(_typename, _type, max, binomial)                       \
   SHCOLL_REDUCE_DECLARE(_typename, _type, max, rec_dbl)                        \
   SHCOLL_REDUCE_DECLARE(_typename, _type, max, rabenseifner)                   \
-  SHCOLL_REDUCE_DECLARE(_typename, _type, max, rabenseifner2)
+  SHCOLL_REDUCE_DECLARE(_typename, _type, max, rabenseifner2)                  \
+  SHCOLL_REDUCE_DECLARE(_typename, _type, max, hierarchical)
 SHMEM_REDUCE_MINMAX_TYPE_TABLE(DECLARE_REDUCE_MINMAX)
 #undef DECLARE_REDUCE_MINMAX
 
@@ -131,11 +143,13 @@ SHMEM_REDUCE_MINMAX_TYPE_TABLE(DECLARE_REDUCE_MINMAX)
   SHCOLL_REDUCE_DECLARE(_typename, _type, sum, rec_dbl)                        \
   SHCOLL_REDUCE_DECLARE(_typename, _type, sum, rabenseifner)                   \
   SHCOLL_REDUCE_DECLARE(_typename, _type, sum, rabenseifner2)                  \
+  SHCOLL_REDUCE_DECLARE(_typename, _type, sum, hierarchical)                   \
   SHCOLL_REDUCE_DECLARE(_typename, _type, prod, linear)                        \
   SHCOLL_REDUCE_DECLARE(_typename, _type, prod, binomial)                      \
   SHCOLL_REDUCE_DECLARE(_typename, _type, prod, rec_dbl)                       \
   SHCOLL_REDUCE_DECLARE(_typename, _type, prod, rabenseifner)                  \
-  SHCOLL_REDUCE_DECLARE(_typename, _type, prod, rabenseifner2)
+  SHCOLL_REDUCE_DECLARE(_typename, _type, prod, rabenseifner2)                 \
+  SHCOLL_REDUCE_DECLARE(_typename, _type, prod, hierarchical)
 SHMEM_REDUCE_ARITH_TYPE_TABLE(DECLARE_REDUCE_ARITH)
 #undef DECLARE_REDUCE_ARITH
 
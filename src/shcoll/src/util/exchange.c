@@ -0,0 +1,407 @@
+/**
+ * @file exchange.c
+ * @brief Node-aggregated and Bruck block exchanges
+ */
+
+#include "exchange.h"
+#include "nodes.h"
+#include "shmemu.h"
+
+#include <shmem.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+/* pSync use by the node-aggregated exchange */
+#define AGGR_COUNT 0   /* staged blocks from other nodes */
+#define AGGR_NODE 1    /* on-node barrier before the swap */
+#define AGGR_BARRIER 2 /* closing barrier (2 longs) */
+
+/*
+ * pSync use by the Bruck exchange: round k's data arrives with a flag
+ * in BRUCK_DATA + k, and the PE I send to in round k tells me in
+ * BRUCK_ACK + k that it is ready for it.
+ */
+#define BRUCK_DATA 0
+#define BRUCK_ACK (SHCOLL_ALLTOALL_SYNC_SIZE / 2)
+
+inline static void *exchange_alloc(size_t nbytes) {
+  void *p = malloc(nbytes);
+
+  shmemu_assert(p != NULL, "shcoll: can't allocate memory for alltoall");
+
+  return p;
+}
+
+/**
+ * @brief Address of element e of a strided buffer
+ */
+inline static char *elem_at(const void *base, ptrdiff_t stride,
+                            size_t elem_size, size_t e) {
+  return (char *)base + (ptrdiff_t)e * stride * (ptrdiff_t)elem_size;
+}
+
+/**
+ * @brief Copy elements between local strided buffers
+ */
+static void copy_elems(void *to, ptrdiff_t tst, const void *from,
+                       ptrdiff_t fst, size_t elem_size, size_t n) {
+  size_t i;
+
+  if ((tst == 1) && (fst == 1)) {
+    memcpy(to, from, n * elem_size);
+    return;
+    /* NOT REACHED */
+  }
+
+  for (i = 0; i < n; ++i) {
+    memcpy(elem_at(to, tst, elem_size, i), elem_at(from, fst, elem_size, i),
+           elem_size);
+  }
+}
+
+/**
+ * @brief Put elements between strided buffers, in one call if we can
+ */
+static void put_elems(void *to, ptrdiff_t tst, const void *from,
+                      ptrdiff_t fst, size_t elem_size, size_t n, int pe) {
+  size_t i;
+
+  if ((tst == 1) && (fst == 1)) {
+    shmem_putmem_nbi(to, from, n * elem_size, pe);
+    return;
+    /* NOT REACHED */
+  }
+
+  switch (elem_size) {
+  case 1:
+    shmem_iput8(to, from, tst, fst, n, pe);
+    break;
+  case 2:
+    shmem_iput16(to, from, tst, fst, n, pe);
+    break;
+  case 4:
+    shmem_iput32(to, from, tst, fst, n, pe);
+    break;
+  case 8:
+    shmem_iput64(to, from, tst, fst, n, pe);
+    break;
+  case 16:
+    shmem_iput128(to, from, tst, fst, n, pe);
+    break;
+  default:
+    for (i = 0; i < n; ++i) {
+      shmem_putmem_nbi(elem_at(to, tst, elem_size, i),
+                       elem_at(from, fst, elem_size, i), elem_size, pe);
+    }
+    break;
+  }
+}
+
+/**
+ * @brief Get elements between strided buffers, in one call if we can
+ */
+static void get_elems(void *to, ptrdiff_t tst, const void *from,
+                      ptrdiff_t fst, size_t elem_size, size_t n, int pe) {
+  size_t i;
+
+  if ((tst == 1) && (fst == 1)) {
+    shmem_getmem(to, from, n * elem_size, pe);
+    return;
+    /* NOT REACHED */
+  }
+
+  switch (elem_size) {
+  case 1:
+    shmem_iget8(to, from, tst, fst, n, pe);
+    break;
+  case 2:
+    shmem_iget16(to, from, tst, fst, n, pe);
+    break;
+  case 4:
+    shmem_iget32(to, from, tst, fst, n, pe);
+    break;
+  case 8:
+    shmem_iget64(to, from, tst, fst, n, pe);
+    break;
+  case 16:
+    shmem_iget128(to, from, tst, fst, n, pe);
+    break;
+  default:
+    for (i = 0; i < n; ++i) {
+      shmem_getmem(elem_at(to, tst, elem_size, i),
+                   elem_at(from, fst, elem_size, i), elem_size, pe);
+    }
+    break;
+  }
+}
+
+/**
+ * @brief Are a node's PEs consecutive in the active set?
+ */
+inline static int node_is_run(const pe_hierarchy_t *hp, int node) {
+  const int *mp = hp->members + hp->node_start[node];
+  int q;
+
+  for (q = 1; q < hp->ppn; ++q) {
+    if (mp[q] != mp[0] + q) {
+      return 0;
+      /* NOT REACHED */
+    }
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Swap one of my dest blocks with one of another PE on my node
+ */
+static void swap_block(const exchange_blocks_t *bp, int mine, int theirs,
+                       int pe, char *tmp) {
+  const size_t es = bp->elem_size;
+  char *mp = elem_at(bp->dest, bp->dst, es, mine * bp->nelems);
+  char *tp = elem_at(bp->dest, bp->dst, es, theirs * bp->nelems);
+  char *pp = (char *)shmem_ptr(tp, pe);
+
+  copy_elems(tmp, 1, mp, bp->dst, es, bp->nelems);
+
+  if (pp != NULL) {
+    copy_elems(mp, bp->dst, pp, bp->dst, es, bp->nelems);
+    copy_elems(pp, bp->dst, tmp, 1, es, bp->nelems);
+  } else {
+    get_elems(mp, bp->dst, tp, bp->dst, es, bp->nelems, pe);
+    put_elems(tp, bp->dst, tmp, 1, es, bp->nelems, pe);
+    shmem_quiet();
+  }
+}
+
+/*
+ * Write (n, i) for the i-th PE on node n, and say I am (a, r).
+ *
+ * The block I have for (b, q) goes to (b, r), which stages it as its
+ * dest block (a, q): one message to each other node, and a copy for my
+ * own.  Then (b, r) and (b, q) swap their blocks (a, q) and (a, r),
+ * which puts the block at (b, q)'s block (a, r), where it belongs.
+ */
+int exchange_node_aggregated(const exchange_blocks_t *bp, int PE_start,
+                             int logPE_stride, int PE_size, long *pSync) {
+  const int stride = 1 << logPE_stride;
+  const pe_hierarchy_t *hp = get_pe_hierarchy(PE_start, stride, PE_size);
+  const size_t nelems = bp->nelems;
+  const size_t es = bp->elem_size;
+  const int ppn = hp->ppn;
+  const int nnodes = hp->nleaders;
+  const int me_node = hp->me_leader;
+  const int me_local = hp->me_local;
+  const int *mine = hp->local;
+  const int mine_run = node_is_run(hp, me_node);
+  int i;
+  int q;
+
+  if (ppn == 0) {
+    return -1;
+    /* NOT REACHED */
+  }
+
+  if ((nelems == 0) || (es == 0)) {
+    return 0;
+    /* NOT REACHED */
+  }
+
+  for (i = 1; i < nnodes; ++i) {
+    const int node = (me_node + i) % nnodes;
+    const int *theirs = hp->members + hp->node_start[node];
+    const int pe = pe_hierarchy_pe(hp, theirs[me_local]);
+
+    if (mine_run && node_is_run(hp, node)) {
+      put_elems(elem_at(bp->dest, bp->dst, es, mine[0] * nelems), bp->dst,
+                elem_at(bp->source, bp->sst, es, theirs[0] * nelems),
+                bp->sst, es, ppn * nelems, pe);
+    } else {
+      for (q = 0; q < ppn; ++q) {
+        put_elems(elem_at(bp->dest, bp->dst, es, mine[q] * nelems), bp->dst,
+                  elem_at(bp->source, bp->sst, es, theirs[q] * nelems),
+                  bp->sst, es, nelems, pe);
+      }
+    }
+  }
+
+  for (q = 0; q < ppn; ++q) {
+    copy_elems(elem_at(bp->dest, bp->dst, es, mine[q] * nelems), bp->dst,
+               elem_at(bp->source, bp->sst, es, mine[q] * nelems), bp->sst,
+               es, nelems);
+  }
+
+  if (nnodes > 1) {
+    shmem_fence();
+
+    for (i = 1; i < nnodes; ++i) {
+      const int node = (me_node + i) % nnodes;
+      const int *theirs = hp->members + hp->node_start[node];
+
+      shmem_long_atomic_inc(pSync + AGGR_COUNT,
+                            pe_hierarchy_pe(hp, theirs[me_local]));
+    }
+
+    shmem_long_wait_until(pSync + AGGR_COUNT, SHMEM_CMP_EQ,
+                          SHCOLL_SYNC_VALUE + nnodes - 1);
+    shmem_long_p(pSync + AGGR_COUNT, SHCOLL_SYNC_VALUE, shmem_my_pe());
+  }
+
+  if (ppn > 1) {
+    long *node_sync = pSync + AGGR_NODE;
+    char *tmp;
+
+    /* wait for everyone on my node to have their blocks staged */
+    if (me_local == 0) {
+      node_wait_check_ins(hp, node_sync);
+      node_release(hp, node_sync);
+    } else {
+      node_check_in(hp, node_sync);
+      node_wait_release(node_sync);
+    }
+
+    /* each pair of PEs swaps once, done by the one placed first */
+    tmp = (char *)exchange_alloc(nelems * es);
+    for (q = me_local + 1; q < ppn; ++q) {
+      const int pe = pe_hierarchy_pe(hp, mine[q]);
+
+      for (i = 0; i < nnodes; ++i) {
+        const int *np = hp->members + hp->node_start[i];
+
+        swap_block(bp, np[q], np[me_local], pe, tmp);
+      }
+    }
+    free(tmp);
+  }
+
+  /* nobody may stage the next exchange here before this one is done */
+  shcoll_barrier_hierarchical(PE_start, logPE_stride, PE_size,
+                              pSync + AGGR_BARRIER);
+
+  return 0;
+}
+
+/*
+ * Work holds my blocks rotated so that block i is the one for the PE i
+ * places after me.  In round k each PE sends on all the blocks whose
+ * index has bit k set to the PE 2^k places after it, so at the end block
+ * i is the one from the PE i places before me.
+ *
+ * Blocks arrive in dest, alternating between its two halves from round
+ * to round; a PE waits to be told a half is free again before writing to
+ * it.
+ */
+void exchange_bruck(const exchange_blocks_t *bp, int PE_start,
+                    int logPE_stride, int PE_size, long *pSync) {
+  const int stride = 1 << logPE_stride;
+  const int me = shmem_my_pe();
+  const int me_as = (me - PE_start) / stride;
+  const size_t nelems = bp->nelems;
+  const size_t es = bp->elem_size;
+  const size_t bsize = nelems * es;
+  const int half = PE_size / 2;
+  char *work;
+  char *sendbuf;
+  int nrounds;
+  int round;
+  int distance;
+  int i;
+  int n;
+
+  if (bsize == 0) {
+    return;
+    /* NOT REACHED */
+  }
+
+  nrounds = 0;
+  while ((1L << nrounds) < PE_size) {
+    ++nrounds;
+  }
+
+  work = (char *)exchange_alloc(PE_size * bsize);
+  sendbuf = (half > 0) ? (char *)exchange_alloc(half * bsize) : NULL;
+
+  for (i = 0; i < PE_size; ++i) {
+    copy_elems(work + i * bsize, 1,
+               elem_at(bp->source, bp->sst, es,
+                       ((me_as + i) % PE_size) * nelems),
+               bp->sst, es, nelems);
+  }
+
+  for (round = 0, distance = 1; round < nrounds;
+       ++round, distance <<= 1) {
+    const int to = PE_start + ((me_as + distance) % PE_size) * stride;
+    const size_t area = (round % 2) * half * nelems;
+
+    /* the half I write to was last used 2 rounds ago */
+    if (round >= 2) {
+      shmem_long_wait_until(pSync + BRUCK_ACK + round, SHMEM_CMP_NE,
+                            SHCOLL_SYNC_VALUE);
+      shmem_long_p(pSync + BRUCK_ACK + round, SHCOLL_SYNC_VALUE, me);
+    }
+
+    n = 0;
+    for (i = distance; i < PE_size; ++i) {
+      if (i & distance) {
+        memcpy(sendbuf + n * bsize, work + i * bsize, bsize);
+        ++n;
+      }
+    }
+
+    put_elems(elem_at(bp->dest, bp->dst, es, area), bp->dst, sendbuf, 1, es,
+              n * nelems, to);
+    shmem_quiet();
+    shmem_long_atomic_set(pSync + BRUCK_DATA + round, SHCOLL_SYNC_VALUE + 1,
+                          to);
+
+    shmem_long_wait_until(pSync + BRUCK_DATA + round, SHMEM_CMP_NE,
+                          SHCOLL_SYNC_VALUE);
+    shmem_long_p(pSync + BRUCK_DATA + round, SHCOLL_SYNC_VALUE, me);
+
+    n = 0;
+    for (i = distance; i < PE_size; ++i) {
+      if (i & distance) {
+        copy_elems(work + i * bsize, 1,
+                   elem_at(bp->dest, bp->dst, es, area + n * nelems), bp->dst,
+                   es, nelems);
+        ++n;
+      }
+    }
+
+    /* tell whoever writes this half in the round after next it's free */
+    if (round + 2 < nrounds) {
+      const int from_as = (me_as - (distance << 2) + PE_size) % PE_size;
+
+      shmem_long_atomic_set(pSync + BRUCK_ACK + round + 2,
+                            SHCOLL_SYNC_VALUE + 1,
+                            PE_start + from_as * stride);
+    }
+  }
+
+  for (i = 0; i < PE_size; ++i) {
+    copy_elems(elem_at(bp->dest, bp->dst, es,
+                       ((me_as - i + PE_size) % PE_size) * nelems),
+               bp->dst, work + i * bsize, 1, es, nelems);
+  }
+
+  /*
+   * The next exchange writes its first two rounds without waiting, so
+   * don't leave until the PEs I send those to are done with this one.
+   */
+  for (round = 0, distance = 1; (round < nrounds) && (round < 2);
+       ++round, distance <<= 1) {
+    const int from_as = (me_as - distance + PE_size) % PE_size;
+
+    shmem_long_atomic_set(pSync + BRUCK_ACK + round, SHCOLL_SYNC_VALUE + 1,
+                          PE_start + from_as * stride);
+  }
+  for (round = 0; (round < nrounds) && (round < 2); ++round) {
+    shmem_long_wait_until(pSync + BRUCK_ACK + round, SHMEM_CMP_NE,
+                          SHCOLL_SYNC_VALUE);
+    shmem_long_p(pSync + BRUCK_ACK + round, SHCOLL_SYNC_VALUE, me);
+  }
+
+  free(sendbuf);
+  free(work);
+}
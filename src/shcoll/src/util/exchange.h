@@ -0,0 +1,63 @@
+/**
+ * @file exchange.h
+ * @brief Block exchange kernels shared by alltoall and alltoalls
+ *
+ * Each PE sends one block to every PE of the active set; a block is
+ * nelems elements that may be strided.  Contiguous alltoall passes one
+ * element per block, as big as the whole block, with unit strides.
+ */
+
+#ifndef SHCOLL_EXCHANGE_H
+#define SHCOLL_EXCHANGE_H
+
+#include <stddef.h>
+
+/**
+ * @brief The buffers of an exchange and how blocks are laid out in them
+ *
+ * Element t of block k is element (k * nelems + t) of the buffer.
+ */
+typedef struct exchange_blocks {
+  void *dest;         /**< symmetric destination */
+  const void *source; /**< symmetric source */
+  ptrdiff_t dst;      /**< element stride in dest */
+  ptrdiff_t sst;      /**< element stride in source */
+  size_t elem_size;   /**< bytes per element */
+  size_t nelems;      /**< elements per block */
+} exchange_blocks_t;
+
+/**
+ * @brief Exchange blocks one node at a time
+ *
+ * The i-th PE on a node sends the i-th PE on every other node all the
+ * blocks for that node at once, staging them in dest, then PEs on each
+ * node swap the staged blocks into place through shared memory.  This
+ * cuts the messages between nodes by the number of PEs per node.
+ *
+ * @param bp The buffers
+ * @param PE_start First PE in the active set
+ * @param logPE_stride Log2 of stride between PEs
+ * @param PE_size Number of PEs in the active set
+ * @param pSync Symmetric work array (SHCOLL_ALLTOALL_SYNC_SIZE)
+ * @return 0 if done, -1 if nodes have different numbers of PEs (and
+ *         nothing has been done)
+ */
+int exchange_node_aggregated(const exchange_blocks_t *bp, int PE_start,
+                             int logPE_stride, int PE_size, long *pSync);
+
+/**
+ * @brief Exchange blocks with Bruck's algorithm
+ *
+ * ceil(log2(PE_size)) rounds of one message each, at the cost of moving
+ * about half the blocks in every round: good for small blocks.
+ *
+ * @param bp The buffers
+ * @param PE_start First PE in the active set
+ * @param logPE_stride Log2 of stride between PEs
+ * @param PE_size Number of PEs in the active set
+ * @param pSync Symmetric work array (SHCOLL_ALLTOALL_SYNC_SIZE)
+ */
+void exchange_bruck(const exchange_blocks_t *bp, int PE_start,
+                    int logPE_stride, int PE_size, long *pSync);
+
+#endif /* ! SHCOLL_EXCHANGE_H */
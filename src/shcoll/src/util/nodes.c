@@ -0,0 +1,201 @@
+/**
+ * @file nodes.c
+ * @brief Work out and cache the node layout of active sets
+ */
+
+#include "nodes.h"
+#include "shmemu.h"
+#include "shmemc.h"
+
+#include <shmem.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/*
+ * Layouts never change once made, so readers walk the list without a
+ * lock; new ones are pushed on the front under the lock.
+ */
+static pe_hierarchy_t *hierarchies = NULL;
+static pthread_mutex_t hierarchies_lock = PTHREAD_MUTEX_INITIALIZER;
+
+inline static int *alloc_ints(size_t n) {
+  int *ip = (int *)malloc(n * sizeof(*ip));
+
+  shmemu_assert(ip != NULL, "shcoll: can't allocate memory for node layout");
+
+  return ip;
+}
+
+inline static int compare_ints(const void *a, const void *b) {
+  const int ia = *(const int *)a;
+  const int ib = *(const int *)b;
+
+  return (ia > ib) - (ia < ib);
+}
+
+/*
+ * Launchers don't have to number nodes 0, 1, 2...  Renumber the nodes
+ * of the active set that way, by rank of their ids.  Every PE sees the
+ * same ids, so agrees on the numbering.  Returns the number of nodes.
+ */
+static int renumber_nodes(int *nodes, int PE_size) {
+  int *ids = alloc_ints(PE_size);
+  int nids = 0;
+  int i;
+
+  memcpy(ids, nodes, PE_size * sizeof(*ids));
+  qsort(ids, PE_size, sizeof(*ids), compare_ints);
+
+  for (i = 0; i < PE_size; ++i) {
+    if ((nids == 0) || (ids[i] != ids[nids - 1])) {
+      ids[nids++] = ids[i];
+    }
+  }
+
+  for (i = 0; i < PE_size; ++i) {
+    const int *ip = (const int *)bsearch(&nodes[i], ids, nids, sizeof(*ids),
+                                         compare_ints);
+
+    nodes[i] = (int)(ip - ids);
+  }
+
+  free(ids);
+
+  return nids;
+}
+
+inline static pe_hierarchy_t *find_hierarchy(int PE_start, int stride,
+                                             int PE_size) {
+  pe_hierarchy_t *hp = __atomic_load_n(&hierarchies, __ATOMIC_ACQUIRE);
+
+  while (hp != NULL) {
+    if ((hp->PE_start == PE_start) && (hp->stride == stride) &&
+        (hp->PE_size == PE_size)) {
+      return hp;
+      /* NOT REACHED */
+    }
+    hp = hp->next;
+  }
+
+  return NULL;
+}
+
+/*
+ * If any PE's node is unknown, give every PE a node of its own so that
+ * all PEs agree on the layout.
+ */
+static pe_hierarchy_t *build_hierarchy(int PE_start, int stride,
+                                       int PE_size) {
+  const int me_as = (shmem_my_pe() - PE_start) / stride;
+  pe_hierarchy_t *hp = (pe_hierarchy_t *)malloc(sizeof(*hp));
+  int *nodes = alloc_ints(PE_size);
+  int *first = NULL;
+  int maxnode = -1;
+  int i;
+
+  shmemu_assert(hp != NULL, "shcoll: can't allocate memory for node layout");
+
+  for (i = 0; i < PE_size; ++i) {
+    nodes[i] = shmemc_pe_node(PE_start + i * stride);
+    if (nodes[i] < 0) {
+      break;
+    }
+  }
+
+  if (i == PE_size) {
+    maxnode = renumber_nodes(nodes, PE_size) - 1;
+  } else {
+    for (i = 0; i < PE_size; ++i) {
+      nodes[i] = i;
+    }
+    maxnode = PE_size - 1;
+  }
+
+  hp->PE_start = PE_start;
+  hp->stride = stride;
+  hp->PE_size = PE_size;
+  hp->leaders = alloc_ints(PE_size);
+  hp->node_index = alloc_ints(PE_size);
+  hp->nleaders = 0;
+
+  /* leader is the first PE seen on each node */
+  first = alloc_ints(maxnode + 1);
+  for (i = 0; i <= maxnode; ++i) {
+    first[i] = -1;
+  }
+  for (i = 0; i < PE_size; ++i) {
+    if (first[nodes[i]] < 0) {
+      first[nodes[i]] = hp->nleaders;
+      hp->leaders[hp->nleaders++] = i;
+    }
+    hp->node_index[i] = first[nodes[i]];
+  }
+  hp->me_leader = hp->node_index[me_as];
+
+  /* group the PEs by node, keeping them in order within each node */
+  hp->node_start = alloc_ints(hp->nleaders + 1);
+  for (i = 0; i <= hp->nleaders; ++i) {
+    hp->node_start[i] = 0;
+  }
+  for (i = 0; i < PE_size; ++i) {
+    ++hp->node_start[hp->node_index[i] + 1];
+  }
+  hp->ppn = hp->node_start[1];
+  for (i = 0; i < hp->nleaders; ++i) {
+    if (hp->node_start[i + 1] != hp->ppn) {
+      hp->ppn = 0;
+    }
+    hp->node_start[i + 1] += hp->node_start[i];
+  }
+
+  /* first[] now counts the PEs placed on each node so far */
+  hp->members = alloc_ints(PE_size);
+  for (i = 0; i <= maxnode; ++i) {
+    first[i] = 0;
+  }
+  for (i = 0; i < PE_size; ++i) {
+    const int n = hp->node_index[i];
+
+    hp->members[hp->node_start[n] + first[n]++] = i;
+  }
+
+  hp->local = hp->members + hp->node_start[hp->me_leader];
+  hp->nlocal = hp->node_start[hp->me_leader + 1] -
+               hp->node_start[hp->me_leader];
+  for (i = 0; i < hp->nlocal; ++i) {
+    if (hp->local[i] == me_as) {
+      hp->me_local = i;
+    }
+  }
+
+  free(first);
+  free(nodes);
+
+  return hp;
+}
+
+const pe_hierarchy_t *get_pe_hierarchy(int PE_start, int stride,
+                                       int PE_size) {
+  pe_hierarchy_t *hp = find_hierarchy(PE_start, stride, PE_size);
+
+  if (shmemu_likely(hp != NULL)) {
+    return hp;
+    /* NOT REACHED */
+  }
+
+  pthread_mutex_lock(&hierarchies_lock);
+
+  /* another thread may have got here first */
+  hp = find_hierarchy(PE_start, stride, PE_size);
+  if (hp == NULL) {
+    hp = build_hierarchy(PE_start, stride, PE_size);
+    hp->next = hierarchies;
+    __atomic_store_n(&hierarchies, hp, __ATOMIC_RELEASE);
+  }
+
+  pthread_mutex_unlock(&hierarchies_lock);
+
+  return hp;
+}
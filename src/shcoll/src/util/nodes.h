@@ -0,0 +1,136 @@
+/**
+ * @file nodes.h
+ * @brief How the PEs of an active set are spread over nodes
+ *
+ * Hierarchical collectives work on-node through shared memory and only
+ * send between nodes from one PE per node, the node leader.  The
+ * leader is the first PE of the active set on that node.
+ */
+
+#ifndef SHCOLL_NODES_H
+#define SHCOLL_NODES_H
+
+#include "../shcoll.h"
+
+#include <shmem.h>
+
+/**
+ * @brief Node layout of an active set, as seen by this PE
+ *
+ * PEs are given by their index in the active set.  If the launcher
+ * can't tell us where PEs are, every PE is treated as being on a node
+ * of its own.
+ */
+typedef struct pe_hierarchy {
+  int PE_start;    /**< first PE of the active set */
+  int stride;      /**< stride between PEs */
+  int PE_size;     /**< PEs in the active set */
+  int nlocal;      /**< PEs on my node, including me */
+  int *local;      /**< their indices, in order: local[0] is leader */
+  int me_local;    /**< my position in local */
+  int nleaders;    /**< nodes spanned by the active set */
+  int *leaders;    /**< index of each node's leader, in order */
+  int me_leader;   /**< my node's position in leaders */
+  int *node_index; /**< position in leaders of each PE's node */
+  int *members;    /**< all indices, grouped by node in leaders order */
+  int *node_start; /**< where each node starts in members (nleaders + 1) */
+  int ppn;         /**< PEs per node if the same on every node, else 0 */
+  struct pe_hierarchy *next;
+} pe_hierarchy_t;
+
+/**
+ * @brief Get the node layout of an active set
+ *
+ * Worked out on first use and kept for the life of the program, so
+ * later calls are cheap.  The calling PE must be in the active set.
+ *
+ * @param PE_start First PE in the active set
+ * @param stride Stride between PEs
+ * @param PE_size Number of PEs in the active set
+ * @return the layout
+ */
+const pe_hierarchy_t *get_pe_hierarchy(int PE_start, int stride, int PE_size);
+
+/**
+ * @brief PE number of an active set index
+ */
+inline static int pe_hierarchy_pe(const pe_hierarchy_t *hp, int idx) {
+  return hp->PE_start + idx * hp->stride;
+}
+
+/*
+ * On-node signalling.  A single pSync element counts check-ins on the
+ * leader and is the release flag on the other PEs.
+ *
+ * Every update to these words, including resetting them, goes through
+ * OpenSHMEM atomics.  The library already uses CPU atomics for them
+ * where the transport allows, and then it does so for every PE
+ * updating the word.  Mixing our own CPU atomics with network AMOs
+ * from PEs that couldn't map the word wouldn't be atomic.
+ */
+
+/**
+ * @brief Set an on-node flag
+ *
+ * @param flag Symmetric flag
+ * @param value Value to store
+ * @param pe PE owning the flag
+ */
+inline static void node_flag_set(long *flag, long value, int pe) {
+  /* what we wrote before has to be seen first */
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  shmem_long_atomic_set(flag, value, pe);
+}
+
+/**
+ * @brief Bump an on-node counter
+ *
+ * @param counter Symmetric counter
+ * @param pe PE owning the counter
+ */
+inline static void node_counter_inc(long *counter, int pe) {
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  shmem_long_atomic_inc(counter, pe);
+}
+
+/**
+ * @brief Non-leader: tell my node leader I've got here
+ */
+inline static void node_check_in(const pe_hierarchy_t *hp, long *sync) {
+  node_counter_inc(sync, pe_hierarchy_pe(hp, hp->local[0]));
+}
+
+/**
+ * @brief Leader: wait for everyone else on my node to check in
+ */
+inline static void node_wait_check_ins(const pe_hierarchy_t *hp, long *sync) {
+  if (hp->nlocal > 1) {
+    shmem_long_wait_until(sync, SHMEM_CMP_EQ,
+                          SHCOLL_SYNC_VALUE + hp->nlocal - 1);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    shmem_long_atomic_set(sync, SHCOLL_SYNC_VALUE, shmem_my_pe());
+  }
+}
+
+/**
+ * @brief Leader: let everyone else on my node go
+ */
+inline static void node_release(const pe_hierarchy_t *hp, long *sync) {
+  int i;
+
+  for (i = 1; i < hp->nlocal; ++i) {
+    node_flag_set(sync, SHCOLL_SYNC_VALUE + 1,
+                  pe_hierarchy_pe(hp, hp->local[i]));
+  }
+}
+
+/**
+ * @brief Non-leader: wait for my node leader to let me go
+ */
+inline static void node_wait_release(long *sync) {
+  shmem_long_wait_until(sync, SHMEM_CMP_NE, SHCOLL_SYNC_VALUE);
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  shmem_long_atomic_set(sync, SHCOLL_SYNC_VALUE, shmem_my_pe());
+}
+
+#endif /* ! SHCOLL_NODES_H */
@@ -185,6 +185,9 @@ inline static void context_set_options(long options, shmemc_context_h ch) {
   ch->attr.serialized = options & SHMEM_CTX_SERIALIZED;
   ch->attr.privat = options & SHMEM_CTX_PRIVATE;
   ch->attr.nostore = options & SHMEM_CTX_NOSTORE;
+
+  ch->wait.spin_ns = proc.env.wait_spin_ns;
+  ch->wait.block_ns = proc.env.wait_block_ns;
 }
 
 /**
@@ -16,6 +16,7 @@
 #include "shmemc.h"
 #include "boolean.h"
 #include "collectives/defaults.h"
+#include "ucx/api.h"
 #include "module.h"
 
 #include <stdio.h>
@@ -23,12 +24,20 @@
 #include <ctype.h>
 #include <string.h>
 #include <strings.h>
+#include <unistd.h>
 
 /**
  * @brief Buffer size for string formatting
  */
 #define BUFSIZE 16
 
+/**
+ * @brief UCX transports that never do NIC atomics (the last two don't
+ * do atomics at all), so on-node AMOs over endpoints using only these
+ * can use CPU atomics directly
+ */
+#define DEFAULT_CPU_AMO_TLS "posix,sysv,xpmem,cma,knem"
+
 /**
  * @brief Test if an environment variable option is enabled
  *
@@ -311,6 +320,25 @@ void shmemc_env_init(void) {
   proc.env.coll.prod_reduce =
       strdup((e != NULL) ? e : COLLECTIVES_DEFAULT_PROD_REDUCE);
 
+  /* Per-call algorithm selection */
+  proc.env.coll_rules = NULL;
+  proc.env.coll_rules_file = NULL;
+
+  CHECK_ENV(e, COLL_RULES);
+  if (e != NULL) {
+    proc.env.coll_rules = strdup(e); /* free@end */
+  }
+  CHECK_ENV(e, COLL_RULES_FILE);
+  if (e != NULL) {
+    proc.env.coll_rules_file = strdup(e); /* free@end */
+  }
+#ifdef SHMEM_COLL_RULES_DEFAULT_FILE
+  else if (access(SHMEM_COLL_RULES_DEFAULT_FILE, R_OK) == 0) {
+    /* osh_tune output installed for everyone */
+    proc.env.coll_rules_file = strdup(SHMEM_COLL_RULES_DEFAULT_FILE);
+  }
+#endif /* SHMEM_COLL_RULES_DEFAULT_FILE */
+
   proc.env.progress_threads = NULL;
 
   CHECK_ENV(e, PROGRESS_THREADS);
@@ -329,6 +357,56 @@ void shmemc_env_init(void) {
                        "progress delay time \"%s\"",
                 e != NULL ? e : delay);
 
+  proc.env.progress_events = false;
+
+  CHECK_ENV(e, PROGRESS_MODE);
+  if (e != NULL) {
+    if (strncasecmp(e, "event", 5) == 0) {
+      proc.env.progress_events = true;
+    } else if (strncasecmp(e, "poll", 4) != 0) {
+      shmemu_warn(MODULE ": unknown progress mode \"%s\", using \"poll\"", e);
+    }
+  }
+
+  proc.env.progress_spin = 100; /* magic number */
+
+  CHECK_ENV(e, PROGRESS_SPIN);
+  if (e != NULL) {
+    long n = strtol(e, NULL, 10);
+
+    if (n >= 0) {
+      proc.env.progress_spin = (size_t)n;
+    }
+  }
+
+  CHECK_ENV(e, WAIT_SPIN);
+  if (e == NULL) {
+    e = "1000"; /* magic number */
+  }
+
+  r = shmemu_parse_duration(e, &proc.env.wait_spin_ns);
+  shmemu_assert(r == 0,
+                MODULE ": couldn't work out requested "
+                       "wait spin time \"%s\"",
+                e);
+
+  CHECK_ENV(e, WAIT_BLOCK);
+  if (e == NULL) {
+    e = "0"; /* never */
+  }
+
+  r = shmemu_parse_duration(e, &proc.env.wait_block_ns);
+  shmemu_assert(r == 0,
+                MODULE ": couldn't work out requested "
+                       "wait blocking time \"%s\"",
+                e);
+
+  /* sleep only after spinning */
+  if ((proc.env.wait_block_ns > 0) &&
+      (proc.env.wait_block_ns < proc.env.wait_spin_ns)) {
+    proc.env.wait_block_ns = proc.env.wait_spin_ns;
+  }
+
   proc.env.prealloc_contexts = 64; /* magic number */
 
   CHECK_ENV(e, PREALLOC_CTXS);
@@ -347,6 +425,119 @@ void shmemc_env_init(void) {
   if (e != NULL) {
     proc.env.memfatal = option_enabled_test(e);
   }
+
+  proc.env.lazy_connect = false;
+  proc.env.connect_warmup = NULL;
+
+  CHECK_ENV(e, LAZY_CONNECT);
+  if (e != NULL) {
+    proc.env.lazy_connect = option_enabled_test(e);
+  }
+  CHECK_ENV(e, CONNECT_WARMUP);
+  if (e != NULL) {
+    proc.env.connect_warmup = strdup(e); /* free@end */
+  }
+
+  proc.env.nbi_amo_depth = 1024; /* magic number */
+
+  CHECK_ENV(e, NBI_AMO_DEPTH);
+  if (e != NULL) {
+    long n = strtol(e, NULL, 10);
+
+    if (n > 0) {
+      proc.env.nbi_amo_depth = (size_t)n;
+    }
+  }
+
+  proc.env.agg_put_max = 0;
+
+  CHECK_ENV(e, AGGREGATE_PUT_MAX);
+  if (e != NULL) {
+    r = shmemu_parse_size(e, &proc.env.agg_put_max);
+    shmemu_assert(r == 0,
+                  MODULE ": couldn't work out requested "
+                         "put aggregation size \"%s\"",
+                  e);
+  }
+#ifndef HAVE_UCP_AM_SEND_NBX
+  if (proc.env.agg_put_max > 0) {
+    shmemu_warn(MODULE ": put aggregation needs UCX active messages, "
+                       "turning it off");
+    proc.env.agg_put_max = 0;
+  }
+#endif /* ! HAVE_UCP_AM_SEND_NBX */
+
+  CHECK_ENV(e, AGGREGATE_BATCH);
+  if (e == NULL) {
+    e = "8k"; /* magic number */
+  }
+
+  r = shmemu_parse_size(e, &proc.env.agg_batch);
+  shmemu_assert(r == 0,
+                MODULE ": couldn't work out requested "
+                       "put aggregation batch size \"%s\"",
+                e);
+
+  /* a batch has to hold at least one put (header and padding too) */
+  if (proc.env.agg_batch < shmemc_ucx_agg_rec_size(proc.env.agg_put_max)) {
+    proc.env.agg_batch = shmemc_ucx_agg_rec_size(proc.env.agg_put_max);
+  }
+
+  proc.env.active_messages = false;
+
+  CHECK_ENV(e, ACTIVE_MESSAGES);
+  if (e != NULL) {
+    proc.env.active_messages = option_enabled_test(e);
+  }
+#ifndef HAVE_UCP_AM_SEND_NBX
+  if (proc.env.active_messages) {
+    shmemu_warn(MODULE ": active messages not supported by this UCX, "
+                       "turning them off");
+    proc.env.active_messages = false;
+  }
+#endif /* ! HAVE_UCP_AM_SEND_NBX */
+
+  proc.env.stripe_lanes = 0;
+
+  CHECK_ENV(e, STRIPE_LANES);
+  if (e != NULL) {
+    long n = strtol(e, NULL, 10);
+
+    if (n > 0) {
+      proc.env.stripe_lanes = (size_t)n;
+    }
+  }
+
+  CHECK_ENV(e, STRIPE_THRESHOLD);
+  if (e == NULL) {
+    e = "1M"; /* magic number */
+  }
+
+  r = shmemu_parse_size(e, &proc.env.stripe_threshold);
+  shmemu_assert(r == 0,
+                MODULE ": couldn't work out requested "
+                       "striping threshold \"%s\"",
+                e);
+
+  /* need something to split */
+  if (proc.env.stripe_threshold < proc.env.stripe_lanes) {
+    proc.env.stripe_threshold = proc.env.stripe_lanes;
+  }
+
+  CHECK_ENV(e, STRIDED_PACK_MIN);
+  if (e == NULL) {
+    e = "16"; /* magic number */
+  }
+
+  r = shmemu_parse_size(e, &proc.env.strided_pack_min);
+  shmemu_assert(r == 0,
+                MODULE ": couldn't work out requested "
+                       "strided packing threshold \"%s\"",
+                e);
+
+  CHECK_ENV(e, CPU_AMO_TLS);
+  proc.env.cpu_amo_tls =
+      strdup(e != NULL ? e : DEFAULT_CPU_AMO_TLS); /* free@end */
 }
 
 #undef CHECK_ENV
@@ -390,6 +581,8 @@ void shmemc_env_finalize(void) {
   free(proc.env.coll.barrier);
 
   free(proc.env.progress_threads);
+  free(proc.env.connect_warmup);
+  free(proc.env.cpu_amo_tls);
 
   /* Free reduction operation fields */
   free(proc.env.coll.and_to_all);
@@ -407,6 +600,9 @@ void shmemc_env_finalize(void) {
   free(proc.env.coll.min_reduce);
   free(proc.env.coll.sum_reduce);
   free(proc.env.coll.prod_reduce);
+
+  free(proc.env.coll_rules);
+  free(proc.env.coll_rules_file);
 }
 
 /**
@@ -543,6 +739,14 @@ void shmemc_print_env_vars(FILE *stream, const char *prefix) {
   DESCRIBE_COLLECTIVE(sum_reduce, SUM_REDUCE);
   DESCRIBE_COLLECTIVE(prod_reduce, PROD_REDUCE);
 
+  fprintf(stream, "%s%-*s %-*s %s\n", prefix, var_width, "SHMEM_COLL_RULES",
+          val_width, proc.env.coll_rules ? "..." : "unset",
+          "per-call collective algorithm rules");
+  fprintf(stream, "%s%-*s %-*s %s\n", prefix, var_width,
+          "SHMEM_COLL_RULES_FILE", val_width,
+          proc.env.coll_rules_file ? proc.env.coll_rules_file : "unset",
+          "file with more collective algorithm rules");
+
   fprintf(stream, "%s%-*s %-*s %s\n", prefix, var_width,
           "SHMEM_PROGRESS_THREADS", val_width,
           proc.env.progress_threads ? proc.env.progress_threads : "none",
@@ -554,12 +758,89 @@ void shmemc_print_env_vars(FILE *stream, const char *prefix) {
     fprintf(stream, " [not used]");
   }
   fprintf(stream, "\n");
+  fprintf(stream, "%s%-*s %-*s %s", prefix, var_width, "SHMEM_PROGRESS_MODE",
+          val_width, proc.env.progress_events ? "event" : "poll",
+          "progress thread polls, or sleeps on events");
+  if (proc.env.progress_threads == NULL) {
+    fprintf(stream, " [not used]");
+  }
+  fprintf(stream, "\n");
+  fprintf(stream, "%s%-*s %-*lu %s", prefix, var_width, "SHMEM_PROGRESS_SPIN",
+          val_width, (unsigned long)proc.env.progress_spin,
+          "idle polls before progress thread sleeps");
+  if ((proc.env.progress_threads == NULL) || !proc.env.progress_events) {
+    fprintf(stream, " [not used]");
+  }
+  fprintf(stream, "\n");
+  {
+    char buf[BUFSIZE];
+
+    snprintf(buf, BUFSIZE, "%luns", (unsigned long)proc.env.wait_spin_ns);
+    fprintf(stream, "%s%-*s %-*s %s\n", prefix, var_width, "SHMEM_WAIT_SPIN",
+            val_width, buf, "waits poll this long first");
+    snprintf(buf, BUFSIZE, "%luns", (unsigned long)proc.env.wait_block_ns);
+    fprintf(stream, "%s%-*s %-*s %s", prefix, var_width, "SHMEM_WAIT_BLOCK",
+            val_width, buf, "waits sleep on events after this long");
+  }
+  if (proc.env.wait_block_ns == 0) {
+    fprintf(stream, " [not used]");
+  }
+  fprintf(stream, "\n");
   fprintf(stream, "%s%-*s %-*lu %s\n", prefix, var_width, "SHMEM_PREALLOC_CTXS",
           val_width, (unsigned long)proc.env.prealloc_contexts,
           "pre-allocate contexts at startup");
   fprintf(stream, "%s%-*s %-*s %s\n", prefix, var_width, "SHMEM_MEMERR_FATAL",
           val_width, proc.env.memfatal ? "yes" : "no",
           "abort if symmetric memory corruption");
+  fprintf(stream, "%s%-*s %-*s %s\n", prefix, var_width, "SHMEM_LAZY_CONNECT",
+          val_width, shmemu_human_option(proc.env.lazy_connect),
+          "connect to PEs on first communication");
+  fprintf(stream, "%s%-*s %-*s %s", prefix, var_width,
+          "SHMEM_CONNECT_WARMUP", val_width,
+          proc.env.connect_warmup ? proc.env.connect_warmup : "none",
+          "PEs to connect at startup");
+  if (!proc.env.lazy_connect) {
+    fprintf(stream, " [not used]");
+  }
+  fprintf(stream, "\n");
+  fprintf(stream, "%s%-*s %-*s %s\n", prefix, var_width, "SHMEM_CPU_AMO_TLS",
+          val_width, proc.env.cpu_amo_tls,
+          "transports where on-node AMOs use CPU atomics");
+  fprintf(stream, "%s%-*s %-*lu %s\n", prefix, var_width,
+          "SHMEM_NBI_AMO_DEPTH", val_width,
+          (unsigned long)proc.env.nbi_amo_depth,
+          "fetching nbi AMOs in flight per context");
+  fprintf(stream, "%s%-*s %-*lu %s\n", prefix, var_width,
+          "SHMEM_AGGREGATE_PUT_MAX", val_width,
+          (unsigned long)proc.env.agg_put_max,
+          "batch up puts this small (0 = off)");
+  fprintf(stream, "%s%-*s %-*lu %s", prefix, var_width,
+          "SHMEM_AGGREGATE_BATCH", val_width, (unsigned long)proc.env.agg_batch,
+          "bytes per batch of aggregated puts");
+  if (proc.env.agg_put_max == 0) {
+    fprintf(stream, " [not used]");
+  }
+  fprintf(stream, "\n");
+  fprintf(stream, "%s%-*s %-*s %s\n", prefix, var_width,
+          "SHMEM_ACTIVE_MESSAGES", val_width,
+          shmemu_human_option(proc.env.active_messages),
+          "allow shmemx_am_* active messages");
+  fprintf(stream, "%s%-*s %-*lu %s\n", prefix, var_width,
+          "SHMEM_STRIPE_LANES", val_width,
+          (unsigned long)proc.env.stripe_lanes,
+          "workers to split large puts/gets over");
+  fprintf(stream, "%s%-*s %-*lu %s", prefix, var_width,
+          "SHMEM_STRIPE_THRESHOLD", val_width,
+          (unsigned long)proc.env.stripe_threshold,
+          "split puts/gets at least this big");
+  if (proc.env.stripe_lanes < 2) {
+    fprintf(stream, " [not used]");
+  }
+  fprintf(stream, "\n");
+  fprintf(stream, "%s%-*s %-*lu %s\n", prefix, var_width,
+          "SHMEM_STRIDED_PACK_MIN", val_width,
+          (unsigned long)proc.env.strided_pack_min,
+          "pack iput/iget of at least this many elements");
 
   /* ---------------------------------------------------------------- */
 
@@ -22,6 +22,55 @@
 #include "pmi_client.h"
 #include "heaps.h"
 #include "env.h"
+#include "state.h"
+#include "shmemu.h"
+
+#include <time.h>
+
+/**
+ * @brief Startup phase timings
+ *
+ * Logging isn't available until after the comms layer is up, so
+ * remember how long each phase took and report later.
+ */
+typedef struct startup_phase {
+  const char *name; /**< what was being done */
+  double secs;      /**< how long it took */
+} startup_phase_t;
+
+#define MAX_STARTUP_PHASES 16
+
+static startup_phase_t phases[MAX_STARTUP_PHASES];
+static size_t nphases = 0;
+
+/**
+ * @brief Read a monotonic clock
+ *
+ * @return Current time in seconds
+ */
+inline static double read_clock(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1.0e9;
+}
+
+/**
+ * @brief Run one startup step and record how long it took
+ */
+#define TIMED_PHASE(_name, _call)                                              \
+  do {                                                                         \
+    const double t0 = read_clock();                                            \
+                                                                               \
+    _call;                                                                     \
+                                                                               \
+    if (nphases < MAX_STARTUP_PHASES) {                                        \
+      phases[nphases].name = (_name);                                          \
+      phases[nphases].secs = read_clock() - t0;                                \
+      ++nphases;                                                               \
+    }                                                                          \
+  } while (0)
 
 /**
  * @brief Initialize the OpenSHMEM communications layer
@@ -39,36 +88,54 @@ void shmemc_init(void) {
   shmemc_nodename_init();
 
   /* find launch info */
-  shmemc_pmi_client_init();
+  TIMED_PHASE("pmi client", shmemc_pmi_client_init());
 
   /* user-supplied setup */
   shmemc_env_init();
 
-  shmemc_heaps_init();
+  TIMED_PHASE("heaps", shmemc_heaps_init());
 
   /* launch and connect my heap to network resources */
-  shmemc_ucx_init();
+  TIMED_PHASE("ucx", shmemc_ucx_init());
 
-  shmemc_context_init_default();
+  TIMED_PHASE("default context", shmemc_context_init_default());
 
-  shmemc_teams_init();
+  TIMED_PHASE("teams", shmemc_teams_init());
 
   /* now heap registered... */
 
-  /* publish worker info, everyone has it and exchanges */
-  shmemc_pmi_publish_worker();
-  shmemc_pmi_barrier_all(true);
-  shmemc_pmi_exchange_workers();
+  /*
+   * publish worker, rkeys & heaps in one go, everyone has it and
+   * exchanges.  If connecting lazily, other PEs' info is pulled in
+   * on first contact, so don't need to collect it all now.
+   */
+  TIMED_PHASE("publish wire-up", shmemc_pmi_publish_wireup());
+  TIMED_PHASE("wire-up fence", shmemc_pmi_barrier_all(!proc.env.lazy_connect));
+  TIMED_PHASE("exchange wire-up", shmemc_pmi_exchange_wireup());
 
-  /* publish rkeys (& maybe heaps), everyone has it and exchanges */
-  shmemc_pmi_publish_rkeys_and_heaps();
-  shmemc_pmi_barrier_all(true);
-  shmemc_pmi_exchange_rkeys_and_heaps();
+  TIMED_PHASE("endpoints", shmemc_ucx_make_eps(defcp));
 
-  shmemc_ucx_make_eps(defcp);
+  TIMED_PHASE("striping lanes", shmemc_ucx_lanes_init());
 
   /* just sync, no collect */
-  shmemc_pmi_barrier_all(false);
+  TIMED_PHASE("final sync", shmemc_pmi_barrier_all(false));
+}
+
+/**
+ * @brief Log how long each phase of shmemc_init() took
+ *
+ * Called once logging is up.
+ */
+void shmemc_log_startup_times(void) {
+  size_t i;
+  double total = 0.0;
+
+  for (i = 0; i < nphases; ++i) {
+    logger(LOG_INIT, "startup phase \"%s\" took %.6f s", phases[i].name,
+           phases[i].secs);
+    total += phases[i].secs;
+  }
+  logger(LOG_INIT, "startup phases took %.6f s in total", total);
 }
 
 /**
@@ -86,6 +153,8 @@ void shmemc_init(void) {
 void shmemc_finalize(void) {
   shmemc_teams_finalize();
 
+  shmemc_ucx_lanes_finalize();
+
   shmemc_ucx_context_default_destroy();
 
   shmemc_pmi_barrier_all(false);
@@ -38,23 +38,30 @@ void shmemc_pmi_client_abort(const char *msg, int status);
 void shmemc_pmi_barrier_all(bool collect_data);
 
 /**
- * @brief Publish worker information to other processes
+ * @brief Publish worker address, rkeys and heap extents as one blob
  */
-void shmemc_pmi_publish_worker(void);
+void shmemc_pmi_publish_wireup(void);
 
 /**
- * @brief Publish remote keys and heap information
+ * @brief Fetch the wire-up blobs published by other processes
+ *
+ * If connecting lazily, only our own is fetched here.
  */
-void shmemc_pmi_publish_rkeys_and_heaps(void);
+void shmemc_pmi_exchange_wireup(void);
 
 /**
- * @brief Exchange worker information between processes
+ * @brief Fetch and unpack the wire-up blob of one process
+ *
+ * @param pe Process whose blob to fetch
  */
-void shmemc_pmi_exchange_workers(void);
+void shmemc_pmi_fetch_wireup(int pe);
 
 /**
- * @brief Exchange remote keys and heap information between processes
+ * @brief Look up which node a process is running on
+ *
+ * @param pe Process to look up
+ * @return node number, or -1 if PMIx doesn't know
  */
-void shmemc_pmi_exchange_rkeys_and_heaps(void);
+int shmemc_pmi_node_of(int pe);
 
 #endif /* ! _SHMEMC_PMI_CLIENT_H */
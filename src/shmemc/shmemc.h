@@ -41,6 +41,7 @@
  */
 
 void shmemc_init(void);
+void shmemc_log_startup_times(void);
 void shmemc_finalize(void);
 
 int shmemc_team_reset_psync(shmemc_team_h th, unsigned psync_idx);
@@ -52,6 +53,7 @@ void shmemc_global_exit(int status);
 
 void *shmemc_ctx_ptr(shmem_ctx_t ctx, const void *target, int pe);
 int shmemc_pe_accessible(int pe);
+int shmemc_pe_node(int pe);
 int shmemc_addr_accessible(const void *addr, int pe);
 
 void shmemc_print_env_vars(FILE *stream, const char *prefix);
@@ -63,6 +65,18 @@ void shmemc_print_env_vars(FILE *stream, const char *prefix);
 int shmemc_global_address(uint64_t addr);
 int shmemc_managed_address(uint64_t addr);
 
+/*
+ * user active messages: handler runs on target PE during progress
+ */
+
+#define SHMEMC_AM_MAX_HANDLERS 64 /* == SHMEMX_AM_MAX_HANDLERS, checked */
+
+typedef void (*shmemc_am_handler_t)(int src_pe, const void *payload,
+                                    size_t nbytes, void *arg);
+
+int shmemc_am_register(int id, shmemc_am_handler_t handler, void *arg);
+void shmemc_am_send(int pe, int id, const void *payload, size_t nbytes);
+
 /*
  * -- Per-context routines ---------------------------------------------------
  */
@@ -70,8 +84,34 @@ int shmemc_managed_address(uint64_t addr);
 void shmemc_ctx_progress(shmem_ctx_t ctx);
 void shmemc_progress(void);
 
+/*
+ * for the progress thread: all shareable contexts, and sleeping
+ * until one of them needs attention
+ */
+unsigned shmemc_progress_all(void);
+void shmemc_progress_events_init(void);
+void shmemc_progress_events_finalize(void);
+void shmemc_progress_wait(int timeout_ms);
+
+/*
+ * waiting on local memory, by context's wait policy
+ */
+typedef struct shmemc_waiter {
+  shmem_ctx_t ctx;    /* whose policy/worker */
+  uint64_t start_ns;  /* when we started waiting */
+  uint64_t waited_ns; /* how long, when last looked */
+  unsigned spins;     /* pauses since then */
+} shmemc_waiter_t;
+
+void shmemc_ctx_set_wait_policy(shmem_ctx_t ctx, size_t spin_ns,
+                                size_t block_ns);
+void shmemc_waiter_init(shmemc_waiter_t *wp, shmem_ctx_t ctx);
+void shmemc_waiter_pause(shmemc_waiter_t *wp, void *addr);
+
 void shmemc_ctx_fence(shmem_ctx_t ctx);
 void shmemc_ctx_quiet(shmem_ctx_t ctx);
+void shmemc_ctx_fence_pe(shmem_ctx_t ctx, int pe);
+void shmemc_ctx_quiet_pe(shmem_ctx_t ctx, int pe);
 
 #ifdef ENABLE_EXPERIMENTAL
 
@@ -85,6 +125,47 @@ void shmemc_ctx_put(shmem_ctx_t ctx, void *dest, const void *src, size_t nbytes,
 void shmemc_ctx_get(shmem_ctx_t ctx, void *dest, const void *src, size_t nbytes,
                     int pe);
 
+void shmemc_ctx_iput(shmem_ctx_t ctx, void *dest, const void *src,
+                     ptrdiff_t tst, ptrdiff_t sst, size_t nelems,
+                     size_t elsize, int pe);
+void shmemc_ctx_iget(shmem_ctx_t ctx, void *dest, const void *src,
+                     ptrdiff_t tst, ptrdiff_t sst, size_t nelems,
+                     size_t elsize, int pe);
+
+/*
+ * multi-dimensional subarrays: dimension 0 outermost, counts and
+ * strides in elements
+ */
+#define SHMEMC_SUBARRAY_MAX_DIMS 8
+
+void shmemc_ctx_put_subarray(shmem_ctx_t ctx, void *dest, const void *src,
+                             size_t elsize, int ndims, const size_t *count,
+                             const ptrdiff_t *tst, const ptrdiff_t *sst,
+                             int pe);
+void shmemc_ctx_get_subarray(shmem_ctx_t ctx, void *dest, const void *src,
+                             size_t elsize, int ndims, const size_t *count,
+                             const ptrdiff_t *tst, const ptrdiff_t *sst,
+                             int pe);
+void shmemc_ctx_put_subarray_nbi(shmem_ctx_t ctx, void *dest, const void *src,
+                                 size_t elsize, int ndims, const size_t *count,
+                                 const ptrdiff_t *tst, const ptrdiff_t *sst,
+                                 int pe);
+void shmemc_ctx_get_subarray_nbi(shmem_ctx_t ctx, void *dest, const void *src,
+                                 size_t elsize, int ndims, const size_t *count,
+                                 const ptrdiff_t *tst, const ptrdiff_t *sst,
+                                 int pe);
+
+/*
+ * batches of independent transfers: op i moves nbytes[i] between
+ * dests[i] and srcs[i] on PE pes[i]
+ */
+void shmemc_ctx_putv_nbi(shmem_ctx_t ctx, void *const *dests,
+                         const void *const *srcs, const size_t *nbytes,
+                         const int *pes, size_t nops, uint64_t *completed);
+void shmemc_ctx_getv_nbi(shmem_ctx_t ctx, void *const *dests,
+                         const void *const *srcs, const size_t *nbytes,
+                         const int *pes, size_t nops, uint64_t *completed);
+
 void shmemc_ctx_put_nbi(shmem_ctx_t ctx, void *dest, const void *src,
                         size_t nbytes, int pe);
 void shmemc_ctx_get_nbi(shmem_ctx_t ctx, void *dest, const void *src,
@@ -112,14 +112,37 @@ typedef struct env_info {
   char *logging_file;   /**< where does logging output go? */
   char *logging_events; /**< show only these types of messages */
 
-  shmemc_coll_t coll; /**< collectives */
+  shmemc_coll_t coll;    /**< collectives */
+  char *coll_rules;      /**< per-call algorithm selection rules */
+  char *coll_rules_file; /**< ...and a file with more */
 
   char *progress_threads;   /**< do we need to start our own? */
   size_t progress_delay_ns; /**< if progress needed, time (ns)
                                between polls */
+  bool progress_events;     /**< progress thread sleeps on events? */
+  size_t progress_spin;     /**< idle polls before sleeping */
+  size_t wait_spin_ns;      /**< waits poll this long (ns) first */
+  size_t wait_block_ns;     /**< waits sleep after this long (ns) */
 
   size_t prealloc_contexts; /**< set up this many at start */
   bool memfatal;            /**< force exit on memory usage error? */
+
+  bool lazy_connect;    /**< make endpoints on first use? */
+  char *connect_warmup; /**< PEs to connect up front if lazy */
+
+  char *cpu_amo_tls; /**< transports where AMOs can be CPU atomics */
+
+  size_t nbi_amo_depth; /**< fetching nbi AMOs in flight per context */
+
+  size_t agg_put_max; /**< aggregate puts up to this size (0 = off) */
+  size_t agg_batch;   /**< bytes per aggregated batch */
+
+  bool active_messages; /**< user active messages wanted? */
+
+  size_t stripe_lanes;     /**< workers to split large puts/gets over */
+  size_t stripe_threshold; /**< split puts/gets at least this big */
+
+  size_t strided_pack_min; /**< pack iput/iget of at least this many */
 } env_info_t;
 
 /**
@@ -135,6 +158,7 @@ typedef struct pmi_info {
   int nnodes;   /**< number of nodes allocated */
   int *peers;   /**< peer PEs in a node group */
   int npeers;   /**< how many peers? */
+  int *nodes;   /**< node of each PE + 1, 0 if not looked up yet */
 } pmi_info_t;
 
 /**
@@ -0,0 +1,372 @@
+/* For license: see LICENSE file at top-level */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include "shmemu.h"
+#include "shmemc.h"
+#include "state.h"
+#include "api.h"
+#include "callbacks.h"
+#include "memfence.h"
+#include "module.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <ucp/api/ucp.h>
+
+/*
+ * Small-put aggregation
+ *
+ * Short puts to off-node PEs are appended to a per-PE batch and
+ * shipped as one active message, which the target unpacks into its
+ * heap.  The target then acknowledges the batch, so fence and quiet
+ * can wait for everything to have landed: after that, it's just as
+ * if each put had gone on its own.
+ *
+ * Catch: targets only unpack (and acknowledge) when they make
+ * progress, so this is opt-in, and best with progress threads.
+ */
+
+/*
+ * each put in a batch: where it goes and how long it is, then the
+ * data, padded to keep the next record aligned
+ */
+typedef struct agg_rec {
+  uint64_t addr; /* on target */
+  uint64_t len;  /* payload bytes */
+} agg_rec_t;
+
+#define AGG_ALIGN sizeof(uint64_t)
+
+size_t shmemc_ucx_agg_rec_size(size_t nbytes) {
+  const size_t padded = (nbytes + AGG_ALIGN - 1) & ~(AGG_ALIGN - 1);
+
+  return sizeof(agg_rec_t) + padded;
+}
+
+#ifdef HAVE_UCP_AM_SEND_NBX
+
+/*
+ * -- target side -----------------------------------------------------------
+ */
+
+/*
+ * unpack a batch into my heap, then tell the sender
+ */
+static ucs_status_t batch_recv_handler(void *arg, const void *header,
+                                       size_t header_length, void *data,
+                                       size_t length,
+                                       const ucp_am_recv_param_t *param) {
+  const char *bp = (const char *)data;
+  const char *const end = bp + length;
+  const ucp_request_param_t prm = {.op_attr_mask =
+                                       UCP_OP_ATTR_FIELD_CALLBACK,
+                                   .cb.send = nb_callbackx};
+  ucs_status_ptr_t sp;
+
+  NO_WARN_UNUSED(arg);
+  NO_WARN_UNUSED(header);
+  NO_WARN_UNUSED(header_length);
+
+  /* sender forces eager, so should always be here */
+  shmemu_assert(!(param->recv_attr & UCP_AM_RECV_ATTR_FLAG_RNDV),
+                MODULE ": aggregated put batch arrived as rendezvous");
+
+  while (bp < end) {
+    agg_rec_t rec;
+
+    memcpy(&rec, bp, sizeof(rec));
+    memcpy((void *)rec.addr, bp + sizeof(rec), rec.len);
+
+    bp += shmemc_ucx_agg_rec_size(rec.len);
+  }
+
+  /* data visible before sender hears about it */
+  LOAD_STORE_FENCE();
+
+  /* say who it's from, so sender can wait per PE */
+  sp = ucp_am_send_nbx(param->reply_ep, SHMEMC_UCX_AM_AGG_ACK, &proc.li.rank,
+                       sizeof(proc.li.rank), NULL, 0, &prm);
+  shmemu_assert(!UCS_PTR_IS_ERR(sp),
+                MODULE ": can't acknowledge aggregated put batch (status: %s)",
+                ucs_status_string(UCS_PTR_STATUS(sp)));
+
+  return UCS_OK;
+}
+
+/*
+ * -- initiator side --------------------------------------------------------
+ */
+
+static ucs_status_t ack_recv_handler(void *arg, const void *header,
+                                     size_t header_length, void *data,
+                                     size_t length,
+                                     const ucp_am_recv_param_t *param) {
+  shmemc_context_h ch = (shmemc_context_h)arg;
+  int pe;
+
+  NO_WARN_UNUSED(header_length);
+  NO_WARN_UNUSED(data);
+  NO_WARN_UNUSED(length);
+  NO_WARN_UNUSED(param);
+
+  memcpy(&pe, header, sizeof(pe));
+
+  __atomic_sub_fetch(&ch->agg.bufs[pe].unacked, 1, __ATOMIC_RELEASE);
+  __atomic_sub_fetch(&ch->agg.unacked, 1, __ATOMIC_RELEASE);
+
+  return UCS_OK;
+}
+
+static void set_handler(shmemc_context_h ch, unsigned id,
+                        ucp_am_recv_callback_t cb) {
+  ucp_am_handler_param_t hp;
+  ucs_status_t s;
+
+  hp.field_mask = UCP_AM_HANDLER_PARAM_FIELD_ID |
+                  UCP_AM_HANDLER_PARAM_FIELD_CB |
+                  UCP_AM_HANDLER_PARAM_FIELD_ARG;
+  hp.id = id;
+  hp.cb = cb;
+  hp.arg = ch;
+
+  s = ucp_worker_set_am_recv_handler(ch->w, &hp);
+  shmemu_assert(s == UCS_OK,
+                MODULE ": can't register active message handler %u: %s", id,
+                ucs_status_string(s));
+}
+
+inline static void agg_lock(shmemc_context_h ch) {
+  while (__atomic_test_and_set(&ch->agg.lock, __ATOMIC_ACQUIRE)) {
+    ;
+  }
+}
+
+inline static void agg_unlock(shmemc_context_h ch) {
+  __atomic_clear(&ch->agg.lock, __ATOMIC_RELEASE);
+}
+
+/*
+ * batch buffer goes with the send, free when UCX is done with it
+ */
+static void batch_sent_callbackx(void *req, ucs_status_t status,
+                                 void *user_data) {
+  shmemu_assert(status == UCS_OK,
+                MODULE ": aggregated put batch failed (status: %s)",
+                ucs_status_string(status));
+
+  free(user_data);
+  ucp_request_free(req);
+}
+
+/*
+ * send PE's batch (lock held)
+ */
+static void ship_locked(shmemc_context_h ch, int pe) {
+  agg_buf_t *bp = &ch->agg.bufs[pe];
+  ucp_request_param_t prm = {.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
+                                             UCP_OP_ATTR_FIELD_USER_DATA |
+                                             UCP_OP_ATTR_FIELD_FLAGS,
+                             .flags = UCP_AM_SEND_FLAG_REPLY |
+                                      UCP_AM_SEND_FLAG_EAGER,
+                             .cb.send = batch_sent_callbackx};
+  ucs_status_ptr_t sp;
+
+  if (bp->used == 0) {
+    return;
+    /* NOT REACHED */
+  }
+
+  __atomic_add_fetch(&bp->unacked, 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&ch->agg.unacked, 1, __ATOMIC_RELAXED);
+
+  prm.user_data = bp->data;
+  sp = ucp_am_send_nbx(ch->eps[pe], SHMEMC_UCX_AM_AGG_PUT, NULL, 0, bp->data,
+                       bp->used, &prm);
+  if (sp == NULL) {
+    free(bp->data);
+  } else {
+    shmemu_assert(!UCS_PTR_IS_ERR(sp),
+                  MODULE ": can't send aggregated puts to PE %d (status: %s)",
+                  pe, ucs_status_string(UCS_PTR_STATUS(sp)));
+  }
+
+  bp->data = NULL;
+  bp->used = 0;
+}
+
+void shmemc_ucx_agg_init(shmemc_context_h ch) {
+  ch->agg.bufs = NULL;
+  ch->agg.dirty = NULL;
+  ch->agg.ndirty = 0;
+  ch->agg.unacked = 0;
+  ch->agg.lock = 0;
+
+  if (proc.env.agg_put_max == 0) {
+    return;
+    /* NOT REACHED */
+  }
+
+  /* batches land on default worker, acks on the sending one */
+  set_handler(ch, SHMEMC_UCX_AM_AGG_PUT, batch_recv_handler);
+  set_handler(ch, SHMEMC_UCX_AM_AGG_ACK, ack_recv_handler);
+
+  ch->agg.bufs = (agg_buf_t *)calloc(proc.li.nranks, sizeof(agg_buf_t));
+  ch->agg.dirty = (int *)malloc(proc.li.nranks * sizeof(int));
+  shmemu_assert((ch->agg.bufs != NULL) && (ch->agg.dirty != NULL),
+                MODULE ": can't allocate memory for put aggregation: %s",
+                strerror(errno));
+}
+
+void shmemc_ucx_agg_finalize(shmemc_context_h ch) {
+  if (ch->agg.bufs != NULL) {
+    int pe;
+
+    for (pe = 0; pe < proc.li.nranks; ++pe) {
+      free(ch->agg.bufs[pe].data);
+    }
+  }
+
+  free(ch->agg.bufs);
+  free(ch->agg.dirty);
+}
+
+void shmemc_ucx_agg_put(shmemc_context_h ch, uint64_t r_dest, const void *src,
+                        size_t nbytes, int pe) {
+  const size_t need = shmemc_ucx_agg_rec_size(nbytes);
+  const agg_rec_t rec = {.addr = r_dest, .len = nbytes};
+  agg_buf_t *bp = &ch->agg.bufs[pe];
+
+  /* env setup sizes batches for this */
+  shmemu_assert(need <= proc.env.agg_batch,
+                MODULE ": aggregated put of %lu bytes doesn't fit in a batch",
+                (unsigned long)nbytes);
+
+  agg_lock(ch);
+
+  if (bp->used + need > proc.env.agg_batch) {
+    ship_locked(ch, pe);
+  }
+
+  if (bp->data == NULL) {
+    bp->data = (char *)malloc(proc.env.agg_batch);
+    shmemu_assert(bp->data != NULL,
+                  MODULE ": can't allocate put aggregation batch for PE %d",
+                  pe);
+  }
+
+  /*
+   * first thing in here since last shipped?  A batch shipped because
+   * it filled up is still listed, so check the flag, not the fill
+   */
+  if (!bp->listed) {
+    ch->agg.dirty[ch->agg.ndirty++] = pe;
+    bp->listed = true;
+  }
+
+  memcpy(bp->data + bp->used, &rec, sizeof(rec));
+  memcpy(bp->data + bp->used + sizeof(rec), src, nbytes);
+  bp->used += need;
+
+  agg_unlock(ch);
+}
+
+void shmemc_ucx_agg_ship(shmemc_context_h ch) {
+  size_t i;
+
+  if (ch->agg.bufs == NULL) {
+    return;
+    /* NOT REACHED */
+  }
+
+  agg_lock(ch);
+
+  for (i = 0; i < ch->agg.ndirty; ++i) {
+    const int pe = ch->agg.dirty[i];
+
+    ship_locked(ch, pe);
+    ch->agg.bufs[pe].listed = false;
+  }
+  ch->agg.ndirty = 0;
+
+  agg_unlock(ch);
+}
+
+/*
+ * targets might be waiting on us to unpack their batches too, and
+ * those arrive on the default worker
+ */
+inline static void wait_acked(shmemc_context_h ch, unsigned long *unackedp) {
+  while (__atomic_load_n(unackedp, __ATOMIC_ACQUIRE) > 0) {
+    (void)ucp_worker_progress(ch->w);
+    if (ch != defcp) {
+      (void)ucp_worker_progress(defcp->w);
+    }
+  }
+}
+
+void shmemc_ucx_agg_flush(shmemc_context_h ch) {
+  shmemc_ucx_agg_ship(ch);
+
+  wait_acked(ch, &ch->agg.unacked);
+}
+
+/*
+ * just one PE's batch: it stays listed, shipping it again later is a
+ * no-op if nothing else has been added
+ */
+void shmemc_ucx_agg_flush_pe(shmemc_context_h ch, int pe) {
+  if (ch->agg.bufs == NULL) {
+    return;
+    /* NOT REACHED */
+  }
+
+  agg_lock(ch);
+  ship_locked(ch, pe);
+  agg_unlock(ch);
+
+  wait_acked(ch, &ch->agg.bufs[pe].unacked);
+}
+
+#else /* ! HAVE_UCP_AM_SEND_NBX */
+
+/*
+ * no active message API to ship batches with, so puts go as they are
+ */
+
+void shmemc_ucx_agg_init(shmemc_context_h ch) {
+  ch->agg.bufs = NULL;
+  ch->agg.dirty = NULL;
+  ch->agg.ndirty = 0;
+  ch->agg.unacked = 0;
+  ch->agg.lock = 0;
+}
+
+void shmemc_ucx_agg_finalize(shmemc_context_h ch) { NO_WARN_UNUSED(ch); }
+
+void shmemc_ucx_agg_put(shmemc_context_h ch, uint64_t r_dest, const void *src,
+                        size_t nbytes, int pe) {
+  NO_WARN_UNUSED(ch);
+  NO_WARN_UNUSED(r_dest);
+  NO_WARN_UNUSED(src);
+  NO_WARN_UNUSED(nbytes);
+  NO_WARN_UNUSED(pe);
+
+  shmemu_fatal(MODULE ": put aggregation not supported by this UCX");
+  /* NOT REACHED */
+}
+
+void shmemc_ucx_agg_ship(shmemc_context_h ch) { NO_WARN_UNUSED(ch); }
+
+void shmemc_ucx_agg_flush(shmemc_context_h ch) { NO_WARN_UNUSED(ch); }
+
+void shmemc_ucx_agg_flush_pe(shmemc_context_h ch, int pe) {
+  NO_WARN_UNUSED(ch);
+  NO_WARN_UNUSED(pe);
+}
+
+#endif /* HAVE_UCP_AM_SEND_NBX */
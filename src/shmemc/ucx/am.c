@@ -0,0 +1,227 @@
+/* For license: see LICENSE file at top-level */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include "shmemu.h"
+#include "shmemc.h"
+#include "state.h"
+#include "api.h"
+#include "module.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <ucp/api/ucp.h>
+
+/*
+ * User active messages
+ *
+ * Handlers are registered on the default worker, which is where every
+ * PE's endpoints lead.  So they run whenever the default context makes
+ * progress: in the progress thread if there is one, otherwise in the
+ * target's next library call that progresses.
+ *
+ * Sends never wait: the payload is copied with the header, and the
+ * copy goes when UCX is done with it.  That means a handler can send
+ * (e.g. reply to the source PE) without getting stuck.
+ *
+ * Only there if asked for with SHMEM_ACTIVE_MESSAGES, so UCX doesn't
+ * set up active messages for programs that don't use them.
+ *
+ * The progress thread can be running a handler while another thread
+ * registers a new one for the same id.  So each registration gets its
+ * own slot, published with one pointer store.  Replaced slots might
+ * still be in use, and are only freed at the end.
+ */
+
+#ifdef HAVE_UCP_AM_SEND_NBX
+
+typedef struct am_slot {
+  shmemc_am_handler_t handler;
+  void *arg;
+  struct am_slot *next; /* once retired */
+} am_slot_t;
+
+static am_slot_t *slots[SHMEMC_AM_MAX_HANDLERS];
+static am_slot_t *retired = NULL;
+
+static pthread_mutex_t register_lock = PTHREAD_MUTEX_INITIALIZER;
+
+typedef struct am_header {
+  int src_pe;
+} am_header_t;
+
+static ucs_status_t user_recv_handler(void *arg, const void *header,
+                                      size_t header_length, void *data,
+                                      size_t length,
+                                      const ucp_am_recv_param_t *param) {
+  const am_slot_t *sp = __atomic_load_n((am_slot_t **)arg, __ATOMIC_ACQUIRE);
+  am_header_t hdr;
+
+  shmemu_assert(header_length == sizeof(hdr),
+                MODULE ": active message with bad header size %lu",
+                (unsigned long)header_length);
+  /* sender forces eager, so should always be here */
+  shmemu_assert(!(param->recv_attr & UCP_AM_RECV_ATTR_FLAG_RNDV),
+                MODULE ": active message arrived as rendezvous");
+
+  /* raced with removal */
+  if (sp == NULL) {
+    return UCS_OK;
+    /* NOT REACHED */
+  }
+
+  memcpy(&hdr, header, sizeof(hdr));
+
+  sp->handler(hdr.src_pe, data, length, sp->arg);
+
+  return UCS_OK;
+}
+
+int shmemc_am_register(int id, shmemc_am_handler_t handler, void *arg) {
+  ucp_am_handler_param_t hp;
+  am_slot_t *sp = NULL;
+  am_slot_t *old;
+  ucs_status_t s;
+
+  if (!proc.env.active_messages) {
+    return -1;
+    /* NOT REACHED */
+  }
+  if ((id < 0) || (id >= SHMEMC_AM_MAX_HANDLERS)) {
+    return -1;
+    /* NOT REACHED */
+  }
+
+  if (handler != NULL) {
+    sp = (am_slot_t *)malloc(sizeof(*sp));
+    if (sp == NULL) {
+      return -1;
+      /* NOT REACHED */
+    }
+    sp->handler = handler;
+    sp->arg = arg;
+    sp->next = NULL;
+  }
+
+  pthread_mutex_lock(&register_lock);
+
+  old = __atomic_exchange_n(&slots[id], sp, __ATOMIC_ACQ_REL);
+  if (old != NULL) {
+    old->next = retired;
+    retired = old;
+  }
+
+  hp.field_mask = UCP_AM_HANDLER_PARAM_FIELD_ID |
+                  UCP_AM_HANDLER_PARAM_FIELD_CB |
+                  UCP_AM_HANDLER_PARAM_FIELD_ARG;
+  hp.id = SHMEMC_UCX_AM_USER_BASE + id;
+  hp.cb = (handler != NULL) ? user_recv_handler : NULL; /* NULL removes */
+  hp.arg = &slots[id];
+
+  s = ucp_worker_set_am_recv_handler(defcp->w, &hp);
+
+  pthread_mutex_unlock(&register_lock);
+
+  return (s == UCS_OK) ? 0 : -1;
+}
+
+void shmemc_ucx_am_finalize(void) {
+  int id;
+
+  for (id = 0; id < SHMEMC_AM_MAX_HANDLERS; ++id) {
+    free(slots[id]);
+    slots[id] = NULL;
+  }
+
+  while (retired != NULL) {
+    am_slot_t *next = retired->next;
+
+    free(retired);
+    retired = next;
+  }
+}
+
+/*
+ * message buffer goes with the send, free when UCX is done with it
+ */
+static void am_sent_callbackx(void *req, ucs_status_t status,
+                              void *user_data) {
+  shmemu_assert(status == UCS_OK,
+                MODULE ": active message send failed (status: %s)",
+                ucs_status_string(status));
+
+  free(user_data);
+  ucp_request_free(req);
+}
+
+void shmemc_am_send(int pe, int id, const void *payload, size_t nbytes) {
+  ucp_request_param_t prm = {.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
+                                             UCP_OP_ATTR_FIELD_USER_DATA |
+                                             UCP_OP_ATTR_FIELD_FLAGS,
+                             .flags = UCP_AM_SEND_FLAG_EAGER,
+                             .cb.send = am_sent_callbackx};
+  const am_header_t hdr = {.src_pe = proc.li.rank};
+  char *buf;
+  ucs_status_ptr_t sp;
+
+  shmemu_assert(proc.env.active_messages,
+                MODULE ": active messages need SHMEM_ACTIVE_MESSAGES set");
+  shmemu_assert((id >= 0) && (id < SHMEMC_AM_MAX_HANDLERS),
+                MODULE ": active message id %d not in range [0, %d)", id,
+                SHMEMC_AM_MAX_HANDLERS);
+
+  buf = (char *)malloc(sizeof(hdr) + nbytes);
+  shmemu_assert(buf != NULL,
+                MODULE ": can't allocate memory for active message to PE %d",
+                pe);
+
+  memcpy(buf, &hdr, sizeof(hdr));
+  memcpy(buf + sizeof(hdr), payload, nbytes);
+
+  if (shmemu_unlikely(__atomic_load_n(&defcp->eps[pe], __ATOMIC_ACQUIRE) ==
+                      NULL)) {
+    shmemc_ucx_connect_pe(defcp, pe);
+  }
+
+  prm.user_data = buf;
+  sp = ucp_am_send_nbx(defcp->eps[pe], SHMEMC_UCX_AM_USER_BASE + id, buf,
+                       sizeof(hdr), buf + sizeof(hdr), nbytes, &prm);
+  if (sp == NULL) {
+    free(buf);
+  } else {
+    shmemu_assert(!UCS_PTR_IS_ERR(sp),
+                  MODULE ": can't send active message to PE %d (status: %s)",
+                  pe, ucs_status_string(UCS_PTR_STATUS(sp)));
+  }
+
+  /* so quiet waits for it to arrive: marked once posted, see comms.c */
+  __atomic_store_n(&defcp->unflushed, true, __ATOMIC_SEQ_CST);
+}
+
+#else /* ! HAVE_UCP_AM_SEND_NBX */
+
+int shmemc_am_register(int id, shmemc_am_handler_t handler, void *arg) {
+  NO_WARN_UNUSED(id);
+  NO_WARN_UNUSED(handler);
+  NO_WARN_UNUSED(arg);
+
+  return -1;
+}
+
+void shmemc_ucx_am_finalize(void) {}
+
+void shmemc_am_send(int pe, int id, const void *payload, size_t nbytes) {
+  NO_WARN_UNUSED(pe);
+  NO_WARN_UNUSED(id);
+  NO_WARN_UNUSED(payload);
+  NO_WARN_UNUSED(nbytes);
+
+  shmemu_fatal(MODULE ": active messages not supported by this UCX");
+  /* NOT REACHED */
+}
+
+#endif /* HAVE_UCP_AM_SEND_NBX */
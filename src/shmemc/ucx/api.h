@@ -27,11 +27,50 @@ void shmemc_ucx_allocate_eps_table(shmemc_context_h ch);
 void shmemc_ucx_deallocate_eps_table(shmemc_context_h ch);
 
 int shmemc_ucx_context_progress(shmemc_context_h ch);
+int shmemc_ucx_lane_progress(shmemc_context_h ch);
 void shmemc_ucx_make_eps(shmemc_context_h ch);
+void shmemc_ucx_connect_pe(shmemc_context_h ch, int pe);
 void shmemc_ucx_disconnect_all_eps(shmemc_context_h ch);
 
 ucs_status_t shmemc_ucx_worker_wireup(shmemc_context_h ch);
 
+/*
+ * internal active message IDs
+ */
+
+#define SHMEMC_UCX_AM_AGG_PUT 0 /* batch of small puts */
+#define SHMEMC_UCX_AM_AGG_ACK 1 /* batch unpacked */
+
+#define SHMEMC_UCX_AM_USER_BASE 2 /* user handler ids start here */
+
+void shmemc_ucx_am_finalize(void);
+
+/*
+ * small-put aggregation
+ */
+
+size_t shmemc_ucx_agg_rec_size(size_t nbytes);
+void shmemc_ucx_agg_init(shmemc_context_h ch);
+void shmemc_ucx_agg_finalize(shmemc_context_h ch);
+void shmemc_ucx_agg_put(shmemc_context_h ch, uint64_t r_dest, const void *src,
+                        size_t nbytes, int pe);
+void shmemc_ucx_agg_ship(shmemc_context_h ch);
+void shmemc_ucx_agg_flush(shmemc_context_h ch);
+void shmemc_ucx_agg_flush_pe(shmemc_context_h ch, int pe);
+
+/*
+ * workers the progress thread can drive
+ */
+void shmemc_ucx_live_add(shmemc_context_h ch);
+void shmemc_ucx_live_remove(shmemc_context_h ch);
+void shmemc_ucx_worker_block(shmemc_context_h ch, uint64_t timeout_ns);
+
+/*
+ * striping large puts/gets across internal workers
+ */
+void shmemc_ucx_lanes_init(void);
+void shmemc_ucx_lanes_finalize(void);
+
 ucs_status_t shmemc_ucx_rkey_pack(ucp_mem_h mh, void **packed_rkey_p,
                                   size_t *len_p);
 
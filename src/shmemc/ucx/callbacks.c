@@ -25,6 +25,32 @@ void nb_callbackx(void *req, ucs_status_t status, void *user_data) {
   NO_WARN_UNUSED(user_data);
 }
 
+/*
+ * as nb_callbackx, but nothing waits on these to see the status, so
+ * a failed AMO has to be reported here
+ */
+
+void amo_callbackx(void *req, ucs_status_t status, void *user_data) {
+  shmemu_assert(status == UCS_OK, "non-blocking AMO failed (status: %s)",
+                ucs_status_string(status));
+
+  ucp_request_release(req);
+  NO_WARN_UNUSED(user_data);
+}
+
+/*
+ * for sends from a buffer of our own (user_data), which can go once
+ * UCX is done with it
+ */
+
+void free_callbackx(void *req, ucs_status_t status, void *user_data) {
+  shmemu_assert(status == UCS_OK, "non-blocking put failed (status: %s)",
+                ucs_status_string(status));
+
+  free(user_data);
+  ucp_request_release(req);
+}
+
 /*
  * dummy callback
  */
@@ -43,3 +69,15 @@ void noop_callbackx(void *req, ucs_status_t status, void *user_data) {
   NO_WARN_UNUSED(status);
   NO_WARN_UNUSED(user_data);
 }
+
+/*
+ * count completions: user_data points to a uint64_t counter
+ */
+
+void counter_callbackx(void *req, ucs_status_t status, void *user_data) {
+  shmemu_assert(status == UCS_OK, "non-blocking operation failed (status: %s)",
+                ucs_status_string(status));
+
+  __atomic_add_fetch((uint64_t *)user_data, 1, __ATOMIC_RELEASE);
+  ucp_request_free(req);
+}
@@ -11,8 +11,12 @@
 
 void nb_callback(void *request, ucs_status_t status);
 void nb_callbackx(void *request, ucs_status_t status, void *user_data);
+void amo_callbackx(void *request, ucs_status_t status, void *user_data);
+void free_callbackx(void *request, ucs_status_t status, void *user_data);
 
 void noop_callback(void *request, ucs_status_t status);
 void noop_callbackx(void *request, ucs_status_t status, void *user_data);
 
+void counter_callbackx(void *request, ucs_status_t status, void *user_data);
+
 #endif /* ! _SHMEMC_UCX_CALLBACKS_HH */
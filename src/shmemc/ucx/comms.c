@@ -11,11 +11,13 @@
 #include "callbacks.h"
 #include "memfence.h"
 #include "module.h"
+#include "pmi_client.h"
 
 #include "shmem/defs.h"
 
 #include <unistd.h>
 #include <string.h>
+#include <limits.h>
 
 #include <ucp/api/ucp.h>
 
@@ -23,10 +25,27 @@
  * -- helpers ----------------------------------------------------------------
  */
 
+/*
+ * with lazy connection, endpoints (and the rkeys that hang off them)
+ * only appear the first time a PE is targeted.  An endpoint is
+ * published after its rkeys, so seeing it means they're ready too.
+ */
+inline static ucp_ep_h peek_ep(shmemc_context_h ch, int pe) {
+  return __atomic_load_n(&ch->eps[pe], __ATOMIC_ACQUIRE);
+}
+
+inline static void ensure_connected(shmemc_context_h ch, int pe) {
+  if (shmemu_unlikely(peek_ep(ch, pe) == NULL)) {
+    shmemc_ucx_connect_pe(ch, pe);
+  }
+}
+
 /*
  * shortcut to look up the UCP endpoint of a context
  */
 inline static ucp_ep_h lookup_ucp_ep(shmemc_context_h ch, int pe) {
+  ensure_connected(ch, pe);
+
   return ch->eps[pe];
 }
 
@@ -35,6 +54,8 @@ inline static ucp_ep_h lookup_ucp_ep(shmemc_context_h ch, int pe) {
  */
 inline static ucp_rkey_h lookup_rkey(shmemc_context_h ch, size_t region,
                                      int pe) {
+  ensure_connected(ch, pe);
+
   return ch->racc[region].rinfo[pe].rkey;
 }
 
@@ -54,18 +75,24 @@ inline static int in_region(uint64_t addr, size_t region) {
 
 /*
  * find memory region that ADDR is in, or -1 if none
+ *
+ * Binary search over the local region extents, which are sorted by
+ * base address once registration is complete.
  */
 inline static long lookup_region(uint64_t addr) {
-  long r;
-
-  /*
-   * Let's search down from top heap to globals (#0) under
-   * assumption most data in heaps and newest one is most likely
-   * (may need to revisit)
-   */
-  for (r = proc.comms.nregions - 1; r >= 0; --r) {
-    if (in_region(addr, (size_t)r)) {
-      return r;
+  const mem_span_t *spans = proc.comms.spans;
+  size_t lo = 0;
+  size_t hi = proc.comms.nregions;
+
+  while (lo < hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+
+    if (addr < spans[mid].base) {
+      hi = mid;
+    } else if (addr >= spans[mid].end) {
+      lo = mid + 1;
+    } else {
+      return spans[mid].region;
       /* NOT REACHED */
     }
   }
@@ -73,6 +100,29 @@ inline static long lookup_region(uint64_t addr) {
   return -1L;
 }
 
+/*
+ * as above, but first try the region this context last resolved:
+ * consecutive operations on a context usually hit the same heap.
+ * Shared contexts have several threads at the hint; it's only a
+ * guess that gets checked, so relaxed atomics are enough.
+ */
+inline static long lookup_ctx_region(shmemc_context_h ch, uint64_t addr) {
+  const long hint = __atomic_load_n(&ch->last_region, __ATOMIC_RELAXED);
+  long r;
+
+  if (shmemu_likely(in_region(addr, (size_t)hint))) {
+    return hint;
+    /* NOT REACHED */
+  }
+
+  r = lookup_region(addr);
+  if (r >= 0) {
+    __atomic_store_n(&ch->last_region, r, __ATOMIC_RELAXED);
+  }
+
+  return r;
+}
+
 /*
  * translate remote address:
  *
@@ -118,6 +168,14 @@ inline static uint64_t translate_address(uint64_t local_addr, int pe) {
     return 0;
   }
 
+  /*
+   * with lazy connection, PE's bases only arrive with its wire-up
+   * info, so there's no context to hang this off: use the default
+   */
+  if (r > 0) {
+    ensure_connected(defcp, pe);
+  }
+
   return translate_region_address(local_addr, r, pe);
 }
 
@@ -130,7 +188,7 @@ inline static void get_remote_key_and_addr(shmemc_context_h ch,
                                            uint64_t local_addr, int pe,
                                            ucp_rkey_h *rkey_p,
                                            uint64_t *raddr_p) {
-  const long r = lookup_region(local_addr);
+  const long r = lookup_ctx_region(ch, local_addr);
 
   shmemu_assert(r >= 0, MODULE ": can't find memory region for %p",
                 (void *)local_addr);
@@ -139,6 +197,71 @@ inline static void get_remote_key_and_addr(shmemc_context_h ch,
   *raddr_p = translate_region_address(local_addr, r, pe);
 }
 
+/*
+ * access info for PE's copy of the region holding local_addr, or NULL
+ * if local_addr isn't symmetric.  Sets *rp to the region.
+ */
+inline static const mem_access_t *lookup_access(shmemc_context_h ch,
+                                                uint64_t local_addr, int pe,
+                                                long *rp) {
+  const long r = lookup_ctx_region(ch, local_addr);
+
+  if (shmemu_unlikely(r < 0)) {
+    return NULL;
+    /* NOT REACHED */
+  }
+
+  ensure_connected(ch, pe);
+
+  *rp = r;
+  return &ch->racc[r].rinfo[pe];
+}
+
+/*
+ * where local_addr lives in the locally mapped copy of region r
+ */
+inline static void *mapped_addr(const mem_access_t *map, long r,
+                                uint64_t local_addr) {
+  return (void *)(map->mapped +
+                  (local_addr - proc.comms.regions[r].minfo[proc.li.rank].base));
+}
+
+/*
+ * if PE's copy of the region holding local_addr is mapped into my
+ * address space (PE is on-node, or me), return where local_addr lives
+ * there.  Otherwise NULL, and have to go through the network.
+ */
+inline static void *lookup_mapped_addr(shmemc_context_h ch,
+                                       uint64_t local_addr, int pe) {
+  const mem_access_t *map;
+  long r;
+
+  map = lookup_access(ch, local_addr, pe, &r);
+  if ((map == NULL) || (map->mapped == NULL)) {
+    return NULL;
+    /* NOT REACHED */
+  }
+
+  return mapped_addr(map, r, local_addr);
+}
+
+/*
+ * as above, but only if AMOs to PE can be done with CPU atomics
+ */
+inline static void *lookup_amo_addr(shmemc_context_h ch, uint64_t local_addr,
+                                    int pe) {
+  const mem_access_t *map;
+  long r;
+
+  map = lookup_access(ch, local_addr, pe, &r);
+  if ((map == NULL) || !map->cpu_amo) {
+    return NULL;
+    /* NOT REACHED */
+  }
+
+  return mapped_addr(map, r, local_addr);
+}
+
 /*
  * wait for some non-blocking request to complete on a worker
  *
@@ -173,608 +296,2160 @@ inline static ucs_status_t check_wait_for_request(shmemc_context_h ch,
 }
 
 /*
- * is a given symmetric variable global or managed?
+ * -- in-flight non-blocking fetching AMOs ---------------------------------
+ *
+ * These return a request we can't just let go of: the fetched value
+ * has to have landed by the next quiet, and we don't want an
+ * unbounded number of them in flight.
  */
 
-int shmemc_managed_address(uint64_t addr) { return lookup_region(addr) > 0; }
-
-int shmemc_global_address(uint64_t addr) { return lookup_region(addr) == 0; }
+inline static void ring_lock(req_ring_t *rp) {
+  while (__atomic_test_and_set(&rp->lock, __ATOMIC_ACQUIRE)) {
+    ;
+  }
+}
 
-/*
- * -- ordering -----------------------------------------------------------
- */
+inline static void ring_unlock(req_ring_t *rp) {
+  __atomic_clear(&rp->lock, __ATOMIC_RELEASE);
+}
 
 /*
- * fence and quiet only do something on storable contexts, but
- * currently, progress is on the default context
+ * release completed requests from the oldest end (lock held)
  */
+inline static void ring_reap_locked(req_ring_t *rp) {
+  while (rp->count > 0) {
+    void *req = rp->reqs[rp->head];
+    const ucs_status_t s = UCX_REQUEST_CHECK(req);
 
-void shmemc_ctx_fence(shmem_ctx_t ctx) {
-  if (ctx != SHMEM_CTX_INVALID) {
-    shmemc_context_h ch = (shmemc_context_h)ctx;
+    if (s == UCS_INPROGRESS) {
+      break;
+    }
 
-    if (!ch->attr.nostore) {
-      const ucs_status_t s = ucp_worker_fence(ch->w);
+    shmemu_assert(s == UCS_OK,
+                  MODULE ": non-blocking fetching AMO failed (status: %s)",
+                  ucs_status_string(s));
 
-      shmemu_assert(s == UCS_OK, MODULE ": %s() failed (status: %s)", __func__,
-                    ucs_status_string(s));
-    }
+    ucp_request_free(req);
+    rp->head = (rp->head + 1) % rp->cap;
+    --rp->count;
   }
 }
 
-void shmemc_ctx_quiet(shmem_ctx_t ctx) {
-  if (ctx != SHMEM_CTX_INVALID) {
-    shmemc_context_h ch = (shmemc_context_h)ctx;
-
-    if (!ch->attr.nostore) {
-      ucs_status_t s;
-
-#ifdef HAVE_UCP_WORKER_FLUSH_NBX
-      const ucp_request_param_t prm = {.op_attr_mask =
-                                           UCP_OP_ATTR_FIELD_CALLBACK,
-                                       .cb.send = noop_callbackx};
-      const ucs_status_ptr_t sp = ucp_worker_flush_nbx(ch->w, &prm);
-
-      s = check_wait_for_request(ch, sp);
-#else
-      s = ucp_worker_flush(ch->w);
-#endif /* HAVE_UCP_WORKER_FLUSH_NBX */
+inline static void ring_reap(shmemc_context_h ch) {
+  req_ring_t *rp = &ch->nbi_amos;
 
-      shmemu_assert(s == UCS_OK, MODULE ": %s() failed (status: %s)", __func__,
-                    ucs_status_string(s));
-    }
+  /* quick unlocked peek, nothing to do most of the time */
+  if (__atomic_load_n(&rp->count, __ATOMIC_RELAXED) == 0) {
+    return;
+    /* NOT REACHED */
   }
-}
 
-#ifdef ENABLE_EXPERIMENTAL
+  ring_lock(rp);
+  ring_reap_locked(rp);
+  ring_unlock(rp);
+}
 
 /*
- * This should be correct, but not optimal.  Gets us going.
+ * track a new request, waiting for the oldest to finish if full
  */
+inline static void ring_push(shmemc_context_h ch, void *req) {
+  req_ring_t *rp = &ch->nbi_amos;
 
-int shmemc_ctx_fence_test(shmem_ctx_t ctx) {
-  shmemc_ctx_fence(ctx);
-  return 1;
-}
+  for (;;) {
+    ring_lock(rp);
 
-int shmemc_ctx_quiet_test(shmem_ctx_t ctx) {
-  shmemc_ctx_quiet(ctx);
-  return 1;
-}
+    ring_reap_locked(rp);
 
-#endif /* ENABLE_EXPERIMENTAL */
+    if (rp->count < rp->cap) {
+      rp->reqs[(rp->head + rp->count) % rp->cap] = req;
+      ++rp->count;
 
-static ucs_status_t helper_posted_amo(shmemc_context_h ch,
-                                      ucp_atomic_post_op_t uapo, void *t,
-                                      void *vp, size_t vs, int pe) {
-  uint64_t r_t;
-  ucp_rkey_h r_key;
-  ucp_ep_h ep;
-  uint64_t rv = *(uint64_t *)vp;
+      ring_unlock(rp);
+      return;
+      /* NOT REACHED */
+    }
 
-  get_remote_key_and_addr(ch, (uint64_t)t, pe, &r_key, &r_t);
-  ep = lookup_ucp_ep(ch, pe);
+    ring_unlock(rp);
 
-  return ucp_atomic_post(ep, uapo, rv, vs, r_t, r_key);
+    /* back-pressure */
+    (void)ucp_worker_progress(ch->w);
+  }
 }
 
 /*
- * fetching AMOs: target t, (optional) condition c, value v
+ * wait for everything in flight
  */
+inline static void ring_drain(shmemc_context_h ch) {
+  req_ring_t *rp = &ch->nbi_amos;
 
-inline static ucs_status_ptr_t
-helper_fetching_amo_internal(shmemc_context_h ch, ucp_atomic_fetch_op_t op,
-                             void *t, void *vp, size_t vs, int pe, void *retp,
-                             ucp_send_callback_t cb) {
-  ucp_rkey_h r_key;
-  uint64_t r_t;
-  ucp_ep_h ep;
-  uint64_t rv = *(uint64_t *)vp;
-  ucs_status_ptr_t sp;
-
-  get_remote_key_and_addr(ch, (uint64_t)t, pe, &r_key, &r_t);
-  ep = lookup_ucp_ep(ch, pe);
+  for (;;) {
+    ring_reap(ch);
 
-  sp = ucp_atomic_fetch_nb(ep, op, rv, retp, vs, r_t, r_key, cb);
+    if (__atomic_load_n(&rp->count, __ATOMIC_ACQUIRE) == 0) {
+      break;
+    }
 
-  return sp;
+    (void)ucp_worker_progress(ch->w);
+  }
 }
 
-static ucs_status_t helper_fetching_amo(shmemc_context_h ch,
-                                        ucp_atomic_fetch_op_t op, void *t,
-                                        void *vp, size_t vs, int pe,
-                                        void *retp) {
-  ucs_status_ptr_t sp;
-
-  sp = helper_fetching_amo_internal(ch, op, t, vp, vs, pe, retp, noop_callback);
-
-  return check_wait_for_request(ch, sp);
+/*
+ * anything that only completes remotely at a flush marks the context,
+ * so quiet knows whether it has to flush or not.  Mark *after* posting:
+ * a quiet on another thread that clears the flag in between then still
+ * leaves it set for the next quiet, instead of missing the operation
+ */
+inline static void mark_unflushed(shmemc_context_h ch) {
+  if (!__atomic_load_n(&ch->unflushed, __ATOMIC_SEQ_CST)) {
+    __atomic_store_n(&ch->unflushed, true, __ATOMIC_SEQ_CST);
+  }
 }
 
-static ucs_status_ptr_t helper_fetching_amo_nbi(shmemc_context_h ch,
-                                                ucp_atomic_fetch_op_t op,
-                                                void *t, void *vp, size_t vs,
-                                                int pe, void *retp) {
+/*
+ * wait for everything outstanding to one PE
+ */
+inline static void flush_ep(shmemc_context_h ch, ucp_ep_h ep) {
   ucs_status_ptr_t sp;
+  ucs_status_t s;
 
-  sp = helper_fetching_amo_internal(ch, op, t, vp, vs, pe, retp, nb_callback);
+#ifdef HAVE_UCP_EP_FLUSH_NBX
+  const ucp_request_param_t prm = {.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK,
+                                   .cb.send = noop_callbackx};
 
-  return sp;
-}
+  sp = ucp_ep_flush_nbx(ep, &prm);
+#else
+  sp = ucp_ep_flush_nb(ep, 0, noop_callback);
+#endif /* HAVE_UCP_EP_FLUSH_NBX */
 
-/**
- * API
- *
- **/
+  s = check_wait_for_request(ch, sp);
+  shmemu_assert(s == UCS_OK, MODULE ": endpoint flush failed (status: %s)",
+                ucs_status_string(s));
+}
 
 /*
- * make progress on a context
+ * is a given symmetric variable global or managed?
  */
 
-inline static void helper_ctx_progress(shmem_ctx_t ctx) {
-  shmemc_context_h ch = (shmemc_context_h)ctx;
-
-  (void)ucp_worker_progress(ch->w);
-}
-
-void shmemc_ctx_progress(shmem_ctx_t ctx) { helper_ctx_progress(ctx); }
+int shmemc_managed_address(uint64_t addr) { return lookup_region(addr) > 0; }
 
-void shmemc_progress(void) { helper_ctx_progress(SHMEM_CTX_DEFAULT); }
+int shmemc_global_address(uint64_t addr) { return lookup_region(addr) == 0; }
 
 /*
- * -- accessible memory pointers -----------------------------------------
+ * -- ordering -----------------------------------------------------------
  */
 
 /*
- * See if addr is reachable using given context.  Return usable
- * address if so, otherwise NULL.
+ * non-blocking put-with-signal defers issuing the signal until its
+ * put has completed on the endpoint.  Ordering points have to wait
+ * for those signals to be issued before they can flush or fence.
  */
-
-inline static void *ctx_ptr_self_check(const void *addr) {
-  /* is it remotely accessible? */
-  if (lookup_region((uint64_t)addr) >= 0) {
-    return (void *)addr;
-  } else {
-    return NULL;
+inline static void wait_pending_signals(shmemc_context_h ch) {
+  while (__atomic_load_n(&ch->pending_signals, __ATOMIC_ACQUIRE) > 0) {
+    (void)ucp_worker_progress(ch->w);
   }
 }
 
-inline static void *ctx_ptr_remote_check(shmem_ctx_t ctx, const void *addr,
-                                         int pe) {
-  shmemc_context_h ch = (shmemc_context_h)ctx;
-  uint64_t r_addr;  /* address on other PE */
-  ucp_rkey_h r_key; /* rkey for remote address */
-  void *usable_addr = NULL;
-  ucs_status_t s;
-
-  get_remote_key_and_addr(ch, (uint64_t)addr, pe, &r_key, &r_addr);
-
-  s = ucp_rkey_ptr(r_key, r_addr, &usable_addr);
-  if (s == UCS_OK) {
-    return usable_addr;
-  } else {
-    return NULL;
-  }
-}
+/*
+ * complete anything this context striped over the lanes
+ */
+inline static void quiet_lanes(shmemc_context_h ch) {
+  size_t i;
 
-void *shmemc_ctx_ptr(shmem_ctx_t ctx, const void *addr, int pe) {
-  /* self short-circuit */
-  if (shmemu_unlikely(pe == proc.li.rank)) {
-    return ctx_ptr_self_check(addr);
+  if (!__atomic_exchange_n(&ch->striped, false, __ATOMIC_ACQ_REL)) {
+    return;
     /* NOT REACHED */
   }
 
-  /* if UCX has check routine, do a full test, otherwise give up */
-#ifdef HAVE_UCP_RKEY_PTR
-  return ctx_ptr_remote_check(ctx, addr, pe);
-#else
-  return NULL;
-#endif /* HAVE_UCP_RKEY_PTR */
+  for (i = 0; i < proc.comms.nlanes; ++i) {
+    shmemc_ctx_quiet(&proc.comms.lanes[i]);
+  }
 }
 
+#ifdef ENABLE_EXPERIMENTAL
+
 /*
- * Return non-zero if adddress is remotely accessible, 0 otherwise.
- *
+ * as above, but just check.  Left marked until a blocking quiet, as
+ * other threads might be striping meanwhile.
  */
-int shmemc_addr_accessible(const void *addr, int pe) {
-  uint64_t uaddr = (uint64_t)addr;
+inline static int test_lanes(shmemc_context_h ch) {
+  int done = 1;
+  size_t i;
 
-  NO_WARN_UNUSED(pe); /* if aligned addresses */
+  if (!__atomic_load_n(&ch->striped, __ATOMIC_ACQUIRE)) {
+    return 1;
+    /* NOT REACHED */
+  }
 
-  return translate_address(uaddr, pe) > 0;
+  for (i = 0; i < proc.comms.nlanes; ++i) {
+    done = shmemc_ctx_quiet_test(&proc.comms.lanes[i]) && done;
+  }
+
+  return done;
 }
 
 /*
- * Return non-zero if a valid PE #, 0 otherwise.
- *
- * N.B. this function was originally meant to test which ranks were
- * SHMEM in mixed SHMEM/MPI programs.  Here we just check the rank
- * number is valid and assume reachability, although might want to
- * revisit for FT/resilience purposes.
+ * Testing versions: each call does one round of progress and reports
+ * whether everything has completed yet.  Quiet starts a worker flush
+ * the first time it has to and keeps polling that same request on
+ * later calls.
  */
-int shmemc_pe_accessible(int pe) { return shmemu_valid_pe_number(pe); }
 
-/*
- * -- atomics ------------------------------------------------------------
- */
+int shmemc_ctx_fence_test(shmem_ctx_t ctx) {
+  if (ctx != SHMEM_CTX_INVALID) {
+    shmemc_context_h ch = (shmemc_context_h)ctx;
 
-/**
- * AMO API
- **/
+    if (!ch->attr.nostore) {
+      ucs_status_t s;
 
-/*
- * add
- */
+      (void)ucp_worker_progress(ch->w);
+
+      /* striped transfers have to have completed */
+      if (!test_lanes(ch)) {
+        return 0;
+        /* NOT REACHED */
+      }
+
+      /* batched puts have to have landed */
+      shmemc_ucx_agg_ship(ch);
+      if (__atomic_load_n(&ch->agg.unacked, __ATOMIC_ACQUIRE) > 0) {
+        return 0;
+        /* NOT REACHED */
+      }
+
+      /* signals have to be issued before they can be ordered */
+      if (__atomic_load_n(&ch->pending_signals, __ATOMIC_ACQUIRE) > 0) {
+        return 0;
+        /* NOT REACHED */
+      }
+
+      LOAD_STORE_FENCE();
+
+      /* doesn't block */
+      s = ucp_worker_fence(ch->w);
+
+      shmemu_assert(s == UCS_OK, MODULE ": %s() failed (status: %s)", __func__,
+                    ucs_status_string(s));
+    }
+  }
+
+  return 1;
+}
+
+/*
+ * kick off, or check on, the flush (test_lock held).  Return non-zero
+ * when the flush is complete.
+ */
+inline static int test_flush_locked(shmemc_context_h ch) {
+  ucs_status_t s;
+
+  if (ch->test_flush == NULL) {
+    ucs_status_ptr_t sp;
+
+    LOAD_STORE_FENCE();
+
+    /* nothing needs flushing? */
+    if (!__atomic_exchange_n(&ch->unflushed, false, __ATOMIC_ACQ_REL)) {
+      return 1;
+      /* NOT REACHED */
+    }
+
+#ifdef HAVE_UCP_WORKER_FLUSH_NBX
+    const ucp_request_param_t prm = {.op_attr_mask =
+                                         UCP_OP_ATTR_FIELD_CALLBACK,
+                                     .cb.send = noop_callbackx};
+
+    sp = ucp_worker_flush_nbx(ch->w, &prm);
+#else
+    sp = ucp_worker_flush_nb(ch->w, 0, noop_callback);
+#endif /* HAVE_UCP_WORKER_FLUSH_NBX */
+
+    if (sp == NULL) {
+      return 1;
+      /* NOT REACHED */
+    }
+
+    shmemu_assert(!UCS_PTR_IS_ERR(sp),
+                  MODULE ": %s() can't start flush (status: %s)", __func__,
+                  ucs_status_string(UCS_PTR_STATUS(sp)));
+
+    ch->test_flush = sp;
+
+    return 0;
+    /* NOT REACHED */
+  }
+
+  s = UCX_REQUEST_CHECK(ch->test_flush);
+  if (s == UCS_INPROGRESS) {
+    return 0;
+    /* NOT REACHED */
+  }
+
+  shmemu_assert(s == UCS_OK, MODULE ": %s() flush failed (status: %s)",
+                __func__, ucs_status_string(s));
+
+  ucp_request_free(ch->test_flush);
+  ch->test_flush = NULL;
+
+  return 1;
+}
+
+int shmemc_ctx_quiet_test(shmem_ctx_t ctx) {
+  shmemc_context_h ch;
+  int done;
+
+  if (ctx == SHMEM_CTX_INVALID) {
+    return 1;
+    /* NOT REACHED */
+  }
+
+  ch = (shmemc_context_h)ctx;
+
+  (void)ucp_worker_progress(ch->w);
+
+  ring_reap(ch);
+  done = (__atomic_load_n(&ch->nbi_amos.count, __ATOMIC_ACQUIRE) == 0);
+
+  done = test_lanes(ch) && done;
+
+  if (ch->attr.nostore) {
+    return done;
+    /* NOT REACHED */
+  }
+
+  /* batched puts are done when their targets say so */
+  shmemc_ucx_agg_ship(ch);
+  if (__atomic_load_n(&ch->agg.unacked, __ATOMIC_ACQUIRE) > 0) {
+    return 0;
+    /* NOT REACHED */
+  }
+
+  /* flush has to cover the signals, so wait until they're out */
+  if (__atomic_load_n(&ch->pending_signals, __ATOMIC_ACQUIRE) > 0) {
+    return 0;
+    /* NOT REACHED */
+  }
+
+  while (__atomic_test_and_set(&ch->test_lock, __ATOMIC_ACQUIRE)) {
+    ;
+  }
+  done = test_flush_locked(ch) && done;
+  __atomic_clear(&ch->test_lock, __ATOMIC_RELEASE);
+
+  return done;
+}
+
+/*
+ * a blocking quiet has to see off any flush quiet_test left behind
+ */
+inline static void wait_test_flush(shmemc_context_h ch) {
+  void *req;
+
+  while (__atomic_test_and_set(&ch->test_lock, __ATOMIC_ACQUIRE)) {
+    ;
+  }
+  req = ch->test_flush;
+  ch->test_flush = NULL;
+  __atomic_clear(&ch->test_lock, __ATOMIC_RELEASE);
+
+  (void)check_wait_for_request(ch, req);
+}
+
+#else
+
+#define wait_test_flush(_ch)
+
+#endif /* ENABLE_EXPERIMENTAL */
+
+/*
+ * fence and quiet only do something on storable contexts, but
+ * currently, progress is on the default context
+ */
+
+void shmemc_ctx_fence(shmem_ctx_t ctx) {
+  if (ctx != SHMEM_CTX_INVALID) {
+    shmemc_context_h ch = (shmemc_context_h)ctx;
+
+    if (!ch->attr.nostore) {
+      ucs_status_t s;
+
+      /* batched puts have to land first */
+      shmemc_ucx_agg_flush(ch);
+
+      /* striped ones too */
+      quiet_lanes(ch);
+
+      /* stores to mapped on-node heaps */
+      LOAD_STORE_FENCE();
+
+      wait_pending_signals(ch);
+
+      s = ucp_worker_fence(ch->w);
+
+      shmemu_assert(s == UCS_OK, MODULE ": %s() failed (status: %s)", __func__,
+                    ucs_status_string(s));
+    }
+  }
+}
+
+void shmemc_ctx_quiet(shmem_ctx_t ctx) {
+  if (ctx != SHMEM_CTX_INVALID) {
+    shmemc_context_h ch = (shmemc_context_h)ctx;
+
+    /* fetched values have to be there, store or not */
+    ring_drain(ch);
+
+    wait_test_flush(ch);
+
+    /* striped gets as well as puts */
+    quiet_lanes(ch);
+
+    if (!ch->attr.nostore) {
+      ucs_status_t s;
+
+      shmemc_ucx_agg_flush(ch);
+
+      /* stores to mapped on-node heaps */
+      LOAD_STORE_FENCE();
+
+      wait_pending_signals(ch);
+
+      /* only tracked requests, or nothing, since last time? */
+      if (!__atomic_exchange_n(&ch->unflushed, false, __ATOMIC_ACQ_REL)) {
+        return;
+        /* NOT REACHED */
+      }
+
+#ifdef HAVE_UCP_WORKER_FLUSH_NBX
+      const ucp_request_param_t prm = {.op_attr_mask =
+                                           UCP_OP_ATTR_FIELD_CALLBACK,
+                                       .cb.send = noop_callbackx};
+      const ucs_status_ptr_t sp = ucp_worker_flush_nbx(ch->w, &prm);
+
+      s = check_wait_for_request(ch, sp);
+#else
+      s = ucp_worker_flush(ch->w);
+#endif /* HAVE_UCP_WORKER_FLUSH_NBX */
+
+      shmemu_assert(s == UCS_OK, MODULE ": %s() failed (status: %s)", __func__,
+                    ucs_status_string(s));
+    }
+  }
+}
+
+/*
+ * Per-PE versions: only wait on the endpoint to that PE, not the
+ * whole worker.  UCX can't fence a single endpoint, so fence has to
+ * flush it too.  Batched puts are waited for per PE, striped ones on
+ * each lane's endpoint to the PE.
+ */
+
+static void flush_pe(shmemc_context_h ch, int pe) {
+  ucp_ep_h ep;
+
+  shmemc_ucx_agg_flush_pe(ch, pe);
+
+  /* lanes stay marked, other PEs might still be outstanding */
+  if (__atomic_load_n(&ch->striped, __ATOMIC_ACQUIRE)) {
+    size_t i;
+
+    for (i = 0; i < proc.comms.nlanes; ++i) {
+      shmemc_context_h lane = &proc.comms.lanes[i];
+
+      const ucp_ep_h ep = peek_ep(lane, pe);
+
+      if (ep != NULL) {
+        flush_ep(lane, ep);
+      }
+    }
+  }
+
+  /* stores to mapped on-node heaps */
+  LOAD_STORE_FENCE();
+
+  wait_pending_signals(ch);
+
+  /* never talked to PE, so nothing to wait for */
+  ep = peek_ep(ch, pe);
+  if (ep != NULL) {
+    flush_ep(ch, ep);
+  }
+}
+
+void shmemc_ctx_fence_pe(shmem_ctx_t ctx, int pe) {
+  if (ctx != SHMEM_CTX_INVALID) {
+    shmemc_context_h ch = (shmemc_context_h)ctx;
+
+    if (!ch->attr.nostore) {
+      flush_pe(ch, pe);
+    }
+  }
+}
+
+void shmemc_ctx_quiet_pe(shmem_ctx_t ctx, int pe) {
+  if (ctx != SHMEM_CTX_INVALID) {
+    shmemc_context_h ch = (shmemc_context_h)ctx;
+
+    /* fetched values aren't tracked per PE */
+    ring_drain(ch);
+
+    if (!ch->attr.nostore) {
+      flush_pe(ch, pe);
+    }
+  }
+}
+
+/*
+ * AMOs on a heap mapped here, done by the CPU.  Same semantics as
+ * UCX: for cswap the comparand is the value, and the swap value is
+ * primed in the return buffer.
+ */
+
+#ifdef HAVE_UCP_BITWISE_ATOMICS
+#define CPU_AMO_FETCH_BITWISE_CASES(_tp, _v)                                   \
+  case UCP_ATOMIC_FETCH_OP_FAND:                                               \
+    return __atomic_fetch_and(_tp, _v, __ATOMIC_SEQ_CST);                      \
+  case UCP_ATOMIC_FETCH_OP_FOR:                                                \
+    return __atomic_fetch_or(_tp, _v, __ATOMIC_SEQ_CST);                       \
+  case UCP_ATOMIC_FETCH_OP_FXOR:                                               \
+    return __atomic_fetch_xor(_tp, _v, __ATOMIC_SEQ_CST);
+#else
+#define CPU_AMO_FETCH_BITWISE_CASES(_tp, _v)
+#endif /* HAVE_UCP_BITWISE_ATOMICS */
+
+#define CPU_AMO_SIZED(_size)                                                   \
+  inline static uint##_size##_t cpu_fetching_amo_##_size(                      \
+      ucp_atomic_fetch_op_t op, uint##_size##_t *tp, uint##_size##_t v,        \
+      uint##_size##_t swap) {                                                  \
+    switch (op) {                                                              \
+    case UCP_ATOMIC_FETCH_OP_FADD:                                             \
+      return __atomic_fetch_add(tp, v, __ATOMIC_SEQ_CST);                      \
+    case UCP_ATOMIC_FETCH_OP_SWAP:                                             \
+      return __atomic_exchange_n(tp, v, __ATOMIC_SEQ_CST);                     \
+    case UCP_ATOMIC_FETCH_OP_CSWAP:                                            \
+      /* on failure, v gets what was there */                                  \
+      (void)__atomic_compare_exchange_n(tp, &v, swap, false,                   \
+                                        __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);   \
+      return v;                                                                \
+      CPU_AMO_FETCH_BITWISE_CASES(tp, v)                                       \
+    default:                                                                   \
+      shmemu_fatal(MODULE ": unknown fetching AMO %d", (int)op);               \
+      /* NOT REACHED */                                                        \
+      return 0;                                                                \
+    }                                                                          \
+  }
+
+CPU_AMO_SIZED(32)
+CPU_AMO_SIZED(64)
+
+inline static void cpu_fetching_amo(ucp_atomic_fetch_op_t op, void *tp,
+                                    void *vp, size_t vs, void *retp) {
+  if (vs == sizeof(uint64_t)) {
+    uint64_t v, swap;
+
+    memcpy(&v, vp, vs);
+    memcpy(&swap, retp, vs);
+    v = cpu_fetching_amo_64(op, (uint64_t *)tp, v, swap);
+    memcpy(retp, &v, vs);
+  } else {
+    uint32_t v, swap;
+
+    memcpy(&v, vp, vs);
+    memcpy(&swap, retp, vs);
+    v = cpu_fetching_amo_32(op, (uint32_t *)tp, v, swap);
+    memcpy(retp, &v, vs);
+  }
+}
+
+inline static void cpu_posted_amo(ucp_atomic_post_op_t op, void *tp, void *vp,
+                                  size_t vs) {
+  uint64_t discard = 0;
+  ucp_atomic_fetch_op_t fop;
+
+  switch (op) {
+  case UCP_ATOMIC_POST_OP_ADD:
+    fop = UCP_ATOMIC_FETCH_OP_FADD;
+    break;
+#ifdef HAVE_UCP_BITWISE_ATOMICS
+  case UCP_ATOMIC_POST_OP_AND:
+    fop = UCP_ATOMIC_FETCH_OP_FAND;
+    break;
+  case UCP_ATOMIC_POST_OP_OR:
+    fop = UCP_ATOMIC_FETCH_OP_FOR;
+    break;
+  case UCP_ATOMIC_POST_OP_XOR:
+    fop = UCP_ATOMIC_FETCH_OP_FXOR;
+    break;
+#endif /* HAVE_UCP_BITWISE_ATOMICS */
+  default:
+    shmemu_fatal(MODULE ": unknown posted AMO %d", (int)op);
+    /* NOT REACHED */
+    return;
+  }
+
+  /* CPU has no posted form, just ignore the fetched value */
+  cpu_fetching_amo(fop, tp, vp, vs, &discard);
+}
+
+#ifdef HAVE_UCP_ATOMIC_OP_NBX
+
+/*
+ * post an AMO with no reply buffer, so it completes at quiet and the
+ * caller doesn't wait.  UCX copies the operand into the request, so
+ * vp can go away as soon as this returns.
+ *
+ * Most transports only do swap in its fetching form, which UCX picks
+ * by whether there's a reply buffer: give it one, and throw away what
+ * comes back.  Each context has its own, so contexts on different
+ * threads don't write to the same word.
+ */
+
+inline static void post_amo_nbx(shmemc_context_h ch, ucp_ep_h ep,
+                                ucp_atomic_op_t op, const void *vp, size_t vs,
+                                uint64_t r_addr, ucp_rkey_h r_key) {
+  ucp_request_param_t prm = {.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
+                                             UCP_OP_ATTR_FIELD_DATATYPE,
+                             .cb.send = amo_callbackx,
+                             .datatype = ucp_dt_make_contig(vs)};
+  ucs_status_ptr_t sp;
+
+  if (op == UCP_ATOMIC_OP_SWAP) {
+    prm.op_attr_mask |= UCP_OP_ATTR_FIELD_REPLY_BUFFER;
+    prm.reply_buffer = &ch->swap_discard;
+  }
+
+  sp = ucp_atomic_op_nbx(ep, op, vp, 1, r_addr, r_key, &prm);
+  shmemu_assert(!UCS_PTR_IS_ERR(sp),
+                MODULE ": posted AMO failed (status: %s)",
+                ucs_status_string(UCS_PTR_STATUS(sp)));
+
+  mark_unflushed(ch);
+}
+
+#endif /* HAVE_UCP_ATOMIC_OP_NBX */
+
+static ucs_status_t helper_posted_amo(shmemc_context_h ch,
+                                      ucp_atomic_post_op_t uapo, void *t,
+                                      void *vp, size_t vs, int pe) {
+  uint64_t r_t;
+  ucp_rkey_h r_key;
+  ucp_ep_h ep;
+  uint64_t rv = *(uint64_t *)vp;
+  void *ap;
+  ucs_status_t s;
+
+  ap = lookup_amo_addr(ch, (uint64_t)t, pe);
+  if (ap != NULL) {
+    cpu_posted_amo(uapo, ap, vp, vs);
+    return UCS_OK;
+    /* NOT REACHED */
+  }
+
+  get_remote_key_and_addr(ch, (uint64_t)t, pe, &r_key, &r_t);
+  ep = lookup_ucp_ep(ch, pe);
+
+  s = ucp_atomic_post(ep, uapo, rv, vs, r_t, r_key);
+
+  mark_unflushed(ch);
+
+  return s;
+}
+
+/*
+ * fetching AMOs: target t, (optional) condition c, value v
+ */
+
+inline static ucs_status_ptr_t
+helper_fetching_amo_internal(shmemc_context_h ch, ucp_atomic_fetch_op_t op,
+                             void *t, void *vp, size_t vs, int pe, void *retp,
+                             ucp_send_callback_t cb) {
+  ucp_rkey_h r_key;
+  uint64_t r_t;
+  ucp_ep_h ep;
+  uint64_t rv = *(uint64_t *)vp;
+  ucs_status_ptr_t sp;
+  void *ap;
+
+  /* completes immediately, as if UCX had said UCS_OK */
+  ap = lookup_amo_addr(ch, (uint64_t)t, pe);
+  if (ap != NULL) {
+    cpu_fetching_amo(op, ap, vp, vs, retp);
+    return NULL;
+    /* NOT REACHED */
+  }
+
+  get_remote_key_and_addr(ch, (uint64_t)t, pe, &r_key, &r_t);
+  ep = lookup_ucp_ep(ch, pe);
+
+  sp = ucp_atomic_fetch_nb(ep, op, rv, retp, vs, r_t, r_key, cb);
+
+  return sp;
+}
+
+static ucs_status_t helper_fetching_amo(shmemc_context_h ch,
+                                        ucp_atomic_fetch_op_t op, void *t,
+                                        void *vp, size_t vs, int pe,
+                                        void *retp) {
+  ucs_status_ptr_t sp;
+
+  sp = helper_fetching_amo_internal(ch, op, t, vp, vs, pe, retp, noop_callback);
+
+  return check_wait_for_request(ch, sp);
+}
+
+static ucs_status_ptr_t helper_fetching_amo_nbi(shmemc_context_h ch,
+                                                ucp_atomic_fetch_op_t op,
+                                                void *t, void *vp, size_t vs,
+                                                int pe, void *retp) {
+  ucs_status_ptr_t sp;
+
+  sp = helper_fetching_amo_internal(ch, op, t, vp, vs, pe, retp,
+                                    noop_callback);
+
+  /* keep hold of it until reaped */
+  if ((sp != NULL) && !UCS_PTR_IS_ERR(sp)) {
+    ring_push(ch, sp);
+  }
+
+  return sp;
+}
+
+/**
+ * API
+ *
+ **/
+
+/*
+ * make progress on a context
+ */
+
+inline static void helper_ctx_progress(shmem_ctx_t ctx) {
+  shmemc_context_h ch = (shmemc_context_h)ctx;
+
+  (void)ucp_worker_progress(ch->w);
+
+  ring_reap(ch);
+}
+
+void shmemc_ctx_progress(shmem_ctx_t ctx) { helper_ctx_progress(ctx); }
+
+void shmemc_progress(void) { helper_ctx_progress(SHMEM_CTX_DEFAULT); }
+
+/*
+ * -- accessible memory pointers -----------------------------------------
+ */
+
+/*
+ * See if addr is reachable using given context.  Return usable
+ * address if so, otherwise NULL.
+ */
+
+inline static void *ctx_ptr_self_check(const void *addr) {
+  /* is it remotely accessible? */
+  if (lookup_region((uint64_t)addr) >= 0) {
+    return (void *)addr;
+  } else {
+    return NULL;
+  }
+}
+
+inline static void *ctx_ptr_remote_check(shmem_ctx_t ctx, const void *addr,
+                                         int pe) {
+  /* mapping done (if possible) when endpoint was made */
+  return lookup_mapped_addr((shmemc_context_h)ctx, (uint64_t)addr, pe);
+}
+
+void *shmemc_ctx_ptr(shmem_ctx_t ctx, const void *addr, int pe) {
+  /* self short-circuit */
+  if (shmemu_unlikely(pe == proc.li.rank)) {
+    return ctx_ptr_self_check(addr);
+    /* NOT REACHED */
+  }
+
+  /* if UCX has check routine, do a full test, otherwise give up */
+#ifdef HAVE_UCP_RKEY_PTR
+  return ctx_ptr_remote_check(ctx, addr, pe);
+#else
+  return NULL;
+#endif /* HAVE_UCP_RKEY_PTR */
+}
+
+/*
+ * Return non-zero if adddress is remotely accessible, 0 otherwise.
+ *
+ */
+int shmemc_addr_accessible(const void *addr, int pe) {
+  uint64_t uaddr = (uint64_t)addr;
+
+  NO_WARN_UNUSED(pe); /* if aligned addresses */
+
+  return translate_address(uaddr, pe) > 0;
+}
+
+/*
+ * Return non-zero if a valid PE #, 0 otherwise.
+ *
+ * N.B. this function was originally meant to test which ranks were
+ * SHMEM in mixed SHMEM/MPI programs.  Here we just check the rank
+ * number is valid and assume reachability, although might want to
+ * revisit for FT/resilience purposes.
+ */
+int shmemc_pe_accessible(int pe) { return shmemu_valid_pe_number(pe); }
+
+/*
+ * Which node is "pe" on?  Node ids are the launcher's, so not
+ * necessarily 0 up to the number of nodes; -1 means we can't tell.
+ * Answers are remembered: collectives ask about the same PEs over and
+ * over.  Threads racing to fill in an answer all store the same one.
+ */
+int shmemc_pe_node(int pe) {
+  int node = __atomic_load_n(&proc.li.nodes[pe], __ATOMIC_RELAXED) - 1;
+
+  if (node < 0) {
+    node = shmemc_pmi_node_of(pe);
+    if ((node < 0) || (node == INT_MAX)) {
+      return -1;
+      /* NOT REACHED */
+    }
+    __atomic_store_n(&proc.li.nodes[pe], node + 1, __ATOMIC_RELAXED);
+  }
+
+  return node;
+}
+
+/*
+ * -- atomics ------------------------------------------------------------
+ */
+
+/**
+ * AMO API
+ **/
+
+/*
+ * add
+ */
 
 void shmemc_ctx_add(shmem_ctx_t ctx, void *t, void *vp, size_t vs, int pe) {
   shmemc_context_h ch = (shmemc_context_h)ctx;
 
-  helper_posted_amo(ch, UCP_ATOMIC_POST_OP_ADD, t, vp, vs, pe);
+  helper_posted_amo(ch, UCP_ATOMIC_POST_OP_ADD, t, vp, vs, pe);
+}
+
+/*
+ * inc = add 1
+ */
+
+/*
+ * fetch-and-add
+ */
+
+void shmemc_ctx_fadd(shmem_ctx_t ctx, void *t, void *vp, size_t vs, int pe,
+                     void *retp) {
+  shmemc_context_h ch = (shmemc_context_h)ctx;
+
+  helper_fetching_amo(ch, UCP_ATOMIC_FETCH_OP_FADD, t, vp, vs, pe, retp);
+}
+
+void shmemc_ctx_fadd_nbi(shmem_ctx_t ctx, void *t, void *vp, size_t vs, int pe,
+                         void *retp) {
+  helper_fetching_amo_nbi(ctx, UCP_ATOMIC_FETCH_OP_FADD, t, vp, vs, pe, retp);
+}
+
+/*
+ * fetch-and-inc: finc = fadd 1
+ */
+
+/*
+ * swaps
+ */
+
+void shmemc_ctx_swap(shmem_ctx_t ctx, void *t, void *vp, size_t vs, int pe,
+                     void *retp) {
+  shmemc_context_h ch = (shmemc_context_h)ctx;
+  ucs_status_t s;
+
+  s = helper_fetching_amo(ch, UCP_ATOMIC_FETCH_OP_SWAP, t, vp, vs, pe, retp);
+
+  shmemu_assert(s == UCS_OK, MODULE ": AMO swap failed (status: %s)",
+                ucs_status_string(s));
+}
+
+void shmemc_ctx_cswap(shmem_ctx_t ctx, void *t, void *c, void *vp, size_t vs,
+                      int pe, void *retp) {
+  shmemc_context_h ch = (shmemc_context_h)ctx;
+  ucs_status_t s;
+
+  memcpy(retp, vp, vs); /* prime the value */
+
+  s = helper_fetching_amo(ch, UCP_ATOMIC_FETCH_OP_CSWAP, t, c, vs, pe, retp);
+
+  shmemu_assert(s == UCS_OK,
+                MODULE ": AMO conditional swap failed (status: %s)",
+                ucs_status_string(s));
+}
+
+void shmemc_ctx_swap_nbi(shmem_ctx_t ctx, void *t, void *vp, size_t vs, int pe,
+                         void *retp) {
+  shmemc_context_h ch = (shmemc_context_h)ctx;
+  ucs_status_ptr_t sp;
+
+  sp = helper_fetching_amo_nbi(ch, UCP_ATOMIC_FETCH_OP_SWAP, t, vp, vs, pe,
+                               retp);
+
+  shmemu_assert(!UCS_PTR_IS_ERR(sp), MODULE ": AMO nbi swap failed");
+}
+
+void shmemc_ctx_cswap_nbi(shmem_ctx_t ctx, void *t, void *c, void *vp,
+                          size_t vs, int pe, void *retp) {
+  shmemc_context_h ch = (shmemc_context_h)ctx;
+  ucs_status_ptr_t sp;
+
+  memcpy(retp, vp, vs); /* prime the value */
+
+  sp = helper_fetching_amo_nbi(ch, UCP_ATOMIC_FETCH_OP_CSWAP, t, c, vs, pe,
+                               retp);
+
+  shmemu_assert(!UCS_PTR_IS_ERR(sp),
+                MODULE ": AMO nbi conditional swap failed");
+}
+
+/*
+ * fetch handled via typed-0-swap
+ */
+
+/*
+ * bitwise helpers
+ *
+ * Newer versions of UCX now have native support for bitwise atomics:
+ * we detect this during configure.
+ *
+ */
+
+#ifdef HAVE_UCP_BITWISE_ATOMICS
+
+#define MAKE_UCP_FETCH_OP(_op) UCP_ATOMIC_FETCH_OP_F##_op
+#define MAKE_UCP_POST_OP(_op) UCP_ATOMIC_POST_OP_##_op
+
+#define HELPER_BITWISE_FETCH_ATOMIC(_ucp_op, _opname)                          \
+  inline static void helper_atomic_fetch_##_opname(                            \
+      shmemc_context_h ch, void *t, void *vp, size_t vs, int pe, void *retp) { \
+    const ucs_status_t s = helper_fetching_amo(ch, MAKE_UCP_FETCH_OP(_ucp_op), \
+                                               t, vp, vs, pe, retp);           \
+                                                                               \
+    /* value came back? */                                                     \
+    shmemu_assert(s == UCS_OK,                                                 \
+                  MODULE ": AMO fetch op \"%s\" failed (status: %s)",          \
+                  #_opname, ucs_status_string(s));                             \
+  }
+
+HELPER_BITWISE_FETCH_ATOMIC(AND, and)
+HELPER_BITWISE_FETCH_ATOMIC(OR, or)
+HELPER_BITWISE_FETCH_ATOMIC(XOR, xor)
+
+#define HELPER_BITWISE_FETCH_ATOMIC_NBI(_ucp_op, _opname)                      \
+  inline static void helper_atomic_fetch_##_opname##_nbi(                      \
+      shmemc_context_h ch, void *t, void *vp, size_t vs, int pe, void *retp) { \
+    const ucs_status_ptr_t sp = helper_fetching_amo_nbi(                       \
+        ch, MAKE_UCP_FETCH_OP(_ucp_op), t, vp, vs, pe, retp);                  \
+                                                                               \
+    shmemu_assert(!UCS_PTR_IS_ERR(sp),                                         \
+                  MODULE ": AMO fetch nbi op \"%s\" failed", #_opname);        \
+  }
+
+HELPER_BITWISE_FETCH_ATOMIC_NBI(AND, and)
+HELPER_BITWISE_FETCH_ATOMIC_NBI(OR, or)
+HELPER_BITWISE_FETCH_ATOMIC_NBI(XOR, xor)
+
+#define HELPER_BITWISE_ATOMIC(_ucp_op, _opname)                                \
+  inline static void helper_atomic_##_opname(shmemc_context_h ch, void *t,     \
+                                             void *vp, size_t vs, int pe) {    \
+    const ucs_status_t s =                                                     \
+        helper_posted_amo(ch, MAKE_UCP_POST_OP(_ucp_op), t, vp, vs, pe);       \
+                                                                               \
+    shmemu_assert(s == UCS_OK,                                                 \
+                  MODULE ": AMO post op \"%s\" failed (status: %s)", #_opname, \
+                  ucs_status_string(s));                                       \
+  }
+
+HELPER_BITWISE_ATOMIC(AND, and)
+HELPER_BITWISE_ATOMIC(OR, or)
+HELPER_BITWISE_ATOMIC(XOR, xor)
+
+#else /* ! HAVE_UCP_BITWISE_ATOMICS */
+
+#define HELPER_BITWISE_FETCH_ATOMIC(_op, _opname)                              \
+  inline static void helper_atomic_fetch_##_opname(                            \
+      shmemc_context_h ch, void *t, void *vp, size_t vs, int pe, void *retp) { \
+    /* make sure zeroed for smaller types */                                   \
+    uint64_t ret = 0, rval = 0, rval_orig = 0, vcomp = 0;                      \
+    ucs_status_t s;                                                            \
+    uint64_t r_t;                                                              \
+    ucp_rkey_h r_key;                                                          \
+    ucp_ep_h ep;                                                               \
+                                                                               \
+    memcpy(&vcomp, vp, vs); /* save comparator */                              \
+    get_remote_key_and_addr(ch, (uint64_t)t, pe, &r_key, &r_t);                \
+    ep = lookup_ucp_ep(ch, pe);                                                \
+                                                                               \
+    do {                                                                       \
+      s = ucp_get(ep, &rval_orig, sizeof(rval_orig), r_t, r_key);              \
+      shmemu_assert(s == UCS_OK,                                               \
+                    MODULE ": AMO fetch failed in CAS (status: %s)",           \
+                    ucs_status_string(s));                                     \
+      rval = (rval_orig)_op vcomp;                                             \
+                                                                               \
+      s = ucp_atomic_cswap64(ep, rval_orig, rval, r_t, r_key, &ret);           \
+    } while (ret != rval_orig);                                                \
+                                                                               \
+    memcpy(retp, &ret, vs); /* copy out answer */                              \
+  }
+
+HELPER_BITWISE_FETCH_ATOMIC(|, or)
+HELPER_BITWISE_FETCH_ATOMIC(&, and)
+HELPER_BITWISE_FETCH_ATOMIC(^, xor)
+
+#define HELPER_BITWISE_FETCH_ATOMIC_NBI(_ucp_op, _opname)                      \
+  inline static void helper_atomic_fetch_##_opname##_nbi(                      \
+      shmemc_context_h ch, void *t, void *vp, size_t vs, int pe, void *retp) { \
+    helper_atomic_fetch_##_opname(ch, t, vp, vs, pe, retp);                    \
+  }
+
+HELPER_BITWISE_FETCH_ATOMIC_NBI(AND, and)
+HELPER_BITWISE_FETCH_ATOMIC_NBI(OR, or)
+HELPER_BITWISE_FETCH_ATOMIC_NBI(XOR, xor)
+
+#define HELPER_BITWISE_ATOMIC(_opname)                                         \
+  inline static void helper_atomic_##_opname(shmemc_context_h ch, void *t,     \
+                                             void *vp, size_t vs, int pe) {    \
+    uint64_t discard;                                                          \
+                                                                               \
+    (void)helper_atomic_fetch_##_opname(ch, t, vp, vs, pe, &discard);          \
+  }
+
+HELPER_BITWISE_ATOMIC(or)
+HELPER_BITWISE_ATOMIC(and)
+HELPER_BITWISE_ATOMIC(xor)
+
+#endif /* HAVE_UCP_BITWISE_ATOMICS */
+
+/*
+ * fetched-bitwise
+ */
+
+#define SHMEMC_CTX_FETCH_BITWISE(_op)                                          \
+  void shmemc_ctx_fetch_##_op(shmem_ctx_t ctx, void *t, void *vp, size_t vs,   \
+                              int pe, void *retp) {                            \
+    shmemc_context_h ch = (shmemc_context_h)ctx;                               \
+                                                                               \
+    helper_atomic_fetch_##_op(ch, t, vp, vs, pe, retp);                        \
+  }
+
+SHMEMC_CTX_FETCH_BITWISE(and)
+SHMEMC_CTX_FETCH_BITWISE(or)
+SHMEMC_CTX_FETCH_BITWISE(xor)
+
+/*
+ * bitwise
+ */
+
+#define SHMEMC_CTX_BITWISE(_op)                                                \
+  void shmemc_ctx_##_op(shmem_ctx_t ctx, void *t, void *vp, size_t vs,         \
+                        int pe) {                                              \
+    shmemc_context_h ch = (shmemc_context_h)ctx;                               \
+                                                                               \
+    helper_atomic_##_op(ch, t, vp, vs, pe);                                    \
+  }
+
+SHMEMC_CTX_BITWISE(and)
+SHMEMC_CTX_BITWISE(or)
+SHMEMC_CTX_BITWISE(xor)
+
+/*
+ * set/fetch
+ */
+
+/*
+ * set doesn't need the old value, so don't wait for it: it completes
+ * at the next fence/quiet like any other non-fetching AMO
+ */
+
+void shmemc_ctx_set(shmem_ctx_t ctx, void *tp, size_t ts, void *vp, size_t vs,
+                    int pe) {
+  shmemc_context_h ch = (shmemc_context_h)ctx;
+  void *ap;
+
+  NO_WARN_UNUSED(ts);
+
+  ap = lookup_amo_addr(ch, (uint64_t)tp, pe);
+  if (ap != NULL) {
+    if (vs == sizeof(uint64_t)) {
+      __atomic_store_n((uint64_t *)ap, *(uint64_t *)vp, __ATOMIC_SEQ_CST);
+    } else {
+      __atomic_store_n((uint32_t *)ap, *(uint32_t *)vp, __ATOMIC_SEQ_CST);
+    }
+    return;
+    /* NOT REACHED */
+  }
+
+#ifdef HAVE_UCP_ATOMIC_OP_NBX
+  {
+    uint64_t r_t;
+    ucp_rkey_h r_key;
+
+    get_remote_key_and_addr(ch, (uint64_t)tp, pe, &r_key, &r_t);
+
+    post_amo_nbx(ch, lookup_ucp_ep(ch, pe), UCP_ATOMIC_OP_SWAP, vp, vs, r_t,
+                 r_key);
+  }
+#else
+  {
+    uint64_t zap;
+
+    /* older UCX can't post a swap */
+    shmemc_ctx_swap(ctx, tp, vp, vs, pe, &zap);
+
+    NO_WARN_UNUSED(zap);
+  }
+#endif /* HAVE_UCP_ATOMIC_OP_NBX */
+}
+
+/*
+ * fetch is an atomic read: if target is mapped here, just load it
+ */
+
+inline static bool helper_mapped_fetch(shmemc_context_h ch, void *tp,
+                                       size_t ts, int pe, void *valp) {
+  const void *mp = lookup_mapped_addr(ch, (uint64_t)tp, pe);
+
+  if (mp == NULL) {
+    return false;
+    /* NOT REACHED */
+  }
+
+  if (ts == sizeof(uint64_t)) {
+    *(uint64_t *)valp = __atomic_load_n((const uint64_t *)mp, __ATOMIC_SEQ_CST);
+  } else {
+    *(uint32_t *)valp = __atomic_load_n((const uint32_t *)mp, __ATOMIC_SEQ_CST);
+  }
+
+  return true;
+}
+
+void shmemc_ctx_fetch(shmem_ctx_t ctx, void *tp, size_t ts, int pe,
+                      void *valp) {
+  uint64_t zero = 0;
+
+  if (helper_mapped_fetch((shmemc_context_h)ctx, tp, ts, pe, valp)) {
+    return;
+    /* NOT REACHED */
+  }
+
+  shmemc_ctx_fadd(ctx, tp, &zero, ts, pe, valp);
+}
+
+void shmemc_ctx_fetch_nbi(shmem_ctx_t ctx, void *tp, size_t ts, int pe,
+                          void *valp) {
+  uint64_t zero = 0;
+
+  if (helper_mapped_fetch((shmemc_context_h)ctx, tp, ts, pe, valp)) {
+    return;
+    /* NOT REACHED */
+  }
+
+  shmemc_ctx_fadd_nbi(ctx, tp, &zero, ts, pe, valp);
+}
+
+/*
+ * -- striping -----------------------------------------------------------
+ *
+ * Big puts/gets are cut into one chunk per lane and posted
+ * non-blocking on the lanes' own endpoints.  Each transfer starts on
+ * the next lane round, so that uneven tails spread out.  The calling
+ * context remembers it has striped, and its fence/quiet then quiet
+ * the lanes too.
+ */
+
+#define STRIPE_ALIGN 64 /* keep chunks cache-line sized */
+
+inline static bool stripe_eligible(size_t nbytes) {
+  return (proc.comms.nlanes > 0) && (nbytes >= proc.env.stripe_threshold);
+}
+
+static void stripe_rma(shmemc_context_h ch, uint64_t symm_addr, void *lp,
+                       size_t nbytes, int pe, bool is_put, bool blocking) {
+  const size_t nl = proc.comms.nlanes;
+  const size_t first =
+      __atomic_fetch_add(&proc.comms.next_lane, 1, __ATOMIC_RELAXED);
+  size_t chunk = (nbytes + nl - 1) / nl;
+  size_t off = 0;
+  size_t k;
+
+  chunk = (chunk + STRIPE_ALIGN - 1) & ~((size_t)STRIPE_ALIGN - 1);
+
+  for (k = 0; off < nbytes; ++k) {
+    shmemc_context_h lane = &proc.comms.lanes[(first + k) % nl];
+    const size_t len = (nbytes - off < chunk) ? nbytes - off : chunk;
+    uint64_t r_addr;
+    ucp_rkey_h r_key;
+    ucp_ep_h ep;
+    ucs_status_t s;
+
+    get_remote_key_and_addr(lane, symm_addr + off, pe, &r_key, &r_addr);
+    ep = lookup_ucp_ep(lane, pe);
+
+    s = is_put ? ucp_put_nbi(ep, (char *)lp + off, len, r_addr, r_key)
+               : ucp_get_nbi(ep, (char *)lp + off, len, r_addr, r_key);
+    shmemu_assert(s == UCS_OK || s == UCS_INPROGRESS,
+                  MODULE ": striped %s failed (status: %s)",
+                  is_put ? "put" : "get", ucs_status_string(s));
+
+    mark_unflushed(lane);
+
+    off += len;
+  }
+
+  if (blocking) {
+    /* k lanes used, none of them twice */
+    while (k-- > 0) {
+      shmemc_context_h lane = &proc.comms.lanes[(first + k) % nl];
+
+      flush_ep(lane, lane->eps[pe]);
+    }
+  } else {
+    __atomic_store_n(&ch->striped, true, __ATOMIC_RELEASE);
+  }
+}
+
+/*
+ * -- puts & gets --------------------------------------------------------
+ */
+
+void shmemc_ctx_put(shmem_ctx_t ctx, void *dest, const void *src, size_t nbytes,
+                    int pe) {
+  shmemc_context_h ch = (shmemc_context_h)ctx;
+  uint64_t r_dest;  /* address on other PE */
+  ucp_rkey_h r_key; /* rkey for remote address */
+  ucp_ep_h ep;
+#if defined(HAVE_UCP_PUT_NBX) || defined(HAVE_UCP_PUT_NB)
+  ucs_status_ptr_t sp;
+#endif /* HAVE_UCP_PUT_NBX || HAVE_UCP_PUT_NB */
+  ucs_status_t s;
+  void *mp;
+
+  mp = lookup_mapped_addr(ch, (uint64_t)dest, pe);
+  if (mp != NULL) {
+    /* self can overlap */
+    memmove(mp, src, nbytes);
+    return;
+    /* NOT REACHED */
+  }
+
+  if (stripe_eligible(nbytes)) {
+    stripe_rma(ch, (uint64_t)dest, (void *)src, nbytes, pe, true, true);
+    return;
+    /* NOT REACHED */
+  }
+
+  get_remote_key_and_addr(ch, (uint64_t)dest, pe, &r_key, &r_dest);
+
+  /* small put to off-node PE: batch it up */
+  if ((ch->agg.bufs != NULL) && (nbytes <= proc.env.agg_put_max)) {
+    shmemc_ucx_agg_put(ch, r_dest, src, nbytes, pe);
+    return;
+    /* NOT REACHED */
+  }
+
+  ep = lookup_ucp_ep(ch, pe);
+
+#ifdef HAVE_UCP_PUT_NBX
+  const ucp_request_param_t prm = {.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK,
+                                   .cb.send = noop_callbackx};
+
+  sp = ucp_put_nbx(ep, src, nbytes, r_dest, r_key, &prm);
+  s = check_wait_for_request(ch, sp);
+#elif defined(HAVE_UCP_PUT_NB)
+  sp = ucp_put_nb(ep, src, nbytes, r_dest, r_key, noop_callback);
+  s = check_wait_for_request(ch, sp);
+#else  /* ! HAVE_UCP_PUT_NB */
+  s = ucp_put(ep, src, nbytes, r_dest, r_key);
+#endif /* HAVE_UCP_PUT_NBX */
+
+  shmemu_assert(s == UCS_OK, MODULE ": put failed (status: %s)",
+                ucs_status_string(s));
+
+  /* only locally complete on return */
+  mark_unflushed(ch);
+}
+
+void shmemc_ctx_get(shmem_ctx_t ctx, void *dest, const void *src, size_t nbytes,
+                    int pe) {
+  shmemc_context_h ch = (shmemc_context_h)ctx;
+  uint64_t r_src;
+  ucp_rkey_h r_key;
+  ucp_ep_h ep;
+#if defined(HAVE_UCP_GET_NBX) || defined(HAVE_UCP_GET_NB)
+  ucs_status_ptr_t sp;
+#endif /* HAVE_UCP_GET_NBX || HAVE_UCP_GET_NB */
+  ucs_status_t s;
+  void *mp;
+
+  mp = lookup_mapped_addr(ch, (uint64_t)src, pe);
+  if (mp != NULL) {
+    memmove(dest, mp, nbytes);
+    return;
+    /* NOT REACHED */
+  }
+
+  if (stripe_eligible(nbytes)) {
+    stripe_rma(ch, (uint64_t)src, dest, nbytes, pe, false, true);
+    return;
+    /* NOT REACHED */
+  }
+
+  get_remote_key_and_addr(ch, (uint64_t)src, pe, &r_key, &r_src);
+  ep = lookup_ucp_ep(ch, pe);
+
+#ifdef HAVE_UCP_GET_NBX
+  const ucp_request_param_t prm = {.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK,
+                                   .cb.send = noop_callbackx};
+
+  sp = ucp_get_nbx(ep, dest, nbytes, r_src, r_key, &prm);
+  s = check_wait_for_request(ch, sp);
+#elif defined(HAVE_UCP_GET_NB)
+  sp = ucp_get_nb(ep, dest, nbytes, r_src, r_key, noop_callback);
+  s = check_wait_for_request(ch, sp);
+#else  /* ! HAVE_UCP_GET_NB */
+  s = ucp_get(ep, dest, nbytes, r_src, r_key);
+#endif /* HAVE_UCP_GET_NB */
+
+  shmemu_assert(s == UCS_OK, MODULE ": get failed (status: %s)",
+                ucs_status_string(s));
+}
+
+/**
+ * Return status from UCP nbi routines probably needs more handling
+ *
+ */
+
+void shmemc_ctx_put_nbi(shmem_ctx_t ctx, void *dest, const void *src,
+                        size_t nbytes, int pe) {
+  shmemc_context_h ch = (shmemc_context_h)ctx;
+  uint64_t r_dest;
+  ucp_rkey_h r_key;
+  ucp_ep_h ep;
+  ucs_status_t s;
+  void *mp;
+
+  /* on-node: done now, ordered by next fence/quiet */
+  mp = lookup_mapped_addr(ch, (uint64_t)dest, pe);
+  if (mp != NULL) {
+    memmove(mp, src, nbytes);
+    return;
+    /* NOT REACHED */
+  }
+
+  if (stripe_eligible(nbytes)) {
+    stripe_rma(ch, (uint64_t)dest, (void *)src, nbytes, pe, true, false);
+    return;
+    /* NOT REACHED */
+  }
+
+  get_remote_key_and_addr(ch, (uint64_t)dest, pe, &r_key, &r_dest);
+
+  /* small put to off-node PE: batch it up */
+  if ((ch->agg.bufs != NULL) && (nbytes <= proc.env.agg_put_max)) {
+    shmemc_ucx_agg_put(ch, r_dest, src, nbytes, pe);
+    return;
+    /* NOT REACHED */
+  }
+
+  ep = lookup_ucp_ep(ch, pe);
+
+  s = ucp_put_nbi(ep, src, nbytes, r_dest, r_key);
+  shmemu_assert(s == UCS_OK || s == UCS_INPROGRESS,
+                MODULE ": non-blocking put failed");
+
+  mark_unflushed(ch);
+}
+
+void shmemc_ctx_get_nbi(shmem_ctx_t ctx, void *dest, const void *src,
+                        size_t nbytes, int pe) {
+  shmemc_context_h ch = (shmemc_context_h)ctx;
+  uint64_t r_src;
+  ucp_rkey_h r_key;
+  ucp_ep_h ep;
+  ucs_status_t s;
+  void *mp;
+
+  mp = lookup_mapped_addr(ch, (uint64_t)src, pe);
+  if (mp != NULL) {
+    memmove(dest, mp, nbytes);
+    return;
+    /* NOT REACHED */
+  }
+
+  if (stripe_eligible(nbytes)) {
+    stripe_rma(ch, (uint64_t)src, dest, nbytes, pe, false, false);
+    return;
+    /* NOT REACHED */
+  }
+
+  get_remote_key_and_addr(ch, (uint64_t)src, pe, &r_key, &r_src);
+  ep = lookup_ucp_ep(ch, pe);
+
+  s = ucp_get_nbi(ep, dest, nbytes, r_src, r_key);
+  shmemu_assert(s == UCS_OK || s == UCS_INPROGRESS,
+                MODULE ": non-blocking get failed");
+
+  mark_unflushed(ch);
 }
 
 /*
- * inc = add 1
+ * -- strided puts & gets ------------------------------------------------
+ *
+ * Strategy depends on where the target is and what's contiguous:
+ *
+ *   on-node (mapped):     copy elements directly
+ *   both contiguous:      one put/get
+ *   remote contiguous:    pack/unpack through a bounce buffer, one
+ *                         put/get per chunk
+ *   remote strided, or    pipeline non-blocking element puts/gets,
+ *   too few elements to   then wait once on the endpoint
+ *   be worth packing:
+ *
+ * Strides are in elements, as per the API.
  */
 
+#define STRIDED_BOUNCE_SIZE (64 * 1024) /* magic number */
+
 /*
- * fetch-and-add
+ * element-wise copy between two strided local views
  */
+inline static void strided_copy(char *dest, const char *src, ptrdiff_t dst,
+                                ptrdiff_t sst, size_t nelems, size_t elsize) {
+  const ptrdiff_t dst_nb = dst * (ptrdiff_t)elsize;
+  const ptrdiff_t sst_nb = sst * (ptrdiff_t)elsize;
+  size_t i;
+
+  for (i = 0; i < nelems; ++i) {
+    memcpy(dest, src, elsize);
+    dest += dst_nb;
+    src += sst_nb;
+  }
+}
 
-void shmemc_ctx_fadd(shmem_ctx_t ctx, void *t, void *vp, size_t vs, int pe,
-                     void *retp) {
-  shmemc_context_h ch = (shmemc_context_h)ctx;
+/*
+ * how many elements of size elsize fit in one bounce buffer
+ */
+inline static size_t bounce_nelems(size_t elsize) {
+  const size_t n = STRIDED_BOUNCE_SIZE / elsize;
 
-  helper_fetching_amo(ch, UCP_ATOMIC_FETCH_OP_FADD, t, vp, vs, pe, retp);
+  return (n > 0) ? n : 1;
 }
 
-void shmemc_ctx_fadd_nbi(shmem_ctx_t ctx, void *t, void *vp, size_t vs, int pe,
-                         void *retp) {
-  helper_fetching_amo_nbi(ctx, UCP_ATOMIC_FETCH_OP_FADD, t, vp, vs, pe, retp);
+inline static char *bounce_alloc(size_t elsize) {
+  char *bounce = (char *)malloc(bounce_nelems(elsize) * elsize);
+
+  shmemu_assert(bounce != NULL,
+                MODULE ": can't allocate bounce buffer for strided transfer");
+
+  return bounce;
 }
 
 /*
- * fetch-and-inc: finc = fadd 1
+ * gather strided local source, ship as contiguous chunks (blocking)
+ */
+static void put_gathered(shmem_ctx_t ctx, char *dp, const char *sp,
+                         ptrdiff_t sst, size_t nelems, size_t elsize, int pe,
+                         char *bounce) {
+  const size_t chunk = bounce_nelems(elsize);
+  size_t done = 0;
+
+  while (done < nelems) {
+    const size_t n = (nelems - done < chunk) ? nelems - done : chunk;
+
+    strided_copy(bounce, sp, 1, sst, n, elsize);
+    shmemc_ctx_put(ctx, dp, bounce, n * elsize, pe);
+
+    sp += (ptrdiff_t)n * sst * (ptrdiff_t)elsize;
+    dp += n * elsize;
+    done += n;
+  }
+}
+
+#ifdef HAVE_UCP_PUT_NBX
+/*
+ * as put_gathered, but doesn't wait: each chunk gets a buffer of its
+ * own, freed when UCX is done with it.  Completed by the next quiet.
  */
+static void put_gathered_nbi(ucp_ep_h ep, uint64_t r_dest, ucp_rkey_h r_key,
+                             const char *sp, ptrdiff_t sst, size_t nelems,
+                             size_t elsize) {
+  const size_t chunk = bounce_nelems(elsize);
+  size_t done = 0;
+
+  while (done < nelems) {
+    const size_t n = (nelems - done < chunk) ? nelems - done : chunk;
+    char *bounce = (char *)malloc(n * elsize);
+    ucp_request_param_t prm = {.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
+                                               UCP_OP_ATTR_FIELD_USER_DATA,
+                               .cb.send = free_callbackx,
+                               .user_data = bounce};
+    ucs_status_ptr_t req;
+
+    shmemu_assert(bounce != NULL,
+                  MODULE ": can't allocate bounce buffer for strided put");
+
+    strided_copy(bounce, sp, 1, sst, n, elsize);
+
+    req = ucp_put_nbx(ep, bounce, n * elsize, r_dest, r_key, &prm);
+    if (req == NULL) {
+      free(bounce);
+    } else {
+      shmemu_assert(!UCS_PTR_IS_ERR(req),
+                    MODULE ": subarray put failed (status: %s)",
+                    ucs_status_string(UCS_PTR_STATUS(req)));
+    }
+
+    sp += (ptrdiff_t)n * sst * (ptrdiff_t)elsize;
+    r_dest += n * elsize;
+    done += n;
+  }
+}
+#endif /* HAVE_UCP_PUT_NBX */
 
 /*
- * swaps
+ * fetch contiguous chunks, scatter into strided local dest (blocking)
  */
+static void get_scattered(shmem_ctx_t ctx, char *dp, const char *sp,
+                          ptrdiff_t tst, size_t nelems, size_t elsize, int pe,
+                          char *bounce) {
+  const size_t chunk = bounce_nelems(elsize);
+  size_t done = 0;
 
-void shmemc_ctx_swap(shmem_ctx_t ctx, void *t, void *vp, size_t vs, int pe,
-                     void *retp) {
-  shmemc_context_h ch = (shmemc_context_h)ctx;
-  ucs_status_t s;
+  while (done < nelems) {
+    const size_t n = (nelems - done < chunk) ? nelems - done : chunk;
 
-  s = helper_fetching_amo(ch, UCP_ATOMIC_FETCH_OP_SWAP, t, vp, vs, pe, retp);
+    shmemc_ctx_get(ctx, bounce, sp, n * elsize, pe);
+    strided_copy(dp, bounce, tst, 1, n, elsize);
 
-  shmemu_assert(s == UCS_OK, MODULE ": AMO swap failed (status: %s)",
-                ucs_status_string(s));
+    sp += n * elsize;
+    dp += (ptrdiff_t)n * tst * (ptrdiff_t)elsize;
+    done += n;
+  }
 }
 
-void shmemc_ctx_cswap(shmem_ctx_t ctx, void *t, void *c, void *vp, size_t vs,
-                      int pe, void *retp) {
-  shmemc_context_h ch = (shmemc_context_h)ctx;
-  ucs_status_t s;
+/*
+ * post one non-blocking put/get per element, caller waits
+ */
+static void put_elements(ucp_ep_h ep, uint64_t r_dest, ucp_rkey_h r_key,
+                         const char *sp, ptrdiff_t tst, ptrdiff_t sst,
+                         size_t nelems, size_t elsize) {
+  const ptrdiff_t tst_nb = tst * (ptrdiff_t)elsize;
+  const ptrdiff_t sst_nb = sst * (ptrdiff_t)elsize;
+  size_t i;
+
+  for (i = 0; i < nelems; ++i) {
+    const ucs_status_t s = ucp_put_nbi(ep, sp, elsize, r_dest, r_key);
+
+    shmemu_assert(s == UCS_OK || s == UCS_INPROGRESS,
+                  MODULE ": strided put failed (status: %s)",
+                  ucs_status_string(s));
+
+    sp += sst_nb;
+    r_dest += tst_nb;
+  }
+}
 
-  memcpy(retp, vp, vs); /* prime the value */
+static void get_elements(ucp_ep_h ep, char *dp, uint64_t r_src,
+                         ucp_rkey_h r_key, ptrdiff_t tst, ptrdiff_t sst,
+                         size_t nelems, size_t elsize) {
+  const ptrdiff_t tst_nb = tst * (ptrdiff_t)elsize;
+  const ptrdiff_t sst_nb = sst * (ptrdiff_t)elsize;
+  size_t i;
 
-  s = helper_fetching_amo(ch, UCP_ATOMIC_FETCH_OP_CSWAP, t, c, vs, pe, retp);
+  for (i = 0; i < nelems; ++i) {
+    const ucs_status_t s = ucp_get_nbi(ep, dp, elsize, r_src, r_key);
 
-  shmemu_assert(s == UCS_OK,
-                MODULE ": AMO conditional swap failed (status: %s)",
-                ucs_status_string(s));
+    shmemu_assert(s == UCS_OK || s == UCS_INPROGRESS,
+                  MODULE ": strided get failed (status: %s)",
+                  ucs_status_string(s));
+
+    dp += tst_nb;
+    r_src += sst_nb;
+  }
 }
 
-void shmemc_ctx_swap_nbi(shmem_ctx_t ctx, void *t, void *vp, size_t vs, int pe,
-                         void *retp) {
+void shmemc_ctx_iput(shmem_ctx_t ctx, void *dest, const void *src,
+                     ptrdiff_t tst, ptrdiff_t sst, size_t nelems,
+                     size_t elsize, int pe) {
   shmemc_context_h ch = (shmemc_context_h)ctx;
-  ucs_status_ptr_t sp;
+  uint64_t r_dest;
+  ucp_rkey_h r_key;
+  ucp_ep_h ep;
+  void *mp;
 
-  sp = helper_fetching_amo_nbi(ch, UCP_ATOMIC_FETCH_OP_SWAP, t, vp, vs, pe,
-                               retp);
+  if (shmemu_unlikely(nelems == 0)) {
+    return;
+    /* NOT REACHED */
+  }
 
-  shmemu_assert(!UCS_PTR_IS_ERR(sp), MODULE ": AMO nbi swap failed");
+  mp = lookup_mapped_addr(ch, (uint64_t)dest, pe);
+  if (mp != NULL) {
+    strided_copy((char *)mp, (const char *)src, tst, sst, nelems, elsize);
+    return;
+    /* NOT REACHED */
+  }
+
+  if ((tst == 1) && (sst == 1)) {
+    shmemc_ctx_put(ctx, dest, src, nelems * elsize, pe);
+    return;
+    /* NOT REACHED */
+  }
+
+  if ((tst == 1) && (nelems >= proc.env.strided_pack_min)) {
+    char *bounce = bounce_alloc(elsize);
+
+    put_gathered(ctx, (char *)dest, (const char *)src, sst, nelems, elsize,
+                 pe, bounce);
+
+    free(bounce);
+    return;
+    /* NOT REACHED */
+  }
+
+  /* one pipelined burst, one wait */
+  get_remote_key_and_addr(ch, (uint64_t)dest, pe, &r_key, &r_dest);
+  ep = lookup_ucp_ep(ch, pe);
+
+  put_elements(ep, r_dest, r_key, (const char *)src, tst, sst, nelems,
+               elsize);
+
+  /* source is reusable once this returns */
+  flush_ep(ch, ep);
 }
 
-void shmemc_ctx_cswap_nbi(shmem_ctx_t ctx, void *t, void *c, void *vp,
-                          size_t vs, int pe, void *retp) {
+void shmemc_ctx_iget(shmem_ctx_t ctx, void *dest, const void *src,
+                     ptrdiff_t tst, ptrdiff_t sst, size_t nelems,
+                     size_t elsize, int pe) {
   shmemc_context_h ch = (shmemc_context_h)ctx;
-  ucs_status_ptr_t sp;
+  uint64_t r_src;
+  ucp_rkey_h r_key;
+  ucp_ep_h ep;
+  void *mp;
 
-  memcpy(retp, vp, vs); /* prime the value */
+  if (shmemu_unlikely(nelems == 0)) {
+    return;
+    /* NOT REACHED */
+  }
 
-  sp = helper_fetching_amo_nbi(ch, UCP_ATOMIC_FETCH_OP_CSWAP, t, c, vs, pe,
-                               retp);
+  mp = lookup_mapped_addr(ch, (uint64_t)src, pe);
+  if (mp != NULL) {
+    strided_copy((char *)dest, (const char *)mp, tst, sst, nelems, elsize);
+    return;
+    /* NOT REACHED */
+  }
 
-  shmemu_assert(!UCS_PTR_IS_ERR(sp),
-                MODULE ": AMO nbi conditional swap failed");
+  if ((tst == 1) && (sst == 1)) {
+    shmemc_ctx_get(ctx, dest, src, nelems * elsize, pe);
+    return;
+    /* NOT REACHED */
+  }
+
+  if ((sst == 1) && (nelems >= proc.env.strided_pack_min)) {
+    char *bounce = bounce_alloc(elsize);
+
+    get_scattered(ctx, (char *)dest, (const char *)src, tst, nelems, elsize,
+                  pe, bounce);
+
+    free(bounce);
+    return;
+    /* NOT REACHED */
+  }
+
+  /* one pipelined burst, one wait */
+  get_remote_key_and_addr(ch, (uint64_t)src, pe, &r_key, &r_src);
+  ep = lookup_ucp_ep(ch, pe);
+
+  get_elements(ep, (char *)dest, r_src, r_key, tst, sst, nelems, elsize);
+
+  /* values have all arrived once this returns */
+  flush_ep(ch, ep);
 }
 
 /*
- * fetch handled via typed-0-swap
+ * -- multi-dimensional subarrays ----------------------------------------
+ *
+ * Dimension 0 is the outermost, ndims-1 the innermost ("row").
+ * Counts and strides are in elements.  Dimensions that are laid out
+ * back-to-back on both sides are merged first, so e.g. a full plane
+ * becomes one row.  Then each row goes as:
+ *
+ *   on-node (mapped):     copied directly
+ *   contiguous both ends: non-blocking put/get, all rows pipelined
+ *   remote contiguous:    packed/unpacked through a bounce buffer
+ *   remote strided:       pipelined non-blocking element puts/gets
+ *
+ * The blocking versions wait once on the endpoint at the end; the
+ * non-blocking ones leave everything to the next quiet.  Non-blocking
+ * packed puts give each chunk its own buffer, freed when sent (gets
+ * have to unpack, so still wait).
  */
 
+typedef struct subarray {
+  int ndims;
+  size_t count[SHMEMC_SUBARRAY_MAX_DIMS];
+  ptrdiff_t tst[SHMEMC_SUBARRAY_MAX_DIMS];
+  ptrdiff_t sst[SHMEMC_SUBARRAY_MAX_DIMS];
+} subarray_t;
+
 /*
- * bitwise helpers
- *
- * Newer versions of UCX now have native support for bitwise atomics:
- * we detect this during configure.
- *
+ * copy shape in, merging dimensions that are contiguous on both
+ * sides.  Return false if there's nothing to move.
  */
+static bool subarray_shape(subarray_t *sa, int ndims, const size_t *count,
+                           const ptrdiff_t *tst, const ptrdiff_t *sst) {
+  int d;
 
-#ifdef HAVE_UCP_BITWISE_ATOMICS
+  shmemu_assert((ndims > 0) && (ndims <= SHMEMC_SUBARRAY_MAX_DIMS),
+                MODULE ": subarray dimensions %d not in range 1..%d", ndims,
+                SHMEMC_SUBARRAY_MAX_DIMS);
 
-#define MAKE_UCP_FETCH_OP(_op) UCP_ATOMIC_FETCH_OP_F##_op
-#define MAKE_UCP_POST_OP(_op) UCP_ATOMIC_POST_OP_##_op
+  sa->ndims = 0;
 
-#define HELPER_BITWISE_FETCH_ATOMIC(_ucp_op, _opname)                          \
-  inline static void helper_atomic_fetch_##_opname(                            \
-      shmemc_context_h ch, void *t, void *vp, size_t vs, int pe, void *retp) { \
-    const ucs_status_t s = helper_fetching_amo(ch, MAKE_UCP_FETCH_OP(_ucp_op), \
-                                               t, vp, vs, pe, retp);           \
-                                                                               \
-    /* value came back? */                                                     \
-    shmemu_assert(s == UCS_OK,                                                 \
-                  MODULE ": AMO fetch op \"%s\" failed (status: %s)",          \
-                  #_opname, ucs_status_string(s));                             \
+  for (d = 0; d < ndims; ++d) {
+    if (count[d] == 0) {
+      return false;
+      /* NOT REACHED */
+    }
   }
 
-HELPER_BITWISE_FETCH_ATOMIC(AND, and)
-HELPER_BITWISE_FETCH_ATOMIC(OR, or)
-HELPER_BITWISE_FETCH_ATOMIC(XOR, xor)
+  for (d = 0; d < ndims; ++d) {
+    /* single-element dimensions don't go anywhere */
+    if (count[d] == 1) {
+      continue;
+    }
 
-#define HELPER_BITWISE_FETCH_ATOMIC_NBI(_ucp_op, _opname)                      \
-  inline static void helper_atomic_fetch_##_opname##_nbi(                      \
-      shmemc_context_h ch, void *t, void *vp, size_t vs, int pe, void *retp) { \
-    const ucs_status_ptr_t sp = helper_fetching_amo_nbi(                       \
-        ch, MAKE_UCP_FETCH_OP(_ucp_op), t, vp, vs, pe, retp);                  \
-                                                                               \
-    shmemu_assert(!UCS_PTR_IS_ERR(sp),                                         \
-                  MODULE ": AMO fetch nbi op \"%s\" failed", #_opname);        \
-  }
+    if (sa->ndims > 0) {
+      const int in = sa->ndims - 1;
+
+      /* does previous dimension step exactly over this one? */
+      if ((sa->tst[in] == tst[d] * (ptrdiff_t)count[d]) &&
+          (sa->sst[in] == sst[d] * (ptrdiff_t)count[d])) {
+        sa->count[in] *= count[d];
+        sa->tst[in] = tst[d];
+        sa->sst[in] = sst[d];
+        continue;
+      }
+    }
 
-HELPER_BITWISE_FETCH_ATOMIC_NBI(AND, and)
-HELPER_BITWISE_FETCH_ATOMIC_NBI(OR, or)
-HELPER_BITWISE_FETCH_ATOMIC_NBI(XOR, xor)
+    sa->count[sa->ndims] = count[d];
+    sa->tst[sa->ndims] = tst[d];
+    sa->sst[sa->ndims] = sst[d];
+    ++sa->ndims;
+  }
 
-#define HELPER_BITWISE_ATOMIC(_ucp_op, _opname)                                \
-  inline static void helper_atomic_##_opname(shmemc_context_h ch, void *t,     \
-                                             void *vp, size_t vs, int pe) {    \
-    const ucs_status_t s =                                                     \
-        helper_posted_amo(ch, MAKE_UCP_POST_OP(_ucp_op), t, vp, vs, pe);       \
-                                                                               \
-    shmemu_assert(s == UCS_OK,                                                 \
-                  MODULE ": AMO post op \"%s\" failed (status: %s)", #_opname, \
-                  ucs_status_string(s));                                       \
+  /* just the one element */
+  if (sa->ndims == 0) {
+    sa->count[0] = 1;
+    sa->tst[0] = 1;
+    sa->sst[0] = 1;
+    sa->ndims = 1;
   }
 
-HELPER_BITWISE_ATOMIC(AND, and)
-HELPER_BITWISE_ATOMIC(OR, or)
-HELPER_BITWISE_ATOMIC(XOR, xor)
+  return true;
+}
 
-#else /* ! HAVE_UCP_BITWISE_ATOMICS */
+/*
+ * walk the outer dimensions: step row offsets (in bytes) on to the
+ * next row, return false when done
+ */
+static bool subarray_next_row(const subarray_t *sa, size_t *idx,
+                              ptrdiff_t *toff, ptrdiff_t *soff,
+                              size_t elsize) {
+  int d;
+
+  for (d = sa->ndims - 2; d >= 0; --d) {
+    const ptrdiff_t tst_nb = sa->tst[d] * (ptrdiff_t)elsize;
+    const ptrdiff_t sst_nb = sa->sst[d] * (ptrdiff_t)elsize;
+
+    if (++idx[d] < sa->count[d]) {
+      *toff += tst_nb;
+      *soff += sst_nb;
+      return true;
+      /* NOT REACHED */
+    }
 
-#define HELPER_BITWISE_FETCH_ATOMIC(_op, _opname)                              \
-  inline static void helper_atomic_fetch_##_opname(                            \
-      shmemc_context_h ch, void *t, void *vp, size_t vs, int pe, void *retp) { \
-    /* make sure zeroed for smaller types */                                   \
-    uint64_t ret = 0, rval = 0, rval_orig = 0, vcomp = 0;                      \
-    ucs_status_t s;                                                            \
-    uint64_t r_t;                                                              \
-    ucp_rkey_h r_key;                                                          \
-    ucp_ep_h ep;                                                               \
-                                                                               \
-    memcpy(&vcomp, vp, vs); /* save comparator */                              \
-    get_remote_key_and_addr(ch, (uint64_t)t, pe, &r_key, &r_t);                \
-    ep = lookup_ucp_ep(ch, pe);                                                \
-                                                                               \
-    do {                                                                       \
-      s = ucp_get(ep, &rval_orig, sizeof(rval_orig), r_t, r_key);              \
-      shmemu_assert(s == UCS_OK,                                               \
-                    MODULE ": AMO fetch failed in CAS (status: %s)",           \
-                    ucs_status_string(s));                                     \
-      rval = (rval_orig)_op vcomp;                                             \
-                                                                               \
-      s = ucp_atomic_cswap64(ep, rval_orig, rval, r_t, r_key, &ret);           \
-    } while (ret != rval_orig);                                                \
-                                                                               \
-    memcpy(retp, &ret, vs); /* copy out answer */                              \
+    /* rewind this dimension, carry into the next one out */
+    *toff -= tst_nb * (ptrdiff_t)(sa->count[d] - 1);
+    *soff -= sst_nb * (ptrdiff_t)(sa->count[d] - 1);
+    idx[d] = 0;
+  }
+
+  return false;
+}
+
+static void put_subarray(shmem_ctx_t ctx, void *dest, const void *src,
+                         size_t elsize, int ndims, const size_t *count,
+                         const ptrdiff_t *tst, const ptrdiff_t *sst, int pe,
+                         bool nbi) {
+  shmemc_context_h ch = (shmemc_context_h)ctx;
+  size_t idx[SHMEMC_SUBARRAY_MAX_DIMS] = {0};
+  ptrdiff_t toff = 0, soff = 0;
+  subarray_t sa;
+  size_t rlen;
+  ptrdiff_t rtst, rsst;
+  char *mp;
+  char *bounce = NULL;
+  uint64_t r_dest = 0;
+  ucp_rkey_h r_key = NULL;
+  ucp_ep_h ep = NULL;
+#ifdef HAVE_UCP_PUT_NBX
+  const bool gather_nbi = nbi;
+#else
+  const bool gather_nbi = false; /* can't free bounce buffers later */
+#endif /* HAVE_UCP_PUT_NBX */
+
+  if (!subarray_shape(&sa, ndims, count, tst, sst)) {
+    return;
+    /* NOT REACHED */
   }
 
-HELPER_BITWISE_FETCH_ATOMIC(|, or)
-HELPER_BITWISE_FETCH_ATOMIC(&, and)
-HELPER_BITWISE_FETCH_ATOMIC(^, xor)
+  rlen = sa.count[sa.ndims - 1];
+  rtst = sa.tst[sa.ndims - 1];
+  rsst = sa.sst[sa.ndims - 1];
 
-#define HELPER_BITWISE_FETCH_ATOMIC_NBI(_ucp_op, _opname)                      \
-  inline static void helper_atomic_fetch_##_opname##_nbi(                      \
-      shmemc_context_h ch, void *t, void *vp, size_t vs, int pe, void *retp) { \
-    helper_atomic_fetch_##_opname(ch, t, vp, vs, pe, retp);                    \
+  mp = (char *)lookup_mapped_addr(ch, (uint64_t)dest, pe);
+
+  if (mp == NULL) {
+    if ((rtst == 1) && (rsst != 1) && !gather_nbi) {
+      bounce = bounce_alloc(elsize);
+    } else {
+      get_remote_key_and_addr(ch, (uint64_t)dest, pe, &r_key, &r_dest);
+      ep = lookup_ucp_ep(ch, pe);
+    }
   }
 
-HELPER_BITWISE_FETCH_ATOMIC_NBI(AND, and)
-HELPER_BITWISE_FETCH_ATOMIC_NBI(OR, or)
-HELPER_BITWISE_FETCH_ATOMIC_NBI(XOR, xor)
+  do {
+    const char *sp = (const char *)src + soff;
 
-#define HELPER_BITWISE_ATOMIC(_opname)                                         \
-  inline static void helper_atomic_##_opname(shmemc_context_h ch, void *t,     \
-                                             void *vp, size_t vs, int pe) {    \
-    uint64_t discard;                                                          \
-                                                                               \
-    (void)helper_atomic_fetch_##_opname(ch, t, vp, vs, pe, &discard);          \
-  }
+    if (mp != NULL) {
+      strided_copy(mp + toff, sp, rtst, rsst, rlen, elsize);
+    } else if (bounce != NULL) {
+      put_gathered(ctx, (char *)dest + toff, sp, rsst, rlen, elsize, pe,
+                   bounce);
+#ifdef HAVE_UCP_PUT_NBX
+    } else if ((rtst == 1) && (rsst != 1)) {
+      put_gathered_nbi(ep, r_dest + toff, r_key, sp, rsst, rlen, elsize);
+#endif /* HAVE_UCP_PUT_NBX */
+    } else if (rtst == 1) {
+      const ucs_status_t s =
+          ucp_put_nbi(ep, sp, rlen * elsize, r_dest + toff, r_key);
 
-HELPER_BITWISE_ATOMIC(or)
-HELPER_BITWISE_ATOMIC(and)
-HELPER_BITWISE_ATOMIC(xor)
+      shmemu_assert(s == UCS_OK || s == UCS_INPROGRESS,
+                    MODULE ": subarray put failed (status: %s)",
+                    ucs_status_string(s));
+    } else {
+      put_elements(ep, r_dest + toff, r_key, sp, rtst, rsst, rlen, elsize);
+    }
+  } while (subarray_next_row(&sa, idx, &toff, &soff, elsize));
 
-#endif /* HAVE_UCP_BITWISE_ATOMICS */
+  free(bounce);
 
-/*
- * fetched-bitwise
- */
+  if (ep != NULL) {
+    if (nbi) {
+      mark_unflushed(ch);
+    } else {
+      flush_ep(ch, ep);
+    }
+  }
+}
 
-#define SHMEMC_CTX_FETCH_BITWISE(_op)                                          \
-  void shmemc_ctx_fetch_##_op(shmem_ctx_t ctx, void *t, void *vp, size_t vs,   \
-                              int pe, void *retp) {                            \
-    shmemc_context_h ch = (shmemc_context_h)ctx;                               \
-                                                                               \
-    helper_atomic_fetch_##_op(ch, t, vp, vs, pe, retp);                        \
+static void get_subarray(shmem_ctx_t ctx, void *dest, const void *src,
+                         size_t elsize, int ndims, const size_t *count,
+                         const ptrdiff_t *tst, const ptrdiff_t *sst, int pe,
+                         bool nbi) {
+  shmemc_context_h ch = (shmemc_context_h)ctx;
+  size_t idx[SHMEMC_SUBARRAY_MAX_DIMS] = {0};
+  ptrdiff_t toff = 0, soff = 0;
+  subarray_t sa;
+  size_t rlen;
+  ptrdiff_t rtst, rsst;
+  char *mp;
+  char *bounce = NULL;
+  uint64_t r_src = 0;
+  ucp_rkey_h r_key = NULL;
+  ucp_ep_h ep = NULL;
+
+  if (!subarray_shape(&sa, ndims, count, tst, sst)) {
+    return;
+    /* NOT REACHED */
   }
 
-SHMEMC_CTX_FETCH_BITWISE(and)
-SHMEMC_CTX_FETCH_BITWISE(or)
-SHMEMC_CTX_FETCH_BITWISE(xor)
+  rlen = sa.count[sa.ndims - 1];
+  rtst = sa.tst[sa.ndims - 1];
+  rsst = sa.sst[sa.ndims - 1];
 
-/*
- * bitwise
- */
+  mp = (char *)lookup_mapped_addr(ch, (uint64_t)src, pe);
 
-#define SHMEMC_CTX_BITWISE(_op)                                                \
-  void shmemc_ctx_##_op(shmem_ctx_t ctx, void *t, void *vp, size_t vs,         \
-                        int pe) {                                              \
-    shmemc_context_h ch = (shmemc_context_h)ctx;                               \
-                                                                               \
-    helper_atomic_##_op(ch, t, vp, vs, pe);                                    \
+  if (mp == NULL) {
+    if (rsst == 1 && rtst != 1) {
+      bounce = bounce_alloc(elsize);
+    } else {
+      get_remote_key_and_addr(ch, (uint64_t)src, pe, &r_key, &r_src);
+      ep = lookup_ucp_ep(ch, pe);
+    }
   }
 
-SHMEMC_CTX_BITWISE(and)
-SHMEMC_CTX_BITWISE(or)
-SHMEMC_CTX_BITWISE(xor)
-
-/*
- * set/fetch
- */
+  do {
+    char *dp = (char *)dest + toff;
 
-void shmemc_ctx_set(shmem_ctx_t ctx, void *tp, size_t ts, void *vp, size_t vs,
-                    int pe) {
-  uint64_t zap;
+    if (mp != NULL) {
+      strided_copy(dp, mp + soff, rtst, rsst, rlen, elsize);
+    } else if (bounce != NULL) {
+      get_scattered(ctx, dp, (const char *)src + soff, rtst, rlen, elsize, pe,
+                    bounce);
+    } else if (rsst == 1) {
+      const ucs_status_t s =
+          ucp_get_nbi(ep, dp, rlen * elsize, r_src + soff, r_key);
 
-  NO_WARN_UNUSED(ts);
+      shmemu_assert(s == UCS_OK || s == UCS_INPROGRESS,
+                    MODULE ": subarray get failed (status: %s)",
+                    ucs_status_string(s));
+    } else {
+      get_elements(ep, dp, r_src + soff, r_key, rtst, rsst, rlen, elsize);
+    }
+  } while (subarray_next_row(&sa, idx, &toff, &soff, elsize));
 
-  shmemc_ctx_swap(ctx, tp, vp, vs, pe, &zap);
+  free(bounce);
 
-  NO_WARN_UNUSED(zap);
+  if (ep != NULL) {
+    if (nbi) {
+      mark_unflushed(ch);
+    } else {
+      flush_ep(ch, ep);
+    }
+  }
 }
 
-void shmemc_ctx_fetch(shmem_ctx_t ctx, void *tp, size_t ts, int pe,
-                      void *valp) {
-  uint64_t zero = 0;
+void shmemc_ctx_put_subarray(shmem_ctx_t ctx, void *dest, const void *src,
+                             size_t elsize, int ndims, const size_t *count,
+                             const ptrdiff_t *tst, const ptrdiff_t *sst,
+                             int pe) {
+  put_subarray(ctx, dest, src, elsize, ndims, count, tst, sst, pe, false);
+}
 
-  shmemc_ctx_fadd(ctx, tp, &zero, ts, pe, valp);
+void shmemc_ctx_put_subarray_nbi(shmem_ctx_t ctx, void *dest, const void *src,
+                                 size_t elsize, int ndims, const size_t *count,
+                                 const ptrdiff_t *tst, const ptrdiff_t *sst,
+                                 int pe) {
+  put_subarray(ctx, dest, src, elsize, ndims, count, tst, sst, pe, true);
 }
 
-void shmemc_ctx_fetch_nbi(shmem_ctx_t ctx, void *tp, size_t ts, int pe,
-                          void *valp) {
-  uint64_t zero = 0;
+void shmemc_ctx_get_subarray(shmem_ctx_t ctx, void *dest, const void *src,
+                             size_t elsize, int ndims, const size_t *count,
+                             const ptrdiff_t *tst, const ptrdiff_t *sst,
+                             int pe) {
+  get_subarray(ctx, dest, src, elsize, ndims, count, tst, sst, pe, false);
+}
 
-  shmemc_ctx_fadd_nbi(ctx, tp, &zero, ts, pe, valp);
+void shmemc_ctx_get_subarray_nbi(shmem_ctx_t ctx, void *dest, const void *src,
+                                 size_t elsize, int ndims, const size_t *count,
+                                 const ptrdiff_t *tst, const ptrdiff_t *sst,
+                                 int pe) {
+  get_subarray(ctx, dest, src, elsize, ndims, count, tst, sst, pe, true);
 }
 
 /*
- * -- puts & gets --------------------------------------------------------
+ * -- vectored puts & gets ----------------------------------------------
+ *
+ * A batch of independent transfers, possibly to many PEs.  Sort them
+ * by PE and address first, so the endpoint, region and key only get
+ * looked up when they change, then post each one as cheaply as we
+ * can.
+ *
+ * If asked for, "completed" goes up by one as each transfer completes
+ * locally (source reusable for puts, dest filled in for gets).
  */
 
-void shmemc_ctx_put(shmem_ctx_t ctx, void *dest, const void *src, size_t nbytes,
-                    int pe) {
-  shmemc_context_h ch = (shmemc_context_h)ctx;
-  uint64_t r_dest;  /* address on other PE */
-  ucp_rkey_h r_key; /* rkey for remote address */
-  ucp_ep_h ep;
-#if defined(HAVE_UCP_PUT_NBX) || defined(HAVE_UCP_PUT_NB)
-  ucs_status_ptr_t sp;
-#endif /* HAVE_UCP_PUT_NBX || HAVE_UCP_PUT_NB */
-  ucs_status_t s;
+typedef struct vec_key {
+  int pe;
+  uint64_t addr; /* symmetric side */
+  size_t i;      /* index into caller's arrays */
+} vec_key_t;
 
-  get_remote_key_and_addr(ch, (uint64_t)dest, pe, &r_key, &r_dest);
-  ep = lookup_ucp_ep(ch, pe);
+static int vec_key_cmp(const void *a, const void *b) {
+  const vec_key_t *ka = (const vec_key_t *)a;
+  const vec_key_t *kb = (const vec_key_t *)b;
 
-#ifdef HAVE_UCP_PUT_NBX
-  const ucp_request_param_t prm = {.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK,
-                                   .cb.send = noop_callbackx};
+  if (ka->pe != kb->pe) {
+    return (ka->pe < kb->pe) ? -1 : 1;
+    /* NOT REACHED */
+  }
+  if (ka->addr != kb->addr) {
+    return (ka->addr < kb->addr) ? -1 : 1;
+    /* NOT REACHED */
+  }
 
-  sp = ucp_put_nbx(ep, src, nbytes, r_dest, r_key, &prm);
-  s = check_wait_for_request(ch, sp);
-#elif defined(HAVE_UCP_PUT_NB)
-  sp = ucp_put_nb(ep, src, nbytes, r_dest, r_key, noop_callback);
-  s = check_wait_for_request(ch, sp);
-#else  /* ! HAVE_UCP_PUT_NB */
-  s = ucp_put(ep, src, nbytes, r_dest, r_key);
-#endif /* HAVE_UCP_PUT_NBX */
+  return 0;
+}
 
-  shmemu_assert(s == UCS_OK, MODULE ": put failed (status: %s)",
-                ucs_status_string(s));
+inline static void vec_count(uint64_t *completed, uint64_t n) {
+  if (completed != NULL) {
+    __atomic_add_fetch(completed, n, __ATOMIC_RELEASE);
+  }
 }
 
-void shmemc_ctx_get(shmem_ctx_t ctx, void *dest, const void *src, size_t nbytes,
-                    int pe) {
-  shmemc_context_h ch = (shmemc_context_h)ctx;
-  uint64_t r_src;
-  ucp_rkey_h r_key;
-  ucp_ep_h ep;
-#if defined(HAVE_UCP_GET_NBX) || defined(HAVE_UCP_GET_NB)
-  ucs_status_ptr_t sp;
-#endif /* HAVE_UCP_GET_NBX || HAVE_UCP_GET_NB */
+/*
+ * post one transfer.  Returns true if "completed" still needs bumping
+ * for it once the context's been flushed.
+ */
+inline static bool vec_post(ucp_ep_h ep, void *lp, size_t nbytes,
+                            uint64_t r_addr, ucp_rkey_h r_key,
+                            uint64_t *completed, bool is_put) {
   ucs_status_t s;
 
-  get_remote_key_and_addr(ch, (uint64_t)src, pe, &r_key, &r_src);
-  ep = lookup_ucp_ep(ch, pe);
-
-#ifdef HAVE_UCP_GET_NBX
-  const ucp_request_param_t prm = {.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK,
-                                   .cb.send = noop_callbackx};
+#if defined(HAVE_UCP_PUT_NBX) && defined(HAVE_UCP_GET_NBX)
+  if (completed != NULL) {
+    const ucp_request_param_t prm = {.op_attr_mask =
+                                         UCP_OP_ATTR_FIELD_CALLBACK |
+                                         UCP_OP_ATTR_FIELD_USER_DATA,
+                                     .cb.send = counter_callbackx,
+                                     .user_data = completed};
+    ucs_status_ptr_t sp;
+
+    sp = is_put ? ucp_put_nbx(ep, lp, nbytes, r_addr, r_key, &prm)
+                : ucp_get_nbx(ep, lp, nbytes, r_addr, r_key, &prm);
+    if (sp == NULL) {
+      vec_count(completed, 1);
+    } else {
+      shmemu_assert(!UCS_PTR_IS_ERR(sp),
+                    MODULE ": vectored %s failed (status: %s)",
+                    is_put ? "put" : "get",
+                    ucs_status_string(UCS_PTR_STATUS(sp)));
+    }
+    return false;
+    /* NOT REACHED */
+  }
+#endif /* HAVE_UCP_PUT_NBX && HAVE_UCP_GET_NBX */
 
-  sp = ucp_get_nbx(ep, dest, nbytes, r_src, r_key, &prm);
-  s = check_wait_for_request(ch, sp);
-#elif defined(HAVE_UCP_GET_NB)
-  sp = ucp_get_nb(ep, dest, nbytes, r_src, r_key, noop_callback);
-  s = check_wait_for_request(ch, sp);
-#else  /* ! HAVE_UCP_GET_NB */
-  s = ucp_get(ep, dest, nbytes, r_src, r_key);
-#endif /* HAVE_UCP_GET_NB */
+  s = is_put ? ucp_put_nbi(ep, lp, nbytes, r_addr, r_key)
+             : ucp_get_nbi(ep, lp, nbytes, r_addr, r_key);
+  shmemu_assert(s == UCS_OK || s == UCS_INPROGRESS,
+                MODULE ": vectored %s failed (status: %s)",
+                is_put ? "put" : "get", ucs_status_string(s));
 
-  shmemu_assert(s == UCS_OK, MODULE ": get failed (status: %s)",
-                ucs_status_string(s));
+  return (completed != NULL);
 }
 
-/*
- * strided ops currently build on put/get in upper API
- */
+static void rma_vec(shmemc_context_h ch, void *const *dests,
+                    const void *const *srcs, const size_t *nbytes,
+                    const int *pes, size_t nops, uint64_t *completed,
+                    bool is_put) {
+  vec_key_t *keys;
+  const mem_access_t *map = NULL;
+  ucp_ep_h ep = NULL;
+  int cur_pe = -1;
+  long r = -1;
+  uint64_t pending = 0; /* waiting on a flush to count */
+  size_t k;
+
+  if (nops == 0) {
+    return;
+    /* NOT REACHED */
+  }
 
-/**
- * Return status from UCP nbi routines probably needs more handling
- *
- */
+  keys = (vec_key_t *)malloc(nops * sizeof(*keys));
+  shmemu_assert(keys != NULL,
+                MODULE ": can't allocate memory for vectored transfer");
 
-void shmemc_ctx_put_nbi(shmem_ctx_t ctx, void *dest, const void *src,
-                        size_t nbytes, int pe) {
-  shmemc_context_h ch = (shmemc_context_h)ctx;
-  uint64_t r_dest;
-  ucp_rkey_h r_key;
-  ucp_ep_h ep;
-  ucs_status_t s;
+  for (k = 0; k < nops; ++k) {
+    keys[k].pe = pes[k];
+    keys[k].addr = is_put ? (uint64_t)dests[k] : (uint64_t)srcs[k];
+    keys[k].i = k;
+  }
+  qsort(keys, nops, sizeof(*keys), vec_key_cmp);
 
-  get_remote_key_and_addr(ch, (uint64_t)dest, pe, &r_key, &r_dest);
-  ep = lookup_ucp_ep(ch, pe);
+  for (k = 0; k < nops; ++k) {
+    const size_t i = keys[k].i;
+    const uint64_t addr = keys[k].addr;
+    void *lp = is_put ? (void *)srcs[i] : dests[i];
 
-  s = ucp_put_nbi(ep, src, nbytes, r_dest, r_key);
-  shmemu_assert(s == UCS_OK || s == UCS_INPROGRESS,
-                MODULE ": non-blocking put failed");
-}
+    if (keys[k].pe != cur_pe) {
+      cur_pe = keys[k].pe;
+      ep = NULL;
+      r = -1;
+    }
 
-void shmemc_ctx_get_nbi(shmem_ctx_t ctx, void *dest, const void *src,
-                        size_t nbytes, int pe) {
-  shmemc_context_h ch = (shmemc_context_h)ctx;
-  uint64_t r_src;
-  ucp_rkey_h r_key;
-  ucp_ep_h ep;
-  ucs_status_t s;
+    if ((r < 0) || !in_region(addr, (size_t)r)) {
+      map = lookup_access(ch, addr, cur_pe, &r);
+      shmemu_assert(map != NULL, MODULE ": can't find memory region for %p",
+                    (void *)addr);
+    }
 
-  get_remote_key_and_addr(ch, (uint64_t)src, pe, &r_key, &r_src);
-  ep = lookup_ucp_ep(ch, pe);
+    if (nbytes[i] == 0) {
+      vec_count(completed, 1);
+      continue;
+    }
 
-  s = ucp_get_nbi(ep, dest, nbytes, r_src, r_key);
-  shmemu_assert(s == UCS_OK || s == UCS_INPROGRESS,
-                MODULE ": non-blocking get failed");
+    /* on-node: just copy */
+    if (map->mapped != NULL) {
+      void *mp = mapped_addr(map, r, addr);
+
+      if (is_put) {
+        memmove(mp, lp, nbytes[i]);
+      } else {
+        memmove(lp, mp, nbytes[i]);
+      }
+      vec_count(completed, 1);
+      continue;
+    }
+
+    {
+      const uint64_t r_addr = translate_region_address(addr, r, cur_pe);
+
+      /* small put to off-node PE: batch it up */
+      if (is_put && (ch->agg.bufs != NULL) &&
+          (nbytes[i] <= proc.env.agg_put_max)) {
+        shmemc_ucx_agg_put(ch, r_addr, lp, nbytes[i], cur_pe);
+        vec_count(completed, 1);
+        continue;
+      }
+
+      if (ep == NULL) {
+        ep = lookup_ucp_ep(ch, cur_pe);
+      }
+
+      if (vec_post(ep, lp, nbytes[i], r_addr, map->rkey, completed, is_put)) {
+        ++pending;
+      }
+      mark_unflushed(ch);
+    }
+  }
+
+  free(keys);
+
+  /*
+   * no per-transfer completion without NBX, so once everything's
+   * posted, one quiet covers the lot
+   */
+  if (pending > 0) {
+    shmemc_ctx_quiet((shmem_ctx_t)ch);
+    vec_count(completed, pending);
+  }
+}
+
+void shmemc_ctx_putv_nbi(shmem_ctx_t ctx, void *const *dests,
+                         const void *const *srcs, const size_t *nbytes,
+                         const int *pes, size_t nops, uint64_t *completed) {
+  rma_vec((shmemc_context_h)ctx, dests, srcs, nbytes, pes, nops, completed,
+          true);
+}
+
+void shmemc_ctx_getv_nbi(shmem_ctx_t ctx, void *const *dests,
+                         const void *const *srcs, const size_t *nbytes,
+                         const int *pes, size_t nops, uint64_t *completed) {
+  rma_vec((shmemc_context_h)ctx, dests, srcs, nbytes, pes, nops, completed,
+          false);
 }
 
 /*
@@ -786,7 +2461,8 @@ void shmemc_ctx_put_signal(shmem_ctx_t ctx, void *dest, const void *src,
                            int sig_op, int pe) {
 
   shmemc_ctx_put(ctx, dest, src, nbytes, pe);
-  shmemc_ctx_fence(ctx);
+  /* only the put to this PE has to land before the signal */
+  shmemc_ctx_fence_pe(ctx, pe);
 
   switch (sig_op) {
   case SHMEM_SIGNAL_SET:
@@ -803,28 +2479,160 @@ void shmemc_ctx_put_signal(shmem_ctx_t ctx, void *dest, const void *src,
   }
 }
 
+#if defined(HAVE_UCP_EP_FLUSH_NBX) && defined(HAVE_UCP_ATOMIC_OP_NBX)
+
 /*
- * TODO HACK1: just use blocking implementation for testing
+ * UCX doesn't order a put against a later AMO on the same endpoint,
+ * so the signal is chained off a flush of just that endpoint rather
+ * than fencing the whole worker.  Completion of both comes at the
+ * next quiet.
  */
 
-void shmemc_ctx_put_signal_nbi(shmem_ctx_t ctx, void *dest, const void *src,
-                               size_t nbytes, uint64_t *sig_addr,
-                               uint64_t signal, int sig_op, int pe) {
+typedef struct signal_desc {
+  shmemc_context_h ch;
+  ucp_ep_h ep;
+  ucp_rkey_h r_key;
+  uint64_t r_sig;
+  uint64_t signal;
+  int sig_op;
+} signal_desc_t;
 
-  shmemc_ctx_put(ctx, dest, src, nbytes, pe);
-  shmemc_ctx_fence(ctx);
+inline static void post_signal(signal_desc_t *sdp) {
+  ucp_atomic_op_t op;
 
-  switch (sig_op) {
+  switch (sdp->sig_op) {
   case SHMEM_SIGNAL_SET:
-    shmemc_ctx_set(ctx, sig_addr, sizeof(*sig_addr), &signal, sizeof(signal),
-                   pe);
+    op = UCP_ATOMIC_OP_SWAP;
     break;
   case SHMEM_SIGNAL_ADD:
-    shmemc_ctx_add(ctx, sig_addr, &signal, sizeof(signal), pe);
+    op = UCP_ATOMIC_OP_ADD;
     break;
   default:
-    shmemu_fatal(MODULE ": unknown signal operation code %d", sig_op);
+    shmemu_fatal(MODULE ": unknown signal operation code %d", sdp->sig_op);
     /* NOT REACHED */
-    break;
+    return;
+  }
+
+  /* set goes as a fetching swap whose old value is discarded */
+  post_amo_nbx(sdp->ch, sdp->ep, op, &sdp->signal, sizeof(sdp->signal),
+               sdp->r_sig, sdp->r_key);
+}
+
+inline static void release_signal(signal_desc_t *sdp) {
+  __atomic_sub_fetch(&sdp->ch->pending_signals, 1, __ATOMIC_RELEASE);
+  free(sdp);
+}
+
+static void signal_flush_callbackx(void *req, ucs_status_t status,
+                                   void *user_data) {
+  signal_desc_t *sdp = (signal_desc_t *)user_data;
+
+  shmemu_assert(status == UCS_OK,
+                MODULE ": put for non-blocking signal failed (status: %s)",
+                ucs_status_string(status));
+
+  post_signal(sdp);
+  release_signal(sdp);
+
+  ucp_request_free(req);
+}
+
+void shmemc_ctx_put_signal_nbi(shmem_ctx_t ctx, void *dest, const void *src,
+                               size_t nbytes, uint64_t *sig_addr,
+                               uint64_t signal, int sig_op, int pe) {
+  shmemc_context_h ch = (shmemc_context_h)ctx;
+  uint64_t r_dest;
+  ucp_rkey_h r_key;
+  ucp_ep_h ep;
+  signal_desc_t *sdp;
+  ucs_status_ptr_t sp;
+  void *mp;
+  const ucp_request_param_t put_prm = {.op_attr_mask =
+                                           UCP_OP_ATTR_FIELD_CALLBACK,
+                                       .cb.send = nb_callbackx};
+  ucp_request_param_t flush_prm = {.op_attr_mask =
+                                       UCP_OP_ATTR_FIELD_CALLBACK |
+                                       UCP_OP_ATTR_FIELD_USER_DATA,
+                                   .cb.send = signal_flush_callbackx};
+
+  mp = lookup_mapped_addr(ch, (uint64_t)dest, pe);
+  if (mp != NULL) {
+    uint64_t *ap;
+
+    /* data already there, just make it visible before the signal */
+    memmove(mp, src, nbytes);
+    LOAD_STORE_FENCE();
+
+    /* signal mapped too: the release orders it after the data */
+    ap = (uint64_t *)lookup_amo_addr(ch, (uint64_t)sig_addr, pe);
+    if (ap != NULL) {
+      if (sig_op == SHMEM_SIGNAL_SET) {
+        __atomic_store_n(ap, signal, __ATOMIC_RELEASE);
+      } else if (sig_op == SHMEM_SIGNAL_ADD) {
+        __atomic_add_fetch(ap, signal, __ATOMIC_RELEASE);
+      } else {
+        shmemu_fatal(MODULE ": unknown signal operation code %d", sig_op);
+        /* NOT REACHED */
+      }
+    } else {
+      signal_desc_t sd = {.ch = ch, .ep = lookup_ucp_ep(ch, pe),
+                          .signal = signal, .sig_op = sig_op};
+
+      get_remote_key_and_addr(ch, (uint64_t)sig_addr, pe, &sd.r_key,
+                              &sd.r_sig);
+      post_signal(&sd);
+    }
+    return;
+    /* NOT REACHED */
+  }
+
+  get_remote_key_and_addr(ch, (uint64_t)dest, pe, &r_key, &r_dest);
+  ep = lookup_ucp_ep(ch, pe);
+
+  sp = ucp_put_nbx(ep, src, nbytes, r_dest, r_key, &put_prm);
+  shmemu_assert(!UCS_PTR_IS_ERR(sp),
+                MODULE ": non-blocking put for signal failed (status: %s)",
+                ucs_status_string(UCS_PTR_STATUS(sp)));
+
+  mark_unflushed(ch);
+
+  sdp = (signal_desc_t *)malloc(sizeof(*sdp));
+  shmemu_assert(sdp != NULL,
+                MODULE ": can't allocate memory for non-blocking signal");
+
+  sdp->ch = ch;
+  sdp->ep = ep;
+  sdp->signal = signal;
+  sdp->sig_op = sig_op;
+  get_remote_key_and_addr(ch, (uint64_t)sig_addr, pe, &sdp->r_key,
+                          &sdp->r_sig);
+
+  __atomic_add_fetch(&ch->pending_signals, 1, __ATOMIC_RELAXED);
+
+  flush_prm.user_data = sdp;
+  sp = ucp_ep_flush_nbx(ep, &flush_prm);
+
+  if (sp == NULL) { /* put already done, signal now */
+    post_signal(sdp);
+    release_signal(sdp);
+  } else {
+    shmemu_assert(!UCS_PTR_IS_ERR(sp),
+                  MODULE ": can't order non-blocking signal (status: %s)",
+                  ucs_status_string(UCS_PTR_STATUS(sp)));
   }
 }
+
+#else /* ! (HAVE_UCP_EP_FLUSH_NBX && HAVE_UCP_ATOMIC_OP_NBX) */
+
+/*
+ * older UCX: no endpoint-scoped ordering to chain off, so fall back
+ * to the blocking implementation
+ */
+
+void shmemc_ctx_put_signal_nbi(shmem_ctx_t ctx, void *dest, const void *src,
+                               size_t nbytes, uint64_t *sig_addr,
+                               uint64_t signal, int sig_op, int pe) {
+  shmemc_ctx_put_signal(ctx, dest, src, nbytes, sig_addr, signal, sig_op, pe);
+}
+
+#endif /* HAVE_UCP_EP_FLUSH_NBX && HAVE_UCP_ATOMIC_OP_NBX */
@@ -10,6 +10,7 @@
 #include "ucx/api.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <ucp/api/ucp.h>
 
@@ -19,7 +20,7 @@
  * Return 0 on success, non-0 on failure
  */
 
-int shmemc_ucx_context_progress(shmemc_context_h ch) {
+static int create_worker(shmemc_context_h ch) {
   ucp_worker_params_t wkpm;
   ucs_status_t s;
 
@@ -39,9 +40,36 @@ int shmemc_ucx_context_progress(shmemc_context_h ch) {
     /* NOT REACHED */
   }
 
+  /* progress thread can help out */
+  if (wkpm.thread_mode == UCS_THREAD_MODE_MULTI) {
+    shmemc_ucx_live_add(ch);
+  }
+
+  return 0;
+}
+
+int shmemc_ucx_context_progress(shmemc_context_h ch) {
+  if (create_worker(ch) != 0) {
+    return 1;
+    /* NOT REACHED */
+  }
+
+  shmemc_ucx_agg_init(ch);
+
   return 0;
 }
 
+/*
+ * striping lanes only carry large puts and gets, so they don't need
+ * aggregation buffers or its handlers
+ */
+
+int shmemc_ucx_lane_progress(shmemc_context_h ch) {
+  memset(&ch->agg, 0, sizeof(ch->agg));
+
+  return create_worker(ch);
+}
+
 /*
  * Fill out info for default context
  *
@@ -8,11 +8,14 @@
 #include "shmemc.h"
 #include "shmemu.h"
 #include "callbacks.h"
+#include "pmi_client.h"
 #include "module.h"
 
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <errno.h>
+#include <pthread.h>
 
 #include <ucp/api/ucp.h>
 
@@ -116,9 +119,254 @@ ucs_status_t shmemc_ucx_rkey_pack(ucp_mem_h mh, void **packed_rkey_p,
   return ucp_rkey_pack(proc.comms.ucx_ctxt, mh, packed_rkey_p, rkey_len_p);
 }
 
-void shmemc_ucx_make_eps(shmemc_context_h ch) {
+/*
+ * has UCX been told to do all its atomics on the CPU?
+ */
+
+static bool ucx_cpu_atomics(void) {
+  const char *mode = getenv("UCX_ATOMIC_MODE");
+
+  return (mode != NULL) && (strcasecmp(mode, "cpu") == 0);
+}
+
+/*
+ * CPU atomics on a mapped heap only play nicely with the atomics
+ * other PEs issue if no-one uses NIC atomics on it.  PEs on other
+ * nodes can only get at it through a NIC, so in a multi-node job
+ * that needs UCX to be doing atomics on the CPU.
+ */
+
+static bool cpu_amo_coherent(void) {
+  if (proc.li.npeers == proc.li.nranks) {
+    return true;
+    /* NOT REACHED */
+  }
+
+  return ucx_cpu_atomics();
+}
+
+/*
+ * is transport "tl" in the comma-separated user list?
+ */
+
+static bool cpu_amo_tl_listed(const char *tl) {
+  const char *p = proc.env.cpu_amo_tls;
+  const size_t tlen = strlen(tl);
+
+  while (*p != '\0') {
+    const size_t n = strcspn(p, ",");
+
+    if ((n == tlen) && (strncasecmp(p, tl, n) == 0)) {
+      return true;
+      /* NOT REACHED */
+    }
+
+    p += n;
+    if (*p == ',') {
+      ++p;
+    }
+  }
+
+  return false;
+}
+
+/*
+ * Can AMOs to this PE be done with CPU atomics on its mapped heap?
+ * Decided per endpoint, by the transports UCX picked for it.  UCX
+ * doesn't say which of an endpoint's lanes carries its atomics, so
+ * every lane has to be on a listed transport: even on-node, UCX can
+ * put atomics on a NIC loopback lane next to shared-memory ones.
+ */
+
+#define MAX_EP_TRANSPORTS 16
+
+static bool cpu_amo_usable(ucp_ep_h ep, int pe) {
+  if (strcasecmp(proc.env.cpu_amo_tls, "none") == 0) {
+    return false;
+    /* NOT REACHED */
+  }
+
+  if (!cpu_amo_coherent()) {
+    return false;
+    /* NOT REACHED */
+  }
+
+  /* my own heap */
+  if (pe == proc.li.rank) {
+    return true;
+    /* NOT REACHED */
+  }
+
+#ifdef HAVE_UCP_EP_QUERY_TRANSPORTS
+  {
+    ucp_transport_entry_t tls[MAX_EP_TRANSPORTS];
+    ucp_ep_attr_t attr;
+    unsigned i;
+
+    attr.field_mask = UCP_EP_ATTR_FIELD_TRANSPORTS;
+    attr.transports.entries = tls;
+    attr.transports.num_entries = MAX_EP_TRANSPORTS;
+    attr.transports.entry_size = sizeof(tls[0]);
+
+    if (ucp_ep_query(ep, &attr) != UCS_OK) {
+      return false;
+      /* NOT REACHED */
+    }
+
+    for (i = 0; i < attr.transports.num_entries; ++i) {
+      if (!cpu_amo_tl_listed(tls[i].transport_name)) {
+        return false;
+        /* NOT REACHED */
+      }
+    }
+
+    return attr.transports.num_entries > 0;
+  }
+#else
+  /* can't ask, so only if UCX isn't using NIC atomics anywhere */
+  NO_WARN_UNUSED(ep);
+
+  return ucx_cpu_atomics();
+#endif /* HAVE_UCP_EP_QUERY_TRANSPORTS */
+}
+
+/*
+ * PEs sharing memory with me can have their heaps mapped straight
+ * into my address space, so puts & gets (& maybe AMOs) can bypass the
+ * network
+ */
+
+inline static void map_region(shmemc_context_h ch, size_t r, int pe,
+                              bool cpu_amo) {
+  mem_access_t *map = &ch->racc[r].rinfo[pe];
+
+  if (pe == proc.li.rank) {
+    map->mapped = (char *)proc.comms.regions[r].minfo[pe].base;
+  } else {
+#ifdef HAVE_UCP_RKEY_PTR
+    void *p;
+    const ucs_status_t s =
+        ucp_rkey_ptr(map->rkey, proc.comms.regions[r].minfo[pe].base, &p);
+
+    /* anything off-node just isn't reachable this way */
+    map->mapped = (s == UCS_OK) ? (char *)p : NULL;
+#else
+    map->mapped = NULL;
+#endif /* HAVE_UCP_RKEY_PTR */
+  }
+
+  map->cpu_amo = cpu_amo && (map->mapped != NULL);
+}
+
+/*
+ * create endpoint to PE and unpack its rkeys onto it.  The endpoint
+ * is only published once everything hanging off it is ready, since
+ * other threads look for it without taking the connect lock.
+ */
+
+inline static void connect_pe(shmemc_context_h ch, int pe) {
   ucp_ep_params_t epm;
+  ucp_ep_h ep;
   ucs_status_t s;
+  bool cpu_amo;
+  size_t r;
+
+  /* wire-up info might have been deferred until now */
+  if (proc.comms.xchg_wrkr_info[pe].buf == NULL) {
+    shmemc_pmi_fetch_wireup(pe);
+  }
+
+  epm.field_mask = UCP_EP_PARAM_FIELD_REMOTE_ADDRESS;
+  epm.address = (ucp_address_t *)proc.comms.xchg_wrkr_info[pe].buf;
+
+  s = ucp_ep_create(ch->w, &epm, &ep);
+  shmemu_assert(s == UCS_OK,
+                MODULE ": Unable to create remote endpoints "
+                       "for PE %d: %s",
+                pe, ucs_status_string(s));
+
+  cpu_amo = cpu_amo_usable(ep, pe);
+
+  for (r = 0; r < proc.comms.nregions; ++r) {
+    s = ucp_ep_rkey_unpack(ep, proc.comms.orks[r].rkeys[pe].data,
+                           &ch->racc[r].rinfo[pe].rkey);
+    shmemu_assert(s == UCS_OK,
+                  MODULE ": can't unpack remote rkey "
+                         "for memory region %lu, PE %d: %s",
+                  (unsigned long)r, pe, ucs_status_string(s));
+
+    map_region(ch, r, pe, cpu_amo);
+  }
+
+  __atomic_store_n(&ch->eps[pe], ep, __ATOMIC_RELEASE);
+}
+
+/*
+ * lazy connection: endpoints are made the first time a PE is
+ * targeted.  Contexts can be shared between threads, so only one
+ * gets to do the connecting.  Connecting can block in PMIx, so
+ * waiters sleep rather than spin.
+ */
+
+static pthread_mutex_t connect_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void shmemc_ucx_connect_pe(shmemc_context_h ch, int pe) {
+  pthread_mutex_lock(&connect_lock);
+
+  /* someone else might have got here first */
+  if (ch->eps[pe] == NULL) {
+    connect_pe(ch, pe);
+
+    logger(LOG_CONTEXTS, "context #%lu connected to PE %d on demand", ch->id,
+           pe);
+  }
+
+  pthread_mutex_unlock(&connect_lock);
+}
+
+/*
+ * connect up front to the PEs in the warm-up list, e.g. "0,4-7,12".
+ * Other threads can be connecting other contexts on demand, and the
+ * wireup fetch isn't thread-safe, so this takes the same lock.
+ */
+
+static void connect_warmup_pes(shmemc_context_h ch) {
+  int *pes = NULL;
+  size_t npes;
+  char *copy;
+  int s;
+
+  /* shmemu_parse_csv zaps the input string */
+  copy = strdup(proc.env.connect_warmup);
+  shmemu_assert(copy != NULL,
+                MODULE ": unable to allocate memory for PE warm-up list: %s",
+                strerror(errno));
+
+  s = shmemu_parse_csv(copy, &pes, &npes);
+  if (s > 0) {
+    size_t i;
+
+    pthread_mutex_lock(&connect_lock);
+
+    for (i = 0; i < npes; ++i) {
+      const int pe = pes[i];
+
+      if (shmemu_valid_pe_number(pe) && (ch->eps[pe] == NULL)) {
+        connect_pe(ch, pe);
+      }
+    }
+
+    pthread_mutex_unlock(&connect_lock);
+  } else {
+    shmemu_warn(MODULE ": ignoring malformed PE warm-up list \"%s\"",
+                proc.env.connect_warmup);
+  }
+
+  free(pes);
+  free(copy);
+}
+
+void shmemc_ucx_make_eps(shmemc_context_h ch) {
   size_t r;
   int pe;
 
@@ -144,28 +392,42 @@ void shmemc_ucx_make_eps(shmemc_context_h ch) {
                        "for context %lu: %s",
                 ch->id, strerror(errno));
 
-  /* create endpoints and unpack rkeys onto them */
+  /* globals always exist, good place to start translating */
+  ch->last_region = 0;
 
-  epm.field_mask = UCP_EP_PARAM_FIELD_REMOTE_ADDRESS;
+  ch->pending_signals = 0;
 
-  for (pe = 0; pe < proc.li.nranks; ++pe) {
+  ch->nbi_amos.cap = proc.env.nbi_amo_depth;
+  ch->nbi_amos.reqs = (void **)calloc(ch->nbi_amos.cap, sizeof(void *));
+  shmemu_assert(ch->nbi_amos.reqs != NULL,
+                MODULE ": can't allocate memory for non-blocking AMO "
+                       "requests for context %lu: %s",
+                ch->id, strerror(errno));
+  ch->nbi_amos.head = 0;
+  ch->nbi_amos.count = 0;
+  ch->nbi_amos.lock = 0;
 
-    epm.address = (ucp_address_t *)proc.comms.xchg_wrkr_info[pe].buf;
+  ch->unflushed = false;
 
-    s = ucp_ep_create(ch->w, &epm, &ch->eps[pe]);
+  ch->test_flush = NULL;
+  ch->test_lock = 0;
 
-    shmemu_assert(s == UCS_OK,
-                  MODULE ": Unable to create remote endpoints "
-                         "for PE %d: %s",
-                  pe, ucs_status_string(s));
-
-    for (r = 0; r < proc.comms.nregions; ++r) {
-      s = ucp_ep_rkey_unpack(ch->eps[pe], proc.comms.orks[r].rkeys[pe].data,
-                             &ch->racc[r].rinfo[pe].rkey);
-      shmemu_assert(s == UCS_OK,
-                    MODULE ": can't unpack remote rkey "
-                           "for memory region %lu, PE %d: %s",
-                    (unsigned long)r, pe, ucs_status_string(s));
+  threadwrap_mutex_init(&ch->api_lock);
+
+  ch->striped = false;
+
+  /* create endpoints and unpack rkeys onto them */
+
+  if (proc.env.lazy_connect) {
+    /* always talk to myself, anything else as & when */
+    connect_pe(ch, proc.li.rank);
+
+    if (proc.env.connect_warmup != NULL) {
+      connect_warmup_pes(ch);
+    }
+  } else {
+    for (pe = 0; pe < proc.li.nranks; ++pe) {
+      connect_pe(ch, pe);
     }
   }
 }
@@ -302,6 +302,39 @@ inline static void register_memory_regions(void) {
   }
 }
 
+/*
+ * regions never move once registered, so sort their local extents
+ * for address lookup in comms
+ */
+
+static int span_cmp(const void *a, const void *b) {
+  const mem_span_t *sa = (const mem_span_t *)a;
+  const mem_span_t *sb = (const mem_span_t *)b;
+
+  return (sa->base > sb->base) - (sa->base < sb->base);
+}
+
+inline static void init_region_spans(void) {
+  size_t r;
+
+  proc.comms.spans =
+      (mem_span_t *)calloc(proc.comms.nregions, sizeof(mem_span_t));
+  shmemu_assert(proc.comms.spans != NULL,
+                MODULE ": can't allocate memory for region lookup");
+
+  for (r = 0; r < proc.comms.nregions; ++r) {
+    const mem_info_t *mip = &proc.comms.regions[r].minfo[proc.li.rank];
+
+    proc.comms.spans[r].base = mip->base;
+    proc.comms.spans[r].end = mip->end;
+    proc.comms.spans[r].region = (long)r;
+  }
+
+  qsort(proc.comms.spans, proc.comms.nregions, sizeof(mem_span_t), span_cmp);
+}
+
+inline static void finalize_region_spans(void) { free(proc.comms.spans); }
+
 inline static void deregister_memory_regions(void) {
   size_t hi;
 
@@ -378,6 +411,20 @@ inline static void ucx_init_ready(void) {
                 UCP_FEATURE_AMO32 | /* 32-bit atomics */
                 UCP_FEATURE_AMO64;  /* 64-bit atomics */
 
+#ifdef HAVE_UCP_AM_SEND_NBX
+  if ((proc.env.agg_put_max > 0) || proc.env.active_messages) {
+    pm.features |= UCP_FEATURE_AM; /* batched puts, user messages */
+  }
+#endif /* HAVE_UCP_AM_SEND_NBX */
+
+  /* progress thread, or waiters, sleep on worker events */
+  proc.comms.wakeup =
+      ((proc.env.progress_threads != NULL) && proc.env.progress_events) ||
+      (proc.env.wait_block_ns > 0);
+  if (proc.comms.wakeup) {
+    pm.features |= UCP_FEATURE_WAKEUP;
+  }
+
   pm.mt_workers_shared = (proc.td.osh_tl > SHMEM_THREAD_SINGLE);
 
   /* estimated program size */
@@ -409,6 +456,7 @@ void shmemc_ucx_init(void) {
   /* make remote memory usable */
   init_memory_regions();
   register_memory_regions();
+  init_region_spans();
 
   /* master copy of exchanged rkeys */
   opaque_rkeys_init();
@@ -443,6 +491,8 @@ void shmemc_ucx_init(void) {
 void shmemc_ucx_finalize(void) {
   shmemc_globalexit_finalize();
 
+  shmemc_ucx_am_finalize();
+
 #if 0
     contexts_table_finalize();
 #endif
@@ -455,6 +505,7 @@ void shmemc_ucx_finalize(void) {
 
   opaque_rkeys_finalize();
 
+  finalize_region_spans();
   deregister_memory_regions();
 
   ucx_cleanup();
@@ -0,0 +1,91 @@
+/* For license: see LICENSE file at top-level */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include "shmemu.h"
+#include "shmemc.h"
+#include "state.h"
+#include "api.h"
+#include "module.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <ucp/api/ucp.h>
+
+/*
+ * Striping lanes
+ *
+ * A pool of internal contexts, each with its own worker and
+ * endpoints, that large puts and gets are split across.  They aren't
+ * in any team and users never see them: contexts that stripe onto
+ * them fold the lanes into their own fence and quiet.
+ */
+
+void shmemc_ucx_lanes_init(void) {
+  size_t i;
+
+  proc.comms.lanes = NULL;
+  proc.comms.nlanes = 0;
+  proc.comms.next_lane = 0;
+
+  /* one lane is no better than the context itself */
+  if (proc.env.stripe_lanes < 2) {
+    return;
+    /* NOT REACHED */
+  }
+
+  proc.comms.lanes = (shmemc_context_t *)calloc(proc.env.stripe_lanes,
+                                                sizeof(shmemc_context_t));
+  shmemu_assert(proc.comms.lanes != NULL,
+                MODULE ": can't allocate memory for %lu striping lanes: %s",
+                (unsigned long)proc.env.stripe_lanes, strerror(errno));
+
+  for (i = 0; i < proc.env.stripe_lanes; ++i) {
+    shmemc_context_h lp = &proc.comms.lanes[i];
+    ucs_status_t s;
+    int ret;
+
+    /* can be used by any thread at any time */
+    lp->attr.serialized = false;
+    lp->attr.privat = false;
+    lp->attr.nostore = false;
+
+    lp->id = i;
+    lp->creator_thread = threadwrap_thread_id();
+    lp->team = NULL;
+
+    ret = shmemc_ucx_lane_progress(lp);
+    shmemu_assert(ret == 0, MODULE ": can't create worker for striping lane %lu",
+                  (unsigned long)i);
+
+    shmemc_ucx_make_eps(lp);
+
+    s = shmemc_ucx_worker_wireup(lp);
+    shmemu_assert(s == UCS_OK,
+                  MODULE ": can't complete wireup for striping lane %lu: %s",
+                  (unsigned long)i, ucs_status_string(s));
+
+    ++proc.comms.nlanes;
+  }
+
+  logger(LOG_INIT, "striping puts/gets of at least %lu bytes over %lu lanes",
+         (unsigned long)proc.env.stripe_threshold,
+         (unsigned long)proc.comms.nlanes);
+}
+
+void shmemc_ucx_lanes_finalize(void) {
+  size_t i;
+
+  for (i = 0; i < proc.comms.nlanes; ++i) {
+    shmemc_ucx_teardown_context(&proc.comms.lanes[i]);
+  }
+
+  free(proc.comms.lanes);
+
+  proc.comms.lanes = NULL;
+  proc.comms.nlanes = 0;
+}
@@ -49,6 +49,8 @@ typedef struct mem_opaque {
  */
 typedef struct mem_access {
   ucp_rkey_h rkey; /* remote key for this heap */
+  char *mapped;    /* heap base mapped locally (on-node), or NULL */
+  bool cpu_amo;    /* AMOs can be CPU atomics on mapped heap */
 } mem_access_t;
 
 /**
@@ -76,6 +78,49 @@ typedef struct mem_region {
   mem_info_t *minfo; /**< nranks mem info */
 } mem_region_t;
 
+/**
+ * @brief Local extent of a memory region, for address lookup
+ */
+typedef struct mem_span {
+  uint64_t base; /* start of region on this PE */
+  uint64_t end;  /* end of region on this PE */
+  long region;   /* index into regions */
+} mem_span_t;
+
+/**
+ * @brief Outstanding non-blocking fetching AMOs on a context
+ *
+ * Oldest first, so completions can be reaped in order.
+ */
+typedef struct req_ring {
+  void **reqs;  /* UCX requests, "cap" slots */
+  size_t cap;   /* how many can be in flight */
+  size_t head;  /* oldest outstanding */
+  size_t count; /* how many outstanding */
+  char lock;    /* context can be shared between threads */
+} req_ring_t;
+
+/**
+ * @brief Small puts batched up for one PE
+ */
+typedef struct agg_buf {
+  char *data;  /* batch being filled, NULL if none yet */
+  size_t used; /* bytes filled */
+  bool listed; /* already in the context's dirty list? */
+  unsigned long unacked; /* batches sent but not yet unpacked */
+} agg_buf_t;
+
+/**
+ * @brief Small-put aggregation state of a context
+ */
+typedef struct put_agg {
+  agg_buf_t *bufs;       /* per PE, NULL if not aggregating */
+  int *dirty;            /* PEs with a non-empty batch */
+  size_t ndirty;         /* how many */
+  unsigned long unacked; /* batches sent but not yet unpacked */
+  char lock;             /* context can be shared between threads */
+} put_agg_t;
+
 /**
  * @brief Internal OpenSHMEM context management handle
  * @note There is a difference between UCX context and OpenSHMEM context
@@ -140,6 +185,14 @@ typedef struct shmemc_context_attr {
   bool nostore;
 } shmemc_context_attr_t;
 
+/**
+ * @brief How a context waits on local memory (see ucx/wait.c)
+ */
+typedef struct shmemc_wait_policy {
+  size_t spin_ns;  /* just poll for this long */
+  size_t block_ns; /* sleep on worker events after this long (0 = never) */
+} shmemc_wait_policy_t;
+
 /**
  * @brief Structure representing an OpenSHMEM context
  */
@@ -155,6 +208,26 @@ typedef struct shmemc_context {
 
   mem_region_access_t *racc; /* for endpoint remote access */
 
+  long last_region; /* region of most recent translation */
+
+  unsigned long pending_signals; /* nbi signals waiting on their put */
+
+  req_ring_t nbi_amos; /* fetching nbi AMOs in flight */
+  bool unflushed;      /* issued anything only a flush completes? */
+
+  uint64_t swap_discard; /* reply to posted swaps, never read */
+
+  void *test_flush; /* flush started by quiet_test, if any */
+  char test_lock;   /* serialize quiet_test callers */
+
+  threadwrap_mutex_t api_lock; /* serialize threads sharing this context */
+
+  put_agg_t agg; /* small puts waiting to be shipped */
+
+  bool striped; /* put/get split across lanes since last quiet? */
+
+  shmemc_wait_policy_t wait; /* waiting on local memory */
+
   shmemc_team_h team; /* team we belong to */
 
   /*
@@ -177,8 +250,15 @@ typedef struct comms_info {
 
   mem_region_t *regions; /**< exchanged symmetric regions */
   size_t nregions;       /**< how many regions */
+  mem_span_t *spans;     /**< local regions, sorted by base */
 
   mem_opaque_t *orks; /* opaque rkeys (nregions * PEs) */
+
+  shmemc_context_t *lanes; /**< internal contexts to stripe over */
+  size_t nlanes;           /**< how many lanes */
+  size_t next_lane;        /**< where next striped transfer starts */
+
+  bool wakeup; /**< workers can sleep on events? */
 } comms_info_t;
 
 /**
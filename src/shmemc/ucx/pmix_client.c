@@ -30,103 +30,92 @@ static pmix_proc_t my_pmix; /* about me */
 static pmix_proc_t wc_pmix; /* wildcard lookups */
 static pmix_proc_t ex_pmix; /* internal exchanges */
 
-static pmix_key_t k1; /* re-usable key spaces */
-#ifndef ENABLE_ALIGNED_ADDRESSES
-static pmix_key_t k2;
-#endif /* ENABLE_ALIGNED_ADDRESSES */
+static pmix_key_t k1; /* re-usable key space */
 
 /*
- * Make local info available to PMIx
+ * Everything another PE needs to talk to me goes out in one blob:
+ *
+ *   worker length, worker address,
+ *   then per region: base, length, rkey length, packed rkey
+ *
+ * so wire-up is one Put here and one Get per remote PE.
  */
 
-static const char *wrkr_exch_fmt = "w:%d"; /* pe */
+static const char *wireup_exch_fmt = "x:%d"; /* pe */
 
-void shmemc_pmi_publish_worker(void) {
-  pmix_status_t ps;
-  pmix_value_t v;
-
-  /* everyone publishes their info */
-  snprintf(k1, PMIX_MAX_KEYLEN, wrkr_exch_fmt, proc.li.rank);
-
-  v.type = PMIX_BYTE_OBJECT;
-  v.data.bo.bytes = (char *)proc.comms.xchg_wrkr_info[proc.li.rank].addr;
-  v.data.bo.size = proc.comms.xchg_wrkr_info[proc.li.rank].len;
+typedef uint64_t wireup_len_t;
 
-  ps = PMIx_Put(PMIX_GLOBAL, k1, &v);
-  shmemu_assert(ps == PMIX_SUCCESS, MODULE ": PMIx can't publish worker blob");
+inline static char *pack_bytes(char *bp, const void *src, size_t n) {
+  memcpy(bp, src, n);
+  return bp + n;
 }
 
-static const char *rkey_exch_fmt = "r:%lu:%d"; /* region, pe */
+inline static char *pack_len(char *bp, wireup_len_t n) {
+  return pack_bytes(bp, &n, sizeof(n));
+}
 
-inline static void publish_one_rkeys(size_t r) {
+void shmemc_pmi_publish_wireup(void) {
+  const worker_info_t *wip = &proc.comms.xchg_wrkr_info[proc.li.rank];
+  void **packed_rkeys;
+  size_t *rkey_lens;
+  size_t bloblen;
+  char *blob;
+  char *bp;
   pmix_value_t v;
-  void *packed_rkey;
-  size_t rkey_len;
   pmix_status_t ps;
-  const ucs_status_t s = shmemc_ucx_rkey_pack(
-      proc.comms.regions[r].minfo[proc.li.rank].mh, &packed_rkey, &rkey_len);
+  size_t r;
 
-  shmemu_assert(s == UCS_OK,
-                MODULE ": PMIx can't pack rkey for memory region %lu",
-                (unsigned long)r);
+  packed_rkeys = (void **)calloc(proc.comms.nregions, sizeof(*packed_rkeys));
+  rkey_lens = (size_t *)calloc(proc.comms.nregions, sizeof(*rkey_lens));
+  shmemu_assert((packed_rkeys != NULL) && (rkey_lens != NULL),
+                MODULE ": PMIx can't allocate memory for packed rkeys");
 
-  snprintf(k1, PMIX_MAX_KEYLEN, rkey_exch_fmt, r, proc.li.rank);
+  bloblen = sizeof(wireup_len_t) + wip->len;
 
-  v.type = PMIX_BYTE_OBJECT;
-  v.data.bo.bytes = (char *)packed_rkey;
-  v.data.bo.size = rkey_len;
+  for (r = 0; r < proc.comms.nregions; ++r) {
+    const ucs_status_t s =
+        shmemc_ucx_rkey_pack(proc.comms.regions[r].minfo[proc.li.rank].mh,
+                             &packed_rkeys[r], &rkey_lens[r]);
 
-  ps = PMIx_Put(PMIX_GLOBAL, k1, &v);
-  shmemu_assert(ps == PMIX_SUCCESS,
-                MODULE ": PMIx can't publish rkey for memory region %lu",
-                (unsigned long)r);
+    shmemu_assert(s == UCS_OK,
+                  MODULE ": PMIx can't pack rkey for memory region %lu",
+                  (unsigned long)r);
 
-  ucp_rkey_buffer_release(packed_rkey);
-}
+    bloblen += 3 * sizeof(wireup_len_t) + rkey_lens[r];
+  }
 
-#ifndef ENABLE_ALIGNED_ADDRESSES
-static const char *region_base_fmt = "b:%lu:%d"; /* region, pe */
-static const char *region_size_fmt = "s:%lu:%d"; /* region, pe */
-#endif /* ! ENABLE_ALIGNED_ADDRESSES */
+  blob = (char *)malloc(bloblen);
+  shmemu_assert(blob != NULL,
+                MODULE ": PMIx can't allocate memory for wire-up blob");
 
-#ifndef ENABLE_ALIGNED_ADDRESSES
-inline static void publish_one_heap(size_t r) {
-  pmix_status_t ps;
-  pmix_value_t vb, vs;
+  bp = pack_len(blob, wip->len);
+  bp = pack_bytes(bp, wip->addr, wip->len);
 
-  snprintf(k1, PMIX_MAX_KEYLEN, region_base_fmt, r, proc.li.rank);
-  snprintf(k2, PMIX_MAX_KEYLEN, region_size_fmt, r, proc.li.rank);
+  for (r = 0; r < proc.comms.nregions; ++r) {
+    const mem_info_t *mip = &proc.comms.regions[r].minfo[proc.li.rank];
 
-  vb.type = PMIX_UINT64;
-  vb.data.uint64 = proc.comms.regions[r].minfo[proc.li.rank].base;
-  vs.type = PMIX_SIZE;
-  vs.data.size = proc.comms.regions[r].minfo[proc.li.rank].len;
+    bp = pack_len(bp, mip->base);
+    bp = pack_len(bp, mip->len);
+    bp = pack_len(bp, rkey_lens[r]);
+    bp = pack_bytes(bp, packed_rkeys[r], rkey_lens[r]);
 
-  ps = PMIx_Put(PMIX_GLOBAL, k1, &vb);
-  shmemu_assert(ps == PMIX_SUCCESS,
-                MODULE ": PMIx can't publish heap base for "
-                       "memory region %lu",
-                r);
-  ps = PMIx_Put(PMIX_GLOBAL, k2, &vs);
-  shmemu_assert(ps == PMIX_SUCCESS,
-                MODULE ": PMIx can't publish heap size for "
-                       "memory region %lu",
-                r);
-}
-#endif /* ! ENABLE_ALIGNED_ADDRESSES */
+    ucp_rkey_buffer_release(packed_rkeys[r]);
+  }
 
-void shmemc_pmi_publish_rkeys_and_heaps(void) {
-  size_t r;
+  snprintf(k1, PMIX_MAX_KEYLEN, wireup_exch_fmt, proc.li.rank);
 
-  publish_one_rkeys(0);
+  v.type = PMIX_BYTE_OBJECT;
+  v.data.bo.bytes = blob;
+  v.data.bo.size = bloblen;
 
-  for (r = 1; r < proc.comms.nregions; ++r) {
-    publish_one_rkeys(r);
+  ps = PMIx_Put(PMIX_GLOBAL, k1, &v);
+  shmemu_assert(ps == PMIX_SUCCESS,
+                MODULE ": PMIx can't publish wire-up blob");
 
-#ifndef ENABLE_ALIGNED_ADDRESSES
-    publish_one_heap(r);
-#endif /* ! ENABLE_ALIGNED_ADDRESSES */
-  }
+  /* PMIx_Put copied it */
+  free(blob);
+  free(rkey_lens);
+  free(packed_rkeys);
 }
 
 /* -------------------------------------------------------------- */
@@ -135,130 +124,82 @@ void shmemc_pmi_publish_rkeys_and_heaps(void) {
  * Get remote info out of PMIx
  */
 
-void shmemc_pmi_exchange_workers(void) {
-  pmix_status_t ps;
-  pmix_value_t *vp = NULL;
-  int pe;
-
-  for (pe = 0; pe < proc.li.nranks; ++pe) {
-    pmix_byte_object_t *bop;
-
-    snprintf(k1, PMIX_MAX_KEYLEN, wrkr_exch_fmt, pe);
-    ex_pmix.rank = pe;
-
-    ps = PMIx_Get(&ex_pmix, k1, NULL, 0, &vp);
-    shmemu_assert(ps == PMIX_SUCCESS,
-                  MODULE ": PMIx can't find remote worker blob for PE %d", pe);
-
-    bop = &vp->data.bo;
-
-    /* save published worker */
-    proc.comms.xchg_wrkr_info[pe].buf = (char *)malloc(bop->size);
-    shmemu_assert(proc.comms.xchg_wrkr_info[pe].buf != NULL,
-                  MODULE ": PMIx can't allocate memory for "
-                         "remote workers for PE %d",
-                  pe);
-    memcpy(proc.comms.xchg_wrkr_info[pe].buf, bop->bytes, bop->size);
-  }
-  PMIX_VALUE_RELEASE(vp);
+inline static const char *unpack_len(const char *bp, wireup_len_t *np) {
+  memcpy(np, bp, sizeof(*np));
+  return bp + sizeof(*np);
 }
 
-#ifndef ENABLE_ALIGNED_ADDRESSES
-inline static void exchange_one_heap(size_t r, int pe) {
-  pmix_status_t ps;
-  pmix_value_t *vpb = NULL;
-  pmix_value_t *vps = NULL;
-  uint64_t base;
-  size_t len;
-
-  ex_pmix.rank = pe;
-
-  snprintf(k1, PMIX_MAX_KEYLEN, region_base_fmt, r, pe);
-  snprintf(k2, PMIX_MAX_KEYLEN, region_size_fmt, r, pe);
-
-  ps = PMIx_Get(&ex_pmix, k1, NULL, 0, &vpb);
-  shmemu_assert(ps == PMIX_SUCCESS,
-                MODULE ": PMIx can't fetch heap base for "
-                       "memory region %lu from PE %d",
-                (unsigned long)r, pe);
-
-  ps = PMIx_Get(&ex_pmix, k2, NULL, 0, &vps);
-  shmemu_assert(ps == PMIX_SUCCESS,
-                MODULE ": PMIx can't fetch heap size for "
-                       "memory region %lu from PE %d",
-                (unsigned long)r, pe);
-
-  base = vpb->data.uint64;
-  len = vps->data.size;
-
-  proc.comms.regions[r].minfo[pe].base = base;
-  proc.comms.regions[r].minfo[pe].len = len;
-  /* slightly redundant storage, but useful */
-  proc.comms.regions[r].minfo[pe].end = base + len;
-
-  PMIX_VALUE_RELEASE(vps);
-  PMIX_VALUE_RELEASE(vpb);
+inline static const char *unpack_copy(const char *bp, wireup_len_t n,
+                                      void **dstp, int pe) {
+  *dstp = malloc(n);
+  shmemu_assert(*dstp != NULL,
+                MODULE ": PMIx can't allocate memory for "
+                       "wire-up data from PE %d",
+                pe);
+  memcpy(*dstp, bp, n);
+  return bp + n;
 }
-#endif /* ! ENABLE_ALIGNED_ADDRESSES */
 
-inline static void exchange_one_rkeys(size_t r, int pe) {
+void shmemc_pmi_fetch_wireup(int pe) {
   pmix_status_t ps;
   pmix_value_t *vp = NULL;
-  pmix_byte_object_t *bop;
+  const char *bp;
+  wireup_len_t n;
+  void *wrkr;
+  size_t r;
 
+  snprintf(k1, PMIX_MAX_KEYLEN, wireup_exch_fmt, pe);
   ex_pmix.rank = pe;
 
-  snprintf(k1, PMIX_MAX_KEYLEN, rkey_exch_fmt, r, pe);
-
   ps = PMIx_Get(&ex_pmix, k1, NULL, 0, &vp);
   shmemu_assert(ps == PMIX_SUCCESS,
-                MODULE ": PMIx can't fetch remote rkey for "
-                       "memory region %lu from PE %d",
-                (unsigned long)r, pe);
+                MODULE ": PMIx can't find wire-up blob for PE %d", pe);
 
-  bop = &vp->data.bo;
+  bp = vp->data.bo.bytes;
 
-  /* opaque rkey */
-  proc.comms.orks[r].rkeys[pe].data = malloc(bop->size);
-  shmemu_assert(proc.comms.orks[r].rkeys[pe].data != NULL,
-                MODULE ": PMIx can't allocate memory for rkey data"
-                       " for memory region %lu from PE %d",
-                (unsigned long)r, pe);
+  /* worker */
+  bp = unpack_len(bp, &n);
+  bp = unpack_copy(bp, n, &wrkr, pe);
+  proc.comms.xchg_wrkr_info[pe].buf = (char *)wrkr;
 
-  memcpy(proc.comms.orks[r].rkeys[pe].data, bop->bytes, bop->size);
+  /* rkeys and extents of each region */
+  for (r = 0; r < proc.comms.nregions; ++r) {
+    mem_info_t *mip = &proc.comms.regions[r].minfo[pe];
+    wireup_len_t base;
+    wireup_len_t len;
 
-  PMIX_VALUE_RELEASE(vp);
-}
+    bp = unpack_len(bp, &base);
+    bp = unpack_len(bp, &len);
 
-inline static void exchange_all_rkeys(size_t r) {
-  int pe;
+    if (pe != proc.li.rank) {
+      mip->base = base;
+      mip->len = len;
+      /* slightly redundant storage, but useful */
+      mip->end = base + len;
+    }
 
-  for (pe = 0; pe < proc.li.nranks; ++pe) {
-    exchange_one_rkeys(r, pe);
+    bp = unpack_len(bp, &n);
+    bp = unpack_copy(bp, n, &proc.comms.orks[r].rkeys[pe].data, pe);
   }
-}
 
-inline static void exchange_one_rkeys_and_heaps(size_t r) {
-  int pe;
-
-  for (pe = 0; pe < proc.li.nranks; ++pe) {
-    exchange_one_rkeys(r, pe);
-
-#ifndef ENABLE_ALIGNED_ADDRESSES
-    exchange_one_heap(r, pe);
-#endif /* ! ENABLE_ALIGNED_ADDRESSES */
-  } /* PE loop */
+  PMIX_VALUE_RELEASE(vp);
 }
 
-void shmemc_pmi_exchange_rkeys_and_heaps(void) {
-  size_t r;
+/*
+ * pull in everyone's wire-up, unless connecting lazily: then only
+ * need our own for now, the rest is fetched on first contact
+ */
+void shmemc_pmi_exchange_wireup(void) {
+  int pe;
 
-  /* global rkeys */
-  exchange_all_rkeys(0);
+  if (proc.env.lazy_connect) {
+    shmemc_pmi_fetch_wireup(proc.li.rank);
+    return;
+    /* NOT REACHED */
+  }
 
-  /* now everything else */
-  for (r = 1; r < proc.comms.nregions; ++r) {
-    exchange_one_rkeys_and_heaps(r);
+  for (pe = 0; pe < proc.li.nranks; ++pe) {
+    shmemc_pmi_fetch_wireup(pe);
   }
 }
 
@@ -404,6 +345,33 @@ inline static void init_peers(void) {
 
   /* am I first on a node/in a group? */
   proc.leader = (proc.li.rank == proc.li.peers[0]);
+
+  /* other PEs' nodes are looked up when first asked for */
+  proc.li.nodes = (int *)calloc(proc.li.nranks, sizeof(*proc.li.nodes));
+  shmemu_assert(proc.li.nodes != NULL,
+                MODULE ": PMIx can't allocate memory for PE node table");
+}
+
+/*
+ * which node is "pe" on?  -1 if PMIx can't tell us
+ */
+int shmemc_pmi_node_of(int pe) {
+  pmix_proc_t pp;
+  pmix_value_t *vp = NULL;
+  pmix_status_t ps;
+  int node = -1;
+
+  PMIX_PROC_CONSTRUCT(&pp);
+  STRNCPY_SAFE(pp.nspace, my_pmix.nspace, PMIX_MAX_NSLEN + 1);
+  pp.rank = pe;
+
+  ps = PMIx_Get(&pp, PMIX_NODEID, NULL, 0, &vp);
+  if (ps == PMIX_SUCCESS) {
+    node = (int)vp->data.uint32;
+    PMIX_VALUE_RELEASE(vp);
+  }
+
+  return node;
 }
 
 /*
@@ -520,6 +488,7 @@ void shmemc_pmi_client_finalize(void) {
 
   /* clean up memory recording peer PEs */
   free(proc.li.peers);
+  free(proc.li.nodes);
 }
 
 /*
@@ -0,0 +1,226 @@
+/* For license: see LICENSE file at top-level */
+
+#ifndef _SHMEMC_UCX_SCAN_H
+#define _SHMEMC_UCX_SCAN_H 1
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include "shmemu.h"
+#include "shmemc.h"
+#include "module.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+/*
+ * Block scans for the test/wait_until _all/_any/_some families
+ *
+ * Variables are compared a block of 64 at a time, giving a bitmask of
+ * the ones that satisfy the comparison, with no branches in the
+ * compare loop.
+ *
+ * Variables get written by other PEs, so they're read with relaxed
+ * atomic loads: every sweep sees fresh values whatever the compiler
+ * makes of the loop around it.
+ *
+ * A scan set remembers which elements are still to be satisfied
+ * (excluded by "status", or already seen to be satisfied, means the
+ * bit is clear), so repeated sweeps only look at blocks with work
+ * left in them.
+ */
+
+#define SCAN_BLOCK 64 /* bits in a mask */
+
+/* sets up to this many elements don't need heap memory */
+#define SCAN_LOCAL_BLOCKS 64
+
+typedef struct scan_set {
+  uint64_t *pending;  /* bit set => still to be satisfied */
+  size_t nblocks;     /* words in pending */
+  size_t nelems;      /* how many variables */
+  size_t npending;    /* bits set in pending */
+  size_t first;       /* lowest index satisfied by last sweep */
+  uint64_t local[SCAN_LOCAL_BLOCKS];
+} scan_set_t;
+
+inline static size_t scan_block_len(const scan_set_t *sp, size_t b) {
+  const size_t start = b * SCAN_BLOCK;
+  const size_t left = sp->nelems - start;
+
+  return (left < SCAN_BLOCK) ? left : SCAN_BLOCK;
+}
+
+/*
+ * everything not excluded by "status" starts off pending
+ */
+inline static void scan_set_init(scan_set_t *sp, size_t nelems,
+                                 const int *status) {
+  size_t b;
+
+  sp->nelems = nelems;
+  sp->nblocks = (nelems + SCAN_BLOCK - 1) / SCAN_BLOCK;
+  sp->npending = 0;
+  sp->first = SIZE_MAX;
+
+  if (sp->nblocks <= SCAN_LOCAL_BLOCKS) {
+    sp->pending = sp->local;
+  } else {
+    sp->pending = (uint64_t *)malloc(sp->nblocks * sizeof(*sp->pending));
+    shmemu_assert(sp->pending != NULL,
+                  MODULE ": can't allocate memory for wait set: %s",
+                  strerror(errno));
+  }
+
+  for (b = 0; b < sp->nblocks; ++b) {
+    const size_t n = scan_block_len(sp, b);
+    uint64_t m = (n == SCAN_BLOCK) ? ~(uint64_t)0 : ((uint64_t)1 << n) - 1;
+
+    if (status != NULL) {
+      const int *sb = status + b * SCAN_BLOCK;
+      size_t j;
+
+      for (j = 0; j < n; ++j) {
+        m &= ~((uint64_t)(sb[j] != 0) << j);
+      }
+    }
+
+    sp->pending[b] = m;
+    sp->npending += __builtin_popcountll(m);
+  }
+}
+
+inline static void scan_set_finalize(scan_set_t *sp) {
+  if (sp->pending != sp->local) {
+    free(sp->pending);
+  }
+}
+
+/*
+ * progress the context being waited on between sweeps.  An invalid
+ * one has no worker of its own, so progress the default instead.
+ */
+inline static void scan_progress(shmem_ctx_t ctx) {
+  if (ctx != SHMEM_CTX_INVALID) {
+    shmemc_ctx_progress(ctx);
+  } else {
+    shmemc_progress();
+  }
+}
+
+/*
+ * Compare a block of "n" variables against a single value, or against
+ * their own values in "vs" if that's not NULL.  The "vs" are ours, so
+ * plain loads do for them.
+ *
+ * Then a sweep over the pending blocks: clears the bits of the
+ * newly-satisfied elements, appending their indices to "idxs" if not
+ * NULL, and stops at the first block with a hit if "any".  Returns how
+ * many were newly satisfied.
+ */
+
+#define SCAN_SIZE(_size, _opname, _op)                                         \
+  inline static uint64_t scan_block_##_opname##_size(                          \
+      const int##_size##_t *vars, const int##_size##_t *vs, size_t n,          \
+      int##_size##_t value) {                                                  \
+    uint64_t m = 0;                                                            \
+    size_t j;                                                                  \
+                                                                               \
+    if (vs == NULL) {                                                          \
+      for (j = 0; j < n; ++j) {                                                \
+        m |= (uint64_t)(__atomic_load_n(&vars[j], __ATOMIC_RELAXED)            \
+                            _op value)                                         \
+             << j;                                                             \
+      }                                                                        \
+    } else {                                                                   \
+      for (j = 0; j < n; ++j) {                                                \
+        m |= (uint64_t)(__atomic_load_n(&vars[j], __ATOMIC_RELAXED)            \
+                            _op vs[j])                                         \
+             << j;                                                             \
+      }                                                                        \
+    }                                                                          \
+                                                                               \
+    return m;                                                                  \
+  }                                                                            \
+                                                                               \
+  inline static size_t scan_sweep_##_opname##_size(                            \
+      scan_set_t *sp, const int##_size##_t *vars, const int##_size##_t *vs,    \
+      int##_size##_t value, size_t *idxs, bool any) {                          \
+    size_t hits = 0;                                                           \
+    size_t b;                                                                  \
+                                                                               \
+    sp->first = SIZE_MAX;                                                      \
+                                                                               \
+    for (b = 0; b < sp->nblocks; ++b) {                                        \
+      const size_t base = b * SCAN_BLOCK;                                      \
+      uint64_t m;                                                              \
+                                                                               \
+      if (sp->pending[b] == 0) {                                               \
+        continue;                                                              \
+      }                                                                        \
+                                                                               \
+      m = scan_block_##_opname##_size(vars + base,                             \
+                                      (vs != NULL) ? vs + base : NULL,         \
+                                      scan_block_len(sp, b), value);           \
+      m &= sp->pending[b];                                                     \
+      if (m == 0) {                                                            \
+        continue;                                                              \
+      }                                                                        \
+                                                                               \
+      sp->pending[b] &= ~m;                                                    \
+      if (sp->first == SIZE_MAX) {                                             \
+        sp->first = base + __builtin_ctzll(m);                                 \
+      }                                                                        \
+                                                                               \
+      if (idxs != NULL) {                                                      \
+        uint64_t r = m;                                                        \
+                                                                               \
+        while (r != 0) {                                                       \
+          idxs[hits++] = base + __builtin_ctzll(r);                            \
+          r &= r - 1;                                                          \
+        }                                                                      \
+      } else {                                                                 \
+        hits += __builtin_popcountll(m);                                       \
+      }                                                                        \
+                                                                               \
+      if (any) {                                                               \
+        break;                                                                 \
+      }                                                                        \
+    }                                                                          \
+                                                                               \
+    sp->npending -= hits;                                                      \
+                                                                               \
+    return hits;                                                               \
+  }
+
+SCAN_SIZE(16, eq, ==)
+SCAN_SIZE(32, eq, ==)
+SCAN_SIZE(64, eq, ==)
+
+SCAN_SIZE(16, ne, !=)
+SCAN_SIZE(32, ne, !=)
+SCAN_SIZE(64, ne, !=)
+
+SCAN_SIZE(16, gt, >)
+SCAN_SIZE(32, gt, >)
+SCAN_SIZE(64, gt, >)
+
+SCAN_SIZE(16, le, <=)
+SCAN_SIZE(32, le, <=)
+SCAN_SIZE(64, le, <=)
+
+SCAN_SIZE(16, lt, <)
+SCAN_SIZE(32, lt, <)
+SCAN_SIZE(64, lt, <)
+
+SCAN_SIZE(16, ge, >=)
+SCAN_SIZE(32, ge, >=)
+SCAN_SIZE(64, ge, >=)
+
+#undef SCAN_SIZE
+
+#endif /* ! _SHMEMC_UCX_SCAN_H */
@@ -16,17 +16,30 @@ void shmemc_ucx_teardown_context(shmemc_context_h ch) {
   size_t r;
   int pe;
 
+  /* first keep the progress thread away, no-op if never listed */
+  shmemc_ucx_live_remove(ch);
+
   shmemc_ucx_disconnect_all_eps(ch);
   /* release remote access memory */
   for (r = 0; r < proc.comms.nregions; ++r) {
     for (pe = 0; pe < proc.li.nranks; ++pe) {
-      ucp_rkey_destroy(ch->racc[r].rinfo[pe].rkey);
+      /* might never have connected to this PE */
+      if (ch->racc[r].rinfo[pe].rkey != NULL) {
+        ucp_rkey_destroy(ch->racc[r].rinfo[pe].rkey);
+      }
     }
     free(ch->racc[r].rinfo);
   }
   free(ch->racc);
 
+  free(ch->nbi_amos.reqs);
+
+  shmemc_ucx_agg_finalize(ch);
+
   shmemc_ucx_deallocate_eps_table(ch);
+
+  threadwrap_mutex_destroy(&ch->api_lock);
+
   ucp_worker_destroy(ch->w);
 }
 
@@ -6,6 +6,7 @@
 
 #include "shmemu.h"
 #include "shmemc.h"
+#include "scan.h"
 
 /*
  * return 1 if the memory location changed w.r.t "value", otherwise 0
@@ -14,12 +15,10 @@
 #define COMMS_CTX_TEST_SIZE(_size, _opname, _op)                               \
   int shmemc_ctx_test_##_opname##_size(shmem_ctx_t ctx, int##_size##_t *var,   \
                                        int##_size##_t value) {                 \
-    NO_WARN_UNUSED(ctx);                                                       \
-                                                                               \
-    int ret = ((*var)_op(value)) ? 1 : 0;                                      \
+    int ret = (__atomic_load_n(var, __ATOMIC_RELAXED) _op value) ? 1 : 0;      \
                                                                                \
     if (ret == 0) {                                                            \
-      shmemc_progress();                                                       \
+      scan_progress(ctx);                                                      \
     }                                                                          \
                                                                                \
     return ret;                                                                \
@@ -52,24 +51,28 @@ COMMS_CTX_TEST_SIZE(64, ge, >=)
 /*
  * return 1 if all the memory locations changed w.r.t "value",
  * otherwise 0
+ *
+ * The multi-variable tests scan in blocks (see scan.h) and make at
+ * most one progress call.
  */
 
 #define COMMS_CTX_TEST_ALL_SIZE(_size, _opname)                                \
   int shmemc_ctx_test_all_##_opname##_size(                                    \
       shmem_ctx_t ctx, int##_size##_t *vars, size_t nelems, const int *status, \
       int##_size##_t value) {                                                  \
-    size_t i;                                                                  \
-    int n = 0;                                                                 \
+    scan_set_t s;                                                              \
+    int ret;                                                                   \
                                                                                \
-    for (i = 0; i < nelems; ++i) {                                             \
-      if ((status != NULL) && (status[i] != 0)) {                              \
-        continue;                                                              \
-      }                                                                        \
+    scan_set_init(&s, nelems, status);                                         \
+    (void)scan_sweep_##_opname##_size(&s, vars, NULL, value, NULL, false);     \
+    ret = (s.npending == 0) ? 1 : 0;                                           \
+    scan_set_finalize(&s);                                                     \
                                                                                \
-      n += shmemc_ctx_test_##_opname##_size(ctx, &(vars[i]), value);           \
+    if (ret == 0) {                                                            \
+      scan_progress(ctx);                                                      \
     }                                                                          \
                                                                                \
-    return ((size_t)n == nelems) ? 1 : 0;                                      \
+    return ret;                                                                \
   }
 
 COMMS_CTX_TEST_ALL_SIZE(16, eq)
@@ -104,19 +107,18 @@ COMMS_CTX_TEST_ALL_SIZE(64, ge)
   size_t shmemc_ctx_test_some_##_opname##_size(                                \
       shmem_ctx_t ctx, int##_size##_t *vars, size_t nelems, size_t *idxs,      \
       const int *status, int##_size##_t value) {                               \
-    size_t n;                                                                  \
-    size_t i = 0;                                                              \
+    scan_set_t s;                                                              \
+    size_t hits;                                                               \
                                                                                \
-    for (n = 0; n < nelems; ++n) {                                             \
-      if ((status != NULL) && (status[n] != 0)) {                              \
-        continue;                                                              \
-      }                                                                        \
+    scan_set_init(&s, nelems, status);                                         \
+    hits = scan_sweep_##_opname##_size(&s, vars, NULL, value, idxs, false);    \
+    scan_set_finalize(&s);                                                     \
                                                                                \
-      if (shmemc_ctx_test_##_opname##_size(ctx, &(vars[n]), value) != 0) {     \
-        idxs[i++] = n;                                                         \
-      }                                                                        \
+    if (hits == 0) {                                                           \
+      scan_progress(ctx);                                                      \
     }                                                                          \
-    return i;                                                                  \
+                                                                               \
+    return hits;                                                               \
   }
 
 COMMS_CTX_TEST_SOME_SIZE(16, eq)
@@ -145,25 +147,26 @@ COMMS_CTX_TEST_SOME_SIZE(64, ge)
 
 /*
  * return the index of a memory location that changed w.r.t "value",
- * otherwise 0
+ * otherwise SIZE_MAX
  */
 
 #define COMMS_CTX_TEST_ANY_SIZE(_size, _opname)                                \
   size_t shmemc_ctx_test_any_##_opname##_size(                                 \
       shmem_ctx_t ctx, int##_size##_t *vars, size_t nelems, const int *status, \
       int##_size##_t value) {                                                  \
-    size_t n;                                                                  \
+    scan_set_t s;                                                              \
+    size_t winner;                                                             \
                                                                                \
-    for (n = 0; n < nelems; ++n) {                                             \
-      if ((status != NULL) && (status[n] != 0)) {                              \
-        continue;                                                              \
-      }                                                                        \
+    scan_set_init(&s, nelems, status);                                         \
+    (void)scan_sweep_##_opname##_size(&s, vars, NULL, value, NULL, true);      \
+    winner = s.first;                                                          \
+    scan_set_finalize(&s);                                                     \
                                                                                \
-      if (shmemc_ctx_test_##_opname##_size(ctx, &(vars[n]), value) != 0) {     \
-        return n;                                                              \
-      }                                                                        \
+    if (winner == SIZE_MAX) {                                                  \
+      scan_progress(ctx);                                                      \
     }                                                                          \
-    return 0;                                                                  \
+                                                                               \
+    return winner;                                                             \
   }
 
 COMMS_CTX_TEST_ANY_SIZE(16, eq)
@@ -194,19 +197,20 @@ COMMS_CTX_TEST_ANY_SIZE(64, ge)
   int shmemc_ctx_test_all_vector_##_opname##_size(                             \
       shmem_ctx_t ctx, int##_size##_t *vars, size_t nelems, const int *status, \
       void *values) {                                                          \
-    int##_size##_t *vs = (int##_size##_t *)values;                             \
-    size_t i;                                                                  \
-    int n = 0;                                                                 \
+    const int##_size##_t *vs = (const int##_size##_t *)values;                 \
+    scan_set_t s;                                                              \
+    int ret;                                                                   \
                                                                                \
-    for (i = 0; i < nelems; ++i) {                                             \
-      if ((status != NULL) && (status[i] != 0)) {                              \
-        continue;                                                              \
-      }                                                                        \
+    scan_set_init(&s, nelems, status);                                         \
+    (void)scan_sweep_##_opname##_size(&s, vars, vs, 0, NULL, false);           \
+    ret = (s.npending == 0) ? 1 : 0;                                           \
+    scan_set_finalize(&s);                                                     \
                                                                                \
-      n += shmemc_ctx_test_##_opname##_size(ctx, &(vars[i]), vs[i]);           \
+    if (ret == 0) {                                                            \
+      scan_progress(ctx);                                                      \
     }                                                                          \
                                                                                \
-    return ((size_t)n == nelems) ? 1 : 0;                                      \
+    return ret;                                                                \
   }
 
 COMMS_CTX_TEST_ALL_VECTOR_SIZE(16, eq)
@@ -237,20 +241,19 @@ COMMS_CTX_TEST_ALL_VECTOR_SIZE(64, ge)
   size_t shmemc_ctx_test_some_vector_##_opname##_size(                         \
       shmem_ctx_t ctx, int##_size##_t *vars, size_t nelems, size_t *idxs,      \
       const int *status, void *values) {                                       \
-    int##_size##_t *vs = (int##_size##_t *)values;                             \
-    size_t n;                                                                  \
-    size_t i = 0;                                                              \
+    const int##_size##_t *vs = (const int##_size##_t *)values;                 \
+    scan_set_t s;                                                              \
+    size_t hits;                                                               \
                                                                                \
-    for (n = 0; n < nelems; ++n) {                                             \
-      if ((status != NULL) && (status[n] != 0)) {                              \
-        continue;                                                              \
-      }                                                                        \
+    scan_set_init(&s, nelems, status);                                         \
+    hits = scan_sweep_##_opname##_size(&s, vars, vs, 0, idxs, false);          \
+    scan_set_finalize(&s);                                                     \
                                                                                \
-      if (shmemc_ctx_test_##_opname##_size(ctx, &(vars[n]), vs[n]) != 0) {     \
-        idxs[i++] = n;                                                         \
-      }                                                                        \
+    if (hits == 0) {                                                           \
+      scan_progress(ctx);                                                      \
     }                                                                          \
-    return i;                                                                  \
+                                                                               \
+    return hits;                                                               \
   }
 
 COMMS_CTX_TEST_SOME_VECTOR_SIZE(16, eq)
@@ -281,19 +284,20 @@ COMMS_CTX_TEST_SOME_VECTOR_SIZE(64, ge)
   size_t shmemc_ctx_test_any_vector_##_opname##_size(                          \
       shmem_ctx_t ctx, int##_size##_t *vars, size_t nelems, const int *status, \
       void *values) {                                                          \
-    int##_size##_t *vs = (int##_size##_t *)values;                             \
-    size_t n;                                                                  \
+    const int##_size##_t *vs = (const int##_size##_t *)values;                 \
+    scan_set_t s;                                                              \
+    size_t winner;                                                             \
                                                                                \
-    for (n = 0; n < nelems; ++n) {                                             \
-      if ((status != NULL) && (status[n] != 0)) {                              \
-        continue;                                                              \
-      }                                                                        \
+    scan_set_init(&s, nelems, status);                                         \
+    (void)scan_sweep_##_opname##_size(&s, vars, vs, 0, NULL, true);            \
+    winner = s.first;                                                          \
+    scan_set_finalize(&s);                                                     \
                                                                                \
-      if (shmemc_ctx_test_##_opname##_size(ctx, &(vars[n]), vs[n]) != 0) {     \
-        return n;                                                              \
-      }                                                                        \
+    if (winner == SIZE_MAX) {                                                  \
+      scan_progress(ctx);                                                      \
     }                                                                          \
-    return 0;                                                                  \
+                                                                               \
+    return winner;                                                             \
   }
 
 COMMS_CTX_TEST_ANY_VECTOR_SIZE(16, eq)
@@ -0,0 +1,119 @@
+/* For license: see LICENSE file at top-level */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include "shmemu.h"
+#include "shmemc.h"
+#include "state.h"
+#include "api.h"
+#include "module.h"
+
+#include "yielder.h"
+
+#include <time.h>
+
+#include <ucp/api/ucp.h>
+
+/*
+ * Waiting on local memory
+ *
+ * Three phases, by how long we've been waiting so far:
+ *
+ *   - spin: just go round again, for short waits.  The clock is only
+ *     read every CLOCK_SPINS times round, it costs more than a load.
+ *
+ *   - wait_mem: let UCX park the core on the address (WFE, UMWAIT
+ *     etc. where the platform has them), then yield
+ *
+ *   - block: sleep on the worker's wakeup fd.  Puts into our memory
+ *     don't raise worker events, so the sleep is bounded and we
+ *     look again afterwards.  Each sleep is an eighth of the time
+ *     waited so far (within limits), so a put that lands during one
+ *     is noticed late by a fraction of the wait, not a fixed tick.
+ *
+ * Each context has its own policy, defaulting to the environment
+ * settings.  Blocking needs UCX's wakeup feature, asked for at
+ * startup.
+ */
+
+#define CLOCK_SPINS 64
+
+#define BLOCK_MIN_NS 10000UL   /* 10us */
+#define BLOCK_MAX_NS 1000000UL /* 1ms */
+
+inline static uint64_t now_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+void shmemc_ctx_set_wait_policy(shmem_ctx_t ctx, size_t spin_ns,
+                                size_t block_ns) {
+  shmemc_context_h ch = (shmemc_context_h)ctx;
+
+  if (ctx == SHMEM_CTX_INVALID) {
+    return;
+    /* NOT REACHED */
+  }
+
+  if ((block_ns > 0) && !proc.comms.wakeup) {
+    shmemu_warn(MODULE ": context #%lu can't block while waiting "
+                       "(set SHMEM_WAIT_BLOCK at startup)",
+                ch->id);
+  }
+
+  ch->wait.spin_ns = spin_ns;
+  ch->wait.block_ns = block_ns;
+}
+
+void shmemc_waiter_init(shmemc_waiter_t *wp, shmem_ctx_t ctx) {
+  wp->ctx = ctx;
+  wp->start_ns = now_ns();
+  wp->waited_ns = 0;
+  wp->spins = 0;
+}
+
+void shmemc_waiter_pause(shmemc_waiter_t *wp, void *addr) {
+  shmemc_context_h ch = (shmemc_context_h)wp->ctx;
+  uint64_t waited;
+
+  if (wp->waited_ns < ch->wait.spin_ns) {
+    if (++wp->spins < CLOCK_SPINS) {
+      return;
+      /* NOT REACHED */
+    }
+    wp->spins = 0;
+  }
+
+  waited = now_ns() - wp->start_ns;
+  wp->waited_ns = waited;
+
+  if (waited < ch->wait.spin_ns) {
+    return;
+    /* NOT REACHED */
+  }
+
+  if ((ch->wait.block_ns > 0) && (waited >= ch->wait.block_ns) &&
+      proc.comms.wakeup) {
+    uint64_t nap = waited / 8;
+
+    if (nap < BLOCK_MIN_NS) {
+      nap = BLOCK_MIN_NS;
+    } else if (nap > BLOCK_MAX_NS) {
+      nap = BLOCK_MAX_NS;
+    }
+
+    shmemc_ucx_worker_block(ch, nap);
+    return;
+    /* NOT REACHED */
+  }
+
+  if (addr != NULL) {
+    ucp_worker_wait_mem(ch->w, addr);
+  }
+  yielder();
+}
@@ -7,7 +7,7 @@
 #include "shmemu.h"
 #include "shmemc.h"
 
-#include "yielder.h"
+#include "scan.h"
 
 #include <ucp/api/ucp.h>
 
@@ -18,11 +18,12 @@
 #define COMMS_CTX_WAIT_SIZE(_size, _opname)                                    \
   void shmemc_ctx_wait_until_##_opname##_size(                                 \
       shmem_ctx_t ctx, int##_size##_t *var, int##_size##_t value) {            \
-    shmemc_context_h ch = (shmemc_context_h)ctx;                               \
+    shmemc_waiter_t w;                                                         \
+                                                                               \
+    shmemc_waiter_init(&w, ctx);                                               \
                                                                                \
     while (shmemc_ctx_test_##_opname##_size(ctx, var, value) == 0) {           \
-      ucp_worker_wait_mem(ch->w, var);                                         \
-      yielder();                                                               \
+      shmemc_waiter_pause(&w, var);                                            \
     }                                                                          \
   }
 
@@ -54,20 +55,22 @@ COMMS_CTX_WAIT_SIZE(64, ge)
   void shmemc_ctx_wait_until_all_##_opname##_size(                             \
       shmem_ctx_t ctx, int##_size##_t *vars, size_t nelems, const int *status, \
       int##_size##_t value) {                                                  \
-    size_t n = 0;                                                              \
-    size_t i;                                                                  \
+    shmemc_waiter_t w;                                                         \
+    scan_set_t s;                                                              \
+                                                                               \
+    shmemc_waiter_init(&w, ctx);                                               \
+    scan_set_init(&s, nelems, status);                                         \
                                                                                \
-    do {                                                                       \
-      for (i = 0; i < nelems; ++i) {                                           \
-        if ((status != NULL) && (status[i] != 0)) {                            \
-          continue;                                                            \
-        }                                                                      \
-        if (shmemc_ctx_test_##_opname##_size(ctx, &(vars[i]), value) != 0) {   \
-          ++n;                                                                 \
-        }                                                                      \
-        yielder();                                                             \
+    while (1) {                                                                \
+      (void)scan_sweep_##_opname##_size(&s, vars, NULL, value, NULL, false);   \
+      if (s.npending == 0) {                                                   \
+        break;                                                                 \
       }                                                                        \
-    } while (n < nelems);                                                      \
+      scan_progress(ctx); /* once per sweep */                                 \
+      shmemc_waiter_pause(&w, NULL);                                           \
+    }                                                                          \
+                                                                               \
+    scan_set_finalize(&s);                                                     \
   }
 
 COMMS_CTX_WAIT_UNTIL_ALL_SIZE(16, eq)
@@ -98,25 +101,25 @@ COMMS_CTX_WAIT_UNTIL_ALL_SIZE(64, ge)
   size_t shmemc_ctx_wait_until_any_##_opname##_size(                           \
       shmem_ctx_t ctx, int##_size##_t *vars, size_t nelems, const int *status, \
       int##_size##_t value) {                                                  \
-    size_t winner;                                                             \
-    size_t i;                                                                  \
+    shmemc_waiter_t w;                                                         \
+    scan_set_t s;                                                              \
+    size_t winner = SIZE_MAX;                                                  \
                                                                                \
-    while (1) {                                                                \
-      for (i = 0; i < nelems; ++i) {                                           \
-        if ((status != NULL) && (status[i] != 0)) {                            \
-          continue;                                                            \
-        }                                                                      \
+    shmemc_waiter_init(&w, ctx);                                               \
+    scan_set_init(&s, nelems, status);                                         \
                                                                                \
-        if (shmemc_ctx_test_##_opname##_size(ctx, &(vars[i]), value) != 0) {   \
-          winner = i;                                                          \
-          goto ret;                                                            \
-          /* NOT REACHED */                                                    \
-        }                                                                      \
-        yielder();                                                             \
+    while (s.npending > 0) {                                                   \
+      (void)scan_sweep_##_opname##_size(&s, vars, NULL, value, NULL, true);    \
+      if (s.first != SIZE_MAX) {                                               \
+        winner = s.first;                                                      \
+        break;                                                                 \
       }                                                                        \
+      scan_progress(ctx); /* once per sweep */                                 \
+      shmemc_waiter_pause(&w, NULL);                                           \
     }                                                                          \
                                                                                \
-  ret:                                                                         \
+    scan_set_finalize(&s);                                                     \
+                                                                               \
     return winner;                                                             \
   }
 
@@ -148,24 +151,24 @@ COMMS_CTX_WAIT_UNTIL_ANY_SIZE(64, ge)
   size_t shmemc_ctx_wait_until_some_##_opname##_size(                          \
       shmem_ctx_t ctx, int##_size##_t *vars, size_t nelems, size_t *idxs,      \
       const int *status, int##_size##_t value) {                               \
-    size_t i;                                                                  \
+    shmemc_waiter_t w;                                                         \
+    scan_set_t s;                                                              \
     size_t hits = 0;                                                           \
                                                                                \
-    /* find any one (there may be others too, further up) */                   \
-    (void)shmemc_ctx_wait_until_any_##_opname##_size(ctx, vars, nelems,        \
-                                                     status, value);           \
-    /* see which ones match */                                                 \
-    for (i = 0; i < nelems; ++i) {                                             \
-      if ((status != NULL) && (status[i] != 0)) {                              \
-        continue;                                                              \
-      }                                                                        \
+    shmemc_waiter_init(&w, ctx);                                               \
+    scan_set_init(&s, nelems, status);                                         \
                                                                                \
-      if (shmemc_ctx_test_##_opname##_size(ctx, &(vars[i]), value) != 0) {     \
-        idxs[hits] = i;                                                        \
-        ++hits;                                                                \
+    while (s.npending > 0) {                                                   \
+      hits = scan_sweep_##_opname##_size(&s, vars, NULL, value, idxs, false);  \
+      if (hits > 0) {                                                          \
+        break;                                                                 \
       }                                                                        \
-      yielder();                                                               \
+      scan_progress(ctx); /* once per sweep */                                 \
+      shmemc_waiter_pause(&w, NULL);                                           \
     }                                                                          \
+                                                                               \
+    scan_set_finalize(&s);                                                     \
+                                                                               \
     return hits;                                                               \
   }
 
@@ -197,21 +200,23 @@ COMMS_CTX_WAIT_UNTIL_SOME_SIZE(64, ge)
   void shmemc_ctx_wait_until_all_vector_##_opname##_size(                      \
       shmem_ctx_t ctx, int##_size##_t *vars, size_t nelems, const int *status, \
       void *values) {                                                          \
-    int##_size##_t *vs = (int##_size##_t *)values;                             \
-    size_t n = 0;                                                              \
-    size_t i;                                                                  \
+    const int##_size##_t *vs = (const int##_size##_t *)values;                 \
+    shmemc_waiter_t w;                                                         \
+    scan_set_t s;                                                              \
                                                                                \
-    do {                                                                       \
-      for (i = 0; i < nelems; ++i) {                                           \
-        if ((status != NULL) && (status[i] != 0)) {                            \
-          continue;                                                            \
-        }                                                                      \
-        if (shmemc_ctx_test_##_opname##_size(ctx, &(vars[i]), vs[i]) != 0) {   \
-          ++n;                                                                 \
-        }                                                                      \
-        yielder();                                                             \
+    shmemc_waiter_init(&w, ctx);                                               \
+    scan_set_init(&s, nelems, status);                                         \
+                                                                               \
+    while (1) {                                                                \
+      (void)scan_sweep_##_opname##_size(&s, vars, vs, 0, NULL, false);         \
+      if (s.npending == 0) {                                                   \
+        break;                                                                 \
       }                                                                        \
-    } while (n < nelems);                                                      \
+      scan_progress(ctx); /* once per sweep */                                 \
+      shmemc_waiter_pause(&w, NULL);                                           \
+    }                                                                          \
+                                                                               \
+    scan_set_finalize(&s);                                                     \
   }
 
 COMMS_CTX_WAIT_UNTIL_ALL_VECTOR_SIZE(16, eq)
@@ -242,26 +247,26 @@ COMMS_CTX_WAIT_UNTIL_ALL_VECTOR_SIZE(64, ge)
   size_t shmemc_ctx_wait_until_any_vector_##_opname##_size(                    \
       shmem_ctx_t ctx, int##_size##_t *vars, size_t nelems, const int *status, \
       void *values) {                                                          \
-    int##_size##_t *vs = (int##_size##_t *)values;                             \
-    size_t winner;                                                             \
-    size_t i;                                                                  \
+    const int##_size##_t *vs = (const int##_size##_t *)values;                 \
+    shmemc_waiter_t w;                                                         \
+    scan_set_t s;                                                              \
+    size_t winner = SIZE_MAX;                                                  \
                                                                                \
-    while (1) {                                                                \
-      for (i = 0; i < nelems; ++i) {                                           \
-        if ((status != NULL) && (status[i] != 0)) {                            \
-          continue;                                                            \
-        }                                                                      \
+    shmemc_waiter_init(&w, ctx);                                               \
+    scan_set_init(&s, nelems, status);                                         \
                                                                                \
-        if (shmemc_ctx_test_##_opname##_size(ctx, &(vars[i]), vs[i]) != 0) {   \
-          winner = i;                                                          \
-          goto ret;                                                            \
-          /* NOT REACHED */                                                    \
-        }                                                                      \
-        yielder();                                                             \
+    while (s.npending > 0) {                                                   \
+      (void)scan_sweep_##_opname##_size(&s, vars, vs, 0, NULL, true);          \
+      if (s.first != SIZE_MAX) {                                               \
+        winner = s.first;                                                      \
+        break;                                                                 \
       }                                                                        \
+      scan_progress(ctx); /* once per sweep */                                 \
+      shmemc_waiter_pause(&w, NULL);                                           \
     }                                                                          \
                                                                                \
-  ret:                                                                         \
+    scan_set_finalize(&s);                                                     \
+                                                                               \
     return winner;                                                             \
   }
 
@@ -293,25 +298,25 @@ COMMS_CTX_WAIT_UNTIL_ANY_VECTOR_SIZE(64, ge)
   size_t shmemc_ctx_wait_until_some_vector_##_opname##_size(                   \
       shmem_ctx_t ctx, int##_size##_t *vars, size_t nelems, size_t *idxs,      \
       const int *status, void *values) {                                       \
-    int##_size##_t *vs = (int##_size##_t *)values;                             \
-    size_t i;                                                                  \
+    const int##_size##_t *vs = (const int##_size##_t *)values;                 \
+    shmemc_waiter_t w;                                                         \
+    scan_set_t s;                                                              \
     size_t hits = 0;                                                           \
                                                                                \
-    /* find any one (there may be others too, further up) */                   \
-    (void)shmemc_ctx_wait_until_any_vector_##_opname##_size(ctx, vars, nelems, \
-                                                            status, vs);       \
-    /* see which ones match */                                                 \
-    for (i = 0; i < nelems; ++i) {                                             \
-      if ((status != NULL) && (status[i] != 0)) {                              \
-        continue;                                                              \
-      }                                                                        \
+    shmemc_waiter_init(&w, ctx);                                               \
+    scan_set_init(&s, nelems, status);                                         \
                                                                                \
-      if (shmemc_ctx_test_##_opname##_size(ctx, &(vars[i]), vs[i]) != 0) {     \
-        idxs[hits] = i;                                                        \
-        ++hits;                                                                \
+    while (s.npending > 0) {                                                   \
+      hits = scan_sweep_##_opname##_size(&s, vars, vs, 0, idxs, false);        \
+      if (hits > 0) {                                                          \
+        break;                                                                 \
       }                                                                        \
-      yielder();                                                               \
+      scan_progress(ctx); /* once per sweep */                                 \
+      shmemc_waiter_pause(&w, NULL);                                           \
     }                                                                          \
+                                                                               \
+    scan_set_finalize(&s);                                                     \
+                                                                               \
     return hits;                                                               \
   }
 
@@ -0,0 +1,254 @@
+/* For license: see LICENSE file at top-level */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include "shmemu.h"
+#include "shmemc.h"
+#include "state.h"
+#include "api.h"
+#include "yielder.h"
+#include "module.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/epoll.h>
+
+#include <ucp/api/ucp.h>
+
+/*
+ * Live workers, for the progress thread
+ *
+ * Every context whose worker can be driven from another thread is
+ * listed here, so the progress thread can get to user contexts as
+ * well as the default one.  Private and serialized contexts are left
+ * alone, as UCX doesn't let another thread near their workers.
+ *
+ * In event mode, each listed worker's wakeup fd also goes into an
+ * epoll set, so the progress thread can sleep until something
+ * happens instead of polling.
+ *
+ * The lock only covers the list itself: progress (which can run user
+ * active message handlers) happens outside it.  Instead, the
+ * progress thread notes which context it's progressing, and removal
+ * waits for it to be done with that one.
+ */
+
+static shmemc_context_h *live = NULL;
+static size_t nlive = 0;
+static size_t live_cap = 0;
+static char live_lock = 0;
+static shmemc_context_h progressing = NULL; /* by the progress thread */
+
+static int epfd = -1; /* epoll set, if in event mode */
+
+inline static void lock_live(void) {
+  while (__atomic_test_and_set(&live_lock, __ATOMIC_ACQUIRE)) {
+    ;
+  }
+}
+
+inline static void unlock_live(void) {
+  __atomic_clear(&live_lock, __ATOMIC_RELEASE);
+}
+
+/*
+ * add/remove worker's wakeup fd to/from the epoll set (lock held)
+ */
+static void watch_worker(shmemc_context_h ch, int op) {
+  struct epoll_event ev;
+  ucs_status_t s;
+  int fd;
+  int ret;
+
+  s = ucp_worker_get_efd(ch->w, &fd);
+  shmemu_assert(s == UCS_OK,
+                MODULE ": can't get wakeup fd for context #%lu worker: %s",
+                ch->id, ucs_status_string(s));
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.ptr = ch;
+
+  ret = epoll_ctl(epfd, op, fd, &ev);
+  shmemu_assert(ret == 0,
+                MODULE ": can't update progress epoll set for "
+                       "context #%lu: %s",
+                ch->id, strerror(errno));
+}
+
+void shmemc_ucx_live_add(shmemc_context_h ch) {
+  lock_live();
+
+  if (nlive == live_cap) {
+    const size_t ncap = (live_cap > 0) ? 2 * live_cap : 16; /* magic number */
+    shmemc_context_h *lp =
+        (shmemc_context_h *)realloc(live, ncap * sizeof(*live));
+
+    shmemu_assert(lp != NULL,
+                  MODULE ": can't allocate memory for live worker list: %s",
+                  strerror(errno));
+
+    live = lp;
+    live_cap = ncap;
+  }
+
+  live[nlive++] = ch;
+
+  if (epfd >= 0) {
+    watch_worker(ch, EPOLL_CTL_ADD);
+  }
+
+  unlock_live();
+}
+
+void shmemc_ucx_live_remove(shmemc_context_h ch) {
+  size_t i;
+
+  lock_live();
+
+  for (i = 0; i < nlive; ++i) {
+    if (live[i] == ch) {
+      if (epfd >= 0) {
+        watch_worker(ch, EPOLL_CTL_DEL);
+      }
+
+      live[i] = live[--nlive]; /* order doesn't matter */
+      break;
+    }
+  }
+
+  unlock_live();
+
+  /* progress thread might still be in this worker */
+  while (__atomic_load_n(&progressing, __ATOMIC_ACQUIRE) == ch) {
+    yielder();
+  }
+}
+
+/*
+ * one round of progress on every live worker.  Return how many
+ * things happened.  Only the progress thread calls this.
+ */
+unsigned shmemc_progress_all(void) {
+  unsigned n = 0;
+  size_t i;
+
+  for (i = 0;; ++i) {
+    shmemc_context_h ch;
+
+    lock_live();
+
+    /* list can change between workers, that's fine */
+    if (i >= nlive) {
+      unlock_live();
+      break;
+      /* NOT REACHED */
+    }
+
+    ch = live[i];
+    __atomic_store_n(&progressing, ch, __ATOMIC_RELAXED);
+
+    unlock_live();
+
+    n += ucp_worker_progress(ch->w);
+
+    __atomic_store_n(&progressing, NULL, __ATOMIC_RELEASE);
+  }
+
+  return n;
+}
+
+void shmemc_progress_events_init(void) {
+  size_t i;
+
+  epfd = epoll_create1(EPOLL_CLOEXEC);
+  shmemu_assert(epfd >= 0, MODULE ": can't create progress epoll set: %s",
+                strerror(errno));
+
+  lock_live();
+
+  for (i = 0; i < nlive; ++i) {
+    watch_worker(live[i], EPOLL_CTL_ADD);
+  }
+
+  unlock_live();
+}
+
+void shmemc_progress_events_finalize(void) {
+  if (epfd >= 0) {
+    lock_live();
+    (void)close(epfd);
+    epfd = -1;
+    unlock_live();
+  }
+}
+
+/*
+ * arm every live worker, then sleep until one of them has something
+ * to do, or timeout_ms is up.  Workers made since arming aren't
+ * armed, hence the time limit.
+ */
+void shmemc_progress_wait(int timeout_ms) {
+  struct epoll_event evs[16]; /* just need to know something fired */
+  bool busy = false;
+  size_t i;
+
+  lock_live();
+
+  for (i = 0; i < nlive; ++i) {
+    const ucs_status_t s = ucp_worker_arm(live[i]->w);
+
+    if (s == UCS_ERR_BUSY) {
+      busy = true; /* events pending, don't sleep */
+      break;
+    }
+
+    shmemu_assert(s == UCS_OK,
+                  MODULE ": can't arm context #%lu worker for wakeup: %s",
+                  live[i]->id, ucs_status_string(s));
+  }
+
+  unlock_live();
+
+  if (!busy) {
+    (void)epoll_wait(epfd, evs, sizeof(evs) / sizeof(evs[0]), timeout_ms);
+  }
+}
+
+/*
+ * sleep on one worker until it has something to do, or timeout_ns
+ * is up.  poll() only does milliseconds, select() gets closer.
+ */
+void shmemc_ucx_worker_block(shmemc_context_h ch, uint64_t timeout_ns) {
+  struct timeval tv;
+  fd_set fds;
+  int fd;
+  ucs_status_t s;
+
+  s = ucp_worker_get_efd(ch->w, &fd);
+  shmemu_assert(s == UCS_OK,
+                MODULE ": can't get wakeup fd for context #%lu worker: %s",
+                ch->id, ucs_status_string(s));
+
+  s = ucp_worker_arm(ch->w);
+  if (s == UCS_ERR_BUSY) {
+    return; /* events pending, don't sleep */
+    /* NOT REACHED */
+  }
+  shmemu_assert(s == UCS_OK,
+                MODULE ": can't arm context #%lu worker for wakeup: %s",
+                ch->id, ucs_status_string(s));
+
+  FD_ZERO(&fds);
+  FD_SET(fd, &fds);
+
+  tv.tv_sec = timeout_ns / 1000000000;
+  tv.tv_usec = (timeout_ns % 1000000000) / 1000;
+
+  (void)select(fd + 1, &fds, NULL, NULL, &tv);
+}
@@ -20,6 +20,7 @@
 #ifdef ENABLE_THREADS
 
 #include "state.h"
+#include "shmemc.h"
 #include "shmem_mutex.h"
 #include "shmem/defs.h"
 #include "threading.h"
@@ -27,34 +28,39 @@
 /** Global mutex for protecting communications */
 static threadwrap_mutex_t comms_mutex;
 
+/** Mutex for the symmetric heap allocator */
+static threadwrap_mutex_t alloc_mutex;
+
 /**
  * @brief Initialize the threading subsystem
- *
- * Initializes the global communications mutex.
  */
-void shmemt_init(void) { threadwrap_mutex_init(&comms_mutex); }
+void shmemt_init(void) { shmemt_mutex_init(); }
+
+/**
+ * @brief Finalize the threading subsystem
+ */
+void shmemt_finalize(void) { shmemt_mutex_destroy(); }
 
 /**
- * @brief Initialize mutex for thread synchronization
+ * @brief Initialize mutexes for thread synchronization
  *
- * Initializes the communications mutex if thread level is
- * SHMEM_THREAD_MULTIPLE.
+ * Initializes the communications and allocator mutexes.  This happens
+ * before the thread level is known, so always do it: the lock calls
+ * decide whether to use them.
  */
 void shmemt_mutex_init(void) {
-  if (proc.td.osh_tl == SHMEM_THREAD_MULTIPLE) {
-    threadwrap_mutex_init(&comms_mutex);
-  }
+  threadwrap_mutex_init(&comms_mutex);
+  threadwrap_mutex_init(&alloc_mutex);
 }
 
 /**
- * @brief Destroy mutex used for thread synchronization
+ * @brief Destroy mutexes used for thread synchronization
  *
- * Cleans up the communications mutex if thread level is SHMEM_THREAD_MULTIPLE.
+ * Cleans up the communications and allocator mutexes.
  */
 void shmemt_mutex_destroy(void) {
-  if (proc.td.osh_tl == SHMEM_THREAD_MULTIPLE) {
-    threadwrap_mutex_destroy(&comms_mutex);
-  }
+  threadwrap_mutex_destroy(&alloc_mutex);
+  threadwrap_mutex_destroy(&comms_mutex);
 }
 
 /**
@@ -79,4 +85,69 @@ void shmemt_mutex_unlock(void) {
   }
 }
 
+/**
+ * @brief Does a context need locking?
+ *
+ * Only if threads can share it: not when private (one thread) or
+ * serialized (user keeps threads apart).  The invalid context has
+ * nothing to lock.
+ *
+ * @param ctx Context to check
+ * @return true if calls on ctx must be locked
+ */
+inline static bool ctx_needs_lock(shmem_ctx_t ctx) {
+  shmemc_context_h ch = (shmemc_context_h)ctx;
+
+  if (ctx == SHMEM_CTX_INVALID) {
+    return false;
+    /* NOT REACHED */
+  }
+
+  return (proc.td.osh_tl == SHMEM_THREAD_MULTIPLE) && !ch->attr.privat &&
+         !ch->attr.serialized;
+}
+
+/**
+ * @brief Acquire a context's lock
+ *
+ * A mutex, not a spinlock: the blocking put_signal it protects waits
+ * on the network while holding it.
+ */
+void shmemt_ctx_lock(shmem_ctx_t ctx) {
+  if (ctx_needs_lock(ctx)) {
+    threadwrap_mutex_lock(&((shmemc_context_h)ctx)->api_lock);
+  }
+}
+
+/**
+ * @brief Release a context's lock
+ */
+void shmemt_ctx_unlock(shmem_ctx_t ctx) {
+  if (ctx_needs_lock(ctx)) {
+    threadwrap_mutex_unlock(&((shmemc_context_h)ctx)->api_lock);
+  }
+}
+
+/**
+ * @brief Acquire the allocator lock
+ *
+ * Locks the mutex if thread level is SHMEM_THREAD_MULTIPLE.
+ */
+void shmemt_alloc_lock(void) {
+  if (proc.td.osh_tl == SHMEM_THREAD_MULTIPLE) {
+    threadwrap_mutex_lock(&alloc_mutex);
+  }
+}
+
+/**
+ * @brief Release the allocator lock
+ *
+ * Unlocks the mutex if thread level is SHMEM_THREAD_MULTIPLE.
+ */
+void shmemt_alloc_unlock(void) {
+  if (proc.td.osh_tl == SHMEM_THREAD_MULTIPLE) {
+    threadwrap_mutex_unlock(&alloc_mutex);
+  }
+}
+
 #endif /* ENABLE_THREADS */
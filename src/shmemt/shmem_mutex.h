@@ -16,8 +16,25 @@
 #include "config.h"
 #endif /* HAVE_CONFIG_H */
 
+#include "shmem/defs.h"
+
 #ifdef ENABLE_THREADS
 
+/*
+ * Under SHMEM_THREAD_MULTIPLE:
+ *
+ *   - SHMEMT_MUTEX_PROTECT: one process-wide lock, for things that
+ *     change process state (creating/destroying contexts)
+ *
+ *   - SHMEMT_CTX_PROTECT: a lock per context, so threads on different
+ *     contexts don't get in each other's way.  Private and serialized
+ *     contexts are not locked at all: only one thread at a time can
+ *     be using them.
+ *
+ *   - SHMEMT_ALLOC_PROTECT: a lock of its own for the symmetric heap
+ *     allocator
+ */
+
 /**
  * @brief Initialize the threading subsystem
  */
@@ -25,18 +42,16 @@ void shmemt_init(void);
 
 /**
  * @brief Finalize the threading subsystem
- *
- * No-op since there's no shutdown work needed
  */
-inline static void shmemt_finalize(void) {}
+void shmemt_finalize(void);
 
 /**
- * @brief Initialize mutex for thread synchronization
+ * @brief Initialize mutexes for thread synchronization
  */
 void shmemt_mutex_init(void);
 
 /**
- * @brief Destroy mutex used for thread synchronization
+ * @brief Destroy mutexes used for thread synchronization
  */
 void shmemt_mutex_destroy(void);
 
@@ -50,6 +65,30 @@ void shmemt_mutex_lock(void);
  */
 void shmemt_mutex_unlock(void);
 
+/**
+ * @brief Acquire a context's lock, if it needs one
+ *
+ * @param ctx Context to lock
+ */
+void shmemt_ctx_lock(shmem_ctx_t ctx);
+
+/**
+ * @brief Release a context's lock, if it needs one
+ *
+ * @param ctx Context to unlock
+ */
+void shmemt_ctx_unlock(shmem_ctx_t ctx);
+
+/**
+ * @brief Acquire the allocator lock
+ */
+void shmemt_alloc_lock(void);
+
+/**
+ * @brief Release the allocator lock
+ */
+void shmemt_alloc_unlock(void);
+
 /**
  * @brief Execute a function with mutex protection
  *
@@ -62,6 +101,31 @@ void shmemt_mutex_unlock(void);
     shmemt_mutex_unlock();                                                     \
   } while (0)
 
+/**
+ * @brief Execute a function holding a context's lock
+ *
+ * @param _ctx Context the function operates on
+ * @param _fn Function to execute within lock/unlock
+ */
+#define SHMEMT_CTX_PROTECT(_ctx, _fn)                                          \
+  do {                                                                         \
+    shmemt_ctx_lock(_ctx);                                                     \
+    _fn;                                                                       \
+    shmemt_ctx_unlock(_ctx);                                                   \
+  } while (0)
+
+/**
+ * @brief Execute a function holding the allocator lock
+ *
+ * @param _fn Function to execute within lock/unlock
+ */
+#define SHMEMT_ALLOC_PROTECT(_fn)                                              \
+  do {                                                                         \
+    shmemt_alloc_lock();                                                       \
+    _fn;                                                                       \
+    shmemt_alloc_unlock();                                                     \
+  } while (0)
+
 /**
  * @brief Execute a function without mutex protection
  *
@@ -75,8 +139,11 @@ void shmemt_mutex_unlock(void);
 #else
 
 #define shmemt_init()
+#define shmemt_finalize()
 
 #define SHMEMT_MUTEX_PROTECT(_fn) _fn
+#define SHMEMT_CTX_PROTECT(_ctx, _fn) _fn
+#define SHMEMT_ALLOC_PROTECT(_fn) _fn
 #define SHMEMT_MUTEX_NOPROTECT(_fn) _fn
 
 #endif /* ENABLE_THREADS */
@@ -19,6 +19,9 @@
 /** Type alias for pthread mutex */
 typedef pthread_mutex_t thr_mutex_t;
 
+_Static_assert(sizeof(threadwrap_mutex_t) >= sizeof(thr_mutex_t),
+               "threadwrap_mutex_t too small for pthread mutex");
+
 /**
  * @brief Initialize a mutex
  *
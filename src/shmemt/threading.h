@@ -18,8 +18,10 @@
 /** Opaque thread handle type */
 typedef void *threadwrap_thread_t;
 
-/** Opaque mutex type */
-typedef void *threadwrap_mutex_t;
+/** Opaque mutex type, big enough to hold the real thing */
+typedef struct threadwrap_mutex {
+  void *opaque[16];
+} threadwrap_mutex_t;
 
 /**
  * @brief Initialize a mutex
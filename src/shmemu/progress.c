@@ -56,8 +56,11 @@ static volatile bool done = false;
 /** Nanoseconds per second constant */
 static const long billion = 1e9;
 
+/** Nanoseconds per millisecond constant */
+static const long million = 1e6;
+
 /**
- * @brief Progress thread main function
+ * @brief Progress thread main function, polling mode
  *
  * Continuously calls communication progress function with configurable delay
  * until signaled to stop.
@@ -72,7 +75,7 @@ static void *start_progress(void *args) {
     const struct timespec ts = {.tv_sec = delay_ns / billion,
                                 .tv_nsec = delay_ns % billion};
 
-    shmemc_progress();
+    (void)shmemc_progress_all();
 
     nanosleep(&ts, NULL); /* back off */
   } while (!done);
@@ -80,6 +83,36 @@ static void *start_progress(void *args) {
   return NULL;
 }
 
+/**
+ * @brief Progress thread main function, event mode
+ *
+ * Keeps polling while there's traffic.  After enough idle polls, sleeps
+ * until a worker signals an event.  The sleep is bounded by the delay
+ * so we notice new contexts and being told to stop.
+ *
+ * @param args Thread arguments (unused)
+ * @return NULL
+ */
+static void *start_progress_events(void *args) {
+  const size_t spin = proc.env.progress_spin;
+  const long ms = delay_ns / million;
+  const int timeout_ms = (ms > 0) ? (int)ms : 1;
+  size_t idle = 0;
+
+  NO_WARN_UNUSED(args);
+
+  do {
+    if (shmemc_progress_all() > 0) {
+      idle = 0;
+    } else if (++idle >= spin) {
+      shmemc_progress_wait(timeout_ms);
+      idle = 0;
+    }
+  } while (!done);
+
+  return NULL;
+}
+
 /**
  * @brief Check if progress thread should be enabled for this PE
  *
@@ -156,7 +189,17 @@ void shmemu_progress_init(void) {
 
     logger(LOG_INIT, "progress thread delay = %ldns", delay_ns);
 
-    s = threadwrap_thread_create(&thr, start_progress, NULL);
+    if (proc.env.progress_events) {
+      logger(LOG_INIT, "progress thread sleeps on events after %lu idle polls",
+             (unsigned long)proc.env.progress_spin);
+
+      shmemc_progress_events_init();
+    }
+
+    s = threadwrap_thread_create(&thr, proc.env.progress_events
+                                           ? start_progress_events
+                                           : start_progress,
+                                 NULL);
     shmemu_assert(s == 0, MODULE ": could not create progress thread (%s)",
                   strerror(s));
   }
@@ -176,6 +219,10 @@ void shmemu_progress_finalize(void) {
     s = threadwrap_thread_join(thr, NULL);
     shmemu_assert(s == 0, MODULE ": could not terminate progress thread (%s)",
                   strerror(s));
+
+    if (proc.env.progress_events) {
+      shmemc_progress_events_finalize();
+    }
   }
 }
 
@@ -118,6 +118,7 @@ void shmemu_test_asr_mismatch(void);
  * @brief Number manipulation functions
  */
 int shmemu_parse_size(const char *size_str, size_t *bytes_p);
+int shmemu_parse_duration(const char *time_str, size_t *ns_p);
 int shmemu_human_number(double bytes, char *buf, size_t buflen);
 const char *shmemu_human_option(int v);
 int shmemu_parse_csv(char *str, int **out, size_t *nout);
@@ -16,6 +16,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <strings.h>
 #include <ctype.h>
 #include <sys/types.h>
 
@@ -98,6 +99,43 @@ int shmemu_parse_size(const char *size_str, size_t *bytes_p) {
   return 0;
 }
 
+/**
+ * @brief Parse a time with an optional unit suffix
+ *
+ * The suffix can be "ns", "us", "ms" or "s"; a plain number is in
+ * nanoseconds.
+ *
+ * @param time_str String containing the time
+ * @param ns_p Pointer to store the time in nanoseconds
+ * @return 0 on success, -1 on parsing error
+ */
+int shmemu_parse_duration(const char *time_str, size_t *ns_p) {
+  static const struct {
+    const char *suffix;
+    double ns;
+  } time_units[] = {{"", 1.0}, {"ns", 1.0}, {"us", 1.0e3}, {"ms", 1.0e6},
+                    {"s", 1.0e9}};
+  char *units;
+  double t;
+  size_t i;
+
+  t = strtod(time_str, &units);
+  if ((units == time_str) || (t < 0.0)) {
+    return -1;
+    /* NOT REACHED */
+  }
+
+  for (i = 0; i < sizeof(time_units) / sizeof(time_units[0]); ++i) {
+    if (strcasecmp(units, time_units[i].suffix) == 0) {
+      *ns_p = (size_t)(t * time_units[i].ns);
+      return 0;
+      /* NOT REACHED */
+    }
+  }
+
+  return -1;
+}
+
 /**
  * @brief Format a byte count into a human-readable string
  *